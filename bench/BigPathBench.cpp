@@ -8,9 +8,13 @@
 #include "bench/Benchmark.h"
 #include "bench/BigPath.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkGraphics.h"
 #include "include/core/SkPath.h"
 #include "tools/ToolUtils.h"
 
+#include <memory>
+
 enum Align {
     kLeft_Align,
     kMiddle_Align,
@@ -25,13 +29,23 @@ class BigPathBench : public Benchmark {
     SkString    fName;
     Align       fAlign;
     bool        fRound;
+    bool        fThreaded;
+
+    std::unique_ptr<SkExecutor> fExecutor;
+    SkExecutor*                 fPrevExecutor = nullptr;
 
 public:
-    BigPathBench(Align align, bool round) : fAlign(align), fRound(round) {
+    // If threaded, the path is filled in bands on a thread pool. See
+    // SkGraphics::SetPathFillExecutor().
+    BigPathBench(Align align, bool round, bool threaded = false)
+            : fAlign(align), fRound(round), fThreaded(threaded) {
         fName.printf("bigpath_%s", gAlignName[fAlign]);
         if (round) {
             fName.append("_round");
         }
+        if (threaded) {
+            fName.append("_mt");
+        }
     }
 
 protected:
@@ -43,7 +57,24 @@ protected:
         return SkISize::Make(640, 100);
     }
 
-    void onDelayedSetup() override { fPath = BenchUtils::make_big_path(); }
+    void onDelayedSetup() override {
+        fPath = BenchUtils::make_big_path();
+        if (fThreaded) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(4);
+        }
+    }
+
+    void onPerCanvasPreDraw(SkCanvas*) override {
+        if (fThreaded) {
+            fPrevExecutor = SkGraphics::SetPathFillExecutor(fExecutor.get());
+        }
+    }
+
+    void onPerCanvasPostDraw(SkCanvas*) override {
+        if (fThreaded) {
+            SkGraphics::SetPathFillExecutor(fPrevExecutor);
+        }
+    }
 
     void onDraw(int loops, SkCanvas* canvas) override {
         SkPaint paint;
@@ -83,3 +114,7 @@ DEF_BENCH( return new BigPathBench(kRight_Align,    false); )
 DEF_BENCH( return new BigPathBench(kLeft_Align,     true); )
 DEF_BENCH( return new BigPathBench(kMiddle_Align,   true); )
 DEF_BENCH( return new BigPathBench(kRight_Align,    true); )
+
+DEF_BENCH( return new BigPathBench(kLeft_Align,     false, true); )
+DEF_BENCH( return new BigPathBench(kMiddle_Align,   false, true); )
+DEF_BENCH( return new BigPathBench(kLeft_Align,     true,  true); )
@@ -9,7 +9,10 @@
 #ifdef SK_ENABLE_ANDROID_UTILS
 #include "bench/CodecBenchPriv.h"
 #include "client_utils/android/BitmapRegionDecoder.h"
+#include "include/codec/SkAndroidCodec.h"
+#include "include/codec/SkCodec.h"
 #include "include/core/SkBitmap.h"
+#include "include/core/SkSamplingOptions.h"
 #include "src/core/SkOSFile.h"
 
 BitmapRegionDecoderBench::BitmapRegionDecoderBench(const char* baseName, SkData* encoded,
@@ -29,6 +32,32 @@ BitmapRegionDecoderBench::BitmapRegionDecoderBench(const char* baseName, SkData*
     }
 }
 
+// The largest power of two that samples size down to no smaller than thumbnailSize.
+static uint32_t thumbnail_sample_size(SkISize size, SkISize thumbnailSize) {
+    uint32_t sampleSize = 1;
+    while (size.width() / (2 * sampleSize) >= (uint32_t)thumbnailSize.width() &&
+           size.height() / (2 * sampleSize) >= (uint32_t)thumbnailSize.height()) {
+        sampleSize *= 2;
+    }
+    return sampleSize;
+}
+
+BitmapRegionDecoderBench::BitmapRegionDecoderBench(const char* baseName, SkData* encoded,
+        SkColorType colorType, const SkIRect& subset, SkISize thumbnailSize, bool sampled)
+    : fBRD(nullptr)
+    , fData(SkRef(encoded))
+    , fColorType(colorType)
+    , fSampleSize(sampled ? thumbnail_sample_size(subset.size(), thumbnailSize) : 0)
+    , fSubset(subset)
+    , fThumbnailSize(thumbnailSize)
+{
+    fName.printf("BRD_%s_%s_thumbnail%dx%d", baseName, color_type_to_str(colorType),
+                 thumbnailSize.width(), thumbnailSize.height());
+    if (sampled) {
+        fName.append("_sampled");
+    }
+}
+
 const char* BitmapRegionDecoderBench::onGetName() {
     return fName.c_str();
 }
@@ -39,11 +68,34 @@ bool BitmapRegionDecoderBench::isSuitableFor(Backend backend) {
 
 void BitmapRegionDecoderBench::onDelayedSetup() {
     fBRD = android::skia::BitmapRegionDecoder::Make(fData);
+    if (!fThumbnailSize.isEmpty()) {
+        fCodec = SkAndroidCodec::MakeFromData(fData);
+    }
 }
 
 void BitmapRegionDecoderBench::onDraw(int n, SkCanvas* canvas) {
     auto ct = fBRD->computeOutputColorType(fColorType);
     auto cs = fBRD->computeOutputColorSpace(ct, nullptr);
+    if (!fThumbnailSize.isEmpty()) {
+        // fSampleSize is zero when getThumbnail() does the sampling.
+        const SkImageInfo info = SkImageInfo::Make(
+                fThumbnailSize, ct, fCodec->computeOutputAlphaType(false), cs);
+        const SkSamplingOptions sampling(SkFilterMode::kLinear, SkMipmapMode::kNearest);
+        for (int i = 0; i < n; i++) {
+            SkBitmap thumbnail;
+            thumbnail.allocPixels(info);
+            if (fSampleSize == 0) {
+                SkAssertResult(SkCodec::kSuccess ==
+                               fCodec->getThumbnail(thumbnail.pixmap(), &fSubset, sampling));
+            } else {
+                SkBitmap bm;
+                SkAssertResult(fBRD->decodeRegion(&bm, nullptr, fSubset, fSampleSize, ct, false,
+                                                  cs));
+                SkAssertResult(bm.pixmap().scalePixels(thumbnail.pixmap(), sampling));
+            }
+        }
+        return;
+    }
     for (int i = 0; i < n; i++) {
         SkBitmap bm;
         SkAssertResult(fBRD->decodeRegion(&bm, nullptr, fSubset, fSampleSize, ct, false, cs));
@@ -13,8 +13,11 @@
 #include "include/core/SkData.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkSize.h"
 #include "include/core/SkString.h"
 
+class SkAndroidCodec;
+
 namespace android {
 namespace skia {
 class BitmapRegionDecoder;
@@ -33,6 +36,12 @@ public:
     BitmapRegionDecoderBench(const char* basename, SkData* encoded, SkColorType colorType,
             uint32_t sampleSize, const SkIRect& subset);
 
+    // Benchmarks making a thumbnail of the subset with SkAndroidCodec::getThumbnail(), or, if
+    // sampled is true, by decoding the subset at the largest power of two sample size that covers
+    // the thumbnail and then scaling it.
+    BitmapRegionDecoderBench(const char* basename, SkData* encoded, SkColorType colorType,
+            const SkIRect& subset, SkISize thumbnailSize, bool sampled);
+
 protected:
     const char* onGetName() override;
     bool isSuitableFor(Backend backend) override;
@@ -42,10 +51,12 @@ protected:
 private:
     SkString                                            fName;
     std::unique_ptr<android::skia::BitmapRegionDecoder> fBRD;
+    std::unique_ptr<SkAndroidCodec>                     fCodec;
     sk_sp<SkData>                                       fData;
     const SkColorType                                   fColorType;
     const uint32_t                                      fSampleSize;
     const SkIRect                                       fSubset;
+    const SkISize                                       fThumbnailSize = {0, 0};
     using INHERITED = Benchmark;
 };
 #endif // SK_ENABLE_ANDROID_UTILS
@@ -23,7 +23,8 @@
 enum class ImageMode {
     kShared, // 1. One shared image referenced by every rectangle
     kUnique, // 2. Unique image for every rectangle
-    kNone    // 3. No image, solid color shading per rectangle
+    kNone,   // 3. No image, solid color shading per rectangle
+    kColor   // 4. No image, one solid color shared by every rectangle
 };
 //   X
 enum class DrawMode {
@@ -49,7 +50,7 @@ public:
 
     // There will either be 0 images, 1 image, or 1 image per rect
     inline static constexpr int kImageCount = kImageMode == ImageMode::kShared ?
-            1 : (kImageMode == ImageMode::kNone ? 0 : kRectCount);
+            1 : (kImageMode == ImageMode::kUnique ? kRectCount : 0);
 
     bool isSuitableFor(Backend backend) override {
         if (kDrawMode == DrawMode::kBatch && kImageMode == ImageMode::kNone) {
@@ -79,6 +80,8 @@ protected:
             fName.append("_sharedimage");
         } else if (kImageMode == ImageMode::kUnique) {
             fName.append("_uniqueimages");
+        } else if (kImageMode == ImageMode::kColor) {
+            fName.append("_sharedcolor");
         } else {
             fName.append("_solidcolor");
         }
@@ -157,6 +160,28 @@ protected:
         sdc->drawQuadSet(nullptr, std::move(grPaint), view, batch, kRectCount);
     }
 
+    void drawSharedColorBatch(SkCanvas* canvas) const {
+        SkASSERT(kImageMode == ImageMode::kColor);
+        SkASSERT(kDrawMode == DrawMode::kBatch);
+
+        SkPaint paint;
+        paint.setColor4f(fColors[0]);
+        paint.setAntiAlias(true);
+        canvas->experimental_DrawRects(fRects, kRectCount, paint);
+    }
+
+    void drawSharedColorRef(SkCanvas* canvas) const {
+        SkASSERT(kImageMode == ImageMode::kColor);
+        SkASSERT(kDrawMode == DrawMode::kRef);
+
+        SkPaint paint;
+        paint.setColor4f(fColors[0]);
+        paint.setAntiAlias(true);
+        for (int i = 0; i < kRectCount; ++i) {
+            canvas->drawRect(fRects[i], paint);
+        }
+    }
+
     void drawSolidColorsRef(SkCanvas* canvas) const {
         SkASSERT(kImageMode == ImageMode::kNone);
         SkASSERT(kDrawMode == DrawMode::kRef || kDrawMode == DrawMode::kQuad);
@@ -252,6 +277,12 @@ protected:
                 } else {
                     this->drawSolidColorsRef(canvas);
                 }
+            } else if (kImageMode == ImageMode::kColor) {
+                if (kDrawMode == DrawMode::kBatch) {
+                    this->drawSharedColorBatch(canvas);
+                } else {
+                    this->drawSharedColorRef(canvas);
+                }
             } else {
                 if (kDrawMode == DrawMode::kBatch) {
                     this->drawImagesBatch(canvas);
@@ -280,10 +311,16 @@ protected:
     ADD_BENCH(n, layout, ImageMode::kUnique, DrawMode::kRef)                   \
     ADD_BENCH(n, layout, ImageMode::kNone,   DrawMode::kBatch)                 \
     ADD_BENCH(n, layout, ImageMode::kNone,   DrawMode::kRef)                   \
-    ADD_BENCH(n, layout, ImageMode::kNone,   DrawMode::kQuad)
+    ADD_BENCH(n, layout, ImageMode::kNone,   DrawMode::kQuad)                  \
+    ADD_BENCH(n, layout, ImageMode::kColor,  DrawMode::kBatch)                 \
+    ADD_BENCH(n, layout, ImageMode::kColor,  DrawMode::kRef)
 
 ADD_BENCH_FAMILY(1000,  RectangleLayout::kRandom)
 ADD_BENCH_FAMILY(1000,  RectangleLayout::kGrid)
 
+// Many tiny rects, as drawn by charts
+ADD_BENCH(10000, RectangleLayout::kGrid, ImageMode::kColor, DrawMode::kBatch)
+ADD_BENCH(10000, RectangleLayout::kGrid, ImageMode::kColor, DrawMode::kRef)
+
 #undef ADD_BENCH_FAMILY
 #undef ADD_BENCH
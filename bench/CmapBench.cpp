@@ -7,14 +7,18 @@
 
 #include "bench/Benchmark.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkData.h"
 #include "include/core/SkFont.h"
 #include "include/core/SkTypeface.h"
 #include "src/base/SkRandom.h"
 #include "src/base/SkUTF.h"
 #include "src/core/SkFontPriv.h"
 #include "src/utils/SkCharToGlyphCache.h"
+#include "tools/Resources.h"
 #include "tools/fonts/FontToolUtils.h"
 
+#include <vector>
+
 enum {
     NGLYPHS = 100
 };
@@ -124,3 +128,105 @@ DEF_BENCH( return new CMAPBench(textToGlyphs_proc, "font_charToGlyph", BIG); )
 DEF_BENCH( return new CMAPBench(charsToGlyphs_proc, "face_charToGlyph", BIG); )
 DEF_BENCH( return new CMAPBench(addcache_proc, "addcache_charToGlyph", BIG); )
 DEF_BENCH( return new CMAPBench(findcache_proc, "findcache_charToGlyph", BIG); )
+
+//////////////////////////////////////////////////////////////////////////////
+
+// Maps text in scripts with large alphabets, which uses many more distinct unichars than the
+// benches above. The text is the CJK translations of the UDHR in resources/text.
+class CJKCMAPBench : public Benchmark {
+public:
+    enum class Proc {
+        kFont,          // SkFont::textToGlyphs() of the UTF-8 text
+        kAddCache,      // insert every unichar into an empty cache
+        kFindCache,     // look up each unichar in a filled cache
+        kFindGlyphs,    // look up the whole text in a filled cache
+    };
+
+    CJKCMAPBench(Proc proc, const char name[]) : fProc{proc} {
+        fName.printf("cjk_%s_charToGlyph", name);
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == Backend::kNonRendering;
+    }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    void onDelayedSetup() override {
+        for (const char* corpus : {"text/han_simplified.txt",
+                                   "text/han_traditional.txt",
+                                   "text/hangul.txt",
+                                   "text/kana.txt"}) {
+            sk_sp<SkData> data = GetResourceAsData(corpus);
+            if (data) {
+                fUTF8.append(static_cast<const char*>(data->data()), data->size());
+            }
+        }
+        const char* ptr = fUTF8.c_str();
+        const char* end = ptr + fUTF8.size();
+        while (ptr < end) {
+            const SkUnichar unichar = SkUTF::NextUTF8(&ptr, end);
+            if (unichar < 0) {
+                break;
+            }
+            fText.push_back(unichar);
+            fCache.addCharAndGlyph(unichar, FakeGlyph(unichar));
+        }
+        fGlyphs.resize(fText.size());
+
+        fFont.setTypeface(
+                ToolUtils::CreateTypefaceFromResource("fonts/NotoSansCJK-VF-subset.otf.ttc"));
+        if (!fFont.getTypeface()) {
+            fFont.setTypeface(ToolUtils::DefaultPortableTypeface());
+        }
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        const int count = SkToInt(fText.size());
+        for (int loop = 0; loop < loops; ++loop) {
+            switch (fProc) {
+                case Proc::kFont:
+                    fFont.textToGlyphs(fUTF8.c_str(), fUTF8.size(), SkTextEncoding::kUTF8,
+                                       fGlyphs.data(), count);
+                    break;
+                case Proc::kAddCache: {
+                    SkCharToGlyphCache cache;
+                    for (int i = 0; i < count; ++i) {
+                        cache.addCharAndGlyph(fText[i], FakeGlyph(fText[i]));
+                    }
+                    break;
+                }
+                case Proc::kFindCache:
+                    for (int i = 0; i < count; ++i) {
+                        fGlyphs[i] = fCache.findGlyphIndex(fText[i]);
+                    }
+                    break;
+                case Proc::kFindGlyphs:
+                    fCache.findGlyphs(fText.data(), count, fGlyphs.data());
+                    break;
+            }
+        }
+    }
+
+private:
+    // The text repeats unichars, and the cache must get the same glyph for each of them.
+    static SkGlyphID FakeGlyph(SkUnichar unichar) { return SkToU16(unichar & 0x7FFF); }
+
+    const Proc             fProc;
+    SkString               fName;
+    SkString               fUTF8;
+    std::vector<SkUnichar> fText;
+    std::vector<SkGlyphID> fGlyphs;
+    SkCharToGlyphCache     fCache;
+    SkFont                 fFont;
+
+    using INHERITED = Benchmark;
+};
+
+DEF_BENCH( return new CJKCMAPBench(CJKCMAPBench::Proc::kFont, "font"); )
+DEF_BENCH( return new CJKCMAPBench(CJKCMAPBench::Proc::kAddCache, "addcache"); )
+DEF_BENCH( return new CJKCMAPBench(CJKCMAPBench::Proc::kFindCache, "findcache"); )
+DEF_BENCH( return new CJKCMAPBench(CJKCMAPBench::Proc::kFindGlyphs, "findglyphs"); )
@@ -6,11 +6,18 @@
  */
 
 #include "bench/Benchmark.h"
+#include "include/android/SkAnimatedImage.h"
+#include "include/codec/SkAndroidCodec.h"
+#include "include/codec/SkCodec.h"
 #include "include/core/SkBitmap.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFontMgr.h"
+#include "include/core/SkImage.h"
 #include "include/core/SkPicture.h"
 #include "include/core/SkPictureRecorder.h"
 #include "modules/skottie/include/Skottie.h"
+#include "modules/skresources/src/SkAnimCodecPlayer.h"
+#include "src/base/SkRandom.h"
 #include "tools/DecodeUtils.h"
 #include "tools/Resources.h"
 #include "tools/fonts/FontToolUtils.h"
@@ -59,6 +66,117 @@ private:
 };
 
 
+// Plays an animated image with SkAnimCodecPlayer, optionally decoding ahead on a thread pool.
+// kPlay shows every frame of the animation once per loop, so the frame rate is the number of
+// frames over the time per loop. kSeek opens the animation and shows the frame at a random time
+// per loop, which may need the frames it depends on to be decoded first.
+class AnimCodecPlayerBench final : public DecodeBench {
+public:
+    enum class Mode { kPlay, kSeek };
+
+    AnimCodecPlayerBench(const char* name, const char* source, Mode mode, int threads)
+        : INHERITED(Name(name, mode, threads).c_str(), source)
+        , fMode(mode)
+        , fThreads(threads) {}
+
+    void onDelayedSetup() override {
+        INHERITED::onDelayedSetup();
+        if (fThreads > 0) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        while (loops-- > 0) {
+            std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(fData);
+            if (!codec) {
+                return;
+            }
+            const std::vector<SkCodec::FrameInfo> frameInfos = codec->getFrameInfo();
+            SkAnimCodecPlayer player(std::move(codec), fExecutor.get());
+            if (player.duration() == 0) {
+                return;
+            }
+            if (fMode == Mode::kPlay) {
+                uint32_t msec = 0;
+                for (const SkCodec::FrameInfo& frameInfo : frameInfos) {
+                    player.seek(msec);
+                    SkAssertResult(player.getFrame());
+                    msec += frameInfo.fDuration;
+                }
+            } else {
+                player.seek(fRandom.nextULessThan(player.duration()));
+                SkAssertResult(player.getFrame());
+            }
+        }
+    }
+
+private:
+    static SkString Name(const char* name, Mode mode, int threads) {
+        SkString result = SkStringPrintf("anim_%s_%s", mode == Mode::kPlay ? "play" : "seek", name);
+        if (threads > 0) {
+            result.appendf("_lookahead%d", threads);
+        }
+        return result;
+    }
+
+    const Mode                  fMode;
+    const int                   fThreads;
+    std::unique_ptr<SkExecutor> fExecutor;
+    SkRandom                    fRandom;
+
+    using INHERITED = DecodeBench;
+};
+
+// Plays every frame of an animated image once per loop with SkAnimatedImage, with its frames
+// cached and, optionally, decoded ahead on a thread pool.
+class AnimatedImageBench final : public DecodeBench {
+public:
+    AnimatedImageBench(const char* name, const char* source, int threads)
+        : INHERITED(Name(name, threads).c_str(), source)
+        , fThreads(threads) {}
+
+    void onDelayedSetup() override {
+        INHERITED::onDelayedSetup();
+        if (fThreads > 0) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        while (loops-- > 0) {
+            std::unique_ptr<SkAndroidCodec> codec = SkAndroidCodec::MakeFromData(fData);
+            if (!codec) {
+                return;
+            }
+            const SkImageInfo info = codec->getInfo();
+            sk_sp<SkAnimatedImage> image = SkAnimatedImage::Make(
+                    std::move(codec), info, info.bounds(), nullptr, fExecutor.get());
+            if (!image) {
+                return;
+            }
+            image->setRepetitionCount(0);
+            while (image->decodeNextFrame() != SkAnimatedImage::kFinished) {
+                SkAssertResult(image->getCurrentFrame());
+            }
+        }
+    }
+
+private:
+    static SkString Name(const char* name, int threads) {
+        SkString result = SkStringPrintf("animated_image_play_%s", name);
+        if (threads > 0) {
+            result.appendf("_lookahead%d", threads);
+        }
+        return result;
+    }
+
+    const int                   fThreads;
+    std::unique_ptr<SkExecutor> fExecutor;
+
+    using INHERITED = DecodeBench;
+};
+
 class SkottieDecodeBench final : public DecodeBench {
 public:
     SkottieDecodeBench(const char* name, const char* source)
@@ -102,6 +220,25 @@ private:
     using INHERITED = DecodeBench;
 };
 
+using AnimMode = AnimCodecPlayerBench::Mode;
+DEF_BENCH(return new AnimCodecPlayerBench(
+        "flightAnim", "images/flightAnim.gif", AnimMode::kPlay, 0));
+DEF_BENCH(return new AnimCodecPlayerBench(
+        "flightAnim", "images/flightAnim.gif", AnimMode::kPlay, 4));
+DEF_BENCH(return new AnimCodecPlayerBench(
+        "flightAnim", "images/flightAnim.gif", AnimMode::kSeek, 0));
+DEF_BENCH(return new AnimCodecPlayerBench(
+        "stoplight", "images/stoplight.webp", AnimMode::kPlay, 0));
+DEF_BENCH(return new AnimCodecPlayerBench(
+        "stoplight", "images/stoplight.webp", AnimMode::kPlay, 4));
+DEF_BENCH(return new AnimCodecPlayerBench(
+        "stoplight", "images/stoplight.webp", AnimMode::kSeek, 0));
+
+DEF_BENCH(return new AnimatedImageBench("flightAnim", "images/flightAnim.gif", 0));
+DEF_BENCH(return new AnimatedImageBench("flightAnim", "images/flightAnim.gif", 4));
+DEF_BENCH(return new AnimatedImageBench("stoplight", "images/stoplight.webp", 0));
+DEF_BENCH(return new AnimatedImageBench("stoplight", "images/stoplight.webp", 4));
+
 DEF_BENCH(return new SkottieDecodeBench("skottie_large",  // 426593
                                         "skottie/skottie-text-scale-to-fit-minmax.json"));
 DEF_BENCH(return new SkottieDecodeBench("skottie_medium", //  10947
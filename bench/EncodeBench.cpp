@@ -7,6 +7,12 @@
 
 #include "bench/Benchmark.h"
 #include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkShader.h"
+#include "include/core/SkTileMode.h"
 #include "include/core/SkStream.h"
 #include "include/encode/SkJpegEncoder.h"
 #include "include/encode/SkPngEncoder.h"
@@ -123,3 +129,53 @@ DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 3), "PNG_3n"));
 DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 1), "PNG_1n"));
 
 #undef PNG
+
+// Encodes a large image as PNG in strips on an executor with a given number of threads. Compare the
+// times of the _threadsN benches to see how encoding scales: the throughput in MB/s is the 16MB of
+// source pixels divided by the time.
+class EncodePngThreadsBench : public Benchmark {
+public:
+    EncodePngThreadsBench(const char* filename, int threads)
+        : fSourceFilename(filename)
+        , fThreads(threads)
+        , fName(SkStringPrintf("Encode_%s_PNG_threads%d", filename, threads)) {}
+
+    bool isSuitableFor(Backend backend) override { return backend == Backend::kNonRendering; }
+
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        sk_sp<SkImage> image = ToolUtils::GetResourceAsImage(fSourceFilename);
+        SkASSERT_RELEASE(image);
+
+        // Tile the source, so that the image is large enough to be split into many strips.
+        fBitmap.allocN32Pixels(2048, 2048);
+        SkPaint paint;
+        paint.setShader(image->makeShader(SkTileMode::kRepeat, SkTileMode::kRepeat, {}));
+        SkCanvas(fBitmap).drawPaint(paint);
+
+        fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkPngEncoder::Options opts;
+        opts.fExecutor = fExecutor.get();
+        while (loops-- > 0) {
+            SkNullWStream dst;
+            SkAssertResult(SkPngEncoder::Encode(&dst, fBitmap.pixmap(), opts));
+            SkASSERT(dst.bytesWritten() > 0);
+        }
+    }
+
+private:
+    const char*                 fSourceFilename;
+    int                         fThreads;
+    SkString                    fName;
+    SkBitmap                    fBitmap;
+    std::unique_ptr<SkExecutor> fExecutor;
+};
+
+DEF_BENCH(return new EncodePngThreadsBench(srcs[0], 1));
+DEF_BENCH(return new EncodePngThreadsBench(srcs[0], 2));
+DEF_BENCH(return new EncodePngThreadsBench(srcs[0], 4));
+DEF_BENCH(return new EncodePngThreadsBench(srcs[0], 8));
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+#include "bench/Benchmark.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkString.h"
+#include "src/core/SkTaskGroup.h"
+
+#include <memory>
+
+// Measures the per-task overhead of the SkExecutor thread pools when SkTaskGroup::batch() fans out
+// many tiny tasks, the case where every thread contends on the pool's queue.
+class ExecutorBench : public Benchmark {
+public:
+    enum class Pool { kFIFO, kLIFO, kWorkStealing };
+
+    // If fanout > 1, each top-level task batches 'fanout' more tasks from inside the pool.
+    ExecutorBench(Pool pool, int fanout) : fPool(pool), fFanout(fanout) {
+        static const char* kPoolNames[] = {"fifo", "lifo", "workstealing"};
+        fName.printf("executor_%s_%s", kPoolNames[(int)pool],
+                     fanout > 1 ? "nested" : "batch");
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == Backend::kNonRendering;
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        switch (fPool) {
+            case Pool::kFIFO:         fExecutor = SkExecutor::MakeFIFOThreadPool();         break;
+            case Pool::kLIFO:         fExecutor = SkExecutor::MakeLIFOThreadPool();         break;
+            case Pool::kWorkStealing: fExecutor = SkExecutor::MakeWorkStealingThreadPool(); break;
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkTaskGroup tasks(*fExecutor);
+        if (fFanout > 1) {
+            tasks.batch(loops, [&](int) {
+                SkTaskGroup subtasks(*fExecutor);
+                subtasks.batch(fFanout, [&](int i) { work(i); });
+                subtasks.wait();
+            });
+        } else {
+            tasks.batch(loops, [&](int i) { work(i); });
+        }
+        tasks.wait();
+    }
+
+private:
+    static void work(int i) {
+        // Just enough work that the compiler can't drop the task, without sharing any state.
+        volatile int x = i;
+        x = x * 3 + 1;
+    }
+
+    Pool                        fPool;
+    int                         fFanout;
+    SkString                    fName;
+    std::unique_ptr<SkExecutor> fExecutor;
+};
+
+DEF_BENCH( return new ExecutorBench(ExecutorBench::Pool::kFIFO,          1); )
+DEF_BENCH( return new ExecutorBench(ExecutorBench::Pool::kLIFO,          1); )
+DEF_BENCH( return new ExecutorBench(ExecutorBench::Pool::kWorkStealing,  1); )
+DEF_BENCH( return new ExecutorBench(ExecutorBench::Pool::kFIFO,         16); )
+DEF_BENCH( return new ExecutorBench(ExecutorBench::Pool::kLIFO,         16); )
+DEF_BENCH( return new ExecutorBench(ExecutorBench::Pool::kWorkStealing, 16); )
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "bench/Benchmark.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkFont.h"
+#include "include/core/SkFontStyle.h"
+#include "include/core/SkMatrix.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkString.h"
+#include "include/core/SkSurfaceProps.h"
+#include "src/core/SkBlitMask.h"
+#include "src/core/SkGlyph.h"
+#include "src/core/SkMask.h"
+#include "src/core/SkScalerContext.h"
+#include "src/core/SkStrikeSpec.h"
+#include "tools/fonts/FontToolUtils.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Blits the A8 or LCD16 masks of a line of text onto 8888 pixels, with the SkOpts routines the
+// raster glyph painter uses. The masks come from a strike, so their sizes and coverage are
+// representative of real text.
+class GlyphBlitBench : public Benchmark {
+public:
+    GlyphBlitBench(SkFont::Edging edging, SkColor color)
+            : fEdging(edging)
+            , fColor(color)
+            , fName(SkStringPrintf("glyph_blit_%s_%s",
+                                   edging == SkFont::Edging::kSubpixelAntiAlias ? "lcd16" : "a8",
+                                   SkColorGetA(color) == 0xFF ? "opaque" : "translucent")) {}
+
+private:
+    struct Mask {
+        std::vector<uint8_t> fImage;
+        int                  fWidth;
+        int                  fHeight;
+        size_t               fRowBytes;
+    };
+
+    const char* onGetName() override { return fName.c_str(); }
+
+    bool isSuitableFor(Backend backend) override { return backend == Backend::kNonRendering; }
+
+    void onDelayedSetup() override {
+        SkFont font(ToolUtils::CreatePortableTypeface("serif", SkFontStyle()), 16);
+        font.setEdging(fEdging);
+        font.setSubpixel(true);
+        const SkStrikeSpec strikeSpec = SkStrikeSpec::MakeMask(
+                font, SkPaint(), SkSurfaceProps(0, kRGB_H_SkPixelGeometry),
+                SkScalerContextFlags::kNone, SkMatrix::I());
+        SkBulkGlyphMetricsAndImages images{strikeSpec};
+
+        const SkMask::Format format = fEdging == SkFont::Edging::kSubpixelAntiAlias
+                                              ? SkMask::kLCD16_Format
+                                              : SkMask::kA8_Format;
+        const char text[] = "The quick brown fox jumps over the lazy dog, 0123456789.";
+        for (const char* c = text; *c != '\0'; ++c) {
+            const SkGlyph* glyph = images.glyph(SkPackedGlyphID{font.unicharToGlyph(*c)});
+            if (glyph->isEmpty() || glyph->image() == nullptr || glyph->maskFormat() != format) {
+                continue;
+            }
+            const auto* image = static_cast<const uint8_t*>(glyph->image());
+            fMasks.push_back({std::vector<uint8_t>(image, image + glyph->imageSize()),
+                              glyph->width(), glyph->height(), glyph->rowBytes()});
+        }
+
+        fDst.assign(kDstWidth * kDstHeight, SK_ColorWHITE);
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        const size_t dstRB = kDstWidth * sizeof(SkPMColor);
+        for (int i = 0; i < loops; ++i) {
+            int x = 0;
+            for (const Mask& mask : fMasks) {
+                if (x + mask.fWidth > kDstWidth) {
+                    x = 0;
+                }
+                SkPMColor* dst = fDst.data() + x;
+                if (fEdging == SkFont::Edging::kSubpixelAntiAlias) {
+                    SkOpts::blit_mask_d32_lcd16(
+                            dst, dstRB, reinterpret_cast<const uint16_t*>(mask.fImage.data()),
+                            mask.fRowBytes, fColor, mask.fWidth, mask.fHeight);
+                } else {
+                    SkOpts::blit_mask_d32_a8(dst, dstRB, mask.fImage.data(), mask.fRowBytes,
+                                             fColor, mask.fWidth, mask.fHeight);
+                }
+                x += mask.fWidth;
+            }
+        }
+    }
+
+    inline static constexpr int kDstWidth = 512;
+    inline static constexpr int kDstHeight = 32;
+
+    const SkFont::Edging   fEdging;
+    const SkColor          fColor;
+    const SkString         fName;
+    std::vector<Mask>      fMasks;
+    std::vector<SkPMColor> fDst;
+};
+
+DEF_BENCH(return new GlyphBlitBench(SkFont::Edging::kAntiAlias, SK_ColorBLACK);)
+DEF_BENCH(return new GlyphBlitBench(SkFont::Edging::kAntiAlias, 0x80336699);)
+DEF_BENCH(return new GlyphBlitBench(SkFont::Edging::kSubpixelAntiAlias, SK_ColorBLACK);)
+DEF_BENCH(return new GlyphBlitBench(SkFont::Edging::kSubpixelAntiAlias, 0x80336699);)
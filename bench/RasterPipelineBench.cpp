@@ -0,0 +1,95 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "bench/Benchmark.h"
+#include "include/core/SkMatrix.h"
+#include "include/core/SkString.h"
+#include "src/base/SkArenaAlloc.h"
+#include "src/core/SkRasterPipeline.h"
+#include "src/core/SkRasterPipelineOpContexts.h"
+#include "src/core/SkRasterPipelineOpList.h"
+
+#include <cstdint>
+
+// Times the lowp stages that carry most 8888 raster work, one pipeline per case. The lowp stride
+// (SkOpts::raster_pipeline_lowp_stride) depends on the CPU: 8 for SSE/NEON, 16 for HSW, 32 for SKX.
+class RasterPipelineLowpBench : public Benchmark {
+public:
+    enum class Case { kBlit, kSrcOver, kSrcOverRGBA8888, kBilerp };
+
+    explicit RasterPipelineLowpBench(Case c) : fCase(c) {
+        static const char* kNames[] = {"blit", "srcover", "srcover_rgba_8888", "bilerp"};
+        fName.printf("SkRasterPipeline_lowp_%s", kNames[(int)c]);
+    }
+
+    bool isSuitableFor(Backend backend) override { return backend == Backend::kNonRendering; }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        for (int i = 0; i < kW * kH; i++) {
+            fSrc[i] = 0x80402010 + (i & 0xf);  // Premul, and half transparent.
+            fDst[i] = 0xff204060;
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkRasterPipeline_MemoryCtx src_ctx = {fSrc, kW},
+                                   dst_ctx = {fDst, kW};
+        SkRasterPipeline_GatherCtx gather_ctx;
+        gather_ctx.pixels = fSrc;
+        gather_ctx.stride = kW;
+        gather_ctx.width  = kW;
+        gather_ctx.height = kH;
+
+        SkSTArenaAlloc<256> alloc;
+        SkRasterPipeline p(&alloc);
+        switch (fCase) {
+            case Case::kBlit:
+                p.append(SkRasterPipelineOp::load_8888, &src_ctx);
+                p.append(SkRasterPipelineOp::store_8888, &dst_ctx);
+                break;
+            case Case::kSrcOver:
+                p.append(SkRasterPipelineOp::load_8888, &src_ctx);
+                p.append(SkRasterPipelineOp::load_8888_dst, &dst_ctx);
+                p.append(SkRasterPipelineOp::srcover);
+                p.append(SkRasterPipelineOp::store_8888, &dst_ctx);
+                break;
+            case Case::kSrcOverRGBA8888:
+                p.append(SkRasterPipelineOp::load_8888, &src_ctx);
+                p.append(SkRasterPipelineOp::srcover_rgba_8888, &dst_ctx);
+                break;
+            case Case::kBilerp: {
+                // A slight scale so every sample lands between pixels.
+                p.append(SkRasterPipelineOp::seed_shader);
+                p.appendMatrix(&alloc, SkMatrix::Scale(0.9f, 0.9f));
+                p.append(SkRasterPipelineOp::bilerp_clamp_8888, &gather_ctx);
+                p.append(SkRasterPipelineOp::store_8888, &dst_ctx);
+            } break;
+        }
+
+        auto fn = p.compile();
+        while (loops --> 0) {
+            fn(0, 0, kW, kH);
+        }
+    }
+
+private:
+    // A non-multiple of every lowp stride, so the tail is exercised too.
+    static constexpr int kW = 1023, kH = 4;
+
+    Case     fCase;
+    SkString fName;
+    uint32_t fSrc[kW * kH];
+    uint32_t fDst[kW * kH];
+};
+
+DEF_BENCH(return new RasterPipelineLowpBench(RasterPipelineLowpBench::Case::kBlit);)
+DEF_BENCH(return new RasterPipelineLowpBench(RasterPipelineLowpBench::Case::kSrcOver);)
+DEF_BENCH(return new RasterPipelineLowpBench(RasterPipelineLowpBench::Case::kSrcOverRGBA8888);)
+DEF_BENCH(return new RasterPipelineLowpBench(RasterPipelineLowpBench::Case::kBilerp);)
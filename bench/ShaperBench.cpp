@@ -9,21 +9,42 @@
 #include "tools/Resources.h"
 #include "tools/fonts/FontToolUtils.h"
 
+#if defined(SK_SHAPER_HARFBUZZ_AVAILABLE)
+#include "modules/skshaper/include/SkShaper_harfbuzz.h"
+#endif
+
 #include <cfloat>
 
 namespace {
 struct ShaperBench : public Benchmark {
-    ShaperBench(const char* r, const char* n) : fResource(r), fName(n) {}
+    // If cacheLimit is not 0, the HarfBuzz shaped run cache is on with that budget.
+    ShaperBench(const char* r, const char* n, size_t cacheLimit = 0)
+            : fResource(r), fName(n), fCacheLimit(cacheLimit) {}
     std::unique_ptr<SkShaper> fShaper;
     sk_sp<SkData> fData;
     const char* fResource;
     const char* fName;
+    size_t fCacheLimit;
+    size_t fPrevCacheLimit = 0;
     const char* onGetName() override { return fName; }
     bool isSuitableFor(Backend backend) override { return backend == Backend::kNonRendering; }
     void onDelayedSetup() override {
         fShaper = SkShaper::Make();
         fData = GetResourceAsData(fResource);
     }
+#if defined(SK_SHAPER_HARFBUZZ_AVAILABLE)
+    void onPerCanvasPreDraw(SkCanvas*) override {
+        if (fCacheLimit) {
+            fPrevCacheLimit = SkShapers::HB::SetShapedRunCacheLimit(fCacheLimit);
+        }
+    }
+    void onPerCanvasPostDraw(SkCanvas*) override {
+        if (fCacheLimit) {
+            SkShapers::HB::SetShapedRunCacheLimit(fPrevCacheLimit);
+            SkShapers::HB::PurgeCaches();
+        }
+    }
+#endif
     void onDraw(int loops, SkCanvas*) override {
         if (!fData || !fShaper) { return; }
         SkFont font = ToolUtils::DefaultFont();
@@ -75,4 +96,17 @@ SHAPER_BENCH(tifnagh)
 SHAPER_BENCH(vai)
 #undef SHAPER_BENCH
 
+#if defined(SK_SHAPER_HARFBUZZ_AVAILABLE)
+// Reshapes the same text every loop, as animated or re-laid-out text does, with the shaped run
+// cache on.
+#define SHAPER_CACHED_BENCH(X) \
+    DEF_BENCH(return new ShaperBench("text/" #X ".txt", "shaper_cached_" #X, 4 << 20);)
+SHAPER_CACHED_BENCH(arabic)
+SHAPER_CACHED_BENCH(devanagari)
+SHAPER_CACHED_BENCH(english)
+SHAPER_CACHED_BENCH(han_simplified)
+SHAPER_CACHED_BENCH(thai)
+#undef SHAPER_CACHED_BENCH
+#endif  // defined(SK_SHAPER_HARFBUZZ_AVAILABLE)
+
 #endif  // !defined(SK_BUILD_FOR_ANDROID_FRAMEWORK) && !defined(SK_BUILD_FOR_GOOGLE3)
@@ -10,6 +10,7 @@
 #include "bench/Benchmark.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColorSpace.h"
+#include "include/core/SkFont.h"
 #include "include/core/SkFontMgr.h"
 #include "include/core/SkGraphics.h"
 #include "include/core/SkTypeface.h"
@@ -22,6 +23,8 @@
 #include "tools/fonts/FontToolUtils.h"
 #include "tools/text/SkTextBlobTrace.h"
 
+#include <vector>
+
 using namespace skia_private;
 
 static void do_font_stuff(SkFont* font) {
@@ -117,10 +120,63 @@ private:
     SkString fName;
 };
 
+// Many threads drawing text from the same few strikes, once their glyphs are cached. This
+// measures contention on the strike cache and the strikes, not glyph generation.
+class SkGlyphCacheContention : public Benchmark {
+public:
+    explicit SkGlyphCacheContention(int threadCount) : fThreadCount(threadCount) {}
+
+protected:
+    const char* onGetName() override {
+        fName.printf("SkGlyphCacheContention_%dthreads", fThreadCount);
+        return fName.c_str();
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == Backend::kNonRendering;
+    }
+
+    void onDelayedSetup() override {
+        SkFont font = ToolUtils::DefaultFont();
+        font.setEdging(SkFont::Edging::kAntiAlias);
+        font.setSubpixel(true);
+        font.setTypeface(ToolUtils::CreatePortableTypeface("serif", SkFontStyle::Normal()));
+        for (int c = ' '; c < 'z'; c++) {
+            fGlyphIDs.push_back(SkPackedGlyphID{font.unicharToGlyph(c)});
+        }
+        for (SkScalar size : {12, 16}) {
+            font.setSize(size);
+            fStrikeSpecs.push_back(SkStrikeSpec::MakeMask(
+                    font, SkPaint(), SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                    SkScalerContextFlags::kNone, SkMatrix::I()));
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        const SkSpan<const SkPackedGlyphID> glyphIDs{fGlyphIDs};
+        for (int work = 0; work < loops; work++) {
+            SkTaskGroup().batch(fThreadCount, [&](int threadIndex) {
+                for (int lookups = 0; lookups < 100; lookups++) {
+                    SkBulkGlyphMetricsAndImages images{fStrikeSpecs[threadIndex % 2]};
+                    (void)images.glyphs(glyphIDs);
+                }
+            });
+        }
+    }
+
+private:
+    const int fThreadCount;
+    SkString fName;
+    std::vector<SkPackedGlyphID> fGlyphIDs;
+    std::vector<SkStrikeSpec> fStrikeSpecs;
+};
+
 DEF_BENCH( return new SkGlyphCacheBasic(256 * 1024); )
 DEF_BENCH( return new SkGlyphCacheBasic(32 * 1024 * 1024); )
 DEF_BENCH( return new SkGlyphCacheStressTest(256 * 1024); )
 DEF_BENCH( return new SkGlyphCacheStressTest(32 * 1024 * 1024); )
+DEF_BENCH( return new SkGlyphCacheContention(1); )
+DEF_BENCH( return new SkGlyphCacheContention(8); )
 
 namespace {
 class DiscardableManager : public SkStrikeServer::DiscardableHandleManager,
@@ -7,7 +7,9 @@
 
 #include "bench/Benchmark.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFont.h"
+#include "include/core/SkGraphics.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkString.h"
@@ -19,6 +21,8 @@
 #include "tools/ToolUtils.h"
 #include "tools/fonts/FontToolUtils.h"
 
+#include <memory>
+
 /*
  * A trivial test which benchmarks the performance of a textblob with a single run.
  */
@@ -109,3 +113,70 @@ class TextBlobMakeBench : public SkTextBlobBench {
     }
 };
 DEF_BENCH( return new TextBlobMakeBench(); )
+
+/*
+ * Draws a blob whose glyph images are not cached yet, so every draw generates them. With an
+ * executor, the images are generated in parallel.
+ */
+class TextBlobColdCacheBench : public Benchmark {
+public:
+    explicit TextBlobColdCacheBench(int threadCount)
+            : fThreadCount(threadCount)
+            , fName(SkStringPrintf("TextBlobColdCacheBench_%dthreads", threadCount)) {}
+
+private:
+    const char* onGetName() override { return fName.c_str(); }
+
+    bool isSuitableFor(Backend backend) override { return backend == Backend::kRaster; }
+
+    void onDelayedSetup() override {
+        // A real font file, so that the glyphs come from the platform's scaler contexts.
+        sk_sp<SkTypeface> typeface = ToolUtils::CreateTypefaceFromResource(
+                "fonts/Roboto-Regular.ttf");
+        if (!typeface) {
+            typeface = ToolUtils::CreatePortableTypeface("serif", SkFontStyle());
+        }
+        SkFont font(std::move(typeface), 32);
+        font.setSubpixel(true);
+
+        // Every printable ASCII glyph, at several subpixel positions.
+        SkTextBlobBuilder builder;
+        for (int line = 0; line < 4; ++line) {
+            const int count = 0x7F - ' ';
+            const SkTextBlobBuilder::RunBuffer& run =
+                    builder.allocRunPosH(font, count, 40 + 40 * line);
+            for (int i = 0; i < count; ++i) {
+                run.glyphs[i] = font.unicharToGlyph(' ' + i);
+                run.pos[i] = 10 + 7.25f * i + 0.25f * line;
+            }
+        }
+        fBlob = builder.make();
+        if (fThreadCount > 1) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(fThreadCount);
+        }
+    }
+
+    void onPerCanvasPreDraw(SkCanvas*) override {
+        fPreviousExecutor = SkGraphics::SetGlyphImageExecutor(fExecutor.get());
+    }
+
+    void onPerCanvasPostDraw(SkCanvas*) override {
+        SkGraphics::SetGlyphImageExecutor(fPreviousExecutor);
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        SkPaint paint;
+        for (int i = 0; i < loops; i++) {
+            SkGraphics::PurgeFontCache();
+            canvas->drawTextBlob(fBlob, 0, 0, paint);
+        }
+    }
+
+    const int                   fThreadCount;
+    const SkString              fName;
+    sk_sp<SkTextBlob>           fBlob;
+    std::unique_ptr<SkExecutor> fExecutor;
+    SkExecutor*                 fPreviousExecutor = nullptr;
+};
+DEF_BENCH( return new TextBlobColdCacheBench(1); )
+DEF_BENCH( return new TextBlobColdCacheBench(4); )
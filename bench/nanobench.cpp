@@ -28,8 +28,10 @@
 #include "include/core/SkBBHFactory.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkGraphics.h"
 #include "include/core/SkPictureRecorder.h"
+#include "include/core/SkPixmap.h"
 #include "include/core/SkString.h"
 #include "include/core/SkSurface.h"
 #include "include/encode/SkPngEncoder.h"
@@ -86,6 +88,7 @@
 
 extern bool gSkForceRasterPipelineBlitter;
 extern bool gForceHighPrecisionRasterPipeline;
+extern bool gDisableRasterPipelineFusion;
 
 #ifndef SK_BUILD_FOR_WIN
 #include <unistd.h>
@@ -158,6 +161,7 @@ static DEFINE_string(benchType,  "",
 
 static DEFINE_bool(forceRasterPipeline, false, "sets gSkForceRasterPipelineBlitter");
 static DEFINE_bool(forceRasterPipelineHP, false, "sets gSkForceRasterPipelineBlitter and gForceHighPrecisionRasterPipeline");
+static DEFINE_bool(noRasterPipelineFusion, false, "sets gDisableRasterPipelineFusion");
 
 static DEFINE_bool2(pre_log, p, false,
                     "Log before running each test. May be incomprehensible when threading");
@@ -195,6 +199,12 @@ static DEFINE_int_2(threads, j, -1,
                "Run threadsafe tests on a threadpool with this many extra threads, "
                "defaulting to one extra thread per core.");
 
+static DEFINE_int(rasterThreads, 0,
+                  "Worker threads used to rasterize the '8888threaded' config, "
+                  "defaulting to one per core.");
+static DEFINE_int(rasterBands, 0,
+                  "Horizontal bands used by the '8888threaded' config; 0 picks from the height.");
+
 static DEFINE_string2(writePath, w, "", "If set, write bitmaps here as .pngs.");
 
 static DEFINE_string(key, "",
@@ -241,6 +251,28 @@ bool Target::capturePixels(SkBitmap* bmp) {
     return true;
 }
 
+// Records each draw, then rasterizes it in parallel bands (see SkSurfaces::RasterThreaded).
+struct ThreadedRasterTarget : public Target {
+    explicit ThreadedRasterTarget(const Config& c) : Target(c) {}
+    std::unique_ptr<SkExecutor> executor;
+
+    ~ThreadedRasterTarget() override {
+        // The surface must not outlive the executor it rasterizes on.
+        surface.reset();
+    }
+
+    bool init(SkImageInfo info, Benchmark*) override {
+        this->executor = SkExecutor::MakeFIFOThreadPool(FLAGS_rasterThreads);
+        this->surface = SkSurfaces::RasterThreaded(info, this->executor.get(), FLAGS_rasterBands);
+        return this->surface != nullptr;
+    }
+    void endTiming() override {
+        // Resolving the pixels waits for the bands to finish rasterizing.
+        SkPixmap pixmap;
+        this->surface->peekPixels(&pixmap);
+    }
+};
+
 struct GPUTarget : public Target {
     explicit GPUTarget(const Config& c) : Target(c) {}
     ContextInfo contextInfo;
@@ -674,6 +706,7 @@ static std::optional<Config> create_config(const SkCommandLineConfig* config) {
     CPU_CONFIG("a8",    Backend::kRaster,    kAlpha_8_SkColorType, kPremul_SkAlphaType)
     CPU_CONFIG("565",   Backend::kRaster,    kRGB_565_SkColorType, kOpaque_SkAlphaType)
     CPU_CONFIG("8888",  Backend::kRaster,        kN32_SkColorType, kPremul_SkAlphaType)
+    CPU_CONFIG("8888threaded", Backend::kRaster, kN32_SkColorType, kPremul_SkAlphaType)
     CPU_CONFIG("rgba",  Backend::kRaster,  kRGBA_8888_SkColorType, kPremul_SkAlphaType)
     CPU_CONFIG("bgra",  Backend::kRaster,  kBGRA_8888_SkColorType, kPremul_SkAlphaType)
     CPU_CONFIG("f16",   Backend::kRaster,   kRGBA_F16_SkColorType, kPremul_SkAlphaType)
@@ -731,7 +764,11 @@ static Target* is_enabled(Benchmark* bench, const Config& config) {
         break;
 #endif
     default:
-        target = new Target(config);
+        if (config.name.equals("8888threaded")) {
+            target = new ThreadedRasterTarget(config);
+        } else {
+            target = new Target(config);
+        }
         break;
     }
 
@@ -1244,6 +1281,50 @@ public:
             }
             fCurrentColorType = 0;
         }
+
+        // Run the BRD thumbnail benches
+        // These model showing a thumbnail of a photo, or of the middle of it, 200 pixels on its
+        // long edge: with SkAndroidCodec::getThumbnail(), and by decoding the region at a power of
+        // two sample size and scaling that, as a client of BitmapRegionDecoder would.
+        const int thumbnailSize = 200;
+        for (; fCurrentThumbnailImage < fImages.size(); fCurrentThumbnailImage++) {
+            fSourceType = "image";
+            fBenchType = "BRD";
+
+            const SkString& path = fImages[fCurrentThumbnailImage];
+            if (CommandLineFlags::ShouldSkip(FLAGS_match, path.c_str())) {
+                continue;
+            }
+
+            while (fCurrentThumbnailType < 4) {
+                sk_sp<SkData> encoded(SkData::MakeFromFileName(path.c_str()));
+                const int currentThumbnailType = fCurrentThumbnailType++;
+                const bool middle = currentThumbnailType >= 2;
+                const bool sampled = currentThumbnailType % 2 == 1;
+
+                // Avoid benchmarking thumbnails of images that are already small.
+                int width = 0;
+                int height = 0;
+                if (!valid_brd_bench(encoded, kN32_SkColorType, 4, thumbnailSize, &width,
+                        &height)) {
+                    break;
+                }
+
+                SkString basename = SkOSPath::Basename(path.c_str());
+                SkIRect subset = SkIRect::MakeWH(width, height);
+                if (middle) {
+                    basename.append("_Middle");
+                    subset = SkIRect::MakeXYWH(width / 4, height / 4, width / 2, height / 2);
+                }
+                const float scale = (float) thumbnailSize /
+                        std::max(subset.width(), subset.height());
+                const SkISize size = SkISize::Make(std::max(1, (int) (subset.width() * scale)),
+                                                   std::max(1, (int) (subset.height() * scale)));
+                return new BitmapRegionDecoderBench(basename.c_str(), encoded.get(),
+                        kN32_SkColorType, subset, size, sampled);
+            }
+            fCurrentThumbnailType = 0;
+        }
 #endif // SK_ENABLE_ANDROID_UTILS
 
         return nullptr;
@@ -1312,6 +1393,8 @@ private:
 #ifdef SK_ENABLE_ANDROID_UTILS
     int fCurrentBRDImage = 0;
     int fCurrentSubsetType = 0;
+    int fCurrentThumbnailImage = 0;
+    int fCurrentThumbnailType = 0;
 #endif
     int fCurrentColorType = 0;
     int fCurrentAlphaType = 0;
@@ -1447,6 +1530,7 @@ int main(int argc, char** argv) {
 
     gSkForceRasterPipelineBlitter     = FLAGS_forceRasterPipelineHP || FLAGS_forceRasterPipeline;
     gForceHighPrecisionRasterPipeline = FLAGS_forceRasterPipelineHP;
+    gDisableRasterPipelineFusion      = FLAGS_noRasterPipelineFusion;
 
     // The SkSL memory benchmark must run before any GPU painting occurs. SkSL allocates memory for
     // its modules the first time they are accessed, and this test is trying to measure the size of
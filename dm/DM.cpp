@@ -25,6 +25,7 @@
 #include "src/core/SkColorSpacePriv.h"
 #include "src/core/SkMD5.h"
 #include "src/core/SkOSFile.h"
+#include "src/core/SkRasterPipeline.h"
 #include "src/core/SkStringUtils.h"
 #include "src/core/SkTHash.h"
 #include "src/core/SkTaskGroup.h"
@@ -46,6 +47,7 @@
 #include "tools/trace/EventTracingPriv.h"
 #include "tools/trace/SkDebugfTracer.h"
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -72,6 +74,8 @@ using namespace skia_private;
 
 extern bool gSkForceRasterPipelineBlitter;
 extern bool gForceHighPrecisionRasterPipeline;
+extern bool gDisableRasterPipelineFusion;
+extern bool gRecordRasterPipelineUnfusedRuns;
 extern bool gCreateProtectedContext;
 
 static DEFINE_string(src, "tests gm skp mskp lottie rive svg image colorImage",
@@ -107,6 +111,10 @@ static DEFINE_int(shard,  0, "Which shard do I run?");
 static DEFINE_string(mskps, "", "Directory to read mskps from, or a single mskp file.");
 static DEFINE_bool(forceRasterPipeline, false, "sets gSkForceRasterPipelineBlitter");
 static DEFINE_bool(forceRasterPipelineHP, false, "sets gSkForceRasterPipelineBlitter and gForceHighPrecisionRasterPipeline");
+static DEFINE_bool(noRasterPipelineFusion, false, "sets gDisableRasterPipelineFusion");
+static DEFINE_int(unfusedRasterPipelineRuns, 0,
+                  "If > 0, count unfused raster pipeline stage runs and print this many of the "
+                  "most common ones at exit.");
 static DEFINE_bool(createProtected, false, "attempts to create a protected backend context");
 
 static DEFINE_string(bisect, "",
@@ -1571,6 +1579,8 @@ int main(int argc, char** argv) {
 
     gSkForceRasterPipelineBlitter     = FLAGS_forceRasterPipelineHP || FLAGS_forceRasterPipeline;
     gForceHighPrecisionRasterPipeline = FLAGS_forceRasterPipelineHP;
+    gDisableRasterPipelineFusion      = FLAGS_noRasterPipelineFusion;
+    gRecordRasterPipelineUnfusedRuns  = FLAGS_unfusedRasterPipelineRuns > 0;
     gCreateProtectedContext           = FLAGS_createProtected;
 
     // The bots like having a verbose.log to upload, so always touch the file even if --verbose.
@@ -1673,6 +1683,20 @@ int main(int argc, char** argv) {
     // Make sure we've flushed all our results to disk.
     dump_json();
 
+    if (FLAGS_unfusedRasterPipelineRuns > 0) {
+        SkRasterPipeline::FusionStats stats = SkRasterPipeline::GetFusionStats();
+        info("Most common unfused raster pipeline runs:\n");
+        for (int i = 0; i < std::min(FLAGS_unfusedRasterPipelineRuns, stats.unfusedRuns.size());
+             ++i) {
+            const SkRasterPipeline::FusionStats::UnfusedRun& run = stats.unfusedRuns[i];
+            SkString stages;
+            for (int j = 0; j < run.count; ++j) {
+                stages.appendf("%s%s", j ? ", " : "", SkRasterPipeline::GetOpName(run.stages[j]));
+            }
+            info("\t%10lld  %s\n", (long long)run.uses, stages.c_str());
+        }
+    }
+
     if (!gFailures->empty()) {
         info("Failures:\n");
         for (const SkString& fail : *gFailures) {
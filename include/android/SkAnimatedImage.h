@@ -15,6 +15,8 @@
 #include "include/core/SkRect.h"
 
 class SkAndroidCodec;
+class SkAnimFrameCache;
+class SkExecutor;
 class SkImage;
 class SkPicture;
 
@@ -41,6 +43,22 @@ public:
      */
     static sk_sp<SkAnimatedImage> Make(std::unique_ptr<SkAndroidCodec>);
 
+    /**
+     *  Like the first Make(), but the decoded frames are kept in the SkResourceCache, so they
+     *  count against its budget and may be purged. A frame that is needed again is decoded from
+     *  the closest cached frame it depends on.
+     *
+     *  If lookAheadExecutor is not null, the lookAheadFrames frames after the current one are
+     *  decoded on it, ahead of time, with codecs of their own. The executor must outlive the
+     *  SkAnimatedImage.
+     *
+     *  HEIF images, whose frame durations are only known once the frames are decoded, are decoded
+     *  as by the first Make().
+     */
+    static sk_sp<SkAnimatedImage> Make(std::unique_ptr<SkAndroidCodec>,
+            const SkImageInfo& info, SkIRect cropRect, sk_sp<SkPicture> postProcess,
+            SkExecutor* lookAheadExecutor, int lookAheadFrames = 8);
+
     ~SkAnimatedImage() override;
 
     /**
@@ -152,11 +170,17 @@ private:
     Frame                           fRestoreFrame;
     int                             fRepetitionCount;
     int                             fRepetitionsCompleted;
+    // Only made by the Make() that caches frames. It decodes into new bitmaps rather than into
+    // fDecodingFrame and fRestoreFrame.
+    std::unique_ptr<SkAnimFrameCache> fFrameCache;
 
     SkAnimatedImage(std::unique_ptr<SkAndroidCodec>, const SkImageInfo& requestedInfo,
-            SkIRect cropRect, sk_sp<SkPicture> postProcess);
+            SkIRect cropRect, sk_sp<SkPicture> postProcess, bool cacheFrames,
+            SkExecutor* lookAheadExecutor, int lookAheadFrames);
 
     int computeNextFrame(int current, bool* animationEnded);
+    // Makes frameToDecode the display frame, from fFrameCache.
+    bool showCachedFrame(int frameToDecode, SkCodecAnimation::DisposalMethod);
     double finish();
 
     /**
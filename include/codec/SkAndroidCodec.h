@@ -12,6 +12,7 @@
 #include "include/core/SkColorSpace.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkSamplingOptions.h"
 #include "include/core/SkSize.h"
 #include "include/core/SkTypes.h"
 #include "include/private/SkEncodedInfo.h"
@@ -27,6 +28,7 @@
 #include <memory>
 
 class SkData;
+class SkPixmap;
 class SkPngChunkReader;
 class SkStream;
 struct SkGainmapInfo;
@@ -261,6 +263,26 @@ public:
         return this->getAndroidPixels(info, pixels, rowBytes);
     }
 
+    /**
+     *  Decode the pixels in subset (or in the whole image, if subset is null) scaled to the size
+     *  of dst, which may be any size.
+     *
+     *  The image is decoded at the smallest scale the codec can decode to natively, such as one
+     *  of JPEG's DCT scales from 1/8 to 7/8, at which the subset still covers dst. Where the codec
+     *  can, it only decodes the part of the image that covers the subset: a JPEG only decodes the
+     *  columns of MCUs that cover it, and does not decode the rows below it. The decoded pixels
+     *  are then resampled to dst with sampling.
+     *
+     *  The subset may be adjusted to one the codec supports, as by getSupportedSubset().
+     *
+     *  @return Result kSuccess, or kIncompleteInput or kErrorInInput if the pixels that could not
+     *          be decoded were filled, or another value explaining the type of failure.
+     */
+    SkCodec::Result getThumbnail(const SkPixmap& dst,
+                                 const SkIRect* subset = nullptr,
+                                 const SkSamplingOptions& sampling = SkSamplingOptions(
+                                         SkFilterMode::kLinear, SkMipmapMode::kNearest));
+
     SkCodec* codec() const { return fCodec.get(); }
 
     /**
@@ -291,6 +313,14 @@ protected:
             size_t rowBytes, const AndroidOptions& options) = 0;
 
 private:
+    SkCodec::Result handleFrameIndex(const SkImageInfo& info, void* pixels, size_t rowBytes,
+            const AndroidOptions& options);
+
+    // Decodes scaledSubset of the image scaled to scaledSize into dst, which is its size.
+    SkCodec::Result decodeScaledSubset(const SkPixmap& dst,
+                                       SkISize scaledSize,
+                                       const SkIRect& scaledSubset);
+
     const SkImageInfo               fInfo;
     std::unique_ptr<SkCodec>        fCodec;
 };
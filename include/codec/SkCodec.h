@@ -30,6 +30,7 @@
 #include <vector>
 
 class SkData;
+class SkExecutor;
 class SkFrameHolder;
 class SkImage;
 class SkPngChunkReader;
@@ -324,6 +325,7 @@ public:
             , fSubset(nullptr)
             , fFrameIndex(0)
             , fPriorFrame(kNoFrame)
+            , fExecutor(nullptr)
         {}
 
         ZeroInitialized            fZeroInitialized;
@@ -367,6 +369,15 @@ public:
          *  If set to kNoFrame, the codec will decode any necessary required frame(s) first.
          */
         int                        fPriorFrame;
+
+        /**
+         *  If not NULL, getPixels() may decode parts of the image concurrently on this executor.
+         *
+         *  Currently only JPEG uses it, for baseline images in memory whose restart markers fall
+         *  at the start of rows of MCUs: horizontal bands between the markers are decoded in
+         *  parallel. Other images are decoded on the calling thread.
+         */
+        SkExecutor*                fExecutor;
     };
 
     /**
@@ -1746,6 +1746,19 @@ public:
                                          const SkSamplingOptions&, const SkPaint* paint = nullptr,
                                          SrcRectConstraint constraint = kStrict_SrcRectConstraint);
 
+    /**
+     * This is an experimental API, and may change or be removed.
+     *
+     * Draws 'count' rectangles with the same paint. The result is the same as calling drawRect()
+     * for each rectangle in order, but backends may batch the rectangles: the raster backend
+     * fills all of them with a single blitter. Paints with an image filter or a mask filter are
+     * applied to each rectangle separately.
+     *
+     * Subclasses that override onDrawRect() to intercept draws should also override
+     * onDrawRects().
+     */
+    void experimental_DrawRects(const SkRect rects[], int count, const SkPaint& paint);
+
     /** Draws text, with origin at (x, y), using clip, SkMatrix, SkFont font,
         and SkPaint paint.
 
@@ -2287,6 +2300,7 @@ protected:
     virtual void onDrawPaint(const SkPaint& paint);
     virtual void onDrawBehind(const SkPaint& paint);
     virtual void onDrawRect(const SkRect& rect, const SkPaint& paint);
+    virtual void onDrawRects(const SkRect rects[], int count, const SkPaint& paint);
     virtual void onDrawRRect(const SkRRect& rrect, const SkPaint& paint);
     virtual void onDrawDRRect(const SkRRect& outer, const SkRRect& inner, const SkPaint& paint);
     virtual void onDrawOval(const SkRect& rect, const SkPaint& paint);
@@ -2496,6 +2510,7 @@ private:
     friend class SkRecords::Draw;
     template <typename Key>
     friend class SkTestCanvas;
+    friend class SkThreadedRasterCanvas;  // needs predrawNotify()
 
 protected:
     // For use by SkNoDrawCanvas (via SkCanvasVirtualEnforcer, which can't be a friend)
@@ -40,6 +40,14 @@ protected:
     void onDrawPoints(SkCanvas::PointMode mode, size_t count, const SkPoint pts[],
                       const SkPaint& paint) override = 0;
 
+    // Batched rects are experimental, so subclasses see them as individual rects unless they
+    // choose to override this.
+    void onDrawRects(const SkRect rects[], int count, const SkPaint& paint) override {
+        for (int i = 0; i < count; ++i) {
+            this->onDrawRect(rects[i], paint);
+        }
+    }
+
 #ifdef SK_BUILD_FOR_ANDROID_FRAMEWORK
     // This is under active development for Chrome and not used in Android. Hold off on adding
     // implementations in Android's SkCanvas subclasses until this stabilizes.
@@ -16,6 +16,7 @@
 #include <memory>
 
 class SkData;
+class SkExecutor;
 class SkImageGenerator;
 class SkOpenTypeSVGDecoder;
 class SkTraceMemoryDump;
@@ -69,6 +70,24 @@ public:
      */
     static int SetFontCacheCountLimit(int count);
 
+    /**
+     *  Use a directory to keep rasterized glyphs across processes. When the font cache needs
+     *  a glyph, it uses the image and path last written for it to the directory, if any,
+     *  instead of rasterizing it again. Images are used in place in the memory mapped file.
+     *  WriteFontCacheToDirectory() writes them. The directory must exist. Pass nullptr to stop
+     *  using a directory.
+     */
+    static void SetFontCacheDirectory(const char* path);
+
+    /**
+     *  Write the glyph images and paths in the font cache to the directory set with
+     *  SetFontCacheDirectory(), replacing what was written for the same entries before. Entries
+     *  with no new glyphs since they were read or last written are skipped. This does file IO,
+     *  so call it at startup, idle or shutdown, not while drawing. Does nothing if no directory
+     *  is set.
+     */
+    static void WriteFontCacheToDirectory();
+
     /**
      *  Return the current limit to the number of entries in the typeface cache.
      *  A cache "entry" is associated with each typeface.
@@ -126,6 +145,58 @@ public:
     static size_t GetResourceCacheSingleAllocationByteLimit();
     static size_t SetResourceCacheSingleAllocationByteLimit(size_t newLimit);
 
+    /**
+     *  Raster draws whose paint reduces to a constant color (no shader or a constant one, and a
+     *  blend mode rather than a custom blender) cache their blitter, keyed by the paint and the
+     *  destination's color type, alpha type and color space. Later draws with the same state
+     *  reuse its pipelines instead of building them again.
+     *
+     *  These functions return the number of entries in that cache and get/set its limit.
+     *  Setting a lower limit purges entries to meet it; a limit of 0 disables the cache.
+     *  The cache is disabled by default. Every thread that draws with a cacheable paint takes
+     *  the cache's lock, so it suits single-threaded raster clients best.
+     */
+    static int GetRasterPipelineBlitterCacheCountUsed();
+    static int GetRasterPipelineBlitterCacheCountLimit();
+    static int SetRasterPipelineBlitterCacheCountLimit(int count);
+
+    /**
+     *  Return how many lookups in the raster pipeline blitter cache found an entry, and how many
+     *  did not, since the process started. Draws that can't be cached aren't counted.
+     */
+    static int64_t GetRasterPipelineBlitterCacheHitCount();
+    static int64_t GetRasterPipelineBlitterCacheMissCount();
+
+    /**
+     *  Purge all entries from the raster pipeline blitter cache. Does not change the limit.
+     */
+    static void PurgeRasterPipelineBlitterCache();
+
+    /**
+     *  If set, raster fills of large, complex anti-aliased paths with a solid color are split into
+     *  horizontal bands that are filled in parallel on this executor. The calling thread still
+     *  steps the path's edges down to the last band, which bounds the speedup. The pixels are
+     *  identical to a single-threaded fill. Pass nullptr (the default) to fill on the calling
+     *  thread only.
+     *
+     *  The executor must outlive every draw that may use it. Returns the previous executor.
+     */
+    static SkExecutor* SetPathFillExecutor(SkExecutor*);
+    static SkExecutor* GetPathFillExecutor();
+
+    /**
+     *  If set, when raster text needs the images of many glyphs that are not in the font cache
+     *  yet, the images are generated in parallel on this executor, each task with its own scaler
+     *  context. This is done for font backends whose scaler contexts can work without a shared
+     *  lock, such as FreeType, where each task has a face of its own that is reused by later
+     *  tasks, and Fontations. The glyphs are identical to ones generated on a single thread. Pass
+     *  nullptr (the default) to generate them on the calling thread only.
+     *
+     *  The executor must outlive every draw that may use it. Returns the previous executor.
+     */
+    static SkExecutor* SetGlyphImageExecutor(SkExecutor*);
+    static SkExecutor* GetGlyphImageExecutor();
+
     /**
      *  Dumps memory usage of caches using the SkTraceMemoryDump interface. See SkTraceMemoryDump
      *  for usage of this method.
@@ -11,14 +11,17 @@
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkShader.h"  // IWYU pragma: keep
+#include "include/core/SkSize.h"
 #include "include/core/SkTypes.h"
 
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 
 class SkCanvas;
 class SkData;
+class SkExecutor;
 class SkMatrix;
 class SkStream;
 class SkWStream;
@@ -135,6 +138,39 @@ public:
     */
     virtual void playback(SkCanvas* canvas, AbortCallback* callback = nullptr) const = 0;
 
+    /** Called by playbackParallel() to get the canvas for one tile. tileIndex numbers the
+        tiles in row-major order, and tileBounds is the tile's area in the destination,
+        which is the picture's cull SkRect mapped by the playback matrix and rounded out.
+
+        The returned canvas must stay valid until playbackParallel() returns, and must not
+        be shared with another tile. Return nullptr to skip the tile.
+    */
+    using TileCanvasFactory = std::function<SkCanvas*(int tileIndex, const SkIRect& tileBounds)>;
+
+    /** Replays the drawing commands split into tiles, playing the tiles back concurrently
+        on executor. The destination is divided into a grid of tileSize tiles. For each
+        tile, tileCanvas supplies a canvas, and only the commands whose bounds touch the
+        tile are sent to it, translated so the tile's top-left corner is at the canvas
+        origin and clipped to the tile.
+
+        To draw into a single set of pixels, have tileCanvas return a canvas that wraps
+        the matching subset of them. To draw each tile on its own, return the canvas of
+        a tileSize surface. As with any tiled rendering, edges that cross a tile boundary
+        may be rasterized slightly differently than by a single playback.
+
+        tileCanvas may be called from several threads at once. If executor is nullptr,
+        the tiles are played back one after another on the calling thread.
+
+        @param tileCanvas  supplies the canvas for each tile
+        @param tileSize    dimensions of each tile; the last row and column may be smaller
+        @param executor    runs the tiles; may be nullptr
+        @param matrix      maps the picture into the destination; may be nullptr
+    */
+    void playbackParallel(const TileCanvasFactory& tileCanvas,
+                          SkISize tileSize,
+                          SkExecutor* executor,
+                          const SkMatrix* matrix = nullptr) const;
+
     /** Returns cull SkRect for this picture, passed in when SkPicture was created.
         Returned SkRect does not specify clipping SkRect for SkPicture; cull is hint
         of SkPicture bounds.
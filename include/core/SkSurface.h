@@ -30,6 +30,7 @@ class SkBitmap;
 class SkCanvas;
 class SkCapabilities;
 class SkColorSpace;
+class SkExecutor;
 class SkPaint;
 class SkSurface;
 struct SkIRect;
@@ -82,6 +83,30 @@ inline sk_sp<SkSurface> Raster(const SkImageInfo& imageInfo,
     return Raster(imageInfo, 0, props);
 }
 
+/** Allocates raster SkSurface whose SkCanvas records draws instead of rasterizing them
+    immediately. Recorded draws are rasterized in parallel on executor, split into bandCount
+    horizontal bands, whenever the surface's pixels are needed: makeImageSnapshot(), draw(),
+    readPixels(), peekPixels() and writePixels() all see every draw made so far. Draws inside a
+    saveLayer() that has not been restored yet are rasterized once the layer is restored.
+
+    The result is identical to a surface returned by Raster(). This is worthwhile for large
+    surfaces with enough draws to amortize recording, e.g. playing back an SkPicture.
+    Surfaces made by makeSurface() are threaded the same way, on the same executor.
+
+    @param imageInfo     width, height, SkColorType, SkAlphaType, SkColorSpace,
+                         of raster surface; width and height must be greater than zero
+    @param executor      runs the band rasterization; must outlive the surface. If nullptr,
+                         SkExecutor::GetDefault() is used.
+    @param bandCount     number of horizontal bands; if zero or less, chosen from the height
+    @param surfaceProps  LCD striping orientation and setting for device independent fonts;
+                         may be nullptr
+    @return              SkSurface if parameters are valid and memory was allocated, else nullptr
+*/
+SK_API sk_sp<SkSurface> RasterThreaded(const SkImageInfo& imageInfo,
+                                       SkExecutor* executor,
+                                       int bandCount = 0,
+                                       const SkSurfaceProps* surfaceProps = nullptr);
+
 /** Allocates raster SkSurface. SkCanvas returned by SkSurface draws directly into the
     provided pixels.
 
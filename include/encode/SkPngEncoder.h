@@ -19,6 +19,7 @@
 
 class GrDirectContext;
 class SkData;
+class SkExecutor;
 class SkImage;
 class SkPixmap;
 class SkWStream;
@@ -80,6 +81,16 @@ struct Options {
      */
     const skcms_ICCProfile* fICCProfile = nullptr;
     const char* fICCProfileDescription = nullptr;
+
+    /**
+     *  If not null, the rows are filtered and compressed in strips concurrently on this executor.
+     *  Each strip is compressed as separate deflate blocks, primed with the end of the strip
+     *  before it, and the blocks are concatenated into one zlib stream. This is much faster for
+     *  large images, and the file is usually only slightly larger.
+     *
+     *  The executor must outlive the encoder.
+     */
+    SkExecutor* fExecutor = nullptr;
 };
 
 /**
@@ -20,6 +20,7 @@
 class SkAutoDescriptor;
 class SkCanvas;
 class SkColorSpace;
+class SkData;
 class SkStrikeCache;
 class SkStrikeClientImpl;
 class SkStrikeServerImpl;
@@ -69,6 +70,24 @@ public:
     // unlocked after this call.
     SK_SPI void writeStrikeData(std::vector<uint8_t>* memory);
 
+    // Write glyph images into memory that the client's process maps too, for example a memfd,
+    // instead of into the strike data. The strike data then only says where the images are, and
+    // the client copies them out of it. memory must be page aligned, and stay mapped for as long
+    // as the server. Set it once, before the first writeStrikeData(), and give the client
+    // its read-only mapping of the same memory with SkStrikeClient::setSharedGlyphMemory().
+    // The client returns the memory it has read with
+    // SkStrikeClient::writeReleasedGlyphMemory(); pass that to readReleasedGlyphMemory(). When
+    // the memory is full, images are written into the strike data again. Typefaces, paths and
+    // drawables are always written into the strike data.
+    SK_SPI void setSharedGlyphMemory(void* memory, size_t size);
+
+    // Deserializes the shared glyph memory released by the client, so that it can be written
+    // again. Returns false if the data is invalid, or names memory that is not in use.
+    SK_SPI bool readReleasedGlyphMemory(const void* memory, size_t memorySize);
+
+    // The number of bytes of the shared glyph memory that the client has not released.
+    SK_SPI size_t sharedGlyphMemoryUsed() const;
+
     // Testing helpers
     void setMaxEntriesInDescriptorMapForTesting(size_t count);
     size_t remoteStrikeMapSizeForTesting() const;
@@ -133,6 +152,17 @@ public:
     // Returns false if the data is invalid.
     SK_SPI bool readStrikeData(const volatile void* memory, size_t memorySize);
 
+    // The client's read-only mapping of the memory given to SkStrikeServer::setSharedGlyphMemory.
+    // The mapping is kept until the client is deleted, so its release proc can unmap it. Set it once, before reading strike data that uses it. The server
+    // must not be able to shrink the memory (for a memfd, seal it with F_SEAL_SHRINK).
+    SK_SPI void setSharedGlyphMemory(sk_sp<SkData> mapping);
+
+    // Serializes the shared glyph memory that was released since the last call, for the server's
+    // SkStrikeServer::readReleasedGlyphMemory(). Memory is released once the images in it are
+    // copied into the strikes by readStrikeData(). memory is left empty if there is nothing to
+    // send.
+    SK_SPI void writeReleasedGlyphMemory(std::vector<uint8_t>* memory);
+
     // Given a descriptor re-write the Rec mapping the typefaceID from the renderer to the
     // corresponding typefaceID on the GPU.
     SK_SPI bool translateTypefaceID(SkAutoDescriptor* descriptor) const;
@@ -13,6 +13,9 @@
 #include "tools/fonts/FontToolUtils.h"
 
 #include <cfloat>
+#include <cstring>
+#include <memory>
+#include "include/core/SkExecutor.h"
 #include "include/core/SkPictureRecorder.h"
 #include "modules/skparagraph/utils/TestFontCollection.h"
 
@@ -54,6 +57,107 @@ struct ParagraphBench : public Benchmark {
         }
     }
 };
+
+// Lays out a long document of many paragraphs separated by hard line breaks, shaping on the
+// calling thread (threads == 0) or on a pool of 'threads' threads.
+struct ParagraphThreadsBench : public Benchmark {
+    ParagraphThreadsBench(int threads) : fThreads(threads) {
+        fName.printf("paragraph_english_document_%d_threads", threads);
+    }
+    SkString fText;
+    std::unique_ptr<SkExecutor> fExecutor;
+    int fThreads;
+    SkString fName;
+    const char* onGetName() override { return fName.c_str(); }
+    bool isSuitableFor(Backend backend) override { return backend == Backend::kNonRendering; }
+    void onDelayedSetup() override {
+        sk_sp<SkData> data = GetResourceAsData("text/english.txt");
+        if (!data) {
+            return;
+        }
+        for (int i = 0; i < 200; ++i) {
+            fText.append((const char*)data->data(), data->size());
+            fText.append("\n");
+        }
+        if (fThreads > 0) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+        }
+    }
+    void onDraw(int loops, SkCanvas*) override {
+        if (fText.isEmpty()) {
+            return;
+        }
+
+        auto fontCollection = sk_make_sp<FontCollection>();
+        fontCollection->setDefaultFontManager(ToolUtils::TestFontMgr());
+        fontCollection->getParagraphCache()->turnOn(false);
+        ParagraphStyle paragraph_style;
+        paragraph_style.turnHintingOff();
+        paragraph_style.setShapingExecutor(fExecutor.get());
+        ParagraphBuilderImpl builder(paragraph_style, fontCollection);
+        builder.addText(fText.c_str(), fText.size());
+        auto paragraph = builder.Build();
+
+        while (loops-- > 0) {
+            paragraph->layout(1000);
+            paragraph->markDirty();
+        }
+    }
+};
+
+// Edits a word in the middle of a long document and lays it out again, either by rebuilding the
+// paragraph, or by updating its text.
+struct ParagraphEditBench : public Benchmark {
+    ParagraphEditBench(bool incremental) : fIncremental(incremental) {
+        fName.printf("paragraph_english_document_edit_%s", incremental ? "incremental" : "rebuild");
+    }
+    SkString fText;
+    bool fIncremental;
+    SkString fName;
+    const char* onGetName() override { return fName.c_str(); }
+    bool isSuitableFor(Backend backend) override { return backend == Backend::kNonRendering; }
+    void onDelayedSetup() override {
+        sk_sp<SkData> data = GetResourceAsData("text/english.txt");
+        if (!data) {
+            return;
+        }
+        for (int i = 0; i < 200; ++i) {
+            fText.append((const char*)data->data(), data->size());
+            fText.append("\n");
+        }
+    }
+    void onDraw(int loops, SkCanvas*) override {
+        if (fText.isEmpty()) {
+            return;
+        }
+
+        auto fontCollection = sk_make_sp<FontCollection>();
+        fontCollection->setDefaultFontManager(ToolUtils::TestFontMgr());
+        fontCollection->getParagraphCache()->turnOn(false);
+        ParagraphStyle paragraph_style;
+        paragraph_style.turnHintingOff();
+        auto build = [&] {
+            ParagraphBuilderImpl builder(paragraph_style, fontCollection);
+            builder.addText(fText.c_str(), fText.size());
+            return builder.Build();
+        };
+        auto paragraph = build();
+        paragraph->layout(1000);
+
+        // Alternate between two words of the same length, so the text stays the same size.
+        const size_t word = fText.size() / 2;
+        const char* words[] = {"abcde", "vwxyz"};
+        for (int i = 0; i < loops; ++i) {
+            if (fIncremental) {
+                paragraph->updateText(word, word + 5, words[i & 1], 5);
+            } else {
+                memcpy(fText.data() + word, words[i & 1], 5);
+                paragraph = build();
+            }
+            paragraph->layout(1000);
+        }
+    }
+};
 }  // namespace
 
 #define PARAGRAPH_BENCH(X) DEF_BENCH(return new ParagraphBench(50000, "text/" #X ".txt", "paragraph_" #X);)
@@ -62,4 +166,13 @@ struct ParagraphBench : public Benchmark {
 PARAGRAPH_BENCH(english)
 #undef PARAGRAPH_BENCH
 
+DEF_BENCH(return new ParagraphThreadsBench(0);)
+DEF_BENCH(return new ParagraphThreadsBench(1);)
+DEF_BENCH(return new ParagraphThreadsBench(2);)
+DEF_BENCH(return new ParagraphThreadsBench(4);)
+DEF_BENCH(return new ParagraphThreadsBench(8);)
+
+DEF_BENCH(return new ParagraphEditBench(false);)
+DEF_BENCH(return new ParagraphEditBench(true);)
+
 #endif  // !defined(SK_BUILD_FOR_ANDROID_FRAMEWORK) && !defined(SK_BUILD_FOR_GOOGLE3)
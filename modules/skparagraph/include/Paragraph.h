@@ -80,6 +80,21 @@ public:
     virtual void updateForegroundPaint(size_t from, size_t to, SkPaint paint) = 0;
     virtual void updateBackgroundPaint(size_t from, size_t to, SkPaint paint) = 0;
 
+    // Experimental API for editors. Replaces the UTF-8 text in [from:to) with 'utf8', which
+    // takes the style of the text before it. The next layout only shapes the text around the
+    // edit again, from the hard line break before it where the direction or the font changes to
+    // the one after it, and reuses the runs of the rest of the text.
+    // At the same width it also keeps the lines the edit did not change, unless the paragraph
+    // limits or ellipsizes its lines, justifies them, or spaces its letters or words.
+    // Returns false, and changes nothing, if the paragraph has placeholders or the range is
+    // not valid, or if the paragraph does not support editing; the caller should then build a
+    // new paragraph. The indices must be on code point boundaries.
+    virtual bool updateText(size_t from, size_t to, const char* utf8, size_t utf8Length) {
+        return false;
+    }
+    // Like updateText(), but changes the style of the text in [from:to).
+    virtual bool updateTextStyle(size_t from, size_t to, const TextStyle& style) { return false; }
+
     enum VisitorFlags {
         kWhiteSpace_VisitorFlag = 1 << 0,
     };
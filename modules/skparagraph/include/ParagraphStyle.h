@@ -15,6 +15,8 @@
 #include <utility>
 #include <vector>
 
+class SkExecutor;
+
 namespace skia {
 namespace textlayout {
 
@@ -127,6 +129,12 @@ struct ParagraphStyle {
     bool getApplyRoundingHack() const { return fApplyRoundingHack; }
     void setApplyRoundingHack(bool value) { fApplyRoundingHack = value; }
 
+    // If set, long text is split where the text direction or the font changes, and the pieces
+    // are shaped concurrently on the executor. The glyphs are the same as without an executor
+    // (the default), which shapes the whole text at once.
+    SkExecutor* getShapingExecutor() const { return fShapingExecutor; }
+    void setShapingExecutor(SkExecutor* executor) { fShapingExecutor = executor; }
+
 private:
     StrutStyle fStrutStyle;
     TextStyle fDefaultTextStyle;
@@ -140,6 +148,7 @@ private:
     bool fHintingIsOn;
     bool fReplaceTabCharacters;
     bool fApplyRoundingHack = true;
+    SkExecutor* fShapingExecutor = nullptr;
 };
 }  // namespace textlayout
 }  // namespace skia
@@ -154,9 +154,15 @@ void OneLineShaper::finish(const Block& block, SkScalar height, SkScalar& advanc
         if (unresolved.fText.width() == 0) {
             continue;
         }
+        unresolved.fUnresolved = true;
         fResolvedBlocks.emplace_back(unresolved);
         fUnresolvedGlyphs += unresolved.fGlyphs.width();
-        fParagraph->addUnresolvedCodepoints(unresolved.fText);
+        fParagraph->fUnicode->forEachCodepoint(
+            &fParagraph->fText[unresolved.fText.start], unresolved.fText.width(),
+            [&](SkUnichar unichar, int32_t start, int32_t end, int32_t count) {
+                fUnresolvedCodepoints->emplace(unichar);
+            }
+        );
     }
 
     // Sort all pieces by text
@@ -174,7 +180,7 @@ void OneLineShaper::finish(const Block& block, SkScalar height, SkScalar& advanc
         }
 
         if (resolvedBlock.fRun != nullptr) {
-            fParagraph->fFontSwitches.emplace_back(resolvedBlock.fText.start, resolvedBlock.fRun->fFont);
+            fFontSwitches->emplace_back(resolvedBlock.fText.start, resolvedBlock.fRun->fFont);
         }
 
         auto run = resolvedBlock.fRun;
@@ -189,8 +195,10 @@ void OneLineShaper::finish(const Block& block, SkScalar height, SkScalar& advanc
 
         if (resolvedBlock.isFullyResolved()) {
             // Just move the entire run
-            resolvedBlock.fRun->fIndex = this->fParagraph->fRuns.size();
-            this->fParagraph->fRuns.emplace_back(*resolvedBlock.fRun);
+            resolvedBlock.fRun->fIndex = fRuns->size();
+            resolvedBlock.fRun->fUnresolvedGlyphs =
+                    resolvedBlock.fUnresolved ? resolvedBlock.fGlyphs.width() : 0;
+            fRuns->emplace_back(*resolvedBlock.fRun);
             resolvedBlock.fRun.reset();
             continue;
         } else if (run == nullptr) {
@@ -205,17 +213,19 @@ void OneLineShaper::finish(const Block& block, SkScalar height, SkScalar& advanc
                 glyphs.width(),
                 SkShaper::RunHandler::Range(text.start - run->fClusterStart, text.width())
         };
-        this->fParagraph->fRuns.emplace_back(
+        fRuns->emplace_back(
                     this->fParagraph,
                     info,
                     run->fClusterStart,
                     height,
                     block.fStyle.getHalfLeading(),
                     block.fStyle.getBaselineShift(),
-                    this->fParagraph->fRuns.size(),
+                    fRuns->size(),
                     advanceX
                 );
-        auto piece = &this->fParagraph->fRuns.back();
+        auto piece = &fRuns->back();
+        piece->fUnresolvedGlyphs = resolvedBlock.fUnresolved ? glyphs.width() : 0;
+        piece->fCarvedOut = true;
 
         // TODO: Optimize copying
         SkPoint zero = {run->fPositions[glyphs.start].fX, 0};
@@ -541,17 +551,27 @@ void OneLineShaper::matchResolvedFonts(const TextStyle& textStyle,
 
 bool OneLineShaper::iterateThroughShapingRegions(const ShapeVisitor& shape) {
 
+    // Skip the bidi regions before the text range
     size_t bidiIndex = 0;
+    while (bidiIndex < fParagraph->fBidiRegions.size() &&
+           fParagraph->fBidiRegions[bidiIndex].end <= fTextRange.start) {
+        ++bidiIndex;
+    }
 
-    SkScalar advanceX = 0;
+    SkScalar advanceX = fStartX;
     for (auto& placeholder : fParagraph->fPlaceholders) {
 
         if (placeholder.fTextBefore.width() > 0) {
             // Shape the text by bidi regions
-            while (bidiIndex < fParagraph->fBidiRegions.size()) {
+            while (bidiIndex < fParagraph->fBidiRegions.size() &&
+                   fParagraph->fBidiRegions[bidiIndex].start < fTextRange.end) {
                 SkUnicode::BidiRegion& bidiRegion = fParagraph->fBidiRegions[bidiIndex];
-                auto start = std::max(bidiRegion.start, placeholder.fTextBefore.start);
-                auto end = std::min(bidiRegion.end, placeholder.fTextBefore.end);
+                auto start = std::max({bidiRegion.start,
+                                       placeholder.fTextBefore.start,
+                                       fTextRange.start});
+                auto end = std::min({bidiRegion.end,
+                                     placeholder.fTextBefore.end,
+                                     fTextRange.end});
 
                 // Set up the iterators (the style iterator points to a bigger region that it could
                 TextRange textRange(start, end);
@@ -596,13 +616,13 @@ bool OneLineShaper::iterateThroughShapingRegions(const ShapeVisitor& shape) {
             1,
             SkShaper::RunHandler::Range(0, placeholder.fRange.width())
         };
-        auto& run = fParagraph->fRuns.emplace_back(this->fParagraph,
+        auto& run = fRuns->emplace_back(this->fParagraph,
                                        runInfo,
                                        placeholder.fRange.start,
                                        0.0f,
                                        0.0f,
                                        false,
-                                       fParagraph->fRuns.size(),
+                                       fRuns->size(),
                                        advanceX);
 
         run.fPositions[0] = { advanceX, 0 };
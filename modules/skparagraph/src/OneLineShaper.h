@@ -4,6 +4,7 @@
 
 #include <functional>  // std::function
 #include <queue>
+#include <unordered_set>
 #include "include/core/SkSpan.h"
 #include "modules/skparagraph/include/TextStyle.h"
 #include "modules/skparagraph/src/ParagraphImpl.h"
@@ -13,16 +14,41 @@ namespace skia {
 namespace textlayout {
 
 class ParagraphImpl;
+
+// The result of shaping a range of the paragraph's text on its own.
+struct ShapedText {
+    skia_private::TArray<Run, false> fRuns;
+    skia_private::TArray<ResolvedFontDescriptor> fFontSwitches;
+    std::unordered_set<SkUnichar> fUnresolvedCodepoints;
+    size_t fUnresolvedGlyphs = 0;
+};
+
 class OneLineShaper : public SkShaper::RunHandler {
 public:
+    // Shapes the entire text into the paragraph's runs.
     explicit OneLineShaper(ParagraphImpl* paragraph)
-        : fParagraph(paragraph)
-        , fHeight(0.0f)
-        , fUseHalfLeading(false)
-        , fBaselineShift(0.0f)
-        , fAdvance(SkPoint::Make(0.0f, 0.0f))
-        , fUnresolvedGlyphs(0)
-        , fUniqueRunId(paragraph->fRuns.size()){ }
+        : OneLineShaper(paragraph,
+                        TextRange(0, paragraph->fText.size()),
+                        &paragraph->fRuns,
+                        &paragraph->fFontSwitches,
+                        &paragraph->fUnresolvedCodepoints) { }
+
+    // Shapes the text range, which must not contain placeholders, into 'result' as shaping the
+    // whole text does, with the runs carved out before the range ending at 'advanceX'. The range
+    // must start and end where shaping the whole text starts a new block (see
+    // ParagraphImpl::shapedTogether()), since HarfBuzz does not see the text outside of it.
+    // Several of these can run at the same time on different threads.
+    OneLineShaper(ParagraphImpl* paragraph,
+                  TextRange textRange,
+                  SkScalar advanceX,
+                  ShapedText* result)
+        : OneLineShaper(paragraph,
+                        textRange,
+                        &result->fRuns,
+                        &result->fFontSwitches,
+                        &result->fUnresolvedCodepoints) {
+        fStartX = advanceX;
+    }
 
     bool shape();
 
@@ -37,6 +63,22 @@ public:
     static SkUnichar getEmojiSequenceStart(SkUnicode* unicode, const char** begin, const char* end);
 
 private:
+    OneLineShaper(ParagraphImpl* paragraph,
+                  TextRange textRange,
+                  skia_private::TArray<Run, false>* runs,
+                  skia_private::TArray<ResolvedFontDescriptor>* fontSwitches,
+                  std::unordered_set<SkUnichar>* unresolvedCodepoints)
+        : fParagraph(paragraph)
+        , fTextRange(textRange)
+        , fRuns(runs)
+        , fFontSwitches(fontSwitches)
+        , fUnresolvedCodepoints(unresolvedCodepoints)
+        , fHeight(0.0f)
+        , fUseHalfLeading(false)
+        , fBaselineShift(0.0f)
+        , fAdvance(SkPoint::Make(0.0f, 0.0f))
+        , fUnresolvedGlyphs(0)
+        , fUniqueRunId(runs->size()){ }
 
     struct RunBlock {
         RunBlock() : fRun(nullptr) { }
@@ -58,6 +100,7 @@ private:
         std::shared_ptr<Run> fRun;
         TextRange fText;
         GlyphRange fGlyphs;
+        bool fUnresolved = false;  // No font had the glyphs; the run shows them as missing
         bool isFullyResolved() { return fRun != nullptr && fGlyphs.width() == fRun->size(); }
     };
 
@@ -113,6 +156,10 @@ private:
     void fillGaps(size_t);
 
     ParagraphImpl* fParagraph;
+    TextRange fTextRange;
+    skia_private::TArray<Run, false>* fRuns;
+    skia_private::TArray<ResolvedFontDescriptor>* fFontSwitches;
+    std::unordered_set<SkUnichar>* fUnresolvedCodepoints;
     TextRange fCurrentText;
     SkScalar fHeight;
     bool fUseHalfLeading;
@@ -120,6 +167,7 @@ private:
     SkVector fAdvance;
     size_t fUnresolvedGlyphs;
     size_t fUniqueRunId;
+    SkScalar fStartX = 0;
 
     // TODO: Something that is not thead-safe since we don't need it
     std::shared_ptr<Run> fCurrentRun;
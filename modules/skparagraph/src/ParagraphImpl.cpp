@@ -4,6 +4,7 @@
 #include "include/core/SkMatrix.h"
 #include "include/core/SkPath.h"
 #include "include/core/SkPictureRecorder.h"
+#include "include/core/SkScalar.h"
 #include "include/core/SkSpan.h"
 #include "include/core/SkTypeface.h"
 #include "include/private/base/SkTFitsIn.h"
@@ -21,12 +22,15 @@
 #include "modules/skparagraph/src/TextWrapper.h"
 #include "modules/skunicode/include/SkUnicode.h"
 #include "src/base/SkUTF.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/core/SkTextBlobPriv.h"
 
 #include <algorithm>
 #include <cfloat>
 #include <cmath>
+#include <memory>
 #include <utility>
+#include <vector>
 
 using namespace skia_private;
 
@@ -46,6 +50,36 @@ SkScalar littleRound(SkScalar a) {
         return SkScalarFloorToScalar(a);
     }
 }
+
+// Finds where shaping the whole text at once puts the runs, which have to be visited in text
+// order: the runs of each block of text shaped in one go start where the runs carved out of
+// bigger runs in the blocks before it end (see OneLineShaper::finish()). Only for paragraphs
+// without placeholders, which move the runs, too.
+class RunPlacer {
+public:
+    explicit RunPlacer(const ParagraphImpl* paragraph) : fParagraph(paragraph) {}
+
+    // Returns the x of the run
+    SkScalar place(const Run& run) {
+        if (fTextEnd > 0 && !fParagraph->shapedTogether(fTextEnd - 1, run.textRange().start)) {
+            fBlockStart = fAdvance;
+        }
+        fTextEnd = run.textRange().end;
+        if (run.carvedOut()) {
+            fAdvance += run.advance().fX;
+        }
+        return fBlockStart;
+    }
+
+    // The x of the next block of text shaped in one go
+    SkScalar advance() const { return fAdvance; }
+
+private:
+    const ParagraphImpl* fParagraph;
+    TextIndex fTextEnd = 0;
+    SkScalar fBlockStart = 0;
+    SkScalar fAdvance = 0;
+};
 }  // namespace
 
 TextRange operator*(const TextRange& a, const TextRange& b) {
@@ -125,15 +159,6 @@ std::unordered_set<SkUnichar> ParagraphImpl::unresolvedCodepoints() {
     return fUnresolvedCodepoints;
 }
 
-void ParagraphImpl::addUnresolvedCodepoints(TextRange textRange) {
-    fUnicode->forEachCodepoint(
-        &fText[textRange.start], textRange.width(),
-        [&](SkUnichar unichar, int32_t start, int32_t end, int32_t count) {
-            fUnresolvedCodepoints.emplace(unichar);
-        }
-    );
-}
-
 void ParagraphImpl::layout(SkScalar rawWidth) {
     // TODO: This rounding is done to match Flutter tests. Must be removed...
     auto floorWidth = rawWidth;
@@ -159,16 +184,18 @@ void ParagraphImpl::layout(SkScalar rawWidth) {
         // Check if we have the text in the cache and don't need to shape it again
         if (!fFontCollection->getParagraphCache()->findParagraph(this)) {
             if (fState < kIndexed) {
-                // This only happens once at the first layout; the text is immutable
-                // and there is no reason to repeat it
+                // This only happens at the first layout, and after the text is edited
                 if (this->computeCodeUnitProperties()) {
                     fState = kIndexed;
                 }
             }
-            this->fRuns.clear();
-            this->fClusters.clear();
-            this->fClustersIndexFromCodeUnit.clear();
-            this->fClustersIndexFromCodeUnit.push_back_n(fText.size() + 1, EMPTY_INDEX);
+            if (fEditedText == EMPTY_RANGE) {
+                // After an edit reshapeEditedText() keeps the clusters of the runs it keeps
+                this->fRuns.clear();
+                this->fClusters.clear();
+                this->fClustersIndexFromCodeUnit.clear();
+                this->fClustersIndexFromCodeUnit.push_back_n(fText.size() + 1, EMPTY_INDEX);
+            }
             if (!this->shapeTextIntoEndlessLine()) {
                 this->resetContext();
                 // TODO: merge the two next calls - they always come together
@@ -196,6 +223,8 @@ void ParagraphImpl::layout(SkScalar rawWidth) {
                 // Add the paragraph to the cache
                 fFontCollection->getParagraphCache()->updateParagraph(this);
             }
+        } else {
+            this->resetTextEdits();
         }
         fState = kShaped;
     }
@@ -287,7 +316,48 @@ bool ParagraphImpl::computeCodeUnitProperties() {
         return false;
     }
 
-    // Get some information about trailing spaces / hard line breaks
+    this->scanCodeUnitFlags();
+    return true;
+}
+
+// Computes the flags of the whole lines in [start:newEnd) again, after the text in them changed
+// from [start:oldEnd). The flags at the ends of the lines depend on the text around them.
+bool ParagraphImpl::computeCodeUnitFlags(TextIndex start, TextIndex oldEnd, TextIndex newEnd) {
+    TArray<SkUnicode::CodeUnitFlags, true> flags;
+    if (!fUnicode->computeCodeUnitFlags(&fText[start],
+                                        newEnd - start,
+                                        this->paragraphStyle().getReplaceTabCharacters(),
+                                        &flags)) {
+        return false;
+    }
+    constexpr auto kLineBreaks = SkUnicode::CodeUnitFlags::kSoftLineBreakBefore |
+                                 SkUnicode::CodeUnitFlags::kHardLineBreakBefore;
+    if (start > 0) {
+        flags.front() = (flags.front() & ~kLineBreaks) |
+                        (fCodeUnitProperties[start] & kLineBreaks);
+    }
+    if (newEnd < fText.size()) {
+        flags.back() = fCodeUnitProperties[oldEnd];
+    }
+
+    if (oldEnd == newEnd) {
+        std::copy(flags.begin(), flags.end(), fCodeUnitProperties.begin() + start);
+        return true;
+    }
+    TArray<SkUnicode::CodeUnitFlags, true> properties;
+    properties.reserve_exact(fText.size() + 1);
+    properties.push_back_n(start, fCodeUnitProperties.begin());
+    properties.push_back_n(flags.size(), flags.begin());
+    properties.push_back_n(fCodeUnitProperties.size() - oldEnd - 1,
+                           fCodeUnitProperties.begin() + oldEnd + 1);
+    fCodeUnitProperties = std::move(properties);
+    return true;
+}
+
+// Gets some information about trailing spaces / hard line breaks
+void ParagraphImpl::scanCodeUnitFlags() {
+    fHasLineBreaks = false;
+    fHasWhitespacesInside = false;
     fTrailingSpaces = fText.size();
     TextIndex firstWhitespace = EMPTY_INDEX;
     for (int i = 0; i < fCodeUnitProperties.size(); ++i) {
@@ -310,8 +380,6 @@ bool ParagraphImpl::computeCodeUnitProperties() {
     if (firstWhitespace < fTrailingSpaces) {
         fHasWhitespacesInside = true;
     }
-
-    return true;
 }
 
 static bool is_ascii_7bit_space(int c) {
@@ -514,62 +582,704 @@ void ParagraphImpl::buildClusterTable() {
 
     // Walk through all the run in the direction of input text
     for (auto& run : fRuns) {
-        auto runIndex = run.index();
-        auto runStart = fClusters.size();
-        if (run.isPlaceholder()) {
-            // Add info to cluster indexes table (text -> cluster)
-            for (auto i = run.textRange().start; i < run.textRange().end; ++i) {
-              fClustersIndexFromCodeUnit[i] = fClusters.size();
-            }
-            // There are no glyphs but we want to have one cluster
-            fClusters.emplace_back(this, runIndex, 0ul, 1ul, this->text(run.textRange()), run.advance().fX, run.advance().fY);
-            fCodeUnitProperties[run.textRange().start] |= SkUnicode::CodeUnitFlags::kSoftLineBreakBefore;
-            fCodeUnitProperties[run.textRange().end] |= SkUnicode::CodeUnitFlags::kSoftLineBreakBefore;
-        } else {
-            // Walk through the glyph in the direction of input text
-            run.iterateThroughClustersInTextOrder([runIndex, this](size_t glyphStart,
-                                                                   size_t glyphEnd,
-                                                                   size_t charStart,
-                                                                   size_t charEnd,
-                                                                   SkScalar width,
-                                                                   SkScalar height) {
-                SkASSERT(charEnd >= charStart);
-                // Add info to cluster indexes table (text -> cluster)
-                for (auto i = charStart; i < charEnd; ++i) {
-                  fClustersIndexFromCodeUnit[i] = fClusters.size();
-                }
-                SkSpan<const char> text(fText.c_str() + charStart, charEnd - charStart);
-                fClusters.emplace_back(this, runIndex, glyphStart, glyphEnd, text, width, height);
-                fCodeUnitProperties[charStart] |= SkUnicode::CodeUnitFlags::kGlyphClusterStart;
-            });
-        }
-        fCodeUnitProperties[run.textRange().start] |= SkUnicode::CodeUnitFlags::kGlyphClusterStart;
-
-        run.setClusterRange(runStart, fClusters.size());
+        this->buildClusters(run);
         fMaxIntrinsicWidth += run.advance().fX;
     }
     fClustersIndexFromCodeUnit[fText.size()] = fClusters.size();
     fClusters.emplace_back(this, EMPTY_RUN, 0, 0, this->text({fText.size(), fText.size()}), 0, 0);
 }
 
+// Adds the clusters of the run to the cluster table
+void ParagraphImpl::buildClusters(Run& run) {
+    auto runIndex = run.index();
+    auto runStart = fClusters.size();
+    if (run.isPlaceholder()) {
+        // Add info to cluster indexes table (text -> cluster)
+        for (auto i = run.textRange().start; i < run.textRange().end; ++i) {
+          fClustersIndexFromCodeUnit[i] = fClusters.size();
+        }
+        // There are no glyphs but we want to have one cluster
+        fClusters.emplace_back(this, runIndex, 0ul, 1ul, this->text(run.textRange()),
+                               run.advance().fX, run.advance().fY);
+        fCodeUnitProperties[run.textRange().start] |=
+                SkUnicode::CodeUnitFlags::kSoftLineBreakBefore;
+        fCodeUnitProperties[run.textRange().end] |=
+                SkUnicode::CodeUnitFlags::kSoftLineBreakBefore;
+    } else {
+        // Walk through the glyph in the direction of input text
+        run.iterateThroughClustersInTextOrder([runIndex, this](size_t glyphStart,
+                                                               size_t glyphEnd,
+                                                               size_t charStart,
+                                                               size_t charEnd,
+                                                               SkScalar width,
+                                                               SkScalar height) {
+            SkASSERT(charEnd >= charStart);
+            // Add info to cluster indexes table (text -> cluster)
+            for (auto i = charStart; i < charEnd; ++i) {
+              fClustersIndexFromCodeUnit[i] = fClusters.size();
+            }
+            SkSpan<const char> text(fText.c_str() + charStart, charEnd - charStart);
+            fClusters.emplace_back(this, runIndex, glyphStart, glyphEnd, text, width, height);
+            fCodeUnitProperties[charStart] |= SkUnicode::CodeUnitFlags::kGlyphClusterStart;
+        });
+    }
+    fCodeUnitProperties[run.textRange().start] |= SkUnicode::CodeUnitFlags::kGlyphClusterStart;
+
+    run.setClusterRange(runStart, fClusters.size());
+}
+
 bool ParagraphImpl::shapeTextIntoEndlessLine() {
 
     if (fText.size() == 0) {
+        if (!(fEditedText == EMPTY_RANGE)) {
+            this->resetTextEdits();
+            fRuns.clear();
+            fClusters.clear();
+            fClustersIndexFromCodeUnit.clear();
+            fClustersIndexFromCodeUnit.push_back(EMPTY_INDEX);
+        }
         return false;
     }
 
+    if (!(fEditedText == EMPTY_RANGE)) {
+        // It keeps the clusters, too (there is no spacing to apply after an edit)
+        bool result = this->reshapeEditedText();
+        fEditedText = EMPTY_RANGE;
+        return result;
+    }
+
     fUnresolvedCodepoints.clear();
     fFontSwitches.clear();
 
-    OneLineShaper oneLineShaper(this);
-    auto result = oneLineShaper.shape();
-    fUnresolvedGlyphs = oneLineShaper.unresolvedGlyphs();
+    bool result;
+    auto pieces = this->splitTextForShaping(TextRange(0, fText.size()));
+    if (pieces.size() > 1) {
+        fUnresolvedGlyphs = 0;
+        result = this->shapeTextPieces(pieces, 0, &fRuns);
+        RunPlacer placer(this);
+        for (auto& run : fRuns) {
+            run.moveToX(placer.place(run));
+        }
+    } else {
+        OneLineShaper oneLineShaper(this);
+        result = oneLineShaper.shape();
+        fUnresolvedGlyphs = oneLineShaper.unresolvedGlyphs();
+    }
 
     this->applySpacingAndBuildClusterTable();
 
     return result;
 }
 
+// With a shaping executor, long text is shaped in pieces that start where shaping the whole text
+// starts a new block anyway: where the bidi region or the font changes. HarfBuzz never sees across
+// those, and each block starts its glyphs from scratch, so the pieces get the glyphs and positions
+// of the whole text. Returns the pieces, or the whole text if there is no executor or the text is
+// not worth splitting.
+std::vector<TextRange> ParagraphImpl::splitTextForShaping(TextRange text) const {
+    // Small pieces are not worth sending to another thread
+    constexpr size_t kMinPieceSize = 2048;
+    constexpr size_t kMaxPieces = 64;
+
+    std::vector<TextRange> pieces;
+    if (fParagraphStyle.getShapingExecutor() == nullptr ||
+        fPlaceholders.size() > 1 ||
+        text.width() < 2 * kMinPieceSize) {
+        pieces.emplace_back(text);
+        return pieces;
+    }
+
+    // The blocks end where a bidi region or a style ends
+    std::vector<TextIndex> ends;
+    ends.reserve(fBidiRegions.size() + fTextStyles.size());
+    for (const auto& region : fBidiRegions) {
+        ends.push_back(region.end);
+    }
+    for (const auto& style : fTextStyles) {
+        ends.push_back(style.fRange.end);
+    }
+    std::sort(ends.begin(), ends.end());
+
+    const size_t pieceSize = std::max(kMinPieceSize, text.width() / kMaxPieces);
+    TextIndex start = text.start;
+    for (TextIndex end : ends) {
+        if (end >= text.end) {
+            break;
+        }
+        if (end >= start + pieceSize && !this->shapedTogether(end - 1, end)) {
+            pieces.emplace_back(start, end);
+            start = end;
+        }
+    }
+    pieces.emplace_back(start, text.end);
+    return pieces;
+}
+
+// Whether shaping the whole text shapes the code units at 'left' and 'right' in one go: they are in
+// the same bidi region, in styles with the same font (see OneLineShaper::iterateThroughFontStyles).
+bool ParagraphImpl::shapedTogether(TextIndex left, TextIndex right) const {
+    auto regionAt = [this](TextIndex index) {
+        return std::partition_point(fBidiRegions.begin(), fBidiRegions.end(),
+                                    [index](const SkUnicode::BidiRegion& region) {
+                                        return region.end <= index;
+                                    });
+    };
+    auto styleAt = [this](TextIndex index) {
+        return std::partition_point(fTextStyles.begin(), fTextStyles.end(),
+                                    [index](const Block& style) {
+                                        return style.fRange.end <= index;
+                                    });
+    };
+    auto leftStyle = styleAt(left);
+    auto rightStyle = styleAt(right);
+    return regionAt(left) == regionAt(right) &&
+           leftStyle != fTextStyles.end() && rightStyle != fTextStyles.end() &&
+           leftStyle->fStyle.matchOneAttribute(StyleType::kFont, rightStyle->fStyle);
+}
+
+// Shapes each piece on its own (on the shaping executor if there is one), and appends the runs to
+// 'runs'. The runs carved out before the pieces end at 'advanceX'. The pieces after the first one
+// are shaped from 0, as if no runs were carved out before them, and RunPlacer moves their runs to
+// where they go, which gives the same positions as long as they carve out no runs themselves. The
+// ones that do are shaped again, from where the runs before them end.
+bool ParagraphImpl::shapeTextPieces(SkSpan<const TextRange> pieces,
+                                    SkScalar advanceX,
+                                    TArray<Run, false>* runs) {
+    std::vector<ShapedText> shapedPieces(pieces.size());
+    std::unique_ptr<bool[]> results(new bool[pieces.size()]);
+    auto shapePiece = [this, &pieces, &shapedPieces, &results](size_t i, SkScalar x) {
+        shapedPieces[i] = ShapedText();
+        OneLineShaper oneLineShaper(this, pieces[i], x, &shapedPieces[i]);
+        results[i] = oneLineShaper.shape();
+        shapedPieces[i].fUnresolvedGlyphs = oneLineShaper.unresolvedGlyphs();
+    };
+
+    SkExecutor* executor = fParagraphStyle.getShapingExecutor();
+    if (pieces.size() > 1 && executor != nullptr) {
+        SkTaskGroup taskGroup(*executor);
+        for (size_t i = 0; i < pieces.size(); ++i) {
+            taskGroup.add([&shapePiece, i, advanceX] { shapePiece(i, i == 0 ? advanceX : 0); });
+        }
+        taskGroup.wait();
+    } else {
+        for (size_t i = 0; i < pieces.size(); ++i) {
+            shapePiece(i, i == 0 ? advanceX : 0);
+        }
+    }
+
+    for (size_t i = 0; i < pieces.size(); ++i) {
+        auto carvedOut = [&shapedPieces, i] {
+            for (const auto& run : shapedPieces[i].fRuns) {
+                if (run.carvedOut()) {
+                    return true;
+                }
+            }
+            return false;
+        };
+        if (i > 0 && advanceX != 0 && carvedOut()) {
+            shapePiece(i, advanceX);
+        }
+        if (!results[i]) {
+            return false;
+        }
+        auto& shaped = shapedPieces[i];
+        for (auto& run : shaped.fRuns) {
+            if (run.carvedOut()) {
+                advanceX += run.advance().fX;
+            }
+            run.fIndex = runs->size();
+            runs->emplace_back(std::move(run));
+        }
+        for (auto& fontSwitch : shaped.fFontSwitches) {
+            fFontSwitches.emplace_back(fontSwitch);
+        }
+        fUnresolvedCodepoints.insert(shaped.fUnresolvedCodepoints.begin(),
+                                     shaped.fUnresolvedCodepoints.end());
+        fUnresolvedGlyphs += shaped.fUnresolvedGlyphs;
+    }
+    return true;
+}
+
+// Keeps the runs that updateText() and updateTextStyle() did not touch, and their clusters, and
+// shapes the rest.
+bool ParagraphImpl::reshapeEditedText() {
+    // HarfBuzz positions the glyphs of a block from its start, so reshape the whole blocks around
+    // the edit (an empty edit changed the block it is in), and all the runs that cross them. The
+    // code unit flags are computed again for whole lines, so the blocks have to start lines, too.
+    // The flag marks the first code unit after the break.
+    auto startsBlockAndLine = [this](TextIndex index) {
+        return index == 0 || index == fText.size() ||
+               (SkUnicode::hasHardLineBreakFlag(fCodeUnitProperties[index]) &&
+                !this->shapedTogether(index - 1, index));
+    };
+    auto blockStart = [&](TextIndex index) {
+        while (!startsBlockAndLine(index)) {
+            --index;
+        }
+        return index;
+    };
+    auto blockEnd = [&](TextIndex index) {
+        while (!startsBlockAndLine(index)) {
+            ++index;
+        }
+        return index;
+    };
+    TextRange edited(std::min(fEditedText.start, fText.size()),
+                     std::min(fEditedText.end, fText.size()));
+    edited = TextRange(blockStart(edited.start),
+                       blockEnd(std::min(std::max(edited.end, edited.start + 1), fText.size())));
+    for (bool extended = true; extended;) {
+        extended = false;
+        for (auto& run : fRuns) {
+            if (run.fTextRange.start < edited.start && run.fTextRange.end > edited.start) {
+                edited.start = blockStart(run.fTextRange.start);
+                extended = true;
+            }
+            if (run.fTextRange.start < edited.end && run.fTextRange.end > edited.end) {
+                edited.end = blockEnd(run.fTextRange.end);
+                extended = true;
+            }
+        }
+    }
+
+    // The runs are in text order
+    int before = 0;
+    while (before < fRuns.size() && fRuns[before].fTextRange.end <= edited.start) {
+        ++before;
+    }
+    int after = before;
+    while (after < fRuns.size() && fRuns[after].fTextRange.start < edited.end) {
+        ++after;
+    }
+    // The runs that are shaped again marked their ends in the flags
+    if (edited.width() > 0 &&
+        !this->computeCodeUnitFlags(edited.start, edited.end, edited.end)) {
+        return false;
+    }
+
+    TArray<ResolvedFontDescriptor> fontSwitches = std::move(fFontSwitches);
+    fFontSwitches.clear();
+    int fontSwitch = 0;
+    while (fontSwitch < fontSwitches.size() &&
+           fontSwitches[fontSwitch].fTextStart < edited.start) {
+        fFontSwitches.emplace_back(fontSwitches[fontSwitch++]);
+    }
+
+    TArray<Run, false> runs;
+    runs.reserve(fRuns.size());
+    RunPlacer placer(this);
+    for (int i = 0; i < before; ++i) {
+        Run& run = runs.emplace_back(std::move(fRuns[i]));
+        // The runs before the edit keep their place
+        [[maybe_unused]] const SkScalar x = placer.place(run);
+        SkASSERT(x == run.offset().fX);
+    }
+    auto shapeAgain = [&](TextRange text) {
+        const int first = runs.size();
+        auto pieces = this->splitTextForShaping(text);
+        if (!this->shapeTextPieces(pieces, placer.advance(), &runs)) {
+            return false;
+        }
+        for (int i = first; i < runs.size(); ++i) {
+            runs[i].moveToX(placer.place(runs[i]));
+        }
+        return true;
+    };
+    if (edited.width() > 0 && !shapeAgain(edited)) {
+        return false;
+    }
+    // The runs after the edit start a block. If the runs carved out of the edited text moved it,
+    // the glyphs of all the text after it move, too, so it is shaped again.
+    if (after < fRuns.size() && fRuns[after].offset().fX != placer.advance()) {
+        const TextRange rest(edited.end, fText.size());
+        if (!this->computeCodeUnitFlags(rest.start, rest.end, rest.end) || !shapeAgain(rest)) {
+            return false;
+        }
+        edited.end = rest.end;
+        after = fRuns.size();
+    }
+
+    // The clusters of the runs before the edited text stay where they are
+    TArray<Cluster, true> clusters = std::move(fClusters);
+    TArray<size_t, true> clusterIndexes = std::move(fClustersIndexFromCodeUnit);
+    const ClusterIndex clustersBefore = before > 0 ? runs[before - 1].fClusterRange.end : 0;
+    fClusters.clear();
+    fClusters.push_back_n(clustersBefore, clusters.begin());
+    fClustersIndexFromCodeUnit.clear();
+    fClustersIndexFromCodeUnit.push_back_n(edited.start, clusterIndexes.begin());
+    fClustersIndexFromCodeUnit.push_back_n(fText.size() + 1 - edited.start, EMPTY_INDEX);
+    for (int i = before; i < runs.size(); ++i) {
+        fCodeUnitProperties[runs[i].fTextRange.start] |= SkUnicode::CodeUnitFlags::kGraphemeStart;
+        this->buildClusters(runs[i]);
+    }
+    fCodeUnitProperties[edited.end] |= SkUnicode::CodeUnitFlags::kGraphemeStart;
+    fCodeUnitProperties[edited.end] |= SkUnicode::CodeUnitFlags::kGlyphClusterStart;
+    const ClusterIndex clustersAfter = fClusters.size();
+
+    // The text and clusters of the runs after it move
+    ptrdiff_t textDelta = 0;
+    ptrdiff_t clusterDelta = 0;
+    ptrdiff_t runDelta = 0;
+    if (after < fRuns.size()) {
+        const Run& first = fRuns[after];
+        textDelta = fText.size() - (clusterIndexes.size() - 1);
+        clusterDelta = clustersAfter - first.fClusterRange.start;
+        runDelta = runs.size() - first.fIndex;
+
+        for (int i = after; i < fRuns.size(); ++i) {
+            Run& run = runs.emplace_back(std::move(fRuns[i]));
+            // They keep their place, too
+            [[maybe_unused]] const SkScalar x = placer.place(run);
+            SkASSERT(x == run.offset().fX);
+            run.fIndex = runs.size() - 1;
+
+            const ClusterIndex runStart = fClusters.size();
+            for (auto c = run.fClusterRange.start; c < run.fClusterRange.end; ++c) {
+                Cluster& cluster = fClusters.emplace_back(clusters[c]);
+                cluster.fRunIndex = run.fIndex;
+                cluster.fTextRange.Shift(textDelta);
+                for (auto i = cluster.fTextRange.start; i < cluster.fTextRange.end; ++i) {
+                    fClustersIndexFromCodeUnit[i] = fClusters.size() - 1;
+                }
+            }
+            run.setClusterRange(runStart, fClusters.size());
+        }
+    }
+    fClustersIndexFromCodeUnit[fText.size()] = fClusters.size();
+    fClusters.emplace_back(this, EMPTY_RUN, 0, 0, this->text({fText.size(), fText.size()}), 0, 0);
+    fRuns = std::move(runs);
+
+    for (; fontSwitch < fontSwitches.size(); ++fontSwitch) {
+        if (fontSwitches[fontSwitch].fTextStart >= edited.end) {
+            fFontSwitches.emplace_back(fontSwitches[fontSwitch]);
+        }
+    }
+
+    // Count what is left unresolved in the runs that were kept, too
+    fUnresolvedGlyphs = 0;
+    fUnresolvedCodepoints.clear();
+    for (auto& run : fRuns) {
+        if (run.fUnresolvedGlyphs == 0) {
+            continue;
+        }
+        fUnresolvedGlyphs += run.fUnresolvedGlyphs;
+        fUnicode->forEachCodepoint(
+            &fText[run.fTextRange.start], run.fTextRange.width(),
+            [&](SkUnichar unichar, int32_t start, int32_t end, int32_t count) {
+                fUnresolvedCodepoints.emplace(unichar);
+            }
+        );
+    }
+
+    fReshapedText = edited;
+    fTextDelta = textDelta;
+    fClusterDelta = clusterDelta;
+    fRunDelta = runDelta;
+    return true;
+}
+
+// Replaces the text in [from:to), and computes the code unit properties, the bidi regions, the
+// words and the UTF-16 mapping only for the lines around it.
+void ParagraphImpl::replaceText(TextIndex from, TextIndex to, const char* utf8, size_t utf8Length) {
+    const TextIndex newEnd = from + utf8Length;
+    const bool indexed = fState >= kIndexed;
+    if (indexed && !fWords.empty()) {
+        // The words are in UTF-16
+        this->ensureUTF16Mapping();
+    }
+
+    // The lines also have to be bidi paragraphs: the text before them has to end with a line
+    // break that ends the paragraph, too (and they are found in the old text)
+    TextIndex start = 0;
+    TextIndex oldEnd = fText.size();
+    if (indexed) {
+        auto startsLine = [this](TextIndex index) {
+            return (fText[index - 1] == '\n' || fText[index - 1] == '\r') &&
+                   SkUnicode::hasHardLineBreakFlag(fCodeUnitProperties[index]);
+        };
+        // The line break flags right at the edit depend on the edited text
+        start = from > 0 ? from - 1 : 0;
+        while (start > 0 && !startsLine(start)) {
+            --start;
+        }
+        oldEnd = std::min(to + 1, fText.size());
+        while (oldEnd < fText.size() && !startsLine(oldEnd)) {
+            ++oldEnd;
+        }
+    }
+    const TextIndex newLineEnd = oldEnd - to + newEnd;
+    const size_t start16 = fHasUTF16Mapping ? fUTF16IndexForUTF8Index[start] : 0;
+    const size_t oldEnd16 = fHasUTF16Mapping ? fUTF16IndexForUTF8Index[oldEnd] : 0;
+    const size_t from16 = fHasUTF16Mapping ? fUTF16IndexForUTF8Index[from] : 0;
+    const size_t to16 = fHasUTF16Mapping ? fUTF16IndexForUTF8Index[to] : 0;
+
+    SkString text(fText.c_str(), from);
+    text.append(utf8, utf8Length);
+    text.append(fText.c_str() + to, fText.size() - to);
+    fText = std::move(text);
+
+    if (fHasUTF16Mapping) {
+        TArray<TextIndex, true> utf8Indexes;
+        TArray<size_t, true> utf16Indexes;
+        if (SkUnicode::extractUtfConversionMapping(
+                    SkSpan<const char>(utf8, utf8Length),
+                    [&](size_t index) { utf8Indexes.emplace_back(from + index); },
+                    [&](size_t index) { utf16Indexes.emplace_back(from16 + index); })) {
+            const size_t newEnd16 = utf8Indexes.size() - 1 + from16;
+            TArray<TextIndex, true> utf8IndexForUTF16Index;
+            utf8IndexForUTF16Index.reserve_exact(
+                    fUTF8IndexForUTF16Index.size() - to16 + newEnd16);
+            utf8IndexForUTF16Index.push_back_n(from16, fUTF8IndexForUTF16Index.begin());
+            utf8IndexForUTF16Index.push_back_n(utf8Indexes.size() - 1, utf8Indexes.begin());
+            for (size_t i = to16; i < SkToSizeT(fUTF8IndexForUTF16Index.size()); ++i) {
+                utf8IndexForUTF16Index.emplace_back(fUTF8IndexForUTF16Index[i] - to + newEnd);
+            }
+            TArray<size_t, true> utf16IndexForUTF8Index;
+            utf16IndexForUTF8Index.reserve_exact(fText.size() + 1);
+            utf16IndexForUTF8Index.push_back_n(from, fUTF16IndexForUTF8Index.begin());
+            utf16IndexForUTF8Index.push_back_n(utf8Length, utf16Indexes.begin());
+            for (size_t i = to; i < SkToSizeT(fUTF16IndexForUTF8Index.size()); ++i) {
+                utf16IndexForUTF8Index.emplace_back(fUTF16IndexForUTF8Index[i] - to16 + newEnd16);
+            }
+            fUTF8IndexForUTF16Index = std::move(utf8IndexForUTF16Index);
+            fUTF16IndexForUTF8Index = std::move(utf16IndexForUTF8Index);
+        } else {
+            fUTF8IndexForUTF16Index.clear();
+            fUTF16IndexForUTF8Index.clear();
+            fHasUTF16Mapping = false;
+        }
+    }
+
+    if (!indexed || fText.isEmpty()) {
+        fState = kUnknown;
+        fCodeUnitProperties.clear();
+        fBidiRegions.clear();
+        fWords.clear();
+        return;
+    }
+
+    auto textDirection = fParagraphStyle.getTextDirection() == TextDirection::kLtr
+                              ? SkUnicode::TextDirection::kLTR
+                              : SkUnicode::TextDirection::kRTL;
+    std::vector<SkUnicode::BidiRegion> bidiRegions;
+    std::vector<size_t> words;
+    if (!this->computeCodeUnitFlags(start, oldEnd, newLineEnd) ||
+        !fUnicode->getBidiRegions(&fText[start], newLineEnd - start, textDirection, &bidiRegions) ||
+        (!fWords.empty() &&
+         (!fHasUTF16Mapping ||
+          !fUnicode->getWords(&fText[start], newLineEnd - start, nullptr, &words)))) {
+        // Compute them for the whole text at the next layout
+        fState = kUnknown;
+        fCodeUnitProperties.clear();
+        fBidiRegions.clear();
+        fWords.clear();
+        return;
+    }
+    this->scanCodeUnitFlags();
+
+    // Levels of the same bidi run come in one region
+    std::vector<SkUnicode::BidiRegion> regions;
+    auto addRegion = [&regions](TextIndex regionStart, TextIndex regionEnd, uint8_t level) {
+        if (regionStart == regionEnd) {
+            return;
+        }
+        if (!regions.empty() && regions.back().level == level) {
+            regions.back().end = regionEnd;
+        } else {
+            regions.emplace_back(regionStart, regionEnd, level);
+        }
+    };
+    for (auto& region : fBidiRegions) {
+        if (region.start < start) {
+            addRegion(region.start, std::min(region.end, start), region.level);
+        }
+    }
+    for (auto& region : bidiRegions) {
+        addRegion(region.start + start, region.end + start, region.level);
+    }
+    for (auto& region : fBidiRegions) {
+        if (region.end > oldEnd) {
+            addRegion(std::max(region.start, oldEnd) - oldEnd + newLineEnd,
+                      region.end - oldEnd + newLineEnd,
+                      region.level);
+        }
+    }
+    fBidiRegions = std::move(regions);
+
+    if (!fWords.empty()) {
+        const size_t newLineEnd16 = fUTF16IndexForUTF8Index[newLineEnd];
+        std::vector<size_t> allWords;
+        for (auto word : fWords) {
+            if (word <= start16) {
+                allWords.emplace_back(word);
+            }
+        }
+        for (auto word : words) {
+            allWords.emplace_back(word + start16);
+        }
+        for (auto word : fWords) {
+            if (word >= oldEnd16) {
+                allWords.emplace_back(word - oldEnd16 + newLineEnd16);
+            }
+        }
+        allWords.erase(std::unique(allWords.begin(), allWords.end()), allWords.end());
+        fWords = std::move(allWords);
+    }
+}
+
+// Makes the text in [from:to), which is now [from:newEnd), shape again at the next layout, and
+// moves the runs after it.
+void ParagraphImpl::markTextEdited(TextIndex from, TextIndex to, TextIndex newEnd) {
+    auto moveIndex = [from, to, newEnd](TextIndex index) {
+        return index < from ? index : index > to ? index - to + newEnd : newEnd;
+    };
+
+    // Spacing moves all the glyphs after it, so the runs can't be kept with spacing
+    bool hasSpacing = false;
+    for (auto& block : fTextStyles) {
+        if (!SkScalarNearlyZero(block.fStyle.getLetterSpacing()) ||
+            !SkScalarNearlyZero(block.fStyle.getWordSpacing())) {
+            hasSpacing = true;
+        }
+    }
+
+    if (fState < kIndexed || hasSpacing ||
+        (fState < kShaped && fEditedText == EMPTY_RANGE)) {
+        // There is nothing to keep
+        this->resetTextEdits();
+        fRuns.clear();
+        fFontSwitches.clear();
+        fClusters.clear();
+    } else {
+        if (fEditedText == EMPTY_RANGE) {
+            // The first edit since the last layout keeps its lines
+            fLinesToReuse = std::move(fLines);
+        }
+
+        // The text of the runs that are not kept has to be shaped again
+        TextRange edited(from, newEnd);
+        TArray<Run, false> runs;
+        for (auto& run : fRuns) {
+            if (run.fTextRange.end <= from) {
+                runs.emplace_back(std::move(run));
+            } else if (run.fTextRange.start >= to) {
+                run.fTextRange = TextRange(moveIndex(run.fTextRange.start),
+                                           moveIndex(run.fTextRange.end));
+                run.fClusterStart = run.fClusterStart - to + newEnd;
+                runs.emplace_back(std::move(run));
+            } else {
+                edited = TextRange(std::min(edited.start, run.fTextRange.start),
+                                   std::max(edited.end, moveIndex(run.fTextRange.end)));
+            }
+        }
+        fRuns = std::move(runs);
+
+        TArray<ResolvedFontDescriptor> fontSwitches;
+        for (auto& fontSwitch : fFontSwitches) {
+            if (fontSwitch.fTextStart < from) {
+                fontSwitches.emplace_back(fontSwitch);
+            } else if (fontSwitch.fTextStart >= to) {
+                fontSwitches.emplace_back(moveIndex(fontSwitch.fTextStart), fontSwitch.fFont);
+            }
+        }
+        fFontSwitches = std::move(fontSwitches);
+
+        fEditedText = fEditedText == EMPTY_RANGE
+                ? edited
+                : TextRange(std::min(moveIndex(fEditedText.start), edited.start),
+                            std::max(moveIndex(fEditedText.end), edited.end));
+    }
+
+    fLines.clear();
+    fPicture = nullptr;
+    fState = std::min(fState, kIndexed);
+}
+
+// Forgets the edits since the last layout, for the next one to shape the whole text
+void ParagraphImpl::resetTextEdits() {
+    fEditedText = EMPTY_RANGE;
+    fLinesToReuse.clear();
+    fReshapedText = EMPTY_RANGE;
+    fTextDelta = 0;
+    fClusterDelta = 0;
+    fRunDelta = 0;
+}
+
+bool ParagraphImpl::updateText(size_t from, size_t to, const char* utf8, size_t utf8Length) {
+    auto isCodePointStart = [this](size_t index) {
+        return index == fText.size() || (fText[index] & 0xC0) != 0x80;
+    };
+    if (fPlaceholders.size() > 1 || from > to || to > fText.size() ||
+        !isCodePointStart(from) || !isCodePointStart(to)) {
+        return false;
+    }
+    const TextIndex newEnd = from + utf8Length;
+    auto moveIndex = [from, to, newEnd](TextIndex index) {
+        // The inserted text takes the style of the text before it
+        return index < from || index == 0 ? index : index > to ? index - to + newEnd : newEnd;
+    };
+
+    TArray<Block, true> blocks;
+    for (auto& block : fTextStyles) {
+        TextRange range(moveIndex(block.fRange.start), moveIndex(block.fRange.end));
+        if (range.width() > 0) {
+            blocks.emplace_back(range, block.fStyle);
+        }
+    }
+    if (blocks.empty() && !fTextStyles.empty()) {
+        blocks.emplace_back(TextRange(0, newEnd), fTextStyles.front().fStyle);
+    }
+    fTextStyles = std::move(blocks);
+
+    this->replaceText(from, to, utf8, utf8Length);
+    this->markTextEdited(from, to, newEnd);
+    this->updateLastPlaceholder();
+    return true;
+}
+
+bool ParagraphImpl::updateTextStyle(size_t from, size_t to, const TextStyle& style) {
+    auto isCodePointStart = [this](size_t index) {
+        return index == fText.size() || (fText[index] & 0xC0) != 0x80;
+    };
+    if (fPlaceholders.size() > 1 || from >= to || to > fText.size() ||
+        !isCodePointStart(from) || !isCodePointStart(to)) {
+        return false;
+    }
+
+    TArray<Block, true> blocks;
+    bool added = false;
+    for (auto& block : fTextStyles) {
+        if (block.fRange.end <= from || block.fRange.start >= to) {
+            blocks.emplace_back(block);
+            continue;
+        }
+        if (block.fRange.start < from) {
+            blocks.emplace_back(TextRange(block.fRange.start, from), block.fStyle);
+        }
+        if (!added) {
+            blocks.emplace_back(TextRange(from, to), style);
+            added = true;
+        }
+        if (block.fRange.end > to) {
+            blocks.emplace_back(TextRange(to, block.fRange.end), block.fStyle);
+        }
+    }
+    fTextStyles = std::move(blocks);
+
+    this->markTextEdited(from, to, to);
+    this->updateLastPlaceholder();
+    return true;
+}
+
+// The last placeholder holds the text and the blocks after the other placeholders.
+void ParagraphImpl::updateLastPlaceholder() {
+    SkASSERT(fPlaceholders.size() == 1);
+    auto& placeholder = fPlaceholders.back();
+    placeholder.fRange = TextRange(fText.size(), fText.size());
+    placeholder.fTextBefore = TextRange(0, fText.size());
+    placeholder.fBlocksBefore = BlockRange(0, fTextStyles.size());
+}
+
 void ParagraphImpl::breakShapedTextIntoLines(SkScalar maxWidth) {
 
     if (!fHasLineBreaks &&
@@ -631,9 +1341,16 @@ void ParagraphImpl::breakShapedTextIntoLines(SkScalar maxWidth) {
         fAlphabeticBaseline = fLines.empty() ? fEmptyMetrics.alphabeticBaseline() : fLines.front().alphabeticBaseline();
         fIdeographicBaseline = fLines.empty() ? fEmptyMetrics.ideographicBaseline() : fLines.front().ideographicBaseline();
         fExceededMaxLines = false;
+        this->resetTextEdits();
         return;
     }
 
+    if (this->breakEditedTextIntoLines(maxWidth)) {
+        this->resetTextEdits();
+        return;
+    }
+    this->resetTextEdits();
+
     TextWrapper textWrapper;
     textWrapper.breakTextIntoLines(
             this,
@@ -667,6 +1384,102 @@ void ParagraphImpl::breakShapedTextIntoLines(SkScalar maxWidth) {
     fExceededMaxLines = textWrapper.exceededMaxLines();
 }
 
+// Keeps the lines of the last layout before and after the text that reshapeEditedText() shaped
+// again, and only breaks that text into lines. A soft line break depends on the words after it,
+// so the text broken again runs from the hard line break before the edit to the one after it.
+bool ParagraphImpl::breakEditedTextIntoLines(SkScalar maxWidth) {
+    if (fReshapedText == EMPTY_RANGE || fLinesToReuse.empty() || maxWidth != fOldWidth ||
+        !fParagraphStyle.unlimited_lines() || fParagraphStyle.ellipsized() ||
+        fParagraphStyle.getTextHeightBehavior() != TextHeightBehavior::kAll ||
+        fParagraphStyle.effective_align() == TextAlign::kJustify) {
+        return false;
+    }
+
+    auto endsParagraph = [this](TextIndex index) {
+        return index == fText.size() ||
+               this->codeUnitHasProperty(index, SkUnicode::CodeUnitFlags::kHardLineBreakBefore);
+    };
+
+    int line = 0;
+    int reusedBefore = 0;
+    for (; line < fLinesToReuse.size() &&
+           fLinesToReuse[line].textWithNewlines().end <= fReshapedText.start; ++line) {
+        if (endsParagraph(fLinesToReuse[line].textWithNewlines().end)) {
+            reusedBefore = line + 1;
+        }
+    }
+    SkScalar top = 0;
+    TextIndex textStart = 0;
+    for (line = 0; line < reusedBefore; ++line) {
+        // The runs were moved, and the text blobs of the line point to them
+        fLinesToReuse[line].relocate(0, 0, 0, top);
+        top += fLinesToReuse[line].height();
+        textStart = fLinesToReuse[line].textWithNewlines().end;
+        fLines.emplace_back(std::move(fLinesToReuse[line]));
+    }
+
+    TextIndex textEnd = fReshapedText.end;
+    while (!endsParagraph(textEnd)) {
+        ++textEnd;
+    }
+
+    TextWrapper textWrapper;
+    textWrapper.breakTextIntoLines(
+            this,
+            maxWidth,
+            ClusterRange(fClustersIndexFromCodeUnit[textStart],
+                         fClustersIndexFromCodeUnit[textEnd]),
+            top,
+            [&](TextRange textExcludingSpaces,
+                TextRange text,
+                TextRange textWithNewlines,
+                ClusterRange clusters,
+                ClusterRange clustersWithGhosts,
+                SkScalar widthWithSpaces,
+                size_t startPos,
+                size_t endPos,
+                SkVector offset,
+                SkVector advance,
+                InternalLineMetrics metrics,
+                bool addEllipsis) {
+                this->addLine(offset, advance, textExcludingSpaces, text, textWithNewlines,
+                              clusters, clustersWithGhosts, widthWithSpaces, metrics);
+            });
+    top = textWrapper.height();
+
+    if (textEnd < fText.size()) {
+        const TextIndex oldEnd = textEnd - fTextDelta;
+        for (line = reusedBefore; line < fLinesToReuse.size(); ++line) {
+            auto& reused = fLinesToReuse[line];
+            if (reused.text().start < oldEnd) {
+                continue;
+            }
+            reused.relocate(fTextDelta, fClusterDelta, fRunDelta, top);
+            top += reused.height();
+            fLines.emplace_back(std::move(reused));
+        }
+    }
+
+    fLongestLine = 0;
+    fMaxWidthWithTrailingSpaces = 0;
+    fMinIntrinsicWidth = std::numeric_limits<SkScalar>::min();
+    fMaxIntrinsicWidth = std::numeric_limits<SkScalar>::min();
+    for (auto& line : fLines) {
+        auto width = line.widthWithoutEllipsis();
+        fLongestLine = std::max(fLongestLine, nearlyZero(width) ? line.widthWithSpaces() : width);
+        fMaxWidthWithTrailingSpaces = std::max(fMaxWidthWithTrailingSpaces,
+                                               line.widthWithSpaces());
+        fMinIntrinsicWidth = std::max(fMinIntrinsicWidth, line.minIntrinsicWidth());
+        fMaxIntrinsicWidth = std::max(fMaxIntrinsicWidth, line.maxIntrinsicWidth());
+    }
+    fHeight = top;
+    fWidth = maxWidth;
+    fAlphabeticBaseline = fLines.front().alphabeticBaseline();
+    fIdeographicBaseline = fLines.front().ideographicBaseline();
+    fExceededMaxLines = false;
+    return true;
+}
+
 void ParagraphImpl::formatLines(SkScalar maxWidth) {
     auto effectiveAlign = fParagraphStyle.effective_align();
     const bool isLeftAligned = effectiveAlign == TextAlign::kLeft
@@ -992,6 +1805,7 @@ void ParagraphImpl::setState(InternalState state) {
         case kIndexed:
             fRuns.clear();
             fClusters.clear();
+            this->resetTextEdits();
             [[fallthrough]];
 
         case kShaped:
@@ -1088,6 +1902,7 @@ void ParagraphImpl::updateFontSize(size_t from, size_t to, SkScalar fontSize) {
   fState = std::min(fState, kIndexed);
   fOldWidth = 0;
   fOldHeight = 0;
+  this->resetTextEdits();
 }
 
 void ParagraphImpl::updateTextAlign(TextAlign textAlign) {
@@ -1168,12 +1983,18 @@ TextIndex ParagraphImpl::findPreviousGlyphClusterBoundary(TextIndex utf8) const
 }
 
 void ParagraphImpl::ensureUTF16Mapping() {
-    fillUTF16MappingOnce([&] {
-        SkUnicode::extractUtfConversionMapping(
-                this->text(),
-                [&](size_t index) { fUTF8IndexForUTF16Index.emplace_back(index); },
-                [&](size_t index) { fUTF16IndexForUTF8Index.emplace_back(index); });
-    });
+    if (fHasUTF16Mapping.load(std::memory_order_acquire)) {
+        return;
+    }
+    SkAutoMutexExclusive lock(fUTF16MappingMutex);
+    if (fHasUTF16Mapping.load(std::memory_order_relaxed)) {
+        return;
+    }
+    SkUnicode::extractUtfConversionMapping(
+            this->text(),
+            [&](size_t index) { fUTF8IndexForUTF16Index.emplace_back(index); },
+            [&](size_t index) { fUTF16IndexForUTF8Index.emplace_back(index); });
+    fHasUTF16Mapping.store(true, std::memory_order_release);
 }
 
 void ParagraphImpl::visit(const Visitor& visitor) {
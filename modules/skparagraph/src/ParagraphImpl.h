@@ -12,7 +12,7 @@
 #include "include/core/SkSpan.h"
 #include "include/core/SkString.h"
 #include "include/core/SkTypes.h"
-#include "include/private/base/SkOnce.h"
+#include "include/private/base/SkMutex.h"
 #include "include/private/base/SkTArray.h"
 #include "include/private/base/SkTemplates.h"
 #include "modules/skparagraph/include/DartTypes.h"
@@ -28,6 +28,7 @@
 #include "src/base/SkBitmaskEnum.h"
 #include "src/core/SkTHash.h"
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <vector>
@@ -183,11 +184,11 @@ public:
         if (fState > kIndexed) {
             fState = kIndexed;
         }
+        this->resetTextEdits();
     }
 
     int32_t unresolvedGlyphs() override;
     std::unordered_set<SkUnichar> unresolvedCodepoints() override;
-    void addUnresolvedCodepoints(TextRange textRange);
 
     void setState(InternalState state);
     sk_sp<SkPicture> getPicture() { return fPicture; }
@@ -198,15 +199,27 @@ public:
     void resolveStrut();
 
     bool computeCodeUnitProperties();
+    bool computeCodeUnitFlags(TextIndex start, TextIndex oldEnd, TextIndex newEnd);
+    void scanCodeUnitFlags();
     void applySpacingAndBuildClusterTable();
     void buildClusterTable();
+    void buildClusters(Run& run);
     bool shapeTextIntoEndlessLine();
+    std::vector<TextRange> splitTextForShaping(TextRange text) const;
+    bool shapedTogether(TextIndex left, TextIndex right) const;
+    bool shapeTextPieces(SkSpan<const TextRange> pieces,
+                         SkScalar advanceX,
+                         skia_private::TArray<Run, false>* runs);
+    bool reshapeEditedText();
     void breakShapedTextIntoLines(SkScalar maxWidth);
+    bool breakEditedTextIntoLines(SkScalar maxWidth);
 
     void updateTextAlign(TextAlign textAlign) override;
     void updateFontSize(size_t from, size_t to, SkScalar fontSize) override;
     void updateForegroundPaint(size_t from, size_t to, SkPaint paint) override;
     void updateBackgroundPaint(size_t from, size_t to, SkPaint paint) override;
+    bool updateText(size_t from, size_t to, const char* utf8, size_t utf8Length) override;
+    bool updateTextStyle(size_t from, size_t to, const TextStyle& style) override;
 
     void visit(const Visitor&) override;
     void extendedVisit(const ExtendedVisitor&) override;
@@ -256,6 +269,10 @@ private:
     friend class OneLineShaper;
 
     void computeEmptyMetrics();
+    void replaceText(TextIndex from, TextIndex to, const char* utf8, size_t utf8Length);
+    void markTextEdited(TextIndex from, TextIndex to, TextIndex newEnd);
+    void resetTextEdits();
+    void updateLastPlaceholder();
 
     // Input
     skia_private::TArray<StyleBlock<SkScalar>> fLetterSpaceStyles;
@@ -271,20 +288,31 @@ private:
     // Internal structures
     InternalState fState;
     skia_private::TArray<Run, false> fRuns;         // kShaped
+    TextRange fEditedText = EMPTY_RANGE;            // text to shape again, keeping fRuns
     skia_private::TArray<Cluster, true> fClusters;  // kClusterized (cached: text, word spacing, letter spacing, resolved fonts)
     skia_private::TArray<SkUnicode::CodeUnitFlags, true> fCodeUnitProperties;
     skia_private::TArray<size_t, true> fClustersIndexFromCodeUnit;
     std::vector<size_t> fWords;
     std::vector<SkUnicode::BidiRegion> fBidiRegions;
     // These two arrays are used in measuring methods (getRectsForRange, getGlyphPositionAtCoordinate)
-    // They are filled lazily whenever they need and cached
+    // They are filled lazily whenever they need and cached (the measuring methods may run on
+    // several threads at once); updateText() keeps them up to date or drops them
     skia_private::TArray<TextIndex, true> fUTF8IndexForUTF16Index;
     skia_private::TArray<size_t, true> fUTF16IndexForUTF8Index;
-    SkOnce fillUTF16MappingOnce;
+    std::atomic<bool> fHasUTF16Mapping = false;
+    SkMutex fUTF16MappingMutex;
     size_t fUnresolvedGlyphs;
     std::unordered_set<SkUnichar> fUnresolvedCodepoints;
 
     skia_private::TArray<TextLine, false> fLines;   // kFormatted   (cached: width, max lines, ellipsis, text align)
+    // The lines of the last layout, which the next layout keeps if the text edits did not change
+    // them, and what reshapeEditedText() changed: the text it shaped again, and how far the text,
+    // clusters and runs after it moved
+    skia_private::TArray<TextLine, false> fLinesToReuse;
+    TextRange fReshapedText = EMPTY_RANGE;
+    ptrdiff_t fTextDelta = 0;
+    ptrdiff_t fClusterDelta = 0;
+    ptrdiff_t fRunDelta = 0;
     sk_sp<SkPicture> fPicture;          // kRecorded    (cached: text styles)
 
     skia_private::TArray<ResolvedFontDescriptor> fFontSwitches;
@@ -56,6 +56,8 @@ Run::Run(ParagraphImpl* owner,
     fClusterIndexes[info.glyphCount] = this->leftToRight() ? info.utf8Range.end() : info.utf8Range.begin();
     fEllipsis = false;
     fPlaceholderIndex = std::numeric_limits<size_t>::max();
+    fUnresolvedGlyphs = 0;
+    fCarvedOut = false;
 }
 
 void Run::calculateMetrics() {
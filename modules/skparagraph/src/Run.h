@@ -82,6 +82,14 @@ public:
         fOffset.fX += shiftX;
         fOffset.fY += shiftY;
     }
+    // Moves the run and its glyphs horizontally, so that the run starts at x
+    void moveToX(SkScalar x) {
+        const SkScalar shiftX = x - fOffset.fX;
+        fOffset.fX = x;
+        for (auto& position : fPositions) {
+            position.fX += shiftX;
+        }
+    }
     SkVector advance() const {
         return SkVector::Make(fAdvance.fX, fFontMetrics.fDescent - fFontMetrics.fAscent + fFontMetrics.fLeading);
     }
@@ -98,6 +106,7 @@ public:
     size_t index() const { return fIndex; }
     SkScalar heightMultiplier() const { return fHeightMultiplier; }
     bool useHalfLeading() const { return fUseHalfLeading; }
+    bool carvedOut() const { return fCarvedOut; }
     SkScalar baselineShift() const { return fBaselineShift; }
     PlaceholderStyle* placeholderStyle() const;
     bool isPlaceholder() const { return fPlaceholderIndex != std::numeric_limits<size_t>::max(); }
@@ -212,6 +221,8 @@ private:
 
     bool fEllipsis;
     uint8_t fBidiLevel;
+    size_t fUnresolvedGlyphs;  // The glyphs of the run if no font had them, or 0
+    bool fCarvedOut;  // Cut out of a bigger run; the runs of the next blocks start after it
 };
 
 template<typename Visitor>
@@ -118,6 +118,8 @@ TextLine::TextLine(ParagraphImpl* owner,
         , fHasBackground(false)
         , fHasShadows(false)
         , fHasDecorations(false)
+        , fMinIntrinsicWidth(std::numeric_limits<SkScalar>::min())
+        , fMaxIntrinsicWidth(std::numeric_limits<SkScalar>::min())
         , fAscentStyle(LineMetricStyle::CSS)
         , fDescentStyle(LineMetricStyle::CSS)
         , fTextBlobCachePopulated(false) {
@@ -126,18 +128,7 @@ TextLine::TextLine(ParagraphImpl* owner,
     auto& end = owner->cluster(fGhostClusterRange.end - 1);
     size_t numRuns = end.runIndex() - start.runIndex() + 1;
 
-    for (BlockIndex index = fBlockRange.start; index < fBlockRange.end; ++index) {
-        auto b = fOwner->styles().begin() + index;
-        if (b->fStyle.hasBackground()) {
-            fHasBackground = true;
-        }
-        if (b->fStyle.getDecorationType() != TextDecoration::kNoDecoration) {
-            fHasDecorations = true;
-        }
-        if (b->fStyle.getShadowNumber() > 0) {
-            fHasShadows = true;
-        }
-    }
+    this->findStyles();
 
     // Get the logical order
 
@@ -184,6 +175,44 @@ TextLine::TextLine(ParagraphImpl* owner,
     }
 }
 
+void TextLine::findStyles() {
+    fHasBackground = false;
+    fHasDecorations = false;
+    fHasShadows = false;
+    for (BlockIndex index = fBlockRange.start; index < fBlockRange.end; ++index) {
+        auto b = fOwner->styles().begin() + index;
+        if (b->fStyle.hasBackground()) {
+            fHasBackground = true;
+        }
+        if (b->fStyle.getDecorationType() != TextDecoration::kNoDecoration) {
+            fHasDecorations = true;
+        }
+        if (b->fStyle.getShadowNumber() > 0) {
+            fHasShadows = true;
+        }
+    }
+}
+
+void TextLine::relocate(ptrdiff_t textDelta,
+                        ptrdiff_t clusterDelta,
+                        ptrdiff_t runDelta,
+                        SkScalar top) {
+    fTextExcludingSpaces.Shift(textDelta);
+    fText.Shift(textDelta);
+    fTextIncludingNewlines.Shift(textDelta);
+    fClusterRange.Shift(clusterDelta);
+    fGhostClusterRange.Shift(clusterDelta);
+    for (auto& runIndex : fRunsInVisualOrder) {
+        runIndex += runDelta;
+    }
+    // The edited styles may have been split or merged
+    fBlockRange = fOwner->findAllBlocks(fTextExcludingSpaces);
+    this->findStyles();
+    fOffset.fY = top;
+    fTextBlobCache.clear();
+    fTextBlobCachePopulated = false;
+}
+
 void TextLine::paint(ParagraphPainter* painter, SkScalar x, SkScalar y) {
     if (fHasBackground) {
         this->iterateThroughVisualRuns(false,
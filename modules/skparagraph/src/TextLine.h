@@ -79,6 +79,7 @@ public:
         return fAdvance.fX + (fEllipsis != nullptr ? fEllipsis->fAdvance.fX : 0);
     }
     SkScalar widthWithoutEllipsis() const { return fAdvance.fX; }
+    SkScalar widthWithSpaces() const { return fWidthWithSpaces; }
     SkVector offset() const;
 
     SkScalar alphabeticBaseline() const { return fSizes.alphabeticBaseline(); }
@@ -142,7 +143,21 @@ public:
 
     bool endsWithHardLineBreak() const;
 
+    // What the line adds to the intrinsic widths of the paragraph, so the paragraph can keep the
+    // line when the text around it changes
+    void setIntrinsicWidths(SkScalar minIntrinsicWidth, SkScalar maxIntrinsicWidth) {
+        fMinIntrinsicWidth = minIntrinsicWidth;
+        fMaxIntrinsicWidth = maxIntrinsicWidth;
+    }
+    SkScalar minIntrinsicWidth() const { return fMinIntrinsicWidth; }
+    SkScalar maxIntrinsicWidth() const { return fMaxIntrinsicWidth; }
+
+    // Moves the line after the text, clusters and runs before it changed, and drops its text
+    // blobs, which point to the runs
+    void relocate(ptrdiff_t textDelta, ptrdiff_t clusterDelta, ptrdiff_t runDelta, SkScalar top);
+
 private:
+    void findStyles();
     std::unique_ptr<Run> shapeEllipsis(const SkString& ellipsis, const Cluster* cluster);
     void justify(SkScalar maxWidth);
 
@@ -187,6 +202,8 @@ private:
     bool fHasBackground;
     bool fHasShadows;
     bool fHasDecorations;
+    SkScalar fMinIntrinsicWidth;
+    SkScalar fMaxIntrinsicWidth;
 
     LineMetricStyle fAscentStyle;
     LineMetricStyle fDescentStyle;
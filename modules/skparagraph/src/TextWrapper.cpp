@@ -277,7 +277,18 @@ std::tuple<Cluster*, size_t, SkScalar> TextWrapper::trimStartSpaces(Cluster* end
 void TextWrapper::breakTextIntoLines(ParagraphImpl* parent,
                                      SkScalar maxWidth,
                                      const AddLineToParagraph& addLine) {
-    fHeight = 0;
+    auto span = parent->clusters();
+    // The last cluster is the empty one at the end of the text
+    auto clusters = ClusterRange(0, span.empty() ? 0 : span.size() - 1);
+    this->breakTextIntoLines(parent, maxWidth, clusters, 0, addLine);
+}
+
+void TextWrapper::breakTextIntoLines(ParagraphImpl* parent,
+                                     SkScalar maxWidth,
+                                     ClusterRange clusters,
+                                     SkScalar top,
+                                     const AddLineToParagraph& addLine) {
+    fHeight = top;
     fMinIntrinsicWidth = std::numeric_limits<SkScalar>::min();
     fMaxIntrinsicWidth = std::numeric_limits<SkScalar>::min();
 
@@ -293,16 +304,22 @@ void TextWrapper::breakTextIntoLines(ParagraphImpl* parent,
 
     auto disableFirstAscent = parent->paragraphStyle().getTextHeightBehavior() & TextHeightBehavior::kDisableFirstAscent;
     auto disableLastDescent = parent->paragraphStyle().getTextHeightBehavior() & TextHeightBehavior::kDisableLastDescent;
-    bool firstLine = true; // We only interested in fist line if we have to disable the first ascent
+    // We only interested in fist line if we have to disable the first ascent
+    bool firstLine = clusters.start == 0;
 
     SkScalar softLineMaxIntrinsicWidth = 0;
-    fEndLine = TextStretch(span.begin(), span.begin(), parent->strutForceHeight());
-    auto end = span.end() - 1;
     auto start = span.begin();
+    auto end = start + clusters.end;
+    fEndLine = TextStretch(start + clusters.start, start + clusters.start,
+                           parent->strutForceHeight());
     InternalLineMetrics maxRunMetrics;
     bool needEllipsis = false;
     while (fEndLine.endCluster() != end) {
 
+        // Collect the words of this line on their own, for the line to remember them
+        auto minIntrinsicWidth = fMinIntrinsicWidth;
+        fMinIntrinsicWidth = std::numeric_limits<SkScalar>::min();
+
         this->lookAhead(maxWidth, end, parent->getApplyRoundingHack());
 
         auto lastLine = (hasEllipsis && unlimitedLines) || fLineNumber >= maxLines;
@@ -356,7 +373,7 @@ void TextWrapper::breakTextIntoLines(ParagraphImpl* parent,
         TextRange textExcludingSpaces(fEndLine.startCluster()->textRange().start, fEndLine.endCluster()->textRange().end);
         TextRange text(fEndLine.startCluster()->textRange().start, fEndLine.breakCluster()->textRange().start);
         TextRange textIncludingNewlines(fEndLine.startCluster()->textRange().start, startLine->textRange().start);
-        if (startLine == end) {
+        if (startLine == span.end() - 1) {
             textIncludingNewlines.end = parent->text().size();
             text.end = parent->text().size();
         }
@@ -399,6 +416,8 @@ void TextWrapper::breakTextIntoLines(ParagraphImpl* parent,
 
         softLineMaxIntrinsicWidth += widthWithSpaces;
 
+        parent->lines().back().setIntrinsicWidths(fMinIntrinsicWidth, softLineMaxIntrinsicWidth);
+        fMinIntrinsicWidth = std::max(minIntrinsicWidth, fMinIntrinsicWidth);
         fMaxIntrinsicWidth = std::max(fMaxIntrinsicWidth, softLineMaxIntrinsicWidth);
         if (fHardLineBreak) {
             softLineMaxIntrinsicWidth = 0;
@@ -473,7 +492,7 @@ void TextWrapper::breakTextIntoLines(ParagraphImpl* parent,
         }
     }
 
-    if (fHardLineBreak) {
+    if (fHardLineBreak && end == span.end() - 1) {
         if (disableLastDescent) {
             fEndLine.metrics().fDescent = fEndLine.metrics().fRawDescent;
         }
@@ -182,6 +182,14 @@ public:
     void breakTextIntoLines(ParagraphImpl* parent,
                             SkScalar maxWidth,
                             const AddLineToParagraph& addLine);
+    // Breaks only the clusters up to clusters.end (not included) into lines, placing the first
+    // one at 'top'. The clusters have to start a line, either at the start of the text or after
+    // a hard line break.
+    void breakTextIntoLines(ParagraphImpl* parent,
+                            SkScalar maxWidth,
+                            ClusterRange clusters,
+                            SkScalar top,
+                            const AddLineToParagraph& addLine);
 
     SkScalar height() const { return fHeight; }
     SkScalar minIntrinsicWidth() const { return fMinIntrinsicWidth; }
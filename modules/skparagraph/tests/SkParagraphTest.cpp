@@ -7,6 +7,7 @@
 #include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFontMgr.h"
 #include "include/core/SkFontStyle.h"
 #include "include/core/SkPaint.h"
@@ -36,6 +37,7 @@
 #include "modules/skparagraph/tests/SkShaperJSONWriter.h"
 #include "modules/skparagraph/utils/TestFontCollection.h"
 #include "modules/skshaper/utils/FactoryHelpers.h"
+#include "src/base/SkRandom.h"
 #include "src/base/SkTSort.h"
 #include "src/core/SkOSFile.h"
 #include "src/utils/SkOSPath.h"
@@ -8356,6 +8358,410 @@ UNIX_ONLY_TEST(SkParagraph_EndWithLineSeparator, reporter) {
     REPORTER_ASSERT(reporter, visitedCount == 3, "visitedCount: %d", visitedCount);
 }
 
+struct LaidOutGlyph {
+    SkGlyphID fGlyph;
+    size_t fCluster;
+    SkScalar fX;
+};
+
+// The glyphs of the runs of a paragraph, where the runs have them
+static std::vector<LaidOutGlyph> run_glyphs(ParagraphImpl* paragraph) {
+    std::vector<LaidOutGlyph> result;
+    for (const Run& run : paragraph->runs()) {
+        for (size_t g = 0; g < run.size(); ++g) {
+            result.push_back({run.glyphs()[g], run.globalClusterIndex(g), run.positions()[g].fX});
+        }
+    }
+    return result;
+}
+
+// The glyphs of the lines of a paragraph, where they are painted
+static std::vector<LaidOutGlyph> painted_glyphs(ParagraphImpl* paragraph) {
+    std::vector<LaidOutGlyph> result;
+    paragraph->visit([&result](int, const Paragraph::VisitorInfo* info) {
+        if (info == nullptr) {
+            return;
+        }
+        for (int g = 0; g < info->count; ++g) {
+            result.push_back({info->glyphs[g], info->utf8Starts[g],
+                              info->origin.fX + info->positions[g].fX});
+        }
+    });
+    return result;
+}
+
+static void compare_glyphs(skiatest::Reporter* reporter,
+                           const std::vector<LaidOutGlyph>& a,
+                           const std::vector<LaidOutGlyph>& b) {
+    REPORTER_ASSERT(reporter, a.size() == b.size());
+    for (size_t i = 0; i < std::min(a.size(), b.size()); ++i) {
+        REPORTER_ASSERT(reporter, a[i].fGlyph == b[i].fGlyph);
+        REPORTER_ASSERT(reporter, a[i].fCluster == b[i].fCluster);
+        REPORTER_ASSERT(reporter, a[i].fX == b[i].fX, "%g != %g", a[i].fX, b[i].fX);
+    }
+}
+
+// Checks that two paragraphs with the same text have the same glyphs in the same runs, and paint
+// them in the same lines, at exactly the same places.
+static void compare_layouts(skiatest::Reporter* reporter, ParagraphImpl* a, ParagraphImpl* b) {
+    REPORTER_ASSERT(reporter, a->text().size() == b->text().size());
+    REPORTER_ASSERT(reporter, a->unresolvedGlyphs() == b->unresolvedGlyphs());
+    REPORTER_ASSERT(reporter, a->unresolvedCodepoints() == b->unresolvedCodepoints());
+    REPORTER_ASSERT(reporter, a->runs().size() == b->runs().size());
+    compare_glyphs(reporter, run_glyphs(a), run_glyphs(b));
+    compare_glyphs(reporter, painted_glyphs(a), painted_glyphs(b));
+
+    REPORTER_ASSERT(reporter, a->lines().size() == b->lines().size());
+    for (size_t i = 0; i < std::min(a->lines().size(), b->lines().size()); ++i) {
+        const TextLine& lineA = a->lines()[i];
+        const TextLine& lineB = b->lines()[i];
+        REPORTER_ASSERT(reporter, lineA.text() == lineB.text());
+        REPORTER_ASSERT(reporter, lineA.width() == lineB.width());
+        REPORTER_ASSERT(reporter, lineA.offset() == lineB.offset());
+    }
+    REPORTER_ASSERT(reporter, a->getHeight() == b->getHeight());
+    REPORTER_ASSERT(reporter, a->getMaxIntrinsicWidth() == b->getMaxIntrinsicWidth());
+    REPORTER_ASSERT(reporter, a->getMinIntrinsicWidth() == b->getMinIntrinsicWidth());
+}
+
+UNIX_ONLY_TEST(SkParagraph_ParallelShaping, reporter) {
+    sk_sp<ResourceFontCollection> fontCollection = sk_make_sp<ResourceFontCollection>();
+    SKIP_IF_FONTS_NOT_FOUND(reporter, fontCollection)
+    fontCollection->getParagraphCache()->turnOn(false);
+
+    // Many paragraphs, with some right-to-left text and unresolved characters in them. The text
+    // can be shaped in pieces where it changes direction.
+    std::string text;
+    for (int i = 0; i < 100; ++i) {
+        text += "Line " + std::to_string(i) + ": Lorem ipsum dolor sit amet, consectetur "
+                "adipiscing elit, sed do eiusmod tempor incididunt ut labore.\n";
+        text += "שלום עולם, and some text in between "
+                "你好.\n";
+    }
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    auto layout = [&](SkExecutor* shapingExecutor) {
+        ParagraphStyle paragraph_style;
+        paragraph_style.setShapingExecutor(shapingExecutor);
+        ParagraphBuilderImpl builder(paragraph_style, fontCollection, get_unicode());
+        TextStyle textStyle;
+        textStyle.setFontFamilies({SkString("Roboto")});
+        textStyle.setFontSize(20);
+        builder.pushStyle(textStyle);
+        builder.addText(text.c_str(), text.size());
+        auto paragraph = builder.Build();
+        paragraph->layout(300);
+        return paragraph;
+    };
+    // Without an executor the text is shaped in one piece.
+    auto whole = layout(nullptr);
+    auto parallel = layout(executor.get());
+    compare_layouts(reporter, static_cast<ParagraphImpl*>(whole.get()),
+                    static_cast<ParagraphImpl*>(parallel.get()));
+}
+
+// Lays out the texts of the tests above with and without a shaping executor, in the fonts and
+// styles they use. Each text is repeated until it is long enough to be shaped in pieces, in two
+// font sizes by turns, so that it can be split where the size changes.
+UNIX_ONLY_TEST(SkParagraph_ParallelShapingCorpus, reporter) {
+    sk_sp<ResourceFontCollection> fontCollection = sk_make_sp<ResourceFontCollection>();
+    SKIP_IF_FONTS_NOT_FOUND(reporter, fontCollection)
+    fontCollection->getParagraphCache()->turnOn(false);
+
+    const char* corpus[] = {
+        "Hello World Text Dialog",
+        "This is a very long sentence to test if the text will properly wrap "
+        "around and go to the next line. Sometimes, short sentence. Longer "
+        "sentences are okay too because they are nessecary. Very short. ",
+        "line1\nline2 test1 test2 test3 test4 test5 test6 test7\nline3\n\nline4 "
+        "test1 test2 test3 test4",
+        "12345  67890 12345 67890 12345 67890 12345 67890 12345 67890 12345 ",
+        "AVAVAWAH A0 V0 VA To The Lo fluttser mdje",
+        " leading space",
+        "01234  \u3000 \n0123\u3000        ",
+        "01234\u6e80\u6bce\u51a0\u884c\u6765\u663c\u672c\u53ef\nabcd\n"
+        "\u6e80\u6bce\u51a0\u884c\u6765\u663c\u672c\u53ef",
+        "     左線読設重説切後碁給能上目秘使約。満毎冠行来昼本可必図将発確年。今属場育",
+        "English English 字典 字典 😀😃😄 😀😃😄",
+        "Roboto 字典 Homemade Apple 字典 Chinese 字典",
+        " אאא בּבּבּבּ אאאא בּבּ אאא בּבּבּ אאאאא בּבּבּבּ אאאא בּבּבּבּבּ ",
+        "من أسر وإعلان الخاصّة وهولندا،, عل قائمة الضغوط بالمطالبة تلك. الصفحة ",
+        "Helloبمباركة التقليدية قام عن. تصفح يد ",
+        "ٱلْرَّحْمَـانُ",
+        "ดีสวัสดีชาวโลกที่น่ารัก",
+        "👨‍👩‍👧‍👦 ♻️🏴󠁧󠁢󠁳󠁣󠁴󠁿 p〠q 一丁丂七",
+        "A text ending with line separator.\u2028",
+        "(\u3000\u00b4\uff65\u203f\uff65\uff40)(\u3000\u00b4\uff65\u203f\uff65\uff40)",
+    };
+    struct Style {
+        std::vector<SkString> fFamilies;
+        SkScalar fFontSize;
+        SkScalar fLetterSpacing;
+        SkScalar fWidth;
+    };
+    const Style styles[] = {
+        {{SkString("Roboto")}, 20, 0, 300},
+        {{SkString("Ahem")}, 10, 0, 500},
+        {{SkString("Roboto"), SkString("Noto Naskh Arabic"), SkString("Source Han Serif CN"),
+          SkString("Noto Color Emoji")}, 16, 0, 250},
+        {{SkString("Homemade Apple"), SkString("Noto Sans CJK JP")}, 24, 1, 400},
+    };
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    for (const char* line : corpus) {
+        std::string text = line;
+        text += '\n';
+        const size_t repeats = 16 * 1024 / text.size() + 1;
+        for (const Style& style : styles) {
+            auto layout = [&](SkExecutor* shapingExecutor) {
+                ParagraphStyle paragraph_style;
+                paragraph_style.setShapingExecutor(shapingExecutor);
+                ParagraphBuilderImpl builder(paragraph_style, fontCollection, get_unicode());
+                TextStyle textStyle;
+                textStyle.setFontFamilies(style.fFamilies);
+                textStyle.setLetterSpacing(style.fLetterSpacing);
+                for (size_t i = 0; i < repeats; ++i) {
+                    textStyle.setFontSize(style.fFontSize + (i % 2) * 2);
+                    builder.pushStyle(textStyle);
+                    builder.addText(text.c_str(), text.size());
+                    builder.pop();
+                }
+                auto paragraph = builder.Build();
+                paragraph->layout(style.fWidth);
+                return paragraph;
+            };
+            auto whole = layout(nullptr);
+            auto parallel = layout(executor.get());
+            compare_layouts(reporter, static_cast<ParagraphImpl*>(whole.get()),
+                            static_cast<ParagraphImpl*>(parallel.get()));
+        }
+    }
+}
+
+UNIX_ONLY_TEST(SkParagraph_IncrementalRelayout, reporter) {
+    sk_sp<ResourceFontCollection> fontCollection = sk_make_sp<ResourceFontCollection>();
+    SKIP_IF_FONTS_NOT_FOUND(reporter, fontCollection)
+    fontCollection->getParagraphCache()->turnOn(false);
+
+    std::string text;
+    for (int i = 0; i < 20; ++i) {
+        text += "Line " + std::to_string(i) + ": Lorem ipsum dolor sit amet, consectetur "
+                "adipiscing elit, sed do eiusmod tempor incididunt ut labore.\n";
+        text += "שלום עולם, and some text in between.\n";
+    }
+    TextStyle textStyle;
+    textStyle.setFontFamilies({SkString("Roboto")});
+    textStyle.setFontSize(20);
+    auto build = [&](const std::string& utf8) {
+        ParagraphStyle paragraph_style;
+        ParagraphBuilderImpl builder(paragraph_style, fontCollection, get_unicode());
+        builder.pushStyle(textStyle);
+        builder.addText(utf8.c_str(), utf8.size());
+        auto paragraph = builder.Build();
+        paragraph->layout(300);
+        return paragraph;
+    };
+
+    auto edited = build(text);
+    auto editedImpl = static_cast<ParagraphImpl*>(edited.get());
+    const SkGlyphID* firstGlyphs = editedImpl->runs()[0].glyphs().data();
+
+    // Replace a word, join two lines, and add a line break.
+    auto edit = [&](size_t from, size_t to, const std::string& replacement) {
+        REPORTER_ASSERT(reporter, edited->updateText(from, to, replacement.c_str(),
+                                                     replacement.size()));
+        text.replace(from, to - from, replacement);
+        edited->layout(300);
+
+        auto expected = build(text);
+        compare_layouts(reporter, static_cast<ParagraphImpl*>(expected.get()), editedImpl);
+    };
+    size_t word = text.find("dolor", text.size() / 2);
+    edit(word, word + 5, "dolorem");
+    size_t lineBreak = text.find('\n', text.size() / 2);
+    edit(lineBreak, lineBreak + 1, " ");
+    edit(word, word, "\n");
+    edit(text.size() - 1, text.size(), "");
+
+    // The runs before the edits were not shaped again.
+    REPORTER_ASSERT(reporter, editedImpl->runs()[0].glyphs().data() == firstGlyphs);
+
+    // Make a word bigger.
+    TextStyle bigStyle = textStyle;
+    bigStyle.setFontSize(30);
+    word = text.find("ipsum", text.size() / 3);
+    REPORTER_ASSERT(reporter, edited->updateTextStyle(word, word + 5, bigStyle));
+    edited->layout(300);
+
+    ParagraphStyle paragraph_style;
+    ParagraphBuilderImpl builder(paragraph_style, fontCollection, get_unicode());
+    builder.pushStyle(textStyle);
+    builder.addText(text.c_str(), word);
+    builder.pushStyle(bigStyle);
+    builder.addText(text.c_str() + word, 5);
+    builder.pop();
+    builder.addText(text.c_str() + word + 5, text.size() - word - 5);
+    auto expected = builder.Build();
+    expected->layout(300);
+    compare_layouts(reporter, static_cast<ParagraphImpl*>(expected.get()), editedImpl);
+    REPORTER_ASSERT(reporter, editedImpl->runs()[0].glyphs().data() == firstGlyphs);
+
+    // The range has to be on code point boundaries.
+    size_t hebrew = text.find("שלום");
+    REPORTER_ASSERT(reporter, !edited->updateTextStyle(hebrew + 1, hebrew + 4, bigStyle));
+
+    // Paragraphs with placeholders can't be edited.
+    ParagraphBuilderImpl placeholderBuilder(paragraph_style, fontCollection, get_unicode());
+    placeholderBuilder.pushStyle(textStyle);
+    placeholderBuilder.addText("text");
+    placeholderBuilder.addPlaceholder(PlaceholderStyle(20, 20, PlaceholderAlignment::kBaseline,
+                                                       TextBaseline::kAlphabetic, 0));
+    auto withPlaceholder = placeholderBuilder.Build();
+    REPORTER_ASSERT(reporter, !withPlaceholder->updateText(0, 1, "T", 1));
+}
+
+UNIX_ONLY_TEST(SkParagraph_EditKeepsRunPositions, reporter) {
+    sk_sp<ResourceFontCollection> fontCollection = sk_make_sp<ResourceFontCollection>();
+    SKIP_IF_FONTS_NOT_FOUND(reporter, fontCollection)
+    fontCollection->getParagraphCache()->turnOn(false);
+
+    // Several font styles, and characters from other fonts, so that the shaper carves runs into
+    // pieces, and the runs of the styles after them start after the pieces.
+    struct Line {
+        std::string before, big, after;
+    };
+    std::vector<Line> lines;
+    for (int i = 0; i < 12; ++i) {
+        lines.push_back({"Line " + std::to_string(i) + ": Lorem ", "ipsum",
+                         " dolor 你好 sit amet.\n"});
+        lines.push_back({"שלום ", "עולם", ", and some text in between.\n"});
+    }
+    TextStyle textStyle;
+    textStyle.setFontFamilies({SkString("Roboto")});
+    textStyle.setFontSize(20);
+    TextStyle bigStyle = textStyle;
+    bigStyle.setFontSize(30);
+    auto build = [&]() {
+        ParagraphStyle paragraph_style;
+        ParagraphBuilderImpl builder(paragraph_style, fontCollection, get_unicode());
+        builder.pushStyle(textStyle);
+        for (const Line& line : lines) {
+            builder.addText(line.before.c_str(), line.before.size());
+            builder.pushStyle(bigStyle);
+            builder.addText(line.big.c_str(), line.big.size());
+            builder.pop();
+            builder.addText(line.after.c_str(), line.after.size());
+        }
+        auto paragraph = builder.Build();
+        paragraph->layout(300);
+        return paragraph;
+    };
+
+    auto original = build();
+    auto edited = build();
+    auto editedImpl = static_cast<ParagraphImpl*>(edited.get());
+
+    const size_t line = 4;
+    size_t word = 0;
+    for (size_t i = 0; i < line; ++i) {
+        word += lines[i].before.size() + lines[i].big.size() + lines[i].after.size();
+    }
+    word += lines[line].before.size() + lines[line].big.size() + lines[line].after.find("dolor");
+
+    // The edited paragraph has the glyphs where a paragraph with the edited text has them.
+    REPORTER_ASSERT(reporter, edited->updateText(word, word + 5, "dolorem", 7));
+    edited->layout(300);
+    lines[line].after.replace(lines[line].after.find("dolor"), 5, "dolorem");
+    auto expected = build();
+    compare_layouts(reporter, static_cast<ParagraphImpl*>(expected.get()), editedImpl);
+
+    // Undoing the edit puts them back where the default layout had them before the edit.
+    REPORTER_ASSERT(reporter, edited->updateText(word, word + 7, "dolor", 5));
+    edited->layout(300);
+    compare_layouts(reporter, static_cast<ParagraphImpl*>(original.get()), editedImpl);
+}
+
+// Inserts and deletes text all over a paragraph with two styles, right-to-left text and fallback
+// fonts, and lays it out after each edit as if it had been built with the edited text.
+UNIX_ONLY_TEST(SkParagraph_EditSeries, reporter) {
+    sk_sp<ResourceFontCollection> fontCollection = sk_make_sp<ResourceFontCollection>();
+    SKIP_IF_FONTS_NOT_FOUND(reporter, fontCollection)
+    fontCollection->getParagraphCache()->turnOn(false);
+
+    TextStyle textStyle;
+    textStyle.setFontFamilies({SkString("Roboto")});
+    textStyle.setFontSize(20);
+    TextStyle bigStyle = textStyle;
+    bigStyle.setFontSize(30);
+
+    // The text, and whether each of its bytes has the big style.
+    std::string text;
+    std::vector<bool> big;
+    auto append = [&](const std::string& utf8, bool isBig) {
+        text += utf8;
+        big.insert(big.end(), utf8.size(), isBig);
+    };
+    for (int i = 0; i < 8; ++i) {
+        append("Line " + std::to_string(i) + ": Lorem ", false);
+        append("ipsum", true);
+        append(" dolor 你好 sit amet, consectetur adipiscing elit.\n", false);
+        append("שלום ", false);
+        append("עולם", true);
+        append(", and some text in between.\n", false);
+    }
+
+    auto build = [&]() {
+        ParagraphStyle paragraph_style;
+        ParagraphBuilderImpl builder(paragraph_style, fontCollection, get_unicode());
+        for (size_t start = 0; start < text.size();) {
+            size_t end = start;
+            while (end < text.size() && big[end] == big[start]) {
+                ++end;
+            }
+            builder.pushStyle(big[start] ? bigStyle : textStyle);
+            builder.addText(text.c_str() + start, end - start);
+            builder.pop();
+            start = end;
+        }
+        auto paragraph = builder.Build();
+        paragraph->layout(300);
+        return paragraph;
+    };
+    auto codePointStart = [&](size_t index) {
+        while (index < text.size() && (text[index] & 0xC0) == 0x80) {
+            ++index;
+        }
+        return index;
+    };
+
+    auto edited = build();
+    auto editedImpl = static_cast<ParagraphImpl*>(edited.get());
+    const std::string insertions[] = {"x", " ", "\n", "dolorem ", "שלום", "你好", "سلام"};
+    SkRandom random;
+    for (int i = 0; i < 60; ++i) {
+        const size_t from = codePointStart(random.nextULessThan(text.size()));
+        if (random.nextBool()) {
+            // Inserted text takes the style of the text before it.
+            const std::string& insertion =
+                    insertions[random.nextULessThan(std::size(insertions))];
+            REPORTER_ASSERT(reporter, edited->updateText(from, from, insertion.c_str(),
+                                                         insertion.size()));
+            text.insert(from, insertion);
+            big.insert(big.begin() + from, insertion.size(), big[from > 0 ? from - 1 : 0]);
+        } else {
+            const size_t to =
+                    codePointStart(std::min<size_t>(from + random.nextRangeU(1, 12), text.size()));
+            REPORTER_ASSERT(reporter, edited->updateText(from, to, "", 0));
+            text.erase(from, to - from);
+            big.erase(big.begin() + from, big.begin() + to);
+        }
+        edited->layout(300);
+
+        auto expected = build();
+        compare_layouts(reporter, static_cast<ParagraphImpl*>(expected.get()), editedImpl);
+    }
+}
+
 [[maybe_unused]] static void SkParagraph_EmojiFontResolution(sk_sp<SkUnicode> icu, skiatest::Reporter* reporter) {
     sk_sp<ResourceFontCollection> fontCollection = sk_make_sp<ResourceFontCollection>();
     SKIP_IF_FONTS_NOT_FOUND(reporter, fontCollection)
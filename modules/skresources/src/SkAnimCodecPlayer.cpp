@@ -20,19 +20,41 @@
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkSamplingOptions.h"
 #include "include/core/SkSize.h"
+#include "include/core/SkStream.h"
 #include "include/core/SkTypes.h"
+#include "src/codec/SkAnimFrameCache.h"
 #include "src/codec/SkCodecImageGenerator.h"
 
 #include <algorithm>
-#include <cstddef>
 #include <memory>
 #include <utility>
 #include <vector>
 
-SkAnimCodecPlayer::SkAnimCodecPlayer(std::unique_ptr<SkCodec> codec) : fCodec(std::move(codec)) {
+// Decodes the frames of the player with a codec, which it owns for look-ahead.
+class SkAnimCodecPlayer::FrameDecoder final : public SkAnimFrameCache::Decoder {
+public:
+    FrameDecoder(const SkAnimCodecPlayer* player, SkCodec* codec,
+                 std::unique_ptr<SkCodec> ownedCodec = nullptr)
+        : fPlayer(player)
+        , fCodec(codec)
+        , fOwnedCodec(std::move(ownedCodec)) {}
+
+    sk_sp<SkImage> decodeFrame(int index, const sk_sp<SkImage>& prior) override {
+        return fPlayer->decodeFrame(fCodec, index, prior);
+    }
+
+private:
+    const SkAnimCodecPlayer* fPlayer;
+    SkCodec*                 fCodec;
+    std::unique_ptr<SkCodec> fOwnedCodec;
+};
+
+SkAnimCodecPlayer::SkAnimCodecPlayer(std::unique_ptr<SkCodec> codec,
+                                     SkExecutor* lookAheadExecutor,
+                                     int lookAheadFrames)
+        : fCodec(std::move(codec)) {
     fImageInfo = fCodec->getInfo();
     fFrameInfos = fCodec->getFrameInfo();
-    fImages.resize(fFrameInfos.size());
 
     // change the interpretation of fDuration to a end-time for that frame
     size_t dur = 0;
@@ -45,18 +67,35 @@ SkAnimCodecPlayer::SkAnimCodecPlayer(std::unique_ptr<SkCodec> codec) : fCodec(st
     if (!fTotalDuration) {
         // Static image -- may or may not have returned a single frame info.
         fFrameInfos.clear();
-        fImages.clear();
-        fImages.push_back(SkImages::DeferredFromGenerator(
-                SkCodecImageGenerator::MakeFromCodec(std::move(fCodec))));
+        fStaticImage = SkImages::DeferredFromGenerator(
+                SkCodecImageGenerator::MakeFromCodec(std::move(fCodec)));
+        return;
     }
+
+    // The look-ahead codecs are made from a duplicate of the encoded stream, because codecs are
+    // not thread-safe.
+    std::unique_ptr<SkStream> encodedData = lookAheadExecutor ? fCodec->getEncodedData() : nullptr;
+    fFrameCache = std::make_unique<SkAnimFrameCache>(
+            std::make_unique<FrameDecoder>(this, fCodec.get()),
+            fFrameInfos,
+            std::move(encodedData),
+            lookAheadExecutor,
+            lookAheadFrames,
+            [this](std::unique_ptr<SkStream> stream) -> std::unique_ptr<FrameDecoder> {
+                std::unique_ptr<SkCodec> codec = SkCodec::MakeFromStream(std::move(stream));
+                if (!codec) {
+                    return nullptr;
+                }
+                SkCodec* codecPtr = codec.get();
+                return std::make_unique<FrameDecoder>(this, codecPtr, std::move(codec));
+            });
 }
 
-SkAnimCodecPlayer::~SkAnimCodecPlayer() {}
+SkAnimCodecPlayer::~SkAnimCodecPlayer() = default;
 
 SkISize SkAnimCodecPlayer::dimensions() const {
     if (!fCodec) {
-        auto image = fImages.front();
-        return image ? image->dimensions() : SkISize::MakeEmpty();
+        return fStaticImage ? fStaticImage->dimensions() : SkISize::MakeEmpty();
     }
     if (SkEncodedOriginSwapsWidthHeight(fCodec->getOrigin())) {
         return { fImageInfo.height(), fImageInfo.width() };
@@ -67,10 +106,16 @@ SkISize SkAnimCodecPlayer::dimensions() const {
 sk_sp<SkImage> SkAnimCodecPlayer::getFrameAt(int index) {
     SkASSERT((unsigned)index < fFrameInfos.size());
 
-    if (fImages[index]) {
-        return fImages[index];
+    if (!fCurrImage) {
+        fCurrImage = fFrameCache->getFrame(index);
+        fFrameCache->lookAhead(index);
     }
+    return fCurrImage;
+}
 
+sk_sp<SkImage> SkAnimCodecPlayer::decodeFrame(SkCodec* codec,
+                                              int index,
+                                              const sk_sp<SkImage>& prior) const {
     size_t rb = fImageInfo.minRowBytes();
     size_t size = fImageInfo.computeByteSize(rb);
     auto data = SkData::MakeUninitialized(size);
@@ -78,7 +123,7 @@ sk_sp<SkImage> SkAnimCodecPlayer::getFrameAt(int index) {
     SkCodec::Options opts;
     opts.fFrameIndex = index;
 
-    const auto origin = fCodec->getOrigin();
+    const auto origin = codec->getOrigin();
     const auto orientedDims = this->dimensions();
     const auto originMatrix = SkEncodedOriginToMatrix(origin, orientedDims.width(),
                                                               orientedDims.height());
@@ -91,8 +136,8 @@ sk_sp<SkImage> SkAnimCodecPlayer::getFrameAt(int index) {
         imageInfo = imageInfo.makeAlphaType(kPremul_SkAlphaType);
     }
     const int requiredFrame = fFrameInfos[index].fRequiredFrame;
-    if (requiredFrame != SkCodec::kNoFrame && fImages[requiredFrame]) {
-        auto requiredImage = fImages[requiredFrame];
+    if (requiredFrame != SkCodec::kNoFrame) {
+        SkASSERT(prior);
         auto canvas = SkCanvas::MakeRasterDirect(imageInfo, data->writable_data(), rb);
         if (origin != kDefault_SkEncodedOrigin) {
             // The required frame is stored after applying the origin. Undo that,
@@ -106,11 +151,11 @@ sk_sp<SkImage> SkAnimCodecPlayer::getFrameAt(int index) {
             SkAssertResult(originMatrix.invert(&inverse));
             canvas->concat(inverse);
         }
-        canvas->drawImage(requiredImage, 0, 0, SkSamplingOptions(), &paint);
+        canvas->drawImage(prior, 0, 0, SkSamplingOptions(), &paint);
         opts.fPriorFrame = requiredFrame;
     }
 
-    if (SkCodec::kSuccess != fCodec->getPixels(imageInfo, data->writable_data(), rb, &opts)) {
+    if (SkCodec::kSuccess != codec->getPixels(imageInfo, data->writable_data(), rb, &opts)) {
         return nullptr;
     }
 
@@ -125,15 +170,13 @@ sk_sp<SkImage> SkAnimCodecPlayer::getFrameAt(int index) {
         canvas->drawImage(image, 0, 0, SkSamplingOptions(), &paint);
         image = SkImages::RasterFromData(imageInfo, std::move(data), rb);
     }
-    return fImages[index] = image;
+    return image;
 }
 
 sk_sp<SkImage> SkAnimCodecPlayer::getFrame() {
-    SkASSERT(fTotalDuration > 0 || fImages.size() == 1);
-
     return fTotalDuration > 0
         ? this->getFrameAt(fCurrIndex)
-        : fImages.front();
+        : fStaticImage;
 }
 
 bool SkAnimCodecPlayer::seek(uint32_t msec) {
@@ -149,6 +192,9 @@ bool SkAnimCodecPlayer::seek(uint32_t msec) {
                                   });
     int prevIndex = fCurrIndex;
     fCurrIndex = lower - fFrameInfos.begin();
+    if (fCurrIndex != prevIndex) {
+        fCurrImage = nullptr;
+    }
     return fCurrIndex != prevIndex;
 }
 
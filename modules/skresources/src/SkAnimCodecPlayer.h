@@ -12,18 +12,33 @@
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkSize.h"
+#include "src/codec/SkAnimFrameCache.h"
 
 #include <cstdint>
 #include <memory>
 #include <vector>
 
+class SkExecutor;
 class SkImage;
 
+/**
+ *  Plays the frames of an animated SkCodec. Decoded frames are kept in the SkResourceCache, so
+ *  they count against its budget and may be purged; a frame that is needed again is decoded from
+ *  the closest cached frame it depends on.
+ *
+ *  If an executor is provided, the frames after the current one are decoded on it, ahead of time,
+ *  with codecs of their own. Runs of frames that start at an independent frame are decoded
+ *  concurrently.
+ */
 class SkAnimCodecPlayer {
 public:
-    SkAnimCodecPlayer(std::unique_ptr<SkCodec> codec);
+    SkAnimCodecPlayer(std::unique_ptr<SkCodec> codec,
+                      SkExecutor* lookAheadExecutor = nullptr,
+                      int lookAheadFrames = kDefaultLookAheadFrames);
     ~SkAnimCodecPlayer();
 
+    static constexpr int kDefaultLookAheadFrames = SkAnimFrameCache::kDefaultLookAheadFrames;
+
     /**
      *  Returns the current frame of the animation. This defaults to the first frame for
      *  animated codecs (i.e. msec = 0). Calling this multiple times (without calling seek())
@@ -53,15 +68,24 @@ public:
 
 
 private:
+    class FrameDecoder;
+
     std::unique_ptr<SkCodec>        fCodec;
     SkImageInfo                     fImageInfo;
     std::vector<SkCodec::FrameInfo> fFrameInfos;
-    std::vector<sk_sp<SkImage> >    fImages;
+    sk_sp<SkImage>                  fStaticImage;   // Only for single-frame images.
+    sk_sp<SkImage>                  fCurrImage;     // The image of fCurrIndex, once decoded.
     int                             fCurrIndex = 0;
     uint32_t                        fTotalDuration;
 
+    // Declared last, so its look-ahead decodes are done before the rest is destroyed.
+    std::unique_ptr<SkAnimFrameCache> fFrameCache;  // Null for single-frame images.
+
     sk_sp<SkImage> getFrameAt(int index);
+
+    // Decodes the frame with codec, on top of prior, the image of its required frame (if it has
+    // one). This may be called on any thread, with a codec that is not used concurrently.
+    sk_sp<SkImage> decodeFrame(SkCodec* codec, int index, const sk_sp<SkImage>& prior) const;
 };
 
 #endif
-
@@ -13,6 +13,7 @@
 #include "modules/skshaper/include/SkShaper.h"
 
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 
 class SkFontMgr;
@@ -33,6 +34,26 @@ SKSHAPER_API std::unique_ptr<SkShaper::ScriptRunIterator> ScriptRunIterator(cons
                                                                             SkFourByteTag script);
 
 SKSHAPER_API void PurgeCaches();
+
+/**
+ *  The HarfBuzz shapers can cache the glyphs they make for each run, so that shaping the same
+ *  text with the same font, features, language and direction again skips HarfBuzz. The cache is
+ *  shared by all HarfBuzz shapers and is off by default.
+ *
+ *  SetShapedRunCacheLimit() sets the cache's budget in bytes, evicting the least recently used
+ *  runs as needed, and returns the previous budget. A budget of 0 turns the cache off.
+ *  PurgeCaches() empties it.
+ */
+SKSHAPER_API size_t SetShapedRunCacheLimit(size_t bytes);
+SKSHAPER_API size_t GetShapedRunCacheLimit();
+
+struct ShapedRunCacheStats {
+    size_t   fBytesUsed;
+    int      fRunCount;
+    uint64_t fHits;
+    uint64_t fMisses;
+};
+SKSHAPER_API ShapedRunCacheStats GetShapedRunCacheStats();
 }  // namespace SkShapers::HB
 
 #endif
@@ -34,6 +34,7 @@
 #include "modules/skunicode/include/SkUnicode.h"
 #include "src/base/SkTDPQueue.h"
 #include "src/base/SkUTF.h"
+#include "src/core/SkChecksum.h"
 #include "src/core/SkLRUCache.h"
 
 #if !defined(SK_DISABLE_LEGACY_SKSHAPER_FUNCTIONS)
@@ -43,8 +44,11 @@
 #include <hb-ot.h>
 #include <hb.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <cstring>
+#include <limits>
 #include <memory>
 #include <type_traits>
 #include <utility>
@@ -1275,6 +1279,180 @@ static HBLockedFaceCache get_hbFace_cache() {
     return HBLockedFaceCache(gHBFaceCache, gHBFaceCacheMutex);
 }
 
+// Caches the glyphs HarfBuzz made for a run. The key holds everything the shaping depends on:
+// the font, the direction, script, language and features, and the run's text along with the
+// context around it that HarfBuzz may look at. Clusters are stored relative to the run's start.
+class ShapedRunCache {
+public:
+    struct Key {
+        const void*   fBytes;
+        size_t        fSize;
+        uint32_t      fHash;
+        sk_sp<SkData> fStorage;  // Owns fBytes for the keys in the cache.
+
+        bool operator==(const Key& that) const {
+            return fHash == that.fHash &&
+                   fSize == that.fSize &&
+                   memcmp(fBytes, that.fBytes, fSize) == 0;
+        }
+        struct Hash {
+            uint32_t operator()(const Key& key) const { return key.fHash; }
+        };
+    };
+
+    ShapedRunCache() : fRuns(std::numeric_limits<int>::max()) {}
+
+    size_t setLimit(size_t bytes) {
+        SkAutoMutexExclusive lock(fMutex);
+        size_t prev = fLimit.exchange(bytes, std::memory_order_relaxed);
+        this->purgeAsNeeded();
+        return prev;
+    }
+    size_t limit() const { return fLimit.load(std::memory_order_relaxed); }
+
+    SkShapers::HB::ShapedRunCacheStats stats() {
+        SkAutoMutexExclusive lock(fMutex);
+        return {fBytesUsed, fRuns.count(), fHits, fMisses};
+    }
+
+    void purge() {
+        SkAutoMutexExclusive lock(fMutex);
+        fRuns.reset();
+        fBytesUsed = 0;
+    }
+
+    // Sets run's glyphs and advance, and returns true, if the key is in the cache.
+    bool find(const Key& key, ShapedRun* run) {
+        SkAutoMutexExclusive lock(fMutex);
+        const Entry* entry = fRuns.find(key);
+        if (!entry) {
+            fMisses++;
+            return false;
+        }
+        fHits++;
+        const uint32_t runStart = SkToU32(run->fUtf8Range.begin());
+        run->fGlyphs.reset(new ShapedGlyph[entry->fNumGlyphs]);
+        run->fNumGlyphs = entry->fNumGlyphs;
+        run->fAdvance = entry->fAdvance;
+        for (size_t i = 0; i < entry->fNumGlyphs; i++) {
+            run->fGlyphs[i] = entry->fGlyphs[i];
+            run->fGlyphs[i].fCluster += runStart;
+        }
+        return true;
+    }
+
+    void insert(const Key& key, const ShapedRun& run) {
+        Key storedKey = key;
+        storedKey.fStorage = SkData::MakeWithCopy(key.fBytes, key.fSize);
+        storedKey.fBytes = storedKey.fStorage->data();
+
+        Entry entry;
+        entry.fGlyphs.reset(new ShapedGlyph[run.fNumGlyphs]);
+        entry.fNumGlyphs = run.fNumGlyphs;
+        entry.fAdvance = run.fAdvance;
+        entry.fBytes = sizeof(Key) + key.fSize + sizeof(Entry) +
+                       run.fNumGlyphs * sizeof(ShapedGlyph);
+        const uint32_t runStart = SkToU32(run.fUtf8Range.begin());
+        for (size_t i = 0; i < run.fNumGlyphs; i++) {
+            entry.fGlyphs[i] = run.fGlyphs[i];
+            entry.fGlyphs[i].fCluster -= runStart;
+        }
+
+        SkAutoMutexExclusive lock(fMutex);
+        if (entry.fBytes > this->limit() || fRuns.find(storedKey)) {
+            return;
+        }
+        fBytesUsed += entry.fBytes;
+        fRuns.insert(storedKey, std::move(entry));
+        this->purgeAsNeeded();
+    }
+
+private:
+    struct Entry {
+        std::unique_ptr<ShapedGlyph[]> fGlyphs;
+        size_t fNumGlyphs;
+        SkVector fAdvance;
+        size_t fBytes;
+    };
+
+    void purgeAsNeeded() SK_REQUIRES(fMutex) {
+        while (fBytesUsed > this->limit()) {
+            fBytesUsed -= fRuns.peekLRU()->fBytes;
+            fRuns.removeLRU();
+        }
+    }
+
+    SkMutex fMutex;
+    std::atomic<size_t> fLimit{0};
+    SkLRUCache<Key, Entry, Key::Hash> fRuns SK_GUARDED_BY(fMutex);
+    size_t fBytesUsed SK_GUARDED_BY(fMutex) = 0;
+    uint64_t fHits SK_GUARDED_BY(fMutex) = 0;
+    uint64_t fMisses SK_GUARDED_BY(fMutex) = 0;
+};
+static ShapedRunCache& get_shaped_run_cache() {
+    static ShapedRunCache* gShapedRunCache = new ShapedRunCache;
+    return *gShapedRunCache;
+}
+
+// HarfBuzz looks at up to 5 code points of context on either side of a run (see
+// HB_BUFFER_MAX_CONTEXT_LENGTH), each of which is at most 4 bytes of utf8.
+static constexpr size_t kMaxContextBytes = 5 * 4;
+
+template <typename T>
+static void append_key(TArray<char>* bytes, const T& value) {
+    static_assert(std::is_trivially_copyable<T>::value);
+    bytes->push_back_n(sizeof(T), reinterpret_cast<const char*>(&value));
+}
+
+static ShapedRunCache::Key make_shaped_run_key(TArray<char>* bytes,
+                                               const char* utf8, size_t utf8Bytes,
+                                               const char* utf8Start, const char* utf8End,
+                                               const SkFont& font,
+                                               hb_direction_t direction,
+                                               hb_script_t script,
+                                               hb_language_t language,
+                                               SkSpan<const hb_feature_t> features) {
+    append_key(bytes, font.getTypeface()->uniqueID());
+    append_key(bytes, font.getSize());
+    append_key(bytes, font.getScaleX());
+    append_key(bytes, font.getSkewX());
+    append_key(bytes, font.getEdging());
+    append_key(bytes, font.getHinting());
+    const uint8_t fontFlags = (font.isForceAutoHinting() ? 1 << 0 : 0) |
+                              (font.isEmbeddedBitmaps()  ? 1 << 1 : 0) |
+                              (font.isSubpixel()         ? 1 << 2 : 0) |
+                              (font.isLinearMetrics()    ? 1 << 3 : 0) |
+                              (font.isEmbolden()         ? 1 << 4 : 0) |
+                              (font.isBaselineSnap()     ? 1 << 5 : 0);
+    append_key(bytes, fontFlags);
+    append_key(bytes, direction);
+    append_key(bytes, script);
+    // Languages are interned by HarfBuzz, so their pointers identify them.
+    append_key(bytes, reinterpret_cast<uintptr_t>(language));
+
+    // Feature ranges are in clusters, which only exist within the run, so clamp them to the run
+    // and make them relative to it.
+    const size_t runStart = utf8Start - utf8,
+                 runEnd   = utf8End   - utf8;
+    append_key(bytes, SkToU32(features.size()));
+    for (const hb_feature_t& feature : features) {
+        append_key(bytes, feature.tag);
+        append_key(bytes, feature.value);
+        append_key(bytes, SkToU32(std::clamp<size_t>(feature.start, runStart, runEnd) - runStart));
+        append_key(bytes, SkToU32(std::clamp<size_t>(feature.end,   runStart, runEnd) - runStart));
+    }
+
+    const size_t preContext  = std::min(runStart, kMaxContextBytes),
+                 postContext = std::min(utf8Bytes - runEnd, kMaxContextBytes);
+    append_key(bytes, SkToU32(preContext));
+    append_key(bytes, SkToU32(runEnd - runStart));
+    bytes->push_back_n(SkToInt(preContext + (runEnd - runStart) + postContext),
+                       utf8Start - preContext);
+
+    const uint32_t hash = SkChecksum::Hash32(bytes->data(), bytes->size());
+    return {bytes->data(), SkToSizeT(bytes->size()), hash, nullptr};
+}
+
 ShapedRun ShaperHarfBuzz::shape(char const * const utf8,
                                   size_t const utf8Bytes,
                                   char const * const utf8Start,
@@ -1289,6 +1467,47 @@ ShapedRun ShaperHarfBuzz::shape(char const * const utf8,
     ShapedRun run(RunHandler::Range(utf8Start - utf8, utf8runLength),
                   font.currentFont(), bidi.currentLevel(), nullptr, 0);
 
+    hb_direction_t direction = is_LTR(bidi.currentLevel()) ? HB_DIRECTION_LTR:HB_DIRECTION_RTL;
+    hb_script_t hbScript = hb_script_from_iso15924_tag((hb_tag_t)script.currentScript());
+    // Buffers with HB_LANGUAGE_INVALID race since hb_language_get_default is not thread safe.
+    // The user must provide a language, but may provide data hb_language_from_string cannot use.
+    // Use "und" for the undefined language in this case (RFC5646 4.1 5).
+    hb_language_t hbLanguage = hb_language_from_string(language.currentLanguage(), -1);
+    if (hbLanguage == HB_LANGUAGE_INVALID) {
+        hbLanguage = fUndefinedLanguage;
+    }
+
+    STArray<32, hb_feature_t> hbFeatures;
+    for (const auto& feature : SkSpan(features, featuresSize)) {
+        if (feature.end < SkTo<size_t>(utf8Start - utf8) ||
+                          SkTo<size_t>(utf8End   - utf8)  <= feature.start)
+        {
+            continue;
+        }
+        if (feature.start <= SkTo<size_t>(utf8Start - utf8) &&
+                             SkTo<size_t>(utf8End   - utf8) <= feature.end)
+        {
+            hbFeatures.push_back({ (hb_tag_t)feature.tag, feature.value,
+                                   HB_FEATURE_GLOBAL_START, HB_FEATURE_GLOBAL_END});
+        } else {
+            hbFeatures.push_back({ (hb_tag_t)feature.tag, feature.value,
+                                   SkTo<unsigned>(feature.start), SkTo<unsigned>(feature.end)});
+        }
+    }
+
+    ShapedRunCache& runCache = get_shaped_run_cache();
+    const bool useRunCache = runCache.limit() > 0;
+    STArray<256, char> runKeyBytes;
+    ShapedRunCache::Key runKey = {};
+    if (useRunCache) {
+        runKey = make_shaped_run_key(&runKeyBytes, utf8, utf8Bytes, utf8Start, utf8End,
+                                     font.currentFont(), direction, hbScript, hbLanguage,
+                                     hbFeatures);
+        if (runCache.find(runKey, &run)) {
+            return run;
+        }
+    }
+
     hb_buffer_t* buffer = fBuffer.get();
     SkAutoTCallVProc<hb_buffer_t, hb_buffer_clear_contents> autoClearBuffer(buffer);
     hb_buffer_set_content_type(buffer, HB_BUFFER_CONTENT_TYPE_UNICODE);
@@ -1313,16 +1532,8 @@ ShapedRun ShaperHarfBuzz::shape(char const * const utf8,
     // Add postcontext.
     hb_buffer_add_utf8(buffer, utf8Current, utf8 + utf8Bytes - utf8Current, 0, 0);
 
-    hb_direction_t direction = is_LTR(bidi.currentLevel()) ? HB_DIRECTION_LTR:HB_DIRECTION_RTL;
     hb_buffer_set_direction(buffer, direction);
-    hb_buffer_set_script(buffer, hb_script_from_iso15924_tag((hb_tag_t)script.currentScript()));
-    // Buffers with HB_LANGUAGE_INVALID race since hb_language_get_default is not thread safe.
-    // The user must provide a language, but may provide data hb_language_from_string cannot use.
-    // Use "und" for the undefined language in this case (RFC5646 4.1 5).
-    hb_language_t hbLanguage = hb_language_from_string(language.currentLanguage(), -1);
-    if (hbLanguage == HB_LANGUAGE_INVALID) {
-        hbLanguage = fUndefinedLanguage;
-    }
+    hb_buffer_set_script(buffer, hbScript);
     hb_buffer_set_language(buffer, hbLanguage);
     hb_buffer_guess_segment_properties(buffer);
 
@@ -1346,24 +1557,6 @@ ShapedRun ShaperHarfBuzz::shape(char const * const utf8,
         return run;
     }
 
-    STArray<32, hb_feature_t> hbFeatures;
-    for (const auto& feature : SkSpan(features, featuresSize)) {
-        if (feature.end < SkTo<size_t>(utf8Start - utf8) ||
-                          SkTo<size_t>(utf8End   - utf8)  <= feature.start)
-        {
-            continue;
-        }
-        if (feature.start <= SkTo<size_t>(utf8Start - utf8) &&
-                             SkTo<size_t>(utf8End   - utf8) <= feature.end)
-        {
-            hbFeatures.push_back({ (hb_tag_t)feature.tag, feature.value,
-                                   HB_FEATURE_GLOBAL_START, HB_FEATURE_GLOBAL_END});
-        } else {
-            hbFeatures.push_back({ (hb_tag_t)feature.tag, feature.value,
-                                   SkTo<unsigned>(feature.start), SkTo<unsigned>(feature.end)});
-        }
-    }
-
     hb_shape(hbFont.get(), buffer, hbFeatures.data(), hbFeatures.size());
     unsigned len = hb_buffer_get_length(buffer);
     if (len == 0) {
@@ -1415,6 +1608,9 @@ ShapedRun ShaperHarfBuzz::shape(char const * const utf8,
     }
     run.fAdvance = runAdvance;
 
+    if (useRunCache) {
+        runCache.insert(runKey, run);
+    }
     return run;
 }
 }  // namespace
@@ -1534,5 +1730,18 @@ std::unique_ptr<SkShaper::ScriptRunIterator> ScriptRunIterator(const char* utf8,
 void PurgeCaches() {
     HBLockedFaceCache cache = get_hbFace_cache();
     cache.reset();
+    get_shaped_run_cache().purge();
+}
+
+size_t SetShapedRunCacheLimit(size_t bytes) {
+    return get_shaped_run_cache().setLimit(bytes);
+}
+
+size_t GetShapedRunCacheLimit() {
+    return get_shaped_run_cache().limit();
+}
+
+ShapedRunCacheStats GetShapedRunCacheStats() {
+    return get_shaped_run_cache().stats();
 }
 }  // namespace SkShapers::HB
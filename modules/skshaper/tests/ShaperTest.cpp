@@ -23,6 +23,7 @@
 #include <cinttypes>
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 #if defined(SK_UNICODE_ICU_IMPLEMENTATION)
 #include "modules/skunicode/include/SkUnicode_icu.h"
@@ -226,6 +227,37 @@ void cluster_test(skiatest::Reporter* reporter, const char* resource) {
     shaper_test(reporter, resource, data.get());
 }
 
+// Collects the glyphs, positions and clusters of every run.
+struct CollectingRunHandler final : public SkShaper::RunHandler {
+    std::vector<SkGlyphID> fGlyphs;
+    std::vector<SkPoint> fPositions;
+    std::vector<uint32_t> fClusters;
+    size_t fRunStart = 0;
+
+    void beginLine() override {}
+    void runInfo(const RunInfo&) override {}
+    void commitRunInfo() override {}
+    Buffer runBuffer(const RunInfo& info) override {
+        fRunStart = fGlyphs.size();
+        fGlyphs.resize(fRunStart + info.glyphCount);
+        fPositions.resize(fRunStart + info.glyphCount);
+        fClusters.resize(fRunStart + info.glyphCount);
+        return {fGlyphs.data() + fRunStart,
+                fPositions.data() + fRunStart,
+                nullptr,
+                fClusters.data() + fRunStart,
+                {0, 0}};
+    }
+    void commitRunBuffer(const RunInfo&) override {}
+    void commitLine() override {}
+
+    bool operator==(const CollectingRunHandler& that) const {
+        return fGlyphs == that.fGlyphs &&
+               fPositions == that.fPositions &&
+               fClusters == that.fClusters;
+    }
+};
+
 #endif  // defined(SK_SHAPER_HARFBUZZ_AVAILABLE) && defined(SK_SHAPER_UNICODE_AVAILABLE)
 
 }  // namespace
@@ -271,4 +303,74 @@ SHAPER_TEST(taitham)
 SHAPER_TEST(tamil)
 #undef SHAPER_TEST
 
+DEF_SERIAL_TEST(Shaper_shaped_run_cache, r) {
+    auto unicode = get_unicode();
+    if (!unicode) {
+        ERRORF(r, "Could not create unicode.");
+        return;
+    }
+    auto shaper = SkShapers::HB::ShaperDrivenWrapper(unicode, SkFontMgr::RefEmpty());
+    if (!shaper) {
+        ERRORF(r, "Could not create shaper.");
+        return;
+    }
+    const SkFont font = ToolUtils::DefaultFont();
+
+    for (const char* resource : {"text/english.txt", "text/arabic.txt", "text/devanagari.txt"}) {
+        skiatest::ReporterContext context(r, resource);
+        auto data = GetResourceAsData(resource);
+        if (!data) {
+            ERRORF(r, "Could not get resource %s.", resource);
+            return;
+        }
+        auto shape = [&](const SkFont& runFont) {
+            const char* utf8 = (const char*)data->data();
+            const size_t utf8Bytes = data->size();
+            auto bidi = SkShapers::unicode::BidiRunIterator(
+                    unicode, utf8, utf8Bytes, SkBidiIterator::kLTR);
+            auto language = SkShaper::MakeStdLanguageRunIterator(utf8, utf8Bytes);
+            auto script = SkShapers::HB::ScriptRunIterator(utf8, utf8Bytes);
+            auto fontRuns = SkShaper::MakeFontMgrRunIterator(
+                    utf8, utf8Bytes, runFont, SkFontMgr::RefEmpty());
+            CollectingRunHandler handler;
+            shaper->shape(utf8, utf8Bytes, *fontRuns, *bidi, *script, *language, nullptr, 0,
+                          400, &handler);
+            return handler;
+        };
+
+        SkShapers::HB::PurgeCaches();
+        const CollectingRunHandler uncached = shape(font);
+
+        // The first shaping fills the cache, and the second one finds every run in it.
+        const size_t prevLimit = SkShapers::HB::SetShapedRunCacheLimit(1 << 20);
+        const CollectingRunHandler first = shape(font);
+        const SkShapers::HB::ShapedRunCacheStats filled = SkShapers::HB::GetShapedRunCacheStats();
+        const CollectingRunHandler second = shape(font);
+        const SkShapers::HB::ShapedRunCacheStats found = SkShapers::HB::GetShapedRunCacheStats();
+        REPORTER_ASSERT(r, first == uncached);
+        REPORTER_ASSERT(r, second == uncached);
+        REPORTER_ASSERT(r, filled.fRunCount > 0);
+        REPORTER_ASSERT(r, filled.fBytesUsed <= (1 << 20));
+        REPORTER_ASSERT(r, found.fMisses == filled.fMisses);
+        REPORTER_ASSERT(r, found.fHits > filled.fHits);
+
+        // A different size is a different key.
+        SkFont bigger = font;
+        bigger.setSize(font.getSize() * 2);
+        const CollectingRunHandler biggerCached = shape(bigger);
+        REPORTER_ASSERT(r, SkShapers::HB::GetShapedRunCacheStats().fMisses > found.fMisses);
+
+        // A tiny budget keeps nothing, and the results are still right.
+        SkShapers::HB::SetShapedRunCacheLimit(1);
+        REPORTER_ASSERT(r, SkShapers::HB::GetShapedRunCacheStats().fRunCount == 0);
+        REPORTER_ASSERT(r, shape(font) == uncached);
+
+        SkShapers::HB::SetShapedRunCacheLimit(0);
+        REPORTER_ASSERT(r, shape(bigger) == biggerCached);
+
+        SkShapers::HB::SetShapedRunCacheLimit(prevLimit);
+        SkShapers::HB::PurgeCaches();
+    }
+}
+
 #endif  // #if defined(SK_SHAPER_HARFBUZZ_AVAILABLE) && defined(SK_SHAPER_UNICODE_AVAILABLE)
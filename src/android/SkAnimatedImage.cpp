@@ -10,9 +10,12 @@
 #include "include/codec/SkCodec.h"
 #include "include/codec/SkEncodedImageFormat.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkImage.h"
 #include "include/core/SkPicture.h"
 #include "include/core/SkPictureRecorder.h"
 #include "include/core/SkPixelRef.h"
+#include "include/core/SkStream.h"
+#include "src/codec/SkAnimFrameCache.h"
 #include "src/codec/SkCodecPriv.h"
 #include "src/codec/SkPixmapUtilsPriv.h"
 #include "src/core/SkImagePriv.h"
@@ -20,6 +23,60 @@
 #include <limits.h>
 #include <utility>
 
+namespace {
+// Decodes frames for SkAnimFrameCache, at the sampled size that SkAnimatedImage decodes to.
+class AndroidFrameDecoder final : public SkAnimFrameCache::Decoder {
+public:
+    AndroidFrameDecoder(SkAndroidCodec* codec, std::unique_ptr<SkAndroidCodec> ownedCodec,
+                        const SkImageInfo& decodeInfo, int sampleSize)
+        : fCodec(codec)
+        , fOwnedCodec(std::move(ownedCodec))
+        , fDecodeInfo(decodeInfo)
+        , fSampleSize(sampleSize) {}
+
+    sk_sp<SkImage> decodeFrame(int index, const sk_sp<SkImage>& prior) override {
+        SkCodec::FrameInfo frameInfo;
+        if (!fCodec->codec()->getFrameInfo(index, &frameInfo)) {
+            return nullptr;
+        }
+
+        auto alphaType = kOpaque_SkAlphaType == frameInfo.fAlphaType ?
+                         kOpaque_SkAlphaType : kPremul_SkAlphaType;
+        SkBitmap bitmap;
+        if (!bitmap.tryAllocPixels(fDecodeInfo.makeAlphaType(alphaType))) {
+            SkCodecPrintf("Failed to allocate pixels for frame\n");
+            return nullptr;
+        }
+
+        SkAndroidCodec::AndroidOptions options;
+        options.fSampleSize = fSampleSize;
+        options.fFrameIndex = index;
+        if (frameInfo.fRequiredFrame != SkCodec::kNoFrame) {
+            SkASSERT(prior);
+            if (!prior->readPixels(nullptr, bitmap.pixmap(), 0, 0)) {
+                return nullptr;
+            }
+            options.fPriorFrame = frameInfo.fRequiredFrame;
+        }
+
+        auto result = fCodec->getAndroidPixels(bitmap.info(), bitmap.getPixels(),
+                                               bitmap.rowBytes(), &options);
+        if (result != SkCodec::kSuccess) {
+            SkCodecPrintf("%s, frame %i\n", SkCodec::ResultToString(result), index);
+            return nullptr;
+        }
+        bitmap.setImmutable();
+        return bitmap.asImage();
+    }
+
+private:
+    SkAndroidCodec*                 fCodec;
+    std::unique_ptr<SkAndroidCodec> fOwnedCodec;
+    const SkImageInfo               fDecodeInfo;
+    const int                       fSampleSize;
+};
+}  // namespace
+
 sk_sp<SkAnimatedImage> SkAnimatedImage::Make(std::unique_ptr<SkAndroidCodec> codec,
         const SkImageInfo& requestedInfo, SkIRect cropRect, sk_sp<SkPicture> postProcess) {
     if (!codec) {
@@ -31,7 +88,30 @@ sk_sp<SkAnimatedImage> SkAnimatedImage::Make(std::unique_ptr<SkAndroidCodec> cod
     }
 
     auto image = sk_sp<SkAnimatedImage>(new SkAnimatedImage(std::move(codec), requestedInfo,
-                cropRect, std::move(postProcess)));
+                cropRect, std::move(postProcess), /*cacheFrames=*/false, nullptr, 0));
+    if (!image->fDisplayFrame.fBitmap.getPixels()) {
+        // tryAllocPixels failed.
+        return nullptr;
+    }
+
+    return image;
+}
+
+sk_sp<SkAnimatedImage> SkAnimatedImage::Make(std::unique_ptr<SkAndroidCodec> codec,
+        const SkImageInfo& requestedInfo, SkIRect cropRect, sk_sp<SkPicture> postProcess,
+        SkExecutor* lookAheadExecutor, int lookAheadFrames) {
+    if (!codec) {
+        return nullptr;
+    }
+
+    if (!requestedInfo.bounds().contains(cropRect)) {
+        return nullptr;
+    }
+
+    const bool cacheFrames = codec->getEncodedFormat() != SkEncodedImageFormat::kHEIF;
+    auto image = sk_sp<SkAnimatedImage>(new SkAnimatedImage(std::move(codec), requestedInfo,
+                cropRect, std::move(postProcess), cacheFrames, lookAheadExecutor,
+                lookAheadFrames));
     if (!image->fDisplayFrame.fBitmap.getPixels()) {
         // tryAllocPixels failed.
         return nullptr;
@@ -55,7 +135,8 @@ sk_sp<SkAnimatedImage> SkAnimatedImage::Make(std::unique_ptr<SkAndroidCodec> cod
 }
 
 SkAnimatedImage::SkAnimatedImage(std::unique_ptr<SkAndroidCodec> codec,
-        const SkImageInfo& requestedInfo, SkIRect cropRect, sk_sp<SkPicture> postProcess)
+        const SkImageInfo& requestedInfo, SkIRect cropRect, sk_sp<SkPicture> postProcess,
+        bool cacheFrames, SkExecutor* lookAheadExecutor, int lookAheadFrames)
     : fCodec(std::move(codec))
     , fDecodeInfo(requestedInfo)
     , fCropRect(cropRect)
@@ -90,7 +171,29 @@ SkAnimatedImage::SkAnimatedImage(std::unique_ptr<SkAndroidCodec> codec,
     fSampleSize = fCodec->computeSampleSize(&decodeSize);
     fDecodeInfo = fDecodeInfo.makeDimensions(decodeSize);
 
-    if (!fDecodingFrame.fBitmap.tryAllocPixels(fDecodeInfo)) {
+    if (cacheFrames && fFrameCount > 1) {
+        // The look-ahead codecs are made from a duplicate of the encoded stream, because codecs
+        // are not thread-safe.
+        const SkImageInfo decodeInfo = fDecodeInfo;
+        const int sampleSize = fSampleSize;
+        fFrameCache = std::make_unique<SkAnimFrameCache>(
+                std::make_unique<AndroidFrameDecoder>(fCodec.get(), nullptr, decodeInfo,
+                                                      sampleSize),
+                fCodec->codec()->getFrameInfo(),
+                lookAheadExecutor ? fCodec->codec()->getEncodedData() : nullptr,
+                lookAheadExecutor,
+                lookAheadFrames,
+                [decodeInfo, sampleSize](std::unique_ptr<SkStream> stream)
+                        -> std::unique_ptr<SkAnimFrameCache::Decoder> {
+                    auto codec = SkAndroidCodec::MakeFromStream(std::move(stream));
+                    if (!codec) {
+                        return nullptr;
+                    }
+                    SkAndroidCodec* codecPtr = codec.get();
+                    return std::make_unique<AndroidFrameDecoder>(codecPtr, std::move(codec),
+                                                                 decodeInfo, sampleSize);
+                });
+    } else if (!fDecodingFrame.fBitmap.tryAllocPixels(fDecodeInfo)) {
         return;
     }
 
@@ -228,6 +331,16 @@ int SkAnimatedImage::decodeNextFrame() {
         return fCurrentFrameDuration;
     }
 
+    if (fFrameCache) {
+        if (!this->showCachedFrame(frameToDecode, frameInfo.fDisposalMethod)) {
+            return this->finish();
+        }
+        if (animationEnded) {
+            return this->finish();
+        }
+        return fCurrentFrameDuration;
+    }
+
     for (Frame* frame : { &fRestoreFrame, &fDecodingFrame }) {
         if (frameToDecode == frame->fIndex) {
             using std::swap;
@@ -333,6 +446,26 @@ int SkAnimatedImage::decodeNextFrame() {
     return fCurrentFrameDuration;
 }
 
+bool SkAnimatedImage::showCachedFrame(int frameToDecode,
+                                      SkCodecAnimation::DisposalMethod disposalMethod) {
+    sk_sp<SkImage> image = fFrameCache->getFrame(frameToDecode);
+    if (!image) {
+        return false;
+    }
+    fFrameCache->lookAhead(frameToDecode);
+
+    // The cached image is immutable, so the display frame shares its pixels. It is never decoded
+    // into.
+    SkBitmap bitmap;
+    if (!image->asLegacyBitmap(&bitmap)) {
+        return false;
+    }
+    fDisplayFrame.fBitmap = std::move(bitmap);
+    fDisplayFrame.fIndex = frameToDecode;
+    fDisplayFrame.fDisposalMethod = disposalMethod;
+    return true;
+}
+
 void SkAnimatedImage::onDraw(SkCanvas* canvas) {
     auto image = this->getCurrentFrameSimple();
 
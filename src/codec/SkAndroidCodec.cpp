@@ -12,12 +12,15 @@
 #include "include/core/SkAlphaType.h"
 #include "include/core/SkColorType.h"
 #include "include/core/SkData.h"
+#include "include/core/SkPixmap.h"
 #include "include/core/SkRect.h"
+#include "include/core/SkSamplingOptions.h"
 #include "include/core/SkStream.h"
 #include "modules/skcms/skcms.h"
 #include "src/codec/SkAndroidCodecAdapter.h"
 #include "src/codec/SkCodecPriv.h"
 #include "src/codec/SkSampledCodec.h"
+#include "src/core/SkAutoPixmapStorage.h"
 
 #include <algorithm>
 #include <cstdint>
@@ -516,6 +519,16 @@ SkCodec::Result SkAndroidCodec::getAndroidPixels(const SkImageInfo& requestInfo,
         }
     }
 
+    if (auto result = this->handleFrameIndex(requestInfo, requestPixels, requestRowBytes,
+            *options); result != SkCodec::kSuccess) {
+        return result;
+    }
+
+    return this->onGetAndroidPixels(requestInfo, requestPixels, requestRowBytes, *options);
+}
+
+SkCodec::Result SkAndroidCodec::handleFrameIndex(const SkImageInfo& requestInfo,
+        void* requestPixels, size_t requestRowBytes, const AndroidOptions& options) {
     // We may need to have handleFrameIndex recursively call this method
     // to resolve one frame depending on another. The recursion stops
     // when we find a frame which does not require an earlier frame
@@ -528,12 +541,8 @@ SkCodec::Result SkAndroidCodec::getAndroidPixels(const SkImageInfo& requestInfo,
         prevFrameOptions.fFrameIndex = requiredFrame;
         return this->getAndroidPixels(info, pixels, rowBytes, &prevFrameOptions);
     };
-    if (auto result = fCodec->handleFrameIndex(requestInfo, requestPixels, requestRowBytes,
-            *options, getPixelsFn); result != SkCodec::kSuccess) {
-        return result;
-    }
-
-    return this->onGetAndroidPixels(requestInfo, requestPixels, requestRowBytes, *options);
+    return fCodec->handleFrameIndex(requestInfo, requestPixels, requestRowBytes, options,
+                                    getPixelsFn);
 }
 
 SkCodec::Result SkAndroidCodec::getAndroidPixels(const SkImageInfo& info, void* pixels,
@@ -541,6 +550,136 @@ SkCodec::Result SkAndroidCodec::getAndroidPixels(const SkImageInfo& info, void*
     return this->getAndroidPixels(info, pixels, rowBytes, nullptr);
 }
 
+// Returns the smallest rect that covers subset, of an image of size from, in the image scaled to
+// size to.
+static SkIRect scale_subset(const SkIRect& subset, SkISize from, SkISize to) {
+    auto scale_down = [](int x, int to, int from) { return (int)((int64_t)x * to / from); };
+    auto scale_up = [](int x, int to, int from) {
+        return (int)(((int64_t)x * to + from - 1) / from);
+    };
+    return SkIRect::MakeLTRB(scale_down(subset.left(), to.width(), from.width()),
+                             scale_down(subset.top(), to.height(), from.height()),
+                             scale_up(subset.right(), to.width(), from.width()),
+                             scale_up(subset.bottom(), to.height(), from.height()));
+}
+
+SkCodec::Result SkAndroidCodec::decodeScaledSubset(const SkPixmap& dst,
+                                                   SkISize scaledSize,
+                                                   const SkIRect& scaledSubset) {
+    // Once fCodec has been given a callback to decode prior frames, as getAndroidPixels does, it
+    // leaves rewinding and setting up its color transform to the caller.
+    const SkImageInfo scaledInfo = dst.info().makeDimensions(scaledSize);
+    if (fCodec->fUsingCallbackForHandleFrameIndex) {
+        if (!fCodec->rewindIfNeeded()) {
+            return SkCodec::kCouldNotRewind;
+        }
+        const SkEncodedInfo& encodedInfo = fCodec->getEncodedInfo();
+        if (!fCodec->initializeColorXform(scaledInfo, encodedInfo.alpha(), encodedInfo.opaque())) {
+            return SkCodec::kInvalidConversion;
+        }
+    }
+    if (scaledSubset == SkIRect::MakeSize(scaledSize)) {
+        return fCodec->getPixels(scaledInfo, dst.writable_addr(), dst.rowBytes());
+    }
+
+    // Decode the columns of the subset, skipping the rows above it and stopping after its last
+    // row.
+    SkCodec::Options options;
+    const SkIRect columns = SkIRect::MakeLTRB(
+            scaledSubset.left(), 0, scaledSubset.right(), scaledSize.height());
+    options.fSubset = &columns;
+    const SkCodec::Result result = fCodec->startScanlineDecode(scaledInfo, &options);
+    if (result != SkCodec::kSuccess) {
+        return result;
+    }
+    if (fCodec->getScanlineOrder() != SkCodec::kTopDown_SkScanlineOrder) {
+        return SkCodec::kUnimplemented;
+    }
+    if (!fCodec->skipScanlines(scaledSubset.top())) {
+        fCodec->fillIncompleteImage(dst.info(), dst.writable_addr(), dst.rowBytes(),
+                                    SkCodec::kNo_ZeroInitialized, dst.height(), 0);
+        return SkCodec::kIncompleteInput;
+    }
+    if (fCodec->getScanlines(dst.writable_addr(), dst.height(), dst.rowBytes()) != dst.height()) {
+        return SkCodec::kIncompleteInput;
+    }
+    return SkCodec::kSuccess;
+}
+
+SkCodec::Result SkAndroidCodec::getThumbnail(const SkPixmap& dst,
+                                             const SkIRect* desiredSubset,
+                                             const SkSamplingOptions& sampling) {
+    if (!dst.addr() || dst.width() <= 0 || dst.height() <= 0) {
+        return SkCodec::kInvalidParameters;
+    }
+    SkIRect subset = desiredSubset ? *desiredSubset : SkIRect::MakeSize(fCodec->dimensions());
+    if (!this->getSupportedSubset(&subset)) {
+        return SkCodec::kInvalidParameters;
+    }
+
+    // Find the smallest scale the codec decodes to natively at which the subset still covers
+    // dst, trying each eighth, as JPEG's DCT scaling does.
+    const SkISize size = fCodec->dimensions();
+    SkISize scaledSize = size;
+    SkIRect scaledSubset = subset;
+    for (int num = 1; num < 8; ++num) {
+        const SkISize candidate = fCodec->getScaledDimensions(num / 8.0f);
+        const SkIRect candidateSubset = scale_subset(subset, size, candidate);
+        if (candidate != size && candidateSubset.width() >= dst.width() &&
+            candidateSubset.height() >= dst.height()) {
+            scaledSize = candidate;
+            scaledSubset = candidateSubset;
+            break;
+        }
+    }
+
+    // Decode straight into dst if no resampling is needed.
+    SkAutoPixmapStorage storage;
+    SkPixmap decoded = dst;
+    if (scaledSubset.size() != dst.dimensions()) {
+        if (!storage.tryAlloc(dst.info().makeDimensions(scaledSubset.size()))) {
+            return SkCodec::kInternalError;
+        }
+        decoded = storage;
+    }
+
+    SkCodec::Result result = SkCodec::kUnimplemented;
+    if (scaledSize != size) {
+        result = this->decodeScaledSubset(decoded, scaledSize, scaledSubset);
+    }
+    if (result == SkCodec::kUnimplemented || result == SkCodec::kInvalidScale) {
+        // Sample the subset instead, by the largest sample size that still covers dst.
+        int sampleSize = std::max(1, std::min(subset.width() / dst.width(),
+                                              subset.height() / dst.height()));
+        SkISize sampledSize = this->getSampledSubsetDimensions(sampleSize, subset);
+        while (sampleSize > 1 &&
+               (sampledSize.width() < dst.width() || sampledSize.height() < dst.height())) {
+            sampledSize = this->getSampledSubsetDimensions(--sampleSize, subset);
+        }
+        if (sampledSize != decoded.dimensions()) {
+            if (!storage.tryAlloc(dst.info().makeDimensions(sampledSize))) {
+                return SkCodec::kInternalError;
+            }
+            decoded = storage;
+        }
+        AndroidOptions options;
+        options.fSubset = &subset;
+        options.fSampleSize = sampleSize;
+        result = this->getAndroidPixels(
+                decoded.info(), decoded.writable_addr(), decoded.rowBytes(), &options);
+    }
+
+    // Incomplete images are filled, and still resampled.
+    if (result != SkCodec::kSuccess && result != SkCodec::kIncompleteInput &&
+        result != SkCodec::kErrorInInput) {
+        return result;
+    }
+    if (decoded.addr() != dst.addr() && !decoded.scalePixels(dst, sampling)) {
+        return SkCodec::kInternalError;
+    }
+    return result;
+}
+
 bool SkAndroidCodec::getAndroidGainmap(SkGainmapInfo* info,
                                        std::unique_ptr<SkStream>* outGainmapImageStream) {
     return fCodec->onGetGainmapInfo(info, outGainmapImageStream);
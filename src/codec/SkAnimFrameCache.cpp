@@ -0,0 +1,257 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/codec/SkAnimFrameCache.h"
+
+#include "include/core/SkImage.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkStream.h"
+#include "include/core/SkTypes.h"
+#include "include/private/base/SkTo.h"
+#include "src/core/SkNextID.h"
+#include "src/core/SkResourceCache.h"
+#include "src/core/SkTaskGroup.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+static unsigned gAnimFrameKeyNamespaceLabel;
+
+uint64_t make_shared_id(uint32_t cacheID) {
+    uint64_t sharedID = SkSetFourByteTag('a', 'n', 'i', 'm');
+    return (sharedID << 32) | cacheID;
+}
+
+struct AnimFrameKey : public SkResourceCache::Key {
+    AnimFrameKey(uint32_t cacheID, int frameIndex)
+        : fCacheID(cacheID)
+        , fFrameIndex(frameIndex)
+    {
+        this->init(&gAnimFrameKeyNamespaceLabel, make_shared_id(cacheID),
+                   sizeof(fCacheID) + sizeof(fFrameIndex));
+    }
+
+    uint32_t fCacheID;
+    int32_t  fFrameIndex;
+};
+
+struct AnimFrameRec : public SkResourceCache::Rec {
+    AnimFrameRec(const AnimFrameKey& key, sk_sp<SkImage> image)
+        : fKey(key)
+        , fImage(std::move(image))
+    {}
+
+    AnimFrameKey   fKey;
+    sk_sp<SkImage> fImage;
+
+    const Key& getKey() const override { return fKey; }
+    size_t bytesUsed() const override {
+        return sizeof(*this) + fImage->imageInfo().computeMinByteSize();
+    }
+    const char* getCategory() const override { return "anim-frame"; }
+
+    static bool Visitor(const SkResourceCache::Rec& baseRec, void* contextData) {
+        const AnimFrameRec& rec = static_cast<const AnimFrameRec&>(baseRec);
+        *static_cast<sk_sp<SkImage>*>(contextData) = rec.fImage;
+        return true;
+    }
+};
+}  // namespace
+
+SkAnimFrameCache::SkAnimFrameCache(std::unique_ptr<Decoder> decoder,
+                                   const std::vector<SkCodec::FrameInfo>& frameInfos,
+                                   std::unique_ptr<SkStream> encodedData,
+                                   SkExecutor* lookAheadExecutor,
+                                   int lookAheadFrames,
+                                   DecoderFactory lookAheadDecoderFactory)
+        : fDecoder(std::move(decoder))
+        , fUniqueID(SkNextID::ImageID())
+        , fLookAheadFrames(lookAheadFrames)
+        , fDecoderFactory(std::move(lookAheadDecoderFactory)) {
+    for (const SkCodec::FrameInfo& frameInfo : frameInfos) {
+        fRequiredFrames.push_back(frameInfo.fRequiredFrame);
+    }
+
+    if (encodedData && lookAheadExecutor && fDecoderFactory && fLookAheadFrames > 0 &&
+        fRequiredFrames.size() > 1) {
+        SkAutoMutexExclusive scheduledLock(fScheduledMutex);
+        SkAutoMutexExclusive poolLock(fDecoderPoolMutex);
+        fEncodedData = std::move(encodedData);
+        fScheduled.resize(fRequiredFrames.size());
+        fLookAheadTasks = std::make_unique<SkTaskGroup>(*lookAheadExecutor);
+    }
+}
+
+SkAnimFrameCache::~SkAnimFrameCache() {
+    if (fLookAheadTasks) {
+        fCancelled = true;
+        fLookAheadTasks->wait();
+    }
+    SkResourceCache::PostPurgeSharedID(make_shared_id(fUniqueID));
+}
+
+sk_sp<SkImage> SkAnimFrameCache::getFrame(int index) {
+    SkASSERT((unsigned)index < fRequiredFrames.size());
+    // The look-ahead decodes skip the frames before this one, but not this one.
+    fLookAheadFrom = index;
+    return this->findOrDecodeFrame(fDecoder.get(), index, /*wait=*/true);
+}
+
+sk_sp<SkImage> SkAnimFrameCache::findFrame(int index) const {
+    sk_sp<SkImage> image;
+    SkResourceCache::Find(AnimFrameKey(fUniqueID, index), AnimFrameRec::Visitor, &image);
+    return image;
+}
+
+sk_sp<SkImage> SkAnimFrameCache::findOrDecodeFrame(Decoder* decoder, int index, bool wait) {
+    // Walk back through the frames this one depends on to one that is cached (or that depends on
+    // none), then decode forward from it, caching each frame on the way.
+    std::vector<int> toDecode;
+    sk_sp<SkImage> image;
+    for (int i = index; i != SkCodec::kNoFrame; i = fRequiredFrames[i]) {
+        if ((image = this->findFrame(i))) {
+            break;
+        }
+        // A frame that is being decoded ahead will be cached (unless it is purged or fails).
+        if (wait && this->waitForFrame(i) && (image = this->findFrame(i))) {
+            break;
+        }
+        toDecode.push_back(i);
+    }
+    for (auto i = toDecode.rbegin(); i != toDecode.rend(); ++i) {
+        image = decoder->decodeFrame(*i, image);
+        if (!image) {
+            return nullptr;
+        }
+        SkResourceCache::Add(new AnimFrameRec(AnimFrameKey(fUniqueID, *i), image));
+    }
+    return image;
+}
+
+bool SkAnimFrameCache::waitForFrame(int index) {
+    if (!fLookAheadTasks) {
+        return false;
+    }
+    {
+        SkAutoMutexExclusive lock(fScheduledMutex);
+        LookAheadRun* run = fScheduled[index].get();
+        if (!run) {
+            return false;
+        }
+        if (!run->fStarted) {
+            // Decoding the frame here is quicker than waiting for the decodes queued before it.
+            // The caller decodes the frames of the run the frame depends on, and a later
+            // lookAhead() queues the ones after it again.
+            run->fStarted = true;
+            for (int frame : run->fFrames) {
+                fScheduled[frame] = nullptr;
+            }
+            return false;
+        }
+        fWaitingFor = index;
+    }
+    fFrameDone.wait();
+    return true;
+}
+
+bool SkAnimFrameCache::dependsOnScheduledFrame(int index) const {
+    for (int i = fRequiredFrames[index]; i != SkCodec::kNoFrame; i = fRequiredFrames[i]) {
+        if (fScheduled[i]) {
+            return true;
+        }
+        if (this->findFrame(i)) {
+            return false;
+        }
+    }
+    return false;
+}
+
+void SkAnimFrameCache::lookAhead(int index) {
+    if (!fLookAheadTasks) {
+        return;
+    }
+    const int frameCount = SkToInt(fRequiredFrames.size());
+    fLookAheadFrom = index;
+
+    // Split the upcoming frames into runs that start at an independent frame, so that each run
+    // can be decoded without waiting for another.
+    auto run = std::make_shared<LookAheadRun>();
+    for (int i = 1; i <= std::min(fLookAheadFrames, frameCount - 1); ++i) {
+        const int next = (index + i) % frameCount;
+        if (fRequiredFrames[next] == SkCodec::kNoFrame && !run->fFrames.empty()) {
+            this->decodeAhead(std::move(run));
+            run = std::make_shared<LookAheadRun>();
+        }
+        if (this->findFrame(next)) {
+            continue;
+        }
+        SkAutoMutexExclusive lock(fScheduledMutex);
+        // A run that starts at a frame that depends on one being decoded ahead would decode that
+        // one again. The frame is queued by a later lookAhead() instead, once that one is cached.
+        if (fScheduled[next] || (run->fFrames.empty() && this->dependsOnScheduledFrame(next))) {
+            continue;
+        }
+        fScheduled[next] = run;
+        run->fFrames.push_back(next);
+    }
+    if (!run->fFrames.empty()) {
+        this->decodeAhead(std::move(run));
+    }
+}
+
+void SkAnimFrameCache::decodeAhead(std::shared_ptr<LookAheadRun> run) {
+    fLookAheadTasks->add([this, run = std::move(run)] {
+        {
+            // getFrame() may have taken the run off the queue.
+            SkAutoMutexExclusive lock(fScheduledMutex);
+            if (run->fStarted) {
+                return;
+            }
+            run->fStarted = true;
+        }
+
+        std::unique_ptr<Decoder> decoder;
+        {
+            SkAutoMutexExclusive lock(fDecoderPoolMutex);
+            if (!fDecoderPool.empty()) {
+                decoder = std::move(fDecoderPool.back());
+                fDecoderPool.pop_back();
+            } else if (auto stream = fEncodedData->duplicate()) {
+                decoder = fDecoderFactory(std::move(stream));
+            }
+        }
+
+        const int frameCount = SkToInt(fRequiredFrames.size());
+        for (int index : run->fFrames) {
+            // Skip the frame if the cache is being destroyed, or if the shown frame has moved
+            // past it since it was queued.
+            const int ahead = (index - fLookAheadFrom + frameCount) % frameCount;
+            if (decoder && !fCancelled && ahead <= fLookAheadFrames) {
+                this->findOrDecodeFrame(decoder.get(), index, /*wait=*/false);
+            }
+
+            bool wake;
+            {
+                SkAutoMutexExclusive lock(fScheduledMutex);
+                fScheduled[index] = nullptr;
+                wake = fWaitingFor == index;
+                if (wake) {
+                    fWaitingFor = SkCodec::kNoFrame;
+                }
+            }
+            if (wake) {
+                fFrameDone.signal();
+            }
+        }
+
+        if (decoder) {
+            SkAutoMutexExclusive lock(fDecoderPoolMutex);
+            fDecoderPool.push_back(std::move(decoder));
+        }
+    });
+}
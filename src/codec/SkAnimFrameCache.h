@@ -0,0 +1,129 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkAnimFrameCache_DEFINED
+#define SkAnimFrameCache_DEFINED
+
+#include "include/codec/SkCodec.h"
+#include "include/core/SkRefCnt.h"
+#include "include/private/base/SkMutex.h"
+#include "include/private/base/SkSemaphore.h"
+#include "include/private/base/SkThreadAnnotations.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class SkExecutor;
+class SkImage;
+class SkStream;
+class SkTaskGroup;
+
+/**
+ *  Keeps the decoded frames of an animation in the SkResourceCache, so they count against its
+ *  budget and may be purged. A frame that is not cached is decoded from the closest cached frame
+ *  it depends on, and every frame decoded on the way is cached.
+ *
+ *  If an executor is provided, lookAhead() queues decodes of the frames after the shown one on it,
+ *  with decoders of their own. Runs of frames that start at an independent frame are decoded
+ *  concurrently. getFrame() takes a run that has not started yet off the queue and decodes the
+ *  frames it needs itself, rather than waiting behind the other decodes. It only waits for a run
+ *  that is being decoded.
+ *
+ *  getFrame() and lookAhead() must not be called concurrently.
+ */
+class SkAnimFrameCache {
+public:
+    /** Decodes the frames of the animation. A Decoder is only used by one thread at a time. */
+    class Decoder {
+    public:
+        virtual ~Decoder() = default;
+
+        /**
+         *  Returns the image of the frame, decoded on top of prior, the image of the frame's
+         *  required frame (or null if it has none). Returns null on failure.
+         */
+        virtual sk_sp<SkImage> decodeFrame(int index, const sk_sp<SkImage>& prior) = 0;
+    };
+
+    /**
+     *  Makes a look-ahead decoder that reads from the stream, a duplicate of the encoded data.
+     *  May return null. Called on the look-ahead threads, one at a time.
+     */
+    using DecoderFactory = std::function<std::unique_ptr<Decoder>(std::unique_ptr<SkStream>)>;
+
+    static constexpr int kDefaultLookAheadFrames = 8;
+
+    /**
+     *  @param decoder     Decodes the frames requested by getFrame().
+     *  @param frameInfos  The frames of the animation. Only fRequiredFrame is used.
+     *  @param encodedData The encoded animation, for the look-ahead decoders. If it, the executor
+     *                     or the factory is null, or lookAheadFrames is not positive, frames are
+     *                     only decoded by getFrame().
+     */
+    SkAnimFrameCache(std::unique_ptr<Decoder> decoder,
+                     const std::vector<SkCodec::FrameInfo>& frameInfos,
+                     std::unique_ptr<SkStream> encodedData,
+                     SkExecutor* lookAheadExecutor,
+                     int lookAheadFrames,
+                     DecoderFactory lookAheadDecoderFactory);
+
+    /** Cancels the look-ahead decodes that have not started, waits for the others, and purges
+     *  the cached frames. */
+    ~SkAnimFrameCache();
+
+    /** Returns the image of the frame, from the cache or decoded. Returns null on failure. */
+    sk_sp<SkImage> getFrame(int index);
+
+    /** Queues decodes of the frames after index that are neither cached nor queued. */
+    void lookAhead(int index);
+
+private:
+    sk_sp<SkImage> findFrame(int index) const;
+    // Decodes the frame with decoder, from the closest cached frame it depends on. If wait, a
+    // frame that is being decoded ahead is waited for instead.
+    sk_sp<SkImage> findOrDecodeFrame(Decoder* decoder, int index, bool wait);
+    // If the frame is being decoded ahead, waits until that is done and returns true. If it is
+    // queued but its run has not started, takes the run off the queue and returns false.
+    bool waitForFrame(int index);
+
+    // Whether a frame the frame depends on, after the closest cached one, is being decoded ahead.
+    bool dependsOnScheduledFrame(int index) const SK_REQUIRES(fScheduledMutex);
+
+    // Frames decoded ahead one after the other, by one task. Guarded by fScheduledMutex.
+    struct LookAheadRun {
+        std::vector<int> fFrames;
+        bool             fStarted = false;  // By its task, or taken off the queue by getFrame().
+    };
+    void decodeAhead(std::shared_ptr<LookAheadRun> run);
+
+    const std::unique_ptr<Decoder> fDecoder;
+    std::vector<int>               fRequiredFrames;
+    const uint32_t                 fUniqueID;      // Keys these frames in the cache.
+
+    // Look-ahead decoding; fLookAheadTasks is null without it.
+    const int                      fLookAheadFrames;
+    const DecoderFactory           fDecoderFactory;
+    std::unique_ptr<SkTaskGroup>   fLookAheadTasks;
+    std::atomic<int>               fLookAheadFrom{0};
+    std::atomic<bool>              fCancelled{false};
+
+    // The runs of the frames queued or being decoded ahead, and the frame getFrame() is waiting
+    // for, if any.
+    SkMutex                        fScheduledMutex;
+    std::vector<std::shared_ptr<LookAheadRun>> fScheduled SK_GUARDED_BY(fScheduledMutex);
+    int                            fWaitingFor SK_GUARDED_BY(fScheduledMutex) = SkCodec::kNoFrame;
+    SkSemaphore                    fFrameDone;     // Signaled when fWaitingFor is done.
+
+    SkMutex                        fDecoderPoolMutex;
+    std::unique_ptr<SkStream>      fEncodedData SK_GUARDED_BY(fDecoderPoolMutex);
+    std::vector<std::unique_ptr<Decoder>> fDecoderPool SK_GUARDED_BY(fDecoderPoolMutex);
+};
+
+#endif
@@ -0,0 +1,278 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/codec/SkJpegBands.h"
+
+#include "include/core/SkData.h"
+#include "src/codec/SkCodecPriv.h"
+#include "src/codec/SkJpegConstants.h"
+#include "src/codec/SkJpegSegmentScan.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+
+static constexpr uint8_t kJpegMarkerBaselineDCT = 0xC0;
+static constexpr uint8_t kJpegMarkerExtendedDCT = 0xC1;
+static constexpr uint8_t kJpegMarkerRestart0 = 0xD0;
+
+// Start of frame markers are 0xC0 through 0xCF, except for DHT (0xC4), JPG (0xC8) and DAC (0xCC).
+static bool is_start_of_frame(uint8_t marker) {
+    return marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+}
+
+static bool is_restart(uint8_t marker) {
+    return marker >= kJpegMarkerRestart0 && marker < kJpegMarkerRestart0 + 8;
+}
+
+namespace {
+// The headers of a JPEG with a single baseline or extended Huffman-coded scan, and the restart
+// markers in the scan's entropy-coded data.
+struct ScanLayout {
+    // The offset of the frame's height, and the size of the headers up to the entropy-coded data.
+    size_t heightOffset = 0;
+    size_t headerSize = 0;
+    std::vector<size_t> restartOffsets;
+    // The offset of the EndOfImage marker, or zero if the scan stopped before it.
+    size_t endOfImage = 0;
+};
+
+// Scans data until restartCount restart markers are found, or to the end of the image if
+// restartCount is negative.
+std::optional<ScanLayout> scan_layout(const SkData& data, int64_t restartCount) {
+    // Scanning in chunks lets it stop soon after the last marker it needs.
+    static constexpr size_t kChunkSize = 4096;
+
+    SkJpegSegmentScanner scanner(kJpegMarkerEndOfImage);
+    size_t scanned = 0;
+    size_t segmentCount = 0;
+    int64_t markerCount = 0;
+    while (!scanner.isDone() && scanned < data.size()) {
+        const size_t chunkSize = std::min(kChunkSize, data.size() - scanned);
+        scanner.onBytes(data.bytes() + scanned, chunkSize);
+        scanned += chunkSize;
+        if (restartCount < 0) {
+            continue;
+        }
+        const std::vector<SkJpegSegment>& segments = scanner.getSegments();
+        for (; segmentCount < segments.size(); ++segmentCount) {
+            markerCount += is_restart(segments[segmentCount].marker);
+        }
+        if (markerCount >= restartCount) {
+            break;
+        }
+    }
+
+    // Find the frame header, the only scan and the restart markers in its entropy-coded data.
+    const SkJpegSegment* startOfFrame = nullptr;
+    const SkJpegSegment* startOfScan = nullptr;
+    ScanLayout layout;
+    for (const SkJpegSegment& segment : scanner.getSegments()) {
+        if (segment.marker == kJpegMarkerEndOfImage) {
+            layout.endOfImage = segment.offset;
+        } else if (startOfScan) {
+            // Only restart markers, numbered RST0 to RST7 and around again, may follow the scan
+            // header.
+            if (segment.marker != kJpegMarkerRestart0 + layout.restartOffsets.size() % 8) {
+                return std::nullopt;
+            }
+            layout.restartOffsets.push_back(segment.offset);
+        } else if (segment.marker == kJpegMarkerStartOfScan) {
+            startOfScan = &segment;
+        } else if (is_start_of_frame(segment.marker) && !startOfFrame) {
+            startOfFrame = &segment;
+        }
+    }
+    if (!startOfFrame || !startOfScan ||
+        (startOfFrame->marker != kJpegMarkerBaselineDCT &&
+         startOfFrame->marker != kJpegMarkerExtendedDCT)) {
+        return std::nullopt;
+    }
+    if (restartCount < 0 ? !layout.endOfImage
+                         : (int64_t)layout.restartOffsets.size() < restartCount) {
+        return std::nullopt;
+    }
+
+    // The frame header's parameters are the length, the sample precision, and then the height.
+    layout.heightOffset = startOfFrame->offset + kJpegMarkerCodeSize +
+                          kJpegSegmentParameterLengthSize + 1;
+    layout.headerSize = startOfScan->offset + kJpegMarkerCodeSize + startOfScan->parameterLength;
+    const size_t firstMarker = layout.restartOffsets.empty() ? layout.endOfImage
+                                                             : layout.restartOffsets.front();
+    if (startOfFrame->parameterLength < kJpegSegmentParameterLengthSize + 5 ||
+        layout.headerSize > firstMarker) {
+        return std::nullopt;
+    }
+    return layout;
+}
+}  // namespace
+
+std::vector<SkJpegBand> SkJpegBand::Split(const SkData& data,
+                                          int width,
+                                          int height,
+                                          int mcuWidth,
+                                          int mcuHeight,
+                                          int restartInterval,
+                                          int maxBands) {
+    if (width <= 0 || height <= 0 || mcuWidth <= 0 || mcuHeight <= 0 || restartInterval <= 0 ||
+        maxBands < 2) {
+        return {};
+    }
+    const int mcusPerRow = (width + mcuWidth - 1) / mcuWidth;
+    const int mcuRows = (height + mcuHeight - 1) / mcuHeight;
+    const int64_t mcuCount = (int64_t)mcusPerRow * mcuRows;
+
+    const std::optional<ScanLayout> layout = scan_layout(data, -1);
+    if (!layout) {
+        return {};
+    }
+    const std::vector<size_t>& restartOffsets = layout->restartOffsets;
+    if ((int64_t)restartOffsets.size() != (mcuCount + restartInterval - 1) / restartInterval - 1) {
+        SkCodecPrintf("Expected a restart marker every %d MCUs\n", restartInterval);
+        return {};
+    }
+    const size_t heightOffset = layout->heightOffset;
+    const size_t headerSize = layout->headerSize;
+
+    // The rows of MCUs that start right after a restart marker (or at the start of the scan).
+    std::vector<int> startRows = {0};
+    for (int row = 1; row < mcuRows; ++row) {
+        if (((int64_t)row * mcusPerRow) % restartInterval == 0) {
+            startRows.push_back(row);
+        }
+    }
+    if (startRows.size() < 2) {
+        return {};
+    }
+    // The offsets of the entropy-coded data of the row, and of the end of the data before it.
+    auto restart_index = [&](int row) {
+        return (int64_t)row * mcusPerRow / restartInterval - 1;
+    };
+    auto data_start = [&](int row) {
+        return row == 0 ? headerSize : restartOffsets[restart_index(row)] + kJpegMarkerCodeSize;
+    };
+    auto data_end = [&](int row) {
+        return row == mcuRows ? layout->endOfImage : restartOffsets[restart_index(row)];
+    };
+
+    // Pick the band boundaries from the start rows, spreading them evenly over the image.
+    const int bandCount = std::min<int>(maxBands, startRows.size());
+    std::vector<int> boundaries = {0};
+    for (int i = 1; i < bandCount; ++i) {
+        const int target = (int)((int64_t)i * mcuRows / bandCount);
+        auto row = std::lower_bound(startRows.begin(), startRows.end(), target);
+        if (row != startRows.end() && *row > boundaries.back()) {
+            boundaries.push_back(*row);
+        }
+    }
+    boundaries.push_back(mcuRows);
+    if (boundaries.size() < 3) {
+        return {};
+    }
+
+    const uint8_t* bytes = data.bytes();
+    std::vector<SkJpegBand> bands;
+    for (size_t i = 0; i + 1 < boundaries.size(); ++i) {
+        const int firstRow = boundaries[i];
+        const int endRow = boundaries[i + 1];
+
+        // Add the rows from the start rows before and after the band, for context.
+        auto first = std::lower_bound(startRows.begin(), startRows.end(), firstRow);
+        const int contextFirstRow = firstRow == 0 ? 0 : *(first - 1);
+        auto end = std::upper_bound(startRows.begin(), startRows.end(), endRow);
+        const int contextEndRow = end == startRows.end() ? mcuRows : *end;
+
+        const int top = firstRow * mcuHeight;
+        const int contextTop = contextFirstRow * mcuHeight;
+        const int contextBottom = std::min(contextEndRow * mcuHeight, height);
+        const int bandHeight = contextBottom - contextTop;
+        if (bandHeight > 0xFFFF) {
+            return {};
+        }
+
+        const size_t dataStart = data_start(contextFirstRow);
+        const size_t dataSize = data_end(contextEndRow) - dataStart;
+        const size_t size = headerSize + dataSize + kJpegMarkerCodeSize;
+        sk_sp<SkData> band = SkData::MakeUninitialized(size);
+        uint8_t* dst = static_cast<uint8_t*>(band->writable_data());
+        memcpy(dst, bytes, headerSize);
+        dst[heightOffset] = bandHeight >> 8;
+        dst[heightOffset + 1] = bandHeight & 0xFF;
+        memcpy(dst + headerSize, bytes + dataStart, dataSize);
+        dst[size - 2] = 0xFF;
+        dst[size - 1] = kJpegMarkerEndOfImage;
+
+        // The decoder expects the markers in the band to count up from RST0.
+        const int64_t firstRestart = contextFirstRow == 0 ? 0 : restart_index(contextFirstRow) + 1;
+        for (int64_t r = firstRestart; r < (int64_t)restartOffsets.size(); ++r) {
+            const size_t offset = restartOffsets[r];
+            if (offset >= dataStart + dataSize) {
+                break;
+            }
+            dst[headerSize + offset - dataStart + 1] = kJpegMarkerRestart0 + (r - firstRestart) % 8;
+        }
+
+        SkJpegBand& added = bands.emplace_back();
+        added.data.push_back(std::move(band));
+        added.top = top;
+        added.height = std::min(endRow * mcuHeight, height) - top;
+        added.contextRows = top - contextTop;
+    }
+    return bands;
+}
+
+std::optional<SkJpegBand> SkJpegBand::MakeFrom(const SkData& data,
+                                               int width,
+                                               int height,
+                                               int mcuWidth,
+                                               int mcuHeight,
+                                               int restartInterval,
+                                               int row) {
+    if (width <= 0 || height <= 0 || mcuWidth <= 0 || mcuHeight <= 0 || restartInterval <= 0 ||
+        row <= 0 || row >= height) {
+        return std::nullopt;
+    }
+    const int mcusPerRow = (width + mcuWidth - 1) / mcuWidth;
+
+    // The band starts with a row of MCUs of context above the one that holds row, at the last row
+    // of MCUs before that to start right after an RST7 marker. The decoder then finds the markers
+    // after it numbered as it expects, and the rest of the image is neither scanned nor copied.
+    const int firstRow = row / mcuHeight;
+    int contextFirstRow = firstRow - 1;
+    for (; contextFirstRow > 0; --contextFirstRow) {
+        const int64_t mcus = (int64_t)contextFirstRow * mcusPerRow;
+        if (mcus % restartInterval == 0 && (mcus / restartInterval) % 8 == 0) {
+            break;
+        }
+    }
+    if (contextFirstRow <= 0) {
+        return std::nullopt;
+    }
+    const int64_t restartIndex = (int64_t)contextFirstRow * mcusPerRow / restartInterval - 1;
+    const std::optional<ScanLayout> layout = scan_layout(data, restartIndex + 1);
+    if (!layout) {
+        return std::nullopt;
+    }
+
+    const int top = firstRow * mcuHeight;
+    const int contextTop = contextFirstRow * mcuHeight;
+    const int bandHeight = height - contextTop;
+    const uint8_t bandHeightBytes[] = {(uint8_t)(bandHeight >> 8), (uint8_t)(bandHeight & 0xFF)};
+    const size_t heightEnd = layout->heightOffset + sizeof(bandHeightBytes);
+    const size_t dataStart = layout->restartOffsets[restartIndex] + kJpegMarkerCodeSize;
+
+    SkJpegBand made;
+    made.data = {SkData::MakeSubset(&data, 0, layout->heightOffset),
+                 SkData::MakeWithCopy(bandHeightBytes, sizeof(bandHeightBytes)),
+                 SkData::MakeSubset(&data, heightEnd, layout->headerSize - heightEnd),
+                 SkData::MakeSubset(&data, dataStart, data.size() - dataStart)};
+    made.top = top;
+    made.height = height - top;
+    made.contextRows = top - contextTop;
+    return made;
+}
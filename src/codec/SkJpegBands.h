@@ -0,0 +1,75 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkJpegBands_codec_DEFINED
+#define SkJpegBands_codec_DEFINED
+
+#include "include/core/SkRefCnt.h"
+
+#include <optional>
+#include <vector>
+
+class SkData;
+
+/*
+ * A horizontal band of a baseline JPEG, made into a JPEG of its own so that it can be decoded
+ * independently of the rest of the image.
+ *
+ * Restart markers reset the entropy decoder's state, so the entropy-coded data after a marker
+ * can be decoded without the data before it. A band starts at a marker that begins a row of MCUs:
+ * its JPEG is the image's headers, with the height changed, followed by the entropy-coded data
+ * of its rows, with the restart markers renumbered from zero.
+ *
+ * Upsampling the chroma of a row reads the rows above and below it, so the band's JPEG also holds
+ * the rows of MCUs from the neighboring markers, and the decoder discards them. The rows of the
+ * band then decode exactly as they do in the whole image.
+ */
+struct SkJpegBand {
+    // A JPEG of the band, with rows of context above and below it, in pieces to be read one after
+    // the other.
+    std::vector<sk_sp<SkData>> data;
+    // The first row of the band in the image, and its number of rows.
+    int top = 0;
+    int height = 0;
+    // The number of rows of context in data above the band.
+    int contextRows = 0;
+
+    /*
+     * Split the JPEG in data into at most maxBands bands of about the same height. The image must
+     * be a baseline or extended Huffman-coded JPEG with a single scan, whose MCUs are mcuWidth by
+     * mcuHeight pixels and which has a restart marker every restartInterval MCUs. Returns an empty
+     * vector if the image is not like that, or if too few of its markers start a row of MCUs to
+     * make two bands.
+     */
+    static std::vector<SkJpegBand> Split(const SkData& data,
+                                         int width,
+                                         int height,
+                                         int mcuWidth,
+                                         int mcuHeight,
+                                         int restartInterval,
+                                         int maxBands);
+
+    /*
+     * Make the band from the row of MCUs that holds row to the bottom of the image, so that the
+     * rows above it need not be decoded. The image must be like those that Split takes. Returns
+     * nullopt if it is not, or if no RST7 marker that starts a row of MCUs leaves a row of context
+     * above row.
+     *
+     * The band starts right after that marker, so its markers already count up from RST0. Its
+     * pieces refer to data rather than copying it, except for the height, and data must outlive
+     * them.
+     */
+    static std::optional<SkJpegBand> MakeFrom(const SkData& data,
+                                              int width,
+                                              int height,
+                                              int mcuWidth,
+                                              int mcuHeight,
+                                              int restartInterval,
+                                              int row);
+};
+
+#endif
@@ -12,6 +12,7 @@
 #include "include/core/SkAlphaType.h"
 #include "include/core/SkColorType.h"
 #include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkPixmap.h"
 #include "include/core/SkRefCnt.h"
@@ -23,12 +24,16 @@
 #include "include/private/base/SkTemplates.h"
 #include "modules/skcms/skcms.h"
 #include "src/codec/SkCodecPriv.h"
+#include "src/codec/SkJpegBands.h"
 #include "src/codec/SkJpegConstants.h"
 #include "src/codec/SkJpegDecoderMgr.h"
 #include "src/codec/SkJpegMetadataDecoderImpl.h"
 #include "src/codec/SkJpegPriv.h"
+#include "src/codec/SkJpegSourceMgr.h"
 #include "src/codec/SkParseEncodedOrigin.h"
+#include "src/codec/SkSampler.h"
 #include "src/codec/SkSwizzler.h"
+#include "src/core/SkTaskGroup.h"
 
 #ifdef SK_CODEC_DECODES_JPEG_GAINMAPS
 #include "include/private/SkGainmapInfo.h"
@@ -37,7 +42,9 @@
 #include <array>
 #include <csetjmp>
 #include <cstring>
+#include <optional>
 #include <utility>
+#include <vector>
 
 using namespace skia_private;
 
@@ -265,6 +272,10 @@ SkISize SkJpegCodec::onGetScaledDimensions(float desiredScale) const {
 }
 
 bool SkJpegCodec::onRewind() {
+    // A band's codec has no stream to read the header from again.
+    if (!this->stream()) {
+        return false;
+    }
     JpegDecoderMgr* decoderMgr = nullptr;
     if (kSuccess != ReadHeader(this->stream(), nullptr, &decoderMgr, nullptr)) {
         return fDecoderMgr->returnFalse("onRewind");
@@ -276,6 +287,7 @@ bool SkJpegCodec::onRewind() {
     fSwizzleSrcRow = nullptr;
     fColorXformSrcRow = nullptr;
     fStorage.reset();
+    fBandCodec.reset();
 
     return true;
 }
@@ -478,6 +490,11 @@ SkCodec::Result SkJpegCodec::onGetPixels(const SkImageInfo& dstInfo,
         return kUnimplemented;
     }
 
+    if (options.fExecutor && dstInfo.dimensions() == this->dimensions() &&
+        this->decodeBands(dstInfo, dst, dstRowBytes, options)) {
+        return kSuccess;
+    }
+
     // Get a pointer to the decompress info since we will use it quite frequently
     jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
 
@@ -513,6 +530,112 @@ SkCodec::Result SkJpegCodec::onGetPixels(const SkImageInfo& dstInfo,
     return kSuccess;
 }
 
+// An interleaved scan's MCUs cover a block of each component, and a single component's MCUs are
+// one block.
+static SkISize mcu_size(const jpeg_decompress_struct* dinfo) {
+    const bool interleaved = dinfo->comps_in_scan > 1;
+    return {DCTSIZE * (interleaved ? dinfo->max_h_samp_factor : 1),
+            DCTSIZE * (interleaved ? dinfo->max_v_samp_factor : 1)};
+}
+
+bool SkJpegCodec::decodeBands(const SkImageInfo& dstInfo,
+                              void* dst,
+                              size_t dstRowBytes,
+                              const Options& options) {
+    // Bands must be at least this many pixels, so that decoding one takes much longer than
+    // making its codec.
+    static constexpr int64_t kMinBandPixels = 1 << 16;
+    static constexpr int kMaxBands = 16;
+
+    const jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
+    const void* memory = this->stream() ? this->stream()->getMemoryBase() : nullptr;
+    const int maxBands = (int)std::min<int64_t>(
+            kMaxBands, (int64_t)dinfo->image_width * dinfo->image_height / kMinBandPixels);
+    if (!memory || !this->stream()->hasLength() || maxBands < 2 || dinfo->progressive_mode ||
+        dinfo->arith_code || dinfo->restart_interval == 0) {
+        return false;
+    }
+
+    const SkISize mcuSize = mcu_size(dinfo);
+    const sk_sp<SkData> data = SkData::MakeWithoutCopy(memory, this->stream()->getLength());
+    const std::vector<SkJpegBand> bands = SkJpegBand::Split(*data,
+                                                            dinfo->image_width,
+                                                            dinfo->image_height,
+                                                            mcuSize.width(),
+                                                            mcuSize.height(),
+                                                            dinfo->restart_interval,
+                                                            maxBands);
+    if (bands.empty()) {
+        return false;
+    }
+
+    Options bandOptions = options;
+    bandOptions.fExecutor = nullptr;
+    // Each band writes its own flag; std::vector<bool> would pack them into shared words.
+    std::unique_ptr<bool[]> decoded = std::make_unique<bool[]>(bands.size());
+    auto decode_band = [&](int i) {
+        const SkJpegBand& band = bands[i];
+        std::unique_ptr<SkCodec> codec = this->makeBandCodec(band);
+        if (!codec) {
+            return;
+        }
+        const SkImageInfo bandInfo = dstInfo.makeDimensions(codec->dimensions());
+        if (codec->startScanlineDecode(bandInfo, &bandOptions) != kSuccess) {
+            return;
+        }
+        // Decode the rows of context above the band into a scratch row.
+        AutoTMalloc<uint8_t> contextRow(bandInfo.minRowBytes());
+        for (int y = 0; y < band.contextRows; ++y) {
+            if (codec->getScanlines(contextRow.get(), 1, 0) != 1) {
+                return;
+            }
+        }
+        decoded[i] = codec->getScanlines(SkTAddOffset<void>(dst, band.top * dstRowBytes),
+                                         band.height,
+                                         dstRowBytes) == band.height;
+    };
+    SkTaskGroup taskGroup(*options.fExecutor);
+    taskGroup.batch(bands.size(), decode_band);
+    taskGroup.wait();
+
+    // If a band failed, the image is decoded again on this thread, to report the error.
+    return std::all_of(decoded.get(), decoded.get() + bands.size(), [](bool d) { return d; });
+}
+
+std::unique_ptr<SkJpegCodec> SkJpegCodec::makeBandCodec(const SkJpegBand& band) const {
+    // The band's codec reads its pieces through its source manager, so it has no stream.
+    std::unique_ptr<JpegDecoderMgr> decoderMgr(
+            new JpegDecoderMgr(SkJpegSourceMgr::MakeFromPieces(band.data)));
+    {
+        skjpeg_error_mgr::AutoPushJmpBuf jmp(decoderMgr->errorMgr());
+        if (setjmp(jmp)) {
+            return nullptr;
+        }
+        decoderMgr->init();
+        if (jpeg_read_header(decoderMgr->dinfo(), true) != JPEG_HEADER_OK) {
+            return nullptr;
+        }
+    }
+
+    // The band uses the image's color profile, which may not be in its markers (for instance if
+    // SkRawCodec supplied it).
+    const SkEncodedInfo& info = this->getEncodedInfo();
+    std::unique_ptr<SkEncodedInfo::ICCProfile> profile;
+    if (sk_sp<SkData> profileData = info.profileData()) {
+        profile = SkEncodedInfo::ICCProfile::Make(std::move(profileData));
+    } else if (info.profile()) {
+        profile = SkEncodedInfo::ICCProfile::Make(*info.profile());
+    }
+    SkEncodedInfo bandInfo = SkEncodedInfo::Make(decoderMgr->dinfo()->image_width,
+                                                 decoderMgr->dinfo()->image_height,
+                                                 info.color(),
+                                                 info.alpha(),
+                                                 info.bitsPerComponent(),
+                                                 std::move(profile));
+    return std::unique_ptr<SkJpegCodec>(new SkJpegCodec(
+            std::move(bandInfo), nullptr, decoderMgr.release(), kDefault_SkEncodedOrigin));
+}
+
 bool SkJpegCodec::allocateStorage(const SkImageInfo& dstInfo) {
     int dstWidth = dstInfo.width();
 
@@ -606,6 +729,8 @@ SkSampler* SkJpegCodec::getSampler(bool createIfNecessary) {
 
 SkCodec::Result SkJpegCodec::onStartScanlineDecode(const SkImageInfo& dstInfo,
         const Options& options) {
+    fBandCodec.reset();
+
     // Set the jump location for libjpeg errors
     skjpeg_error_mgr::AutoPushJmpBuf jmp(fDecoderMgr->errorMgr());
     if (setjmp(jmp)) {
@@ -671,6 +796,10 @@ SkCodec::Result SkJpegCodec::onStartScanlineDecode(const SkImageInfo& dstInfo,
 }
 
 int SkJpegCodec::onGetScanlines(void* dst, int count, size_t dstRowBytes) {
+    if (fBandCodec) {
+        return fBandCodec->getScanlines(dst, count, dstRowBytes);
+    }
+
     int rows = this->readRows(this->dstInfo(), dst, dstRowBytes, count, this->options());
     if (rows < count) {
         // This allows us to skip calling jpeg_finish_decompress().
@@ -681,6 +810,13 @@ int SkJpegCodec::onGetScanlines(void* dst, int count, size_t dstRowBytes) {
 }
 
 bool SkJpegCodec::onSkipScanlines(int count) {
+    if (fBandCodec) {
+        return fBandCodec->skipScanlines(count);
+    }
+    if (this->skipToBand(count)) {
+        return true;
+    }
+
     // Set the jump location for libjpeg errors
     skjpeg_error_mgr::AutoPushJmpBuf jmp(fDecoderMgr->errorMgr());
     if (setjmp(jmp)) {
@@ -690,6 +826,71 @@ bool SkJpegCodec::onSkipScanlines(int count) {
     return (uint32_t) count == jpeg_skip_scanlines(fDecoderMgr->dinfo(), count);
 }
 
+bool SkJpegCodec::skipToBand(int count) {
+    // Finding the marker scans the image above it, and the band may start up to eight markers
+    // above the first row, so this is only worth it to skip enough rows.
+    static constexpr int kMinSkippedFraction = 16;
+
+    jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
+    const void* memory = this->stream() ? this->stream()->getMemoryBase() : nullptr;
+    if (!memory || !this->stream()->hasLength() || dinfo->output_scanline != 0 ||
+        dinfo->progressive_mode || dinfo->arith_code || dinfo->restart_interval == 0 ||
+        dinfo->scale_num == 0 || count < (int)dinfo->output_height / kMinSkippedFraction) {
+        return false;
+    }
+
+    // Each row of the output is scale_denom / scale_num rows of the image.
+    const int num = dinfo->scale_num;
+    const int denom = dinfo->scale_denom;
+    const SkISize mcuSize = mcu_size(dinfo);
+    if ((mcuSize.height() * num) % denom != 0) {
+        return false;
+    }
+    const sk_sp<SkData> data = SkData::MakeWithoutCopy(memory, this->stream()->getLength());
+    const std::optional<SkJpegBand> band =
+            SkJpegBand::MakeFrom(*data,
+                                 dinfo->image_width,
+                                 dinfo->image_height,
+                                 mcuSize.width(),
+                                 mcuSize.height(),
+                                 dinfo->restart_interval,
+                                 (int)((int64_t)count * denom / num));
+    if (!band) {
+        return false;
+    }
+    std::unique_ptr<SkJpegCodec> codec = this->makeBandCodec(*band);
+    if (!codec) {
+        return false;
+    }
+
+    // Decode the band at the same scale and with the same subset and sampling as the image.
+    const int bandTop = (band->top - band->contextRows) * num / denom;
+    const SkImageInfo bandInfo = this->dstInfo().makeWH(this->dstInfo().width(),
+                                                        this->dstInfo().height() - bandTop);
+    Options bandOptions = this->options();
+    SkIRect bandSubset;
+    if (bandOptions.fSubset) {
+        bandSubset = SkIRect::MakeLTRB(
+                bandOptions.fSubset->left(), 0, bandOptions.fSubset->right(), bandInfo.height());
+        bandOptions.fSubset = &bandSubset;
+    }
+    if (codec->startScanlineDecode(bandInfo, &bandOptions) != kSuccess) {
+        return false;
+    }
+    if (fSwizzler && fSwizzler->sampleX() != 1) {
+        SkSampler* sampler = codec->getSampler(true);
+        if (!sampler) {
+            return false;
+        }
+        sampler->setSampleX(fSwizzler->sampleX());
+    }
+    if (!codec->skipScanlines(count - bandTop)) {
+        return false;
+    }
+    fBandCodec = std::move(codec);
+    return true;
+}
+
 static bool is_yuv_supported(const jpeg_decompress_struct* dinfo,
                              const SkJpegCodec& codec,
                              const SkYUVAPixmapInfo::SupportedDataTypes* supportedDataTypes,
@@ -26,6 +26,7 @@ class JpegDecoderMgr;
 class SkSampler;
 class SkStream;
 class SkSwizzler;
+struct SkJpegBand;
 struct SkGainmapInfo;
 struct SkImageInfo;
 
@@ -129,6 +130,22 @@ private:
     void initializeSwizzler(const SkImageInfo& dstInfo, const Options& options,
                             bool needsCMYKToRGB);
     [[nodiscard]] bool allocateStorage(const SkImageInfo& dstInfo);
+
+    /*
+     * Decodes the image in horizontal bands between restart markers, concurrently on
+     * options.fExecutor. Returns false if the image cannot be split into bands, or if a band
+     * fails to decode, so that it is decoded on the calling thread instead.
+     */
+    bool decodeBands(const SkImageInfo& dstInfo, void* dst, size_t rowBytes, const Options&);
+    std::unique_ptr<SkJpegCodec> makeBandCodec(const SkJpegBand&) const;
+
+    /*
+     * Skips the first count rows of a scanline decode by decoding the image from a restart
+     * marker near them instead, so that the rows above it are not entropy-decoded. Returns false
+     * if the image has no such marker, leaving the decode as it was.
+     */
+    bool skipToBand(int count);
+
     int readRows(const SkImageInfo& dstInfo, void* dst, size_t rowBytes, int count, const Options&);
 
     /*
@@ -158,6 +175,9 @@ private:
 
     std::unique_ptr<SkSwizzler>        fSwizzler;
 
+    // Set by skipToBand; the rest of the scanline decode reads from it.
+    std::unique_ptr<SkJpegCodec>       fBandCodec;
+
     friend class SkRawCodec;
 
     using INHERITED = SkCodec;
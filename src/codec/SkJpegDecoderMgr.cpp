@@ -90,7 +90,10 @@ SkJpegSourceMgr* JpegDecoderMgr::getSourceMgr() {
 }
 
 JpegDecoderMgr::JpegDecoderMgr(SkStream* stream)
-        : fSrcMgr(SkJpegSourceMgr::Make(stream)), fInit(false) {
+        : JpegDecoderMgr(SkJpegSourceMgr::Make(stream)) {}
+
+JpegDecoderMgr::JpegDecoderMgr(std::unique_ptr<SkJpegSourceMgr> sourceMgr)
+        : fSrcMgr(std::move(sourceMgr)), fInit(false) {
     // An error manager must be set before any calls to libjpeg, in order to handle failures.
     fDInfo.err = jpeg_std_error(&fErrorMgr);
     fErrorMgr.error_exit = skjpeg_err_exit;
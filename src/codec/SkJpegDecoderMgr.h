@@ -41,6 +41,11 @@ public:
      */
     JpegDecoderMgr(SkStream* stream);
 
+    /*
+     * Create the decode manager to read through sourceMgr
+     */
+    JpegDecoderMgr(std::unique_ptr<SkJpegSourceMgr> sourceMgr);
+
     /*
      * Initialize decompress struct
      * Initialize the source manager
@@ -18,6 +18,8 @@
 #include "src/codec/SkJpegSegmentScan.h"
 #endif  // SK_CODEC_DECODES_JPEG_GAINMAPS
 
+#include <utility>
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // SkStream helpers.
 
@@ -418,6 +420,95 @@ private:
 };
 #endif  // SK_CODEC_DECODES_JPEG_GAINMAPS
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// SkJpegPiecesSourceMgr
+
+/*
+ * This class implements SkJpegSourceMgr for data held in several pieces of memory, such as a JPEG
+ * made of parts of another one. It has no stream, and hands each piece to libjpeg in turn.
+ */
+class SkJpegPiecesSourceMgr : public SkJpegSourceMgr {
+public:
+    SkJpegPiecesSourceMgr(std::vector<sk_sp<SkData>> pieces)
+            : SkJpegSourceMgr(nullptr), fPieces(std::move(pieces)) {}
+    ~SkJpegPiecesSourceMgr() override {}
+
+    void initSource(const uint8_t*& nextInputByte, size_t& bytesInBuffer) override {
+        fNextPiece = 0;
+        if (!this->fillInputBuffer(nextInputByte, bytesInBuffer)) {
+            nextInputByte = nullptr;
+            bytesInBuffer = 0;
+        }
+    }
+    bool fillInputBuffer(const uint8_t*& nextInputByte, size_t& bytesInBuffer) override {
+        // libjpeg expects at least one byte, so empty pieces are passed over.
+        while (fNextPiece < fPieces.size()) {
+            const SkData& piece = *fPieces[fNextPiece++];
+            if (piece.size() > 0) {
+                nextInputByte = piece.bytes();
+                bytesInBuffer = piece.size();
+                return true;
+            }
+        }
+        SkCodecPrintf("Asked to read past the last piece.\n");
+        return false;
+    }
+    bool skipInputBytes(size_t bytesToSkip,
+                        const uint8_t*& nextInputByte,
+                        size_t& bytesInBuffer) override {
+        while (bytesToSkip > bytesInBuffer) {
+            bytesToSkip -= bytesInBuffer;
+            if (!this->fillInputBuffer(nextInputByte, bytesInBuffer)) {
+                return false;
+            }
+        }
+        nextInputByte += bytesToSkip;
+        bytesInBuffer -= bytesToSkip;
+        return true;
+    }
+#ifdef SK_CODEC_DECODES_JPEG_GAINMAPS
+    const std::vector<SkJpegSegment>& getAllSegments() override {
+        if (fScanner) {
+            return fScanner->getSegments();
+        }
+        fScanner = std::make_unique<SkJpegSegmentScanner>(kJpegMarkerEndOfImage);
+        for (const sk_sp<SkData>& piece : fPieces) {
+            fScanner->onBytes(piece->data(), piece->size());
+        }
+        return fScanner->getSegments();
+    }
+    sk_sp<SkData> getSubsetData(size_t offset, size_t size, bool* wasCopied) override {
+        for (const sk_sp<SkData>& piece : fPieces) {
+            if (offset < piece->size()) {
+                if (size > piece->size() - offset) {
+                    SkCodecPrintf("Subset spans more than one piece.\n");
+                    return nullptr;
+                }
+                if (wasCopied) {
+                    *wasCopied = false;
+                }
+                return SkData::MakeSubset(piece.get(), offset, size);
+            }
+            offset -= piece->size();
+        }
+        return nullptr;
+    }
+    sk_sp<SkData> getSegmentParameters(const SkJpegSegment& segment) override {
+        if (segment.parameterLength <= kJpegSegmentParameterLengthSize) {
+            return nullptr;
+        }
+        return this->getSubsetData(
+                segment.offset + kJpegMarkerCodeSize + kJpegSegmentParameterLengthSize,
+                segment.parameterLength - kJpegSegmentParameterLengthSize,
+                /*wasCopied=*/nullptr);
+    }
+#endif  // SK_CODEC_DECODES_JPEG_GAINMAPS
+
+private:
+    const std::vector<sk_sp<SkData>> fPieces;
+    size_t fNextPiece = 0;
+};
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // SkJpegSourceMgr
 
@@ -434,6 +525,12 @@ std::unique_ptr<SkJpegSourceMgr> SkJpegSourceMgr::Make(SkStream* stream, size_t
     return std::make_unique<SkJpegBufferedSourceMgr>(stream, bufferSize);
 }
 
+// static
+std::unique_ptr<SkJpegSourceMgr> SkJpegSourceMgr::MakeFromPieces(
+        std::vector<sk_sp<SkData>> pieces) {
+    return std::make_unique<SkJpegPiecesSourceMgr>(std::move(pieces));
+}
+
 SkJpegSourceMgr::SkJpegSourceMgr(SkStream* stream) : fStream(stream) {}
 
 SkJpegSourceMgr::~SkJpegSourceMgr() = default;
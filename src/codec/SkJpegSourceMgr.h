@@ -8,24 +8,18 @@
 #ifndef SkJpegSourceMgr_codec_DEFINED
 #define SkJpegSourceMgr_codec_DEFINED
 
-#include "include/core/SkTypes.h"
-
-#ifdef SK_CODEC_DECODES_JPEG_GAINMAPS
 #include "include/core/SkRefCnt.h"
-#endif  // SK_CODEC_DECODES_JPEG_GAINMAPS
+#include "include/core/SkTypes.h"
 
 #include <cstddef>
 #include <cstdint>
 #include <memory>
-
-#ifdef SK_CODEC_DECODES_JPEG_GAINMAPS
 #include <vector>
-#endif  // SK_CODEC_DECODES_JPEG_GAINMAPS
 
+class SkData;
 class SkStream;
 
 #ifdef SK_CODEC_DECODES_JPEG_GAINMAPS
-class SkData;
 class SkJpegSegmentScanner;
 struct SkJpegSegment;
 #endif  // SK_CODEC_DECODES_JPEG_GAINMAPS
@@ -39,6 +33,8 @@ public:
     // Create a source manager. If the source manager will buffer data, |bufferSize| specifies
     // the size of that buffer.
     static std::unique_ptr<SkJpegSourceMgr> Make(SkStream* stream, size_t bufferSize = 1024);
+    // Create a source manager that reads |pieces| one after the other, directly from their memory.
+    static std::unique_ptr<SkJpegSourceMgr> MakeFromPieces(std::vector<sk_sp<SkData>> pieces);
     virtual ~SkJpegSourceMgr();
 
     // Interface called by libjpeg via its jpeg_source_mgr interface.
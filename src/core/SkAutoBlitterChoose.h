@@ -42,6 +42,7 @@ public:
                                         drawCoverage,
                                         draw.fRC->clipShader(),
                                         SkSurfacePropsCopyOrDefault(draw.fProps));
+        fBlitter = draw.applyBlitBounds(fBlitter, &fAlloc);
         return fBlitter;
     }
 
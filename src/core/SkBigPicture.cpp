@@ -10,6 +10,8 @@
 #include "include/core/SkBBHFactory.h"
 #include "include/core/SkCanvas.h"
 #include "include/private/base/SkAssert.h"
+#include "include/private/base/SkTemplates.h"
+#include "src/core/SkRTree.h"
 #include "src/core/SkRecord.h"
 #include "src/core/SkRecordDraw.h"
 #include "src/core/SkRecords.h"
@@ -43,6 +45,31 @@ void SkBigPicture::playback(SkCanvas* canvas, AbortCallback* callback) const {
                  callback);
 }
 
+sk_sp<const SkBBoxHierarchy> SkBigPicture::refOrMakeBBH() const {
+    if (fBBH) {
+        return fBBH;
+    }
+    // Same as SkPictureRecorder does when recording with an SkRTreeFactory.
+    skia_private::AutoTArray<SkRect> bounds(fRecord->count());
+    skia_private::AutoTMalloc<SkBBoxHierarchy::Metadata> meta(fRecord->count());
+    SkRecordFillBounds(fCullRect, *fRecord, bounds.data(), meta);
+
+    sk_sp<SkBBoxHierarchy> rtree = sk_make_sp<SkRTree>();
+    rtree->insert(bounds.data(), meta, fRecord->count());
+    return rtree;
+}
+
+void SkBigPicture::playbackWithBBH(SkCanvas* canvas, const SkBBoxHierarchy* bbh) const {
+    SkASSERT(canvas);
+    SkRecordDraw(*fRecord,
+                 canvas,
+                 this->drawablePicts(),
+                 nullptr,
+                 this->drawableCount(),
+                 bbh,
+                 nullptr/*no callback*/);
+}
+
 struct NestedApproxOpCounter {
     int fCount = 0;
 
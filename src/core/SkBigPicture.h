@@ -57,6 +57,12 @@ public:
     const SkBBoxHierarchy* bbh() const { return fBBH.get(); }
     const SkRecord*     record() const { return fRecord.get(); }
 
+    // Used by SkPicture::playbackParallel. Returns the picture's BBH, or if it was recorded
+    // without one, builds an SkRTree for it.
+    sk_sp<const SkBBoxHierarchy> refOrMakeBBH() const;
+    // Like playback(), but culls ops against the canvas clip with the given BBH.
+    void playbackWithBBH(SkCanvas*, const SkBBoxHierarchy*) const;
+
 private:
     int drawableCount() const;
     SkPicture const* const* drawablePicts() const;
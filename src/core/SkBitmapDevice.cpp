@@ -38,6 +38,7 @@
 #include "src/image/SkImage_Base.h"
 #include "src/text/GlyphRun.h"
 
+#include <algorithm>
 #include <utility>
 
 class SkVertices;
@@ -73,6 +74,7 @@ class SkDrawTiler {
     // fTileMatrix... are only used if fNeedTiling
     SkTLazy<SkMatrix> fTileMatrix;
     SkRasterClip      fTileRC;
+    SkIRect           fTileBlitBounds;
     SkIPoint          fOrigin;
 
     bool            fDone, fNeedsTiling;
@@ -131,6 +133,7 @@ public:
             fDraw.fDst = fRootPixmap;
             fDraw.fCTM = &dev->localToDevice();
             fDraw.fRC = &dev->fRCStack.rc();
+            fDraw.fBlitBounds = dev->fBlitBounds ? &*dev->fBlitBounds : nullptr;
             fOrigin.set(0, 0);
         }
 
@@ -186,6 +189,13 @@ private:
         fDraw.fCTM = fTileMatrix.get();
         fDevice->fRCStack.rc().translate(-fOrigin.x(), -fOrigin.y(), &fTileRC);
         fTileRC.op(SkIRect::MakeSize(fDraw.fDst.dimensions()), SkClipOp::kIntersect);
+        if (fDevice->fBlitBounds) {
+            fTileBlitBounds = fDevice->fBlitBounds->makeOffset(-fOrigin.x(), -fOrigin.y());
+            if (!fTileBlitBounds.intersect(SkIRect::MakeSize(fDraw.fDst.dimensions()))) {
+                fTileBlitBounds.setEmpty();
+            }
+            fDraw.fBlitBounds = &fTileBlitBounds;
+        }
     }
 };
 
@@ -210,6 +220,7 @@ public:
         }
         fCTM = &dev->localToDevice();
         fRC = &dev->fRCStack.rc();
+        fBlitBounds = dev->fBlitBounds ? &*dev->fBlitBounds : nullptr;
     }
 };
 
@@ -354,6 +365,19 @@ void SkBitmapDevice::drawRect(const SkRect& r, const SkPaint& paint) {
     LOOP_TILER( drawRect(r, paint), Bounder(r, paint))
 }
 
+void SkBitmapDevice::drawRects(const SkRect rects[], int count, const SkPaint& paint) {
+    if (count <= 0) {
+        return;
+    }
+    SkRect bounds = rects[0];
+    for (int i = 1; i < count; ++i) {
+        bounds = {std::min(bounds.fLeft, rects[i].fLeft), std::min(bounds.fTop, rects[i].fTop),
+                  std::max(bounds.fRight, rects[i].fRight),
+                  std::max(bounds.fBottom, rects[i].fBottom)};
+    }
+    LOOP_TILER( drawRects(rects, count, paint), Bounder(bounds, paint))
+}
+
 void SkBitmapDevice::drawOval(const SkRect& oval, const SkPaint& paint) {
     // call the VIRTUAL version, so any subclasses who do handle drawPath aren't
     // required to override drawOval.
@@ -586,6 +610,7 @@ void SkBitmapDevice::drawSpecial(SkSpecialImage* src,
         }
         draw.fCTM = &localToDevice;
         draw.fRC = &fRCStack.rc();
+        draw.fBlitBounds = fBlitBounds ? &*fBlitBounds : nullptr;
         draw.drawBitmap(resultBM, SkMatrix::I(), nullptr, sampling, paint);
     }
 }
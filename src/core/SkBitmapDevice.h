@@ -19,6 +19,7 @@
 #include "src/core/SkRasterClipStack.h"
 
 #include <cstddef>
+#include <optional>
 
 class SkBlender;
 class SkImage;
@@ -66,6 +67,7 @@ public:
     void drawPoints(SkCanvas::PointMode mode, size_t count,
                             const SkPoint[], const SkPaint& paint) override;
     void drawRect(const SkRect& r, const SkPaint& paint) override;
+    void drawRects(const SkRect rects[], int count, const SkPaint& paint) override;
     void drawOval(const SkRect& oval, const SkPaint& paint) override;
     void drawRRect(const SkRRect& rr, const SkPaint& paint) override;
 
@@ -115,6 +117,20 @@ public:
 
     void* getRasterHandle() const override { return fRasterHandle; }
 
+    /**
+     *  Limit the pixels this device's draws may write to 'bounds', in device space. Unlike a
+     *  clip, this does not change how draws are rasterized, so several devices sharing the same
+     *  pixels can each draw the same content into disjoint bounds, and produce exactly what a
+     *  single device would. Layers created by this device are not limited.
+     */
+    void setBlitBounds(const SkIRect& bounds) { fBlitBounds = bounds; }
+
+protected:
+    bool onReadPixels(const SkPixmap&, int x, int y) override;
+    bool onWritePixels(const SkPixmap&, int, int) override;
+    bool onPeekPixels(SkPixmap*) override;
+    bool onAccessPixels(SkPixmap*) override;
+
 private:
     // friend class SkCanvas;
     friend class SkDraw;
@@ -132,11 +148,6 @@ private:
 
     void onDrawGlyphRunList(SkCanvas*, const sktext::GlyphRunList&, const SkPaint& paint) override;
 
-    bool onReadPixels(const SkPixmap&, int x, int y) override;
-    bool onWritePixels(const SkPixmap&, int, int) override;
-    bool onPeekPixels(SkPixmap*) override;
-    bool onAccessPixels(SkPixmap*) override;
-
     void drawBitmap(const SkBitmap&, const SkMatrix&, const SkRect* dstOrNull,
                     const SkSamplingOptions&, const SkPaint&);
 
@@ -144,6 +155,7 @@ private:
     void*       fRasterHandle = nullptr;
     SkRasterClipStack  fRCStack;
     SkGlyphRunListPainterCPU fGlyphPainter;
+    std::optional<SkIRect> fBlitBounds;
 };
 
 #endif // SkBitmapDevice_DEFINED
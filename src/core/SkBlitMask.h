@@ -10,12 +10,23 @@
 
 #include "include/core/SkColor.h"
 
+// The kernels behind these are in src/opts/SkBlitMask_opts.h. On x86, A8 goes up to SSSE3 and
+// LCD16 up to AVX2 (hsw). There are no AVX-512 kernels: glyph rows are rarely wider than 16
+// pixels, so most of them would end up in the tail loops, and an 8-wide AVX2 A8 kernel was no
+// faster than SSSE3. ARM uses the NEON kernels of its default target. Color (ARGB32) glyphs are
+// drawn as sprites instead, which blend with SkBlitRow::Factory32() (SkOpts::blit_row_s32a_opaque
+// for opaque paints).
 namespace SkOpts {
     // Optimized mask-blit routine
     extern void (*blit_mask_d32_a8)(SkPMColor* dst, size_t dstRB,
                                     const SkAlpha* mask, size_t maskRB,
                                     SkColor color, int w, int h);
 
+    // Blend color through an LCD16 mask onto 8888 pixels.
+    extern void (*blit_mask_d32_lcd16)(SkPMColor* dst, size_t dstRB,
+                                       const uint16_t* mask, size_t maskRB,
+                                       SkColor color, int w, int h);
+
     void Init_BlitMask();
 }  // namespace SkOpts
 
@@ -488,6 +488,38 @@ void SkRectClipBlitter::blitMask(const SkMask& mask, const SkIRect& clip) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+void SkRectBoundsBlitter::blitAntiH2(int x, int y, U8CPU a0, U8CPU a1) {
+    if (!y_in_rect(y, fClipRect)) {
+        return;
+    }
+    const bool in0 = x_in_rect(x, fClipRect),
+               in1 = x_in_rect(x + 1, fClipRect);
+    if (in0 && in1) {
+        fBlitter->blitAntiH2(x, y, a0, a1);
+    } else if (in0) {
+        fBlitter->blitAnti1(x, y, a0);
+    } else if (in1) {
+        fBlitter->blitAnti1(x + 1, y, a1);
+    }
+}
+
+void SkRectBoundsBlitter::blitAntiV2(int x, int y, U8CPU a0, U8CPU a1) {
+    if (!x_in_rect(x, fClipRect)) {
+        return;
+    }
+    const bool in0 = y_in_rect(y, fClipRect),
+               in1 = y_in_rect(y + 1, fClipRect);
+    if (in0 && in1) {
+        fBlitter->blitAntiV2(x, y, a0, a1);
+    } else if (in0) {
+        fBlitter->blitAnti1(x, y, a0);
+    } else if (in1) {
+        fBlitter->blitAnti1(x, y + 1, a1);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 void SkRgnClipBlitter::blitH(int x, int y, int width) {
     SkRegion::Spanerator span(*fRgn, y, x, x + width);
     int left, right;
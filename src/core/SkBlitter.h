@@ -106,6 +106,13 @@ public:
         this->blitAntiH(x, y + 1, aa, runs);
     }
 
+    // Blit the single pixel (x, y) exactly as blitAntiH2() and blitAntiV2() blit each of theirs.
+    virtual void blitAnti1(int x, int y, U8CPU a) {
+        int16_t runs[2] = {1, 0};
+        uint8_t aa[1] = {SkToU8(a)};
+        this->blitAntiH(x, y, aa, runs);
+    }
+
     /**
      *  Special method just to identify the null blitter, which is returned
      *  from Choose() if the request cannot be fulfilled. Default impl
@@ -121,6 +128,13 @@ public:
      */
     virtual int requestRowsPreserved() const { return 1; }
 
+    /**
+     * Whether blits to disjoint rows may be made from several threads at once. The callers must
+     * use their own memory (not allocBlitMemory()) on each thread. Blitters that write to shared
+     * scratch state while blitting must return false.
+     */
+    virtual bool canBlitRowsConcurrently() const { return false; }
+
     /**
      * This function allocates memory for the blitter that the blitter then owns.
      * The memory can be used by the calling function at will, but it will be
@@ -199,15 +213,29 @@ public:
         return fBlitter->requestRowsPreserved();
     }
 
+    bool canBlitRowsConcurrently() const override {
+        return fBlitter->canBlitRowsConcurrently();
+    }
+
     void* allocBlitMemory(size_t sz) override {
         return fBlitter->allocBlitMemory(sz);
     }
 
-private:
+protected:
     SkBlitter*  fBlitter;
     SkIRect     fClipRect;
 };
 
+/** Like SkRectClipBlitter, but every pixel inside the rect is written exactly as the real blitter
+    would write it without clipping, even when a blitAntiH2() or blitAntiV2() pair straddles the
+    rect's edge.
+*/
+class SkRectBoundsBlitter : public SkRectClipBlitter {
+public:
+    void blitAntiH2(int x, int y, U8CPU a0, U8CPU a1) override;
+    void blitAntiV2(int x, int y, U8CPU a0, U8CPU a1) override;
+};
+
 /** Wraps another (real) blitter, and ensures that the real blitter is only
     called with coordinates that have been clipped by the specified clipRgn.
     This means the caller need not perform the clipping ahead of time.
@@ -232,6 +260,10 @@ public:
         return fBlitter->requestRowsPreserved();
     }
 
+    bool canBlitRowsConcurrently() const override {
+        return fBlitter->canBlitRowsConcurrently();
+    }
+
     void* allocBlitMemory(size_t sz) override {
         return fBlitter->allocBlitMemory(sz);
     }
@@ -265,6 +297,10 @@ public:
         return fBlitter->requestRowsPreserved();
     }
 
+    bool canBlitRowsConcurrently() const override {
+        return fBlitter->canBlitRowsConcurrently();
+    }
+
     void* allocBlitMemory(size_t sz) override {
         return fBlitter->allocBlitMemory(sz);
     }
@@ -1677,6 +1677,19 @@ void SkCanvas::drawRect(const SkRect& r, const SkPaint& paint) {
     this->onDrawRect(r.makeSorted(), paint);
 }
 
+void SkCanvas::experimental_DrawRects(const SkRect rects[], int count, const SkPaint& paint) {
+    TRACE_EVENT0("skia", TRACE_FUNC);
+    if (count <= 0) {
+        return;
+    }
+    // Like drawRect(), sort the rects before passing them along.
+    skia_private::AutoSTArray<64, SkRect> sorted(count);
+    for (int i = 0; i < count; ++i) {
+        sorted[i] = rects[i].makeSorted();
+    }
+    this->onDrawRects(sorted.get(), count, paint);
+}
+
 void SkCanvas::drawClippedToSaveBehind(const SkPaint& paint) {
     TRACE_EVENT0("skia", TRACE_FUNC);
     this->onDrawBehind(paint);
@@ -2016,6 +2029,33 @@ void SkCanvas::onDrawRect(const SkRect& r, const SkPaint& paint) {
     }
 }
 
+void SkCanvas::onDrawRects(const SkRect rects[], int count, const SkPaint& paint) {
+    // Image filters and mask filters apply to each rect on its own.
+    if (paint.getImageFilter() || paint.getMaskFilter()) {
+        for (int i = 0; i < count; ++i) {
+            this->onDrawRect(rects[i], paint);
+        }
+        return;
+    }
+
+    // Not join(), which skips empty rects: those still draw when stroked.
+    SkRect bounds = rects[0];
+    for (int i = 1; i < count; ++i) {
+        SkASSERT(rects[i].isSorted());
+        bounds = {std::min(bounds.fLeft, rects[i].fLeft), std::min(bounds.fTop, rects[i].fTop),
+                  std::max(bounds.fRight, rects[i].fRight),
+                  std::max(bounds.fBottom, rects[i].fBottom)};
+    }
+    if (this->internalQuickReject(bounds, paint)) {
+        return;
+    }
+
+    auto layer = this->aboutToDraw(paint, &bounds);
+    if (layer) {
+        this->topDevice()->drawRects(rects, count, layer->paint());
+    }
+}
+
 void SkCanvas::onDrawRegion(const SkRegion& region, const SkPaint& paint) {
     const SkRect bounds = SkRect::Make(region.getBounds());
     if (this->internalQuickReject(bounds, paint)) {
@@ -73,6 +73,10 @@ public:
     void blitMask(const SkMask&, const SkIRect&) override;
     void blitAntiH2(int x, int y, U8CPU a0, U8CPU a1) override;
     void blitAntiV2(int x, int y, U8CPU a0, U8CPU a1) override;
+    void blitAnti1(int x, int y, U8CPU a) override;
+
+    // Only reads the color set up at construction.
+    bool canBlitRowsConcurrently() const override { return true; }
 
 protected:
     SkColor                fColor;
@@ -94,6 +98,7 @@ public:
     void blitMask(const SkMask&, const SkIRect&) override;
     void blitAntiH2(int x, int y, U8CPU a0, U8CPU a1) override;
     void blitAntiV2(int x, int y, U8CPU a0, U8CPU a1) override;
+    void blitAnti1(int x, int y, U8CPU a) override;
 
 private:
     using INHERITED = SkARGB32_Blitter;
@@ -106,6 +111,7 @@ public:
     void blitAntiH(int x, int y, const SkAlpha antialias[], const int16_t runs[]) override;
     void blitAntiH2(int x, int y, U8CPU a0, U8CPU a1) override;
     void blitAntiV2(int x, int y, U8CPU a0, U8CPU a1) override;
+    void blitAnti1(int x, int y, U8CPU a) override;
 
 private:
     using INHERITED = SkARGB32_Opaque_Blitter;
@@ -148,4 +154,22 @@ SkBlitter* SkCreateRasterPipelineBlitter(const SkPixmap&, const SkPaint&,
                                          bool shader_is_opaque,
                                          SkArenaAlloc*, sk_sp<SkShader> clipShader);
 
+// Raster pipeline blitters for paints that collapse to a constant color are cached by paint and
+// destination state, so that repeated draws with the same paint skip building their pipelines.
+// These are exposed through SkGraphics. The cache is shared by every thread behind one mutex, so
+// it is off (a limit of 0) until a client opts in.
+namespace SkRasterPipelineBlitterCache {
+    inline constexpr int kDefaultCountLimit = 0;
+
+    int GetCountLimit();
+    int SetCountLimit(int count);  // Returns the previous limit.
+    int GetCountUsed();
+
+    // Lookups of cacheable paints since the process started.
+    int64_t GetHitCount();
+    int64_t GetMissCount();
+
+    void PurgeAll();
+}  // namespace SkRasterPipelineBlitterCache
+
 #endif
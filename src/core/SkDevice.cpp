@@ -110,6 +110,12 @@ static inline bool is_int(float x) {
     return x == (float) sk_float_round2int(x);
 }
 
+void SkDevice::drawRects(const SkRect rects[], int count, const SkPaint& paint) {
+    for (int i = 0; i < count; ++i) {
+        this->drawRect(rects[i], paint);
+    }
+}
+
 void SkDevice::drawRegion(const SkRegion& region, const SkPaint& paint) {
     const SkMatrix& localToDevice = this->localToDevice();
     bool isNonTranslate = localToDevice.getType() & ~(SkMatrix::kTranslate_Mask);
@@ -337,6 +337,8 @@ public:
                             const SkPoint[], const SkPaint& paint) = 0;
     virtual void drawRect(const SkRect& r,
                           const SkPaint& paint) = 0;
+    // Default impl calls drawRect() for each rect.
+    virtual void drawRects(const SkRect rects[], int count, const SkPaint& paint);
     virtual void drawRegion(const SkRegion& r,
                             const SkPaint& paint);
     virtual void drawOval(const SkRect& oval,
@@ -5,6 +5,7 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkBlendMode.h"
 #include "include/core/SkMatrix.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkPath.h"
@@ -22,10 +23,12 @@
 #include "include/private/base/SkDebug.h"
 #include "include/private/base/SkFloatingPoint.h"
 #include "include/private/base/SkTemplates.h"
+#include "src/base/SkArenaAlloc.h"
 #include "src/base/SkTLazy.h"
 #include "src/base/SkZip.h"
 #include "src/core/SkAutoBlitterChoose.h"
 #include "src/core/SkBlendModePriv.h"
+#include "src/core/SkBlitter.h"
 #include "src/core/SkBlitter_A8.h"
 #include "src/core/SkDevice.h"
 #include "src/core/SkDrawBase.h"
@@ -52,6 +55,18 @@ using namespace skia_private;
 
 SkDrawBase::SkDrawBase() {}
 
+SkBlitter* SkDrawBase::applyBlitBounds(SkBlitter* blitter, SkArenaAlloc* alloc) const {
+    if (!fBlitBounds || !blitter) {
+        return blitter;
+    }
+    if (fBlitBounds->isEmpty()) {
+        return alloc->make<SkNullBlitter>();
+    }
+    auto boundsBlitter = alloc->make<SkRectBoundsBlitter>();
+    boundsBlitter->init(blitter, *fBlitBounds);
+    return boundsBlitter;
+}
+
 bool SkDrawBase::computeConservativeLocalClipBounds(SkRect* localBounds) const {
     if (fRC->isEmpty()) {
         return false;
@@ -249,6 +264,76 @@ void SkDrawBase::drawRect(const SkRect& prePaintRect, const SkPaint& paint,
     }
 }
 
+void SkDrawBase::drawRects(const SkRect rects[], int count, const SkPaint& paint) const {
+    SkDEBUGCODE(this->validate();)
+
+    // nothing to draw
+    if (fRC->isEmpty() || count <= 0) {
+        return;
+    }
+
+    // Only plain fills share a blitter; strokes and rects drawn as paths go one at a time.
+    SkPoint strokeSize;
+    if (kFill_RectType != ComputeRectType(rects[0], paint, *fCTM, &strokeSize)) {
+        for (int i = 0; i < count; ++i) {
+            this->drawRect(rects[i], paint);
+        }
+        return;
+    }
+
+    // Without anti-aliasing, src and src-over apply the same function to every pixel a rect
+    // covers, so the rects can be filled in any order with exactly the same result.
+    const std::optional<SkBlendMode> mode = paint.asBlendMode();
+    const bool anyOrder = !paint.isAntiAlias() && mode &&
+                          (*mode == SkBlendMode::kSrcOver || *mode == SkBlendMode::kSrc);
+
+    skia_private::AutoSTArray<64, SkRect> devRects(count);
+    int devCount = 0;
+    for (int i = 0; i < count; ++i) {
+        SkRect devRect;
+        fCTM->mapPoints(rect_points(devRect), rect_points(rects[i]), 2);
+        devRect.sort();
+        if (SkPathPriv::TooBigForMath(devRect)) {
+            continue;
+        }
+        if (!SkRectPriv::FitsInFixed(devRect)) {
+            if (!anyOrder) {
+                // Keep the rects in order by drawing them all one at a time.
+                for (int j = 0; j < count; ++j) {
+                    this->drawRect(rects[j], paint);
+                }
+                return;
+            }
+            draw_rect_as_path(*this, rects[i], paint, *fCTM);
+            continue;
+        }
+        if (!fRC->quickReject(devRect.roundOut())) {
+            devRects[devCount++] = devRect;
+        }
+    }
+    if (devCount == 0) {
+        return;
+    }
+
+    // Filling top to bottom keeps the blitter's writes close together in the destination.
+    if (anyOrder) {
+        std::sort(devRects.get(), devRects.get() + devCount, [](const SkRect& a, const SkRect& b) {
+            return a.fTop < b.fTop || (a.fTop == b.fTop && a.fLeft < b.fLeft);
+        });
+    }
+
+    SkAutoBlitterChoose blitterStorage(*this, nullptr, paint);
+    const SkRasterClip& clip = *fRC;
+    SkBlitter*          blitter = blitterStorage.get();
+    for (int i = 0; i < devCount; ++i) {
+        if (paint.isAntiAlias()) {
+            SkScan::AntiFillRect(devRects[i], clip, blitter);
+        } else {
+            SkScan::FillRect(devRects[i], clip, blitter);
+        }
+    }
+}
+
 static SkScalar fast_len(const SkVector& vec) {
     SkScalar x = SkScalarAbs(vec.fX);
     SkScalar y = SkScalarAbs(vec.fY);
@@ -47,6 +47,9 @@ public:
     void    drawRect(const SkRect& rect, const SkPaint& paint) const {
         this->drawRect(rect, paint, nullptr, nullptr);
     }
+    // Draws each rect as drawRect() would. Filled rects share one blitter, and are filled
+    // top to bottom when their order doesn't change the result.
+    void    drawRects(const SkRect rects[], int count, const SkPaint&) const;
     void    drawRRect(const SkRRect&, const SkPaint&) const;
     /**
      *  To save on mallocs, we allow a flag that tells us that srcPath is
@@ -118,6 +121,9 @@ public:
                                        sk_sp<SkShader> clipShader,
                                        const SkSurfaceProps&);
 
+    // If fBlitBounds is set, wraps blitter (allocated in alloc) so that it only writes inside
+    // those bounds. Otherwise returns blitter unchanged.
+    SkBlitter* applyBlitBounds(SkBlitter* blitter, SkArenaAlloc* alloc) const;
 
 private:
     // not supported
@@ -155,6 +161,10 @@ public:
     const SkMatrix*         fCTM{nullptr};             // required
     const SkRasterClip*     fRC{nullptr};              // required
     const SkSurfaceProps*   fProps{nullptr};           // optional
+    // Unlike fRC, fBlitBounds only limits which pixels are written, not how the geometry is
+    // rasterized: a draw split over several SkDraws with disjoint fBlitBounds writes exactly
+    // the pixels one SkDraw without fBlitBounds would.
+    const SkIRect*          fBlitBounds{nullptr};      // optional
 
 #ifdef SK_DEBUG
     void validate() const;
@@ -122,8 +122,9 @@ void SkDraw::drawAtlas(const SkRSXform xform[],
         isOpaque = false;
     }
 
-    auto blitter = SkCreateRasterPipelineBlitter(fDst, p, pipeline, isOpaque, &alloc,
-                                                 fRC->clipShader());
+    SkBlitter* blitter = this->applyBlitBounds(
+            SkCreateRasterPipelineBlitter(fDst, p, pipeline, isOpaque, &alloc, fRC->clipShader()),
+            &alloc);
     if (!blitter) {
         return;
     }
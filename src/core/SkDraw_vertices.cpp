@@ -289,6 +289,7 @@ void SkDraw::drawFixedVertices(const SkVertices* vertices,
                                                  outerAlloc,
                                                  fRC->clipShader(),
                                                  props);
+    blitter = this->applyBlitBounds(blitter, outerAlloc);
     if (!blitter) {
         return;
     }
@@ -9,11 +9,17 @@
 #include "include/private/base/SkMutex.h"
 #include "include/private/base/SkSemaphore.h"
 #include "include/private/base/SkTArray.h"
+#include "include/private/base/SkTo.h"
 #include "src/base/SkNoDestructor.h"
+#include "src/base/SkRandom.h"
 
+#include <atomic>
+#include <cstdint>
 #include <deque>
+#include <memory>
 #include <thread>
 #include <utility>
+#include <vector>
 
 using namespace skia_private;
 
@@ -143,6 +149,240 @@ private:
     bool                  fAllowBorrowing;
 };
 
+// A Chase-Lev work-stealing deque of tasks, following "Correct and Efficient Work-Stealing for
+// Weak Memory Models" (Lê, Pop, Cohen, Zappa Nardelli, PPoPP 2013), with the paper's fences
+// folded into sequentially consistent loads and stores so that TSAN can follow them. Only the
+// owning thread may push() and take(), at the bottom; any thread may steal(), from the top.
+class SkWorkStealingDeque {
+public:
+    using Task = std::function<void(void)>;
+
+    SkWorkStealingDeque() {
+        fArrays.push_back(std::make_unique<Array>(kInitialCapacity));
+        fArray.store(fArrays.back().get(), std::memory_order_relaxed);
+    }
+
+    ~SkWorkStealingDeque() {
+        // Any tasks left behind are never run.
+        while (Task* task = this->take()) {
+            delete task;
+        }
+    }
+
+    void push(Task* task) {
+        int64_t b = fBottom.load(std::memory_order_relaxed);
+        int64_t t = fTop.load(std::memory_order_acquire);
+        Array* a = fArray.load(std::memory_order_relaxed);
+        if (b - t > a->capacity() - 1) {
+            a = this->grow(a, b, t);
+        }
+        a->put(b, task);
+        fBottom.store(b + 1, std::memory_order_release);
+    }
+
+    Task* take() {
+        int64_t b = fBottom.load(std::memory_order_relaxed) - 1;
+        Array* a = fArray.load(std::memory_order_relaxed);
+        fBottom.store(b, std::memory_order_seq_cst);
+        int64_t t = fTop.load(std::memory_order_seq_cst);
+
+        if (t > b) {
+            // Empty.
+            fBottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        Task* task = a->get(b);
+        if (t == b) {
+            // This is the last task; race any thieves for it.
+            if (!fTop.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                        std::memory_order_relaxed)) {
+                task = nullptr;
+            }
+            fBottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return task;
+    }
+
+    Task* steal() {
+        int64_t t = fTop.load(std::memory_order_seq_cst);
+        int64_t b = fBottom.load(std::memory_order_seq_cst);
+        if (t >= b) {
+            return nullptr;
+        }
+        Task* task = fArray.load(std::memory_order_acquire)->get(t);
+        if (!fTop.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                    std::memory_order_relaxed)) {
+            return nullptr;  // Lost the race to take() or another steal().
+        }
+        return task;
+    }
+
+private:
+    static constexpr int64_t kInitialCapacity = 256;
+
+    // A power-of-two sized circular buffer, indexed by the deque's unbounded top and bottom.
+    class Array {
+    public:
+        explicit Array(int64_t capacity)
+            : fMask(capacity - 1)
+            , fSlots(new std::atomic<Task*>[capacity]) {}
+
+        int64_t capacity() const { return fMask + 1; }
+        Task* get(int64_t i) const { return fSlots[i & fMask].load(std::memory_order_relaxed); }
+        void put(int64_t i, Task* task) {
+            fSlots[i & fMask].store(task, std::memory_order_relaxed);
+        }
+
+    private:
+        const int64_t fMask;
+        std::unique_ptr<std::atomic<Task*>[]> fSlots;
+    };
+
+    Array* grow(Array* a, int64_t b, int64_t t) {
+        auto bigger = std::make_unique<Array>(2 * a->capacity());
+        for (int64_t i = t; i < b; i++) {
+            bigger->put(i, a->get(i));
+        }
+        // Thieves may still be reading the old array, so it's kept alive until we're destroyed.
+        fArrays.push_back(std::move(bigger));
+        fArray.store(fArrays.back().get(), std::memory_order_release);
+        return fArrays.back().get();
+    }
+
+    std::atomic<int64_t> fTop{0};
+    std::atomic<int64_t> fBottom{0};
+    std::atomic<Array*>  fArray;
+    std::vector<std::unique_ptr<Array>> fArrays;  // Owner only.
+};
+
+// An SkWorkStealingThreadPool gives each of its threads its own SkWorkStealingDeque. Work added
+// from one of the pool's threads (e.g. an SkTaskGroup::batch() inside a task) is pushed onto that
+// thread's deque without taking any lock. Work added from other threads goes to a shared queue.
+// Idle threads take work from their own deque first, then steal from a randomly chosen victim,
+// and only then look at the shared queue.
+//
+// Like SkThreadPool, fWorkAvailable counts tasks that have been added but not yet claimed, so a
+// thread that has decremented it is guaranteed to find a task somewhere.
+class SkWorkStealingThreadPool final : public SkExecutor {
+public:
+    using Task = SkWorkStealingDeque::Task;
+
+    explicit SkWorkStealingThreadPool(int threads, bool allowBorrowing)
+            : fWorkers(threads)
+            , fAllowBorrowing(allowBorrowing) {
+        for (int i = 0; i < threads; i++) {
+            fWorkers[i].fRandom.setSeed(i + 1);
+        }
+        for (int i = 0; i < threads; i++) {
+            fThreads.emplace_back(&Loop, this, i);
+        }
+    }
+
+    ~SkWorkStealingThreadPool() override {
+        // Signal each thread that it's time to shut down.
+        for (int i = 0; i < fThreads.size(); i++) {
+            this->add(nullptr);
+        }
+        // Wait for each thread to shut down.
+        for (int i = 0; i < fThreads.size(); i++) {
+            fThreads[i].join();
+        }
+        SkASSERT(fShared.empty());
+    }
+
+    void add(std::function<void(void)> work) override {
+        Task* task = new Task(std::move(work));
+        if (tPool == this) {
+            fWorkers[tWorker].fDeque.push(task);
+        } else {
+            SkAutoMutexExclusive lock(fSharedLock);
+            fShared.push_back(task);
+        }
+        fWorkAvailable.signal(1);
+    }
+
+    void borrow() override {
+        // If there is work waiting and we're allowed to borrow work, do it.
+        if (fAllowBorrowing && fWorkAvailable.try_wait()) {
+            SkAssertResult(this->do_work());
+        }
+    }
+
+private:
+    struct Worker {
+        SkWorkStealingDeque fDeque;
+        SkRandom            fRandom;  // Only used by this worker's thread.
+    };
+
+    Task* find_work() {
+        const int n = SkToInt(fWorkers.size());
+        Worker* self = tPool == this ? &fWorkers[tWorker] : nullptr;
+        if (self) {
+            if (Task* task = self->fDeque.take()) {
+                return task;
+            }
+        }
+        const int start = self ? (int)self->fRandom.nextULessThan(n)
+                               : (int)(fNextVictim.fetch_add(1, std::memory_order_relaxed) % n);
+        for (int i = 0; i < n; i++) {
+            Worker* victim = &fWorkers[(start + i) % n];
+            if (victim == self) {
+                continue;
+            }
+            if (Task* task = victim->fDeque.steal()) {
+                return task;
+            }
+        }
+        SkAutoMutexExclusive lock(fSharedLock);
+        if (fShared.empty()) {
+            return nullptr;
+        }
+        Task* task = fShared.front();
+        fShared.pop_front();
+        return task;
+    }
+
+    // This method should be called only when fWorkAvailable indicates there's work to do.
+    bool do_work() {
+        Task* task;
+        while (!(task = this->find_work())) {
+            // A task has been added for us, but we raced its owner or another thief for it.
+            std::this_thread::yield();
+        }
+        std::unique_ptr<Task> work(task);
+
+        if (!*work) {
+            return false;  // This is Loop()'s signal to shut down.
+        }
+
+        (*work)();
+        return true;
+    }
+
+    static void Loop(SkWorkStealingThreadPool* pool, int worker) {
+        tPool   = pool;
+        tWorker = worker;
+        do {
+            pool->fWorkAvailable.wait();
+        } while (pool->do_work());
+    }
+
+    // The pool and worker index of the current thread, if it's one of a pool's threads.
+    static thread_local SkWorkStealingThreadPool* tPool;
+    static thread_local int                       tWorker;
+
+    std::vector<Worker>   fWorkers;
+    TArray<std::thread>   fThreads;
+    std::deque<Task*>     fShared;
+    SkMutex               fSharedLock;
+    std::atomic<uint32_t> fNextVictim{0};
+    SkSemaphore           fWorkAvailable;
+    bool                  fAllowBorrowing;
+};
+
+thread_local SkWorkStealingThreadPool* SkWorkStealingThreadPool::tPool   = nullptr;
+thread_local int                       SkWorkStealingThreadPool::tWorker = 0;
+
 std::unique_ptr<SkExecutor> SkExecutor::MakeFIFOThreadPool(int threads, bool allowBorrowing) {
     using WorkList = std::deque<std::function<void(void)>>;
     return std::make_unique<SkThreadPool<WorkList>>(threads > 0 ? threads : num_cores(),
@@ -153,3 +393,9 @@ std::unique_ptr<SkExecutor> SkExecutor::MakeLIFOThreadPool(int threads, bool all
     return std::make_unique<SkThreadPool<WorkList>>(threads > 0 ? threads : num_cores(),
                                                     allowBorrowing);
 }
+
+std::unique_ptr<SkExecutor> SkExecutor::MakeWorkStealingThreadPool(int threads,
+                                                                   bool allowBorrowing) {
+    return std::make_unique<SkWorkStealingThreadPool>(threads > 0 ? threads : num_cores(),
+                                                      allowBorrowing);
+}
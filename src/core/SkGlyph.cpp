@@ -21,6 +21,7 @@
 #include "src/base/SkBezierCurves.h"
 #include "src/core/SkReadBuffer.h"
 #include "src/core/SkScalerContext.h"
+#include "src/core/SkSharedGlyphMemory.h"
 #include "src/core/SkWriteBuffer.h"
 #include "src/text/StrikeForGPU.h"
 
@@ -346,16 +347,24 @@ void SkGlyph::flattenMetrics(SkWriteBuffer& buffer) const {
     buffer.writeUInt(SkTo<uint32_t>(fMaskFormat));
 }
 
-void SkGlyph::flattenImage(SkWriteBuffer& buffer) const {
+void SkGlyph::flattenImage(SkWriteBuffer& buffer, SkSharedGlyphImageWriter* sharedImages) const {
     SkASSERT(this->setImageHasBeenCalled());
 
     // If the glyph is empty or too big, then no image data is sent.
-    if (!this->isEmpty() && SkGlyphDigest::FitsInAtlas(*this)) {
-        buffer.writeByteArray(this->image(), this->imageSize());
+    if (this->isEmpty() || !SkGlyphDigest::FitsInAtlas(*this)) {
+        return;
+    }
+    if (sharedImages != nullptr) {
+        buffer.writeUInt(
+                sharedImages->write(this->image(), this->imageSize(), this->formatAlignment()));
+        return;
     }
+    buffer.writeByteArray(this->image(), this->imageSize());
 }
 
-size_t SkGlyph::addImageFromBuffer(SkReadBuffer& buffer, SkArenaAlloc* alloc) {
+size_t SkGlyph::addImageFromBuffer(SkReadBuffer& buffer,
+                                   SkArenaAlloc* alloc,
+                                   const SkSharedGlyphLease* sharedImages) {
     SkASSERT(buffer.isValid());
 
     // If the glyph is empty or too big, then no image data is received.
@@ -363,6 +372,31 @@ size_t SkGlyph::addImageFromBuffer(SkReadBuffer& buffer, SkArenaAlloc* alloc) {
         return 0;
     }
 
+    // A strike may already have an image for this glyph, which other threads may be reading, so
+    // keep it and skip the one in the buffer.
+    const bool keepImage = this->setImageHasBeenCalled();
+
+    if (sharedImages != nullptr) {
+        const uint32_t offset = buffer.readUInt();
+        const void* image =
+                sharedImages->find(offset, this->imageSize(), this->formatAlignment());
+        if (!buffer.validate(image != nullptr) || keepImage) {
+            return 0;
+        }
+        // The writer can still change the memory, so the glyph keeps a copy.
+        void* imageData = alloc->makeBytesAlignedTo(this->imageSize(), this->formatAlignment());
+        memcpy(imageData, image, this->imageSize());
+        this->installImage(imageData);
+        return this->imageSize();
+    }
+
+    if (keepImage) {
+        size_t size;
+        buffer.skipByteArray(&size);
+        buffer.validate(size == this->imageSize());
+        return 0;
+    }
+
     size_t memoryIncrease = 0;
 
     void* imageData = alloc->makeBytesAlignedTo(this->imageSize(), this->formatAlignment());
@@ -375,6 +409,31 @@ size_t SkGlyph::addImageFromBuffer(SkReadBuffer& buffer, SkArenaAlloc* alloc) {
     return memoryIncrease;
 }
 
+size_t SkGlyph::addImageInPlaceFromBuffer(SkReadBuffer& buffer, SkArenaAlloc* alloc) {
+    SkASSERT(buffer.isValid());
+
+    // If the glyph is empty or too big, then no image data was written.
+    if (this->isEmpty() || !SkGlyphDigest::FitsInAtlas(*this)) {
+        return 0;
+    }
+
+    size_t size;
+    const void* image = buffer.skipByteArray(&size);
+    if (!buffer.validate(image != nullptr && size == this->imageSize()) ||
+        this->setImageHasBeenCalled()) {
+        return 0;
+    }
+    if (reinterpret_cast<uintptr_t>(image) % this->formatAlignment() != 0) {
+        void* imageData = alloc->makeBytesAlignedTo(size, this->formatAlignment());
+        memcpy(imageData, image, size);
+        this->installImage(imageData);
+        return size;
+    }
+    // Images are never written through a glyph, so the read-only memory can be used.
+    this->installImage(const_cast<void*>(image));
+    return 0;
+}
+
 void SkGlyph::flattenPath(SkWriteBuffer& buffer) const {
     SkASSERT(this->setPathHasBeenCalled());
 
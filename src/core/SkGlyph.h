@@ -36,6 +36,8 @@ class SkCanvas;
 class SkGlyph;
 class SkReadBuffer;
 class SkScalerContext;
+class SkSharedGlyphImageWriter;
+class SkSharedGlyphLease;
 class SkWriteBuffer;
 namespace sktext {
 class StrikeForGPU;
@@ -534,11 +536,21 @@ public:
     // Flatten the metrics portions, but no drawing data.
     void flattenMetrics(SkWriteBuffer&) const;
 
-    // Flatten just the the mask data.
-    void flattenImage(SkWriteBuffer&) const;
-
-    // Read the image data, store it in the alloc, and add it to the glyph.
-    size_t addImageFromBuffer(SkReadBuffer&, SkArenaAlloc*);
+    // Flatten just the the mask data. If sharedImages is not null, the image is copied into it,
+    // and only its offset is flattened.
+    void flattenImage(SkWriteBuffer&, SkSharedGlyphImageWriter* sharedImages = nullptr) const;
+
+    // Read the image data, store it in the alloc, and add it to the glyph. If the image was
+    // flattened into shared memory, sharedImages is the lease on it, and the image is copied from
+    // there. Returns the bytes allocated.
+    size_t addImageFromBuffer(SkReadBuffer&,
+                              SkArenaAlloc*,
+                              const SkSharedGlyphLease* sharedImages = nullptr);
+
+    // Like addImageFromBuffer, but use the image where it is in the buffer, whose memory must
+    // outlive the glyph. The image is only copied to the alloc if it is misaligned for its format.
+    // Returns the bytes allocated.
+    size_t addImageInPlaceFromBuffer(SkReadBuffer&, SkArenaAlloc*);
 
     // Flatten just the path data.
     void flattenPath(SkWriteBuffer&) const;
@@ -130,6 +130,19 @@ prepare_for_direct_mask_drawing(SkStrike* strike,
     SkMatrix positionMatrixWithRounding = creationMatrix;
     positionMatrixWithRounding.postTranslate(halfSampleFreq.x(), halfSampleFreq.y());
 
+    SkExecutor* executor = SkStrike::GetImageExecutor();
+    if (executor != nullptr && strike->canPrefillImages()) {
+        // Generate the missing images in parallel before they are needed under the lock.
+        skia_private::STArray<64, SkPackedGlyphID> packedGlyphIDs;
+        for (auto [glyphID, pos] : source) {
+            if (SkIsFinite(pos.x(), pos.y())) {
+                packedGlyphIDs.push_back(SkPackedGlyphID{
+                        glyphID, positionMatrixWithRounding.mapPoint(pos), mask});
+            }
+        }
+        strike->prefillImages(packedGlyphIDs, executor);
+    }
+
     int acceptedSize = 0;
     int rejectedSize = 0;
     strike->lock();
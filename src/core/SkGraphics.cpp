@@ -10,12 +10,16 @@
 #include "src/core/SkBitmapProcState.h"
 #include "src/core/SkBlitMask.h"
 #include "src/core/SkBlitRow.h"
+#include "src/core/SkCoreBlitters.h"
 #include "src/core/SkCpu.h"
 #include "src/core/SkImageFilter_Base.h"
 #include "src/core/SkMemset.h"
 #include "src/core/SkOpts.h"
 #include "src/core/SkResourceCache.h"
+#include "src/core/SkScan.h"
+#include "src/core/SkStrike.h"
 #include "src/core/SkStrikeCache.h"
+#include "src/core/SkStrikeDiskCache.h"
 #include "src/core/SkSwizzlePriv.h"
 #include "src/core/SkTypefaceCache.h"
 
@@ -41,6 +45,7 @@ void SkGraphics::PurgeAllCaches() {
     SkGraphics::PurgeFontCache();
     SkGraphics::PurgeResourceCache();
     SkImageFilter_Base::PurgeCache();
+    SkGraphics::PurgeRasterPipelineBlitterCache();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -69,6 +74,15 @@ int SkGraphics::GetFontCacheCountUsed() {
     return SkStrikeCache::GlobalStrikeCache()->getCacheCountUsed();
 }
 
+void SkGraphics::SetFontCacheDirectory(const char* path) {
+    SkStrikeCache::GlobalStrikeCache()->setDiskCache(
+            path != nullptr ? sk_make_sp<SkStrikeDiskCache>(path) : nullptr);
+}
+
+void SkGraphics::WriteFontCacheToDirectory() {
+    SkStrikeCache::GlobalStrikeCache()->writeToDiskCache();
+}
+
 void SkGraphics::PurgeFontCache() {
     SkStrikeCache::GlobalStrikeCache()->purgeAll();
     SkTypefaceCache::PurgeAll();
@@ -90,6 +104,50 @@ int SkGraphics::SetTypefaceCacheCountLimit(int count) {
     return prev;
 }
 
+int SkGraphics::GetRasterPipelineBlitterCacheCountUsed() {
+    return SkRasterPipelineBlitterCache::GetCountUsed();
+}
+
+int SkGraphics::GetRasterPipelineBlitterCacheCountLimit() {
+    return SkRasterPipelineBlitterCache::GetCountLimit();
+}
+
+int SkGraphics::SetRasterPipelineBlitterCacheCountLimit(int count) {
+    return SkRasterPipelineBlitterCache::SetCountLimit(count);
+}
+
+int64_t SkGraphics::GetRasterPipelineBlitterCacheHitCount() {
+    return SkRasterPipelineBlitterCache::GetHitCount();
+}
+
+int64_t SkGraphics::GetRasterPipelineBlitterCacheMissCount() {
+    return SkRasterPipelineBlitterCache::GetMissCount();
+}
+
+void SkGraphics::PurgeRasterPipelineBlitterCache() {
+    SkRasterPipelineBlitterCache::PurgeAll();
+}
+
+SkExecutor* SkGraphics::SetPathFillExecutor(SkExecutor* executor) {
+    SkExecutor* old = SkScan::GetAAAPathExecutor();
+    SkScan::SetAAAPathExecutor(executor);
+    return old;
+}
+
+SkExecutor* SkGraphics::GetPathFillExecutor() {
+    return SkScan::GetAAAPathExecutor();
+}
+
+SkExecutor* SkGraphics::SetGlyphImageExecutor(SkExecutor* executor) {
+    SkExecutor* old = SkStrike::GetImageExecutor();
+    SkStrike::SetImageExecutor(executor);
+    return old;
+}
+
+SkExecutor* SkGraphics::GetGlyphImageExecutor() {
+    return SkStrike::GetImageExecutor();
+}
+
 static SkGraphics::OpenTypeSVGDecoderFactory gSVGDecoderFactory = nullptr;
 
 SkGraphics::OpenTypeSVGDecoderFactory
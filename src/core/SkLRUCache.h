@@ -84,6 +84,31 @@ public:
         return fMap.count();
     }
 
+    int maxCount() const {
+        return fMaxCount;
+    }
+
+    // Evicts the least recently used entries until count() <= maxCount.
+    void setMaxCount(int maxCount) {
+        fMaxCount = maxCount;
+        while (fMap.count() > fMaxCount) {
+            this->remove(fLRU.tail()->fKey);
+        }
+    }
+
+    // Returns the least recently used value without marking it as used, or nullptr if empty.
+    V* peekLRU() {
+        Entry* tail = fLRU.tail();
+        return tail ? &tail->fValue : nullptr;
+    }
+
+    // Evicts the least recently used entry, if any.
+    void removeLRU() {
+        if (Entry* tail = fLRU.tail()) {
+            this->remove(tail->fKey);
+        }
+    }
+
     template <typename Fn>  // f(K*, V*)
     void foreach(Fn&& fn) {
         typename SkTInternalLList<Entry>::Iter iter;
@@ -7,13 +7,17 @@
 
 #include "include/core/SkPicture.h"
 
+#include "include/core/SkCanvas.h"
 #include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkMatrix.h"
 #include "include/core/SkPictureRecorder.h"
 #include "include/core/SkSerialProcs.h"
 #include "include/core/SkStream.h"
 #include "include/private/base/SkTFitsIn.h"
 #include "include/private/base/SkTo.h"
 #include "src/base/SkMathPriv.h"
+#include "src/core/SkBigPicture.h"
 #include "src/core/SkCanvasPriv.h"
 #include "src/core/SkPictureData.h"
 #include "src/core/SkPicturePlayback.h"
@@ -22,6 +26,7 @@
 #include "src/core/SkReadBuffer.h"
 #include "src/core/SkResourceCache.h"
 #include "src/core/SkStreamPriv.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/core/SkWriteBuffer.h"
 
 #include <atomic>
@@ -55,6 +60,66 @@ SkPicture::~SkPicture() {
     }
 }
 
+void SkPicture::playbackParallel(const TileCanvasFactory& tileCanvas,
+                                 SkISize tileSize,
+                                 SkExecutor* executor,
+                                 const SkMatrix* matrix) const {
+    const SkMatrix& ctm = matrix ? *matrix : SkMatrix::I();
+    const SkIRect bounds = ctm.mapRect(this->cullRect()).roundOut();
+    if (bounds.isEmpty() || tileSize.isEmpty()) {
+        return;
+    }
+    const int64_t cols64 = (bounds.width64()  + tileSize.width()  - 1) / tileSize.width(),
+                  rows64 = (bounds.height64() + tileSize.height() - 1) / tileSize.height();
+    if (!SkTFitsIn<int>(cols64 * rows64)) {
+        return;
+    }
+    const int cols = SkToInt(cols64),
+              rows = SkToInt(rows64);
+
+    // Each tile queries a BBH with its own bounds, so only the ops that touch it are visited.
+    // Pictures recorded without a BBH (including all deserialized ones) get a temporary one.
+    const SkBigPicture* big = this->asSkBigPicture();
+    sk_sp<const SkBBoxHierarchy> bbh;
+    if (big && cols * rows > 1) {
+        bbh = big->refOrMakeBBH();
+    }
+
+    auto playTile = [&](int i) {
+        const SkIRect tile = SkIRect::MakeXYWH(bounds.fLeft + (i % cols) * tileSize.width(),
+                                               bounds.fTop  + (i / cols) * tileSize.height(),
+                                               tileSize.width(),
+                                               tileSize.height());
+        SkIRect tileBounds;
+        if (!tileBounds.intersect(tile, bounds)) {
+            return;
+        }
+        SkCanvas* canvas = tileCanvas(i, tileBounds);
+        if (!canvas) {
+            return;
+        }
+        SkAutoCanvasRestore acr(canvas, true);
+        canvas->translate(-tileBounds.fLeft, -tileBounds.fTop);
+        canvas->clipIRect(tileBounds);
+        canvas->concat(ctm);
+        if (bbh) {
+            big->playbackWithBBH(canvas, bbh.get());
+        } else {
+            this->playback(canvas);
+        }
+    };
+
+    if (!executor) {
+        for (int i = 0; i < cols * rows; ++i) {
+            playTile(i);
+        }
+        return;
+    }
+    SkTaskGroup tasks(*executor);
+    tasks.batch(cols * rows, playTile);
+    tasks.wait();
+}
+
 static const char kMagic[] = { 's', 'k', 'i', 'a', 'p', 'i', 'c', 't' };
 
 SkPictInfo SkPicture::createHeader() const {
@@ -11,6 +11,8 @@
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkMatrix.h"
 #include "include/private/base/SkDebug.h"
+#include "include/private/base/SkMutex.h"
+#include "include/private/base/SkThreadAnnotations.h"
 #include "include/private/base/SkTemplates.h"
 #include "modules/skcms/skcms.h"
 #include "src/base/SkVx.h"
@@ -18,15 +20,86 @@
 #include "src/core/SkOpts.h"
 #include "src/core/SkRasterPipelineOpContexts.h"
 #include "src/core/SkRasterPipelineOpList.h"
+#include "src/core/SkTHash.h"
+#include "src/core/SkTraceEvent.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <iterator>
 #include <vector>
 
 using namespace skia_private;
 using Op = SkRasterPipelineOp;
 
 bool gForceHighPrecisionRasterPipeline;
+bool gDisableRasterPipelineFusion;
+bool gRecordRasterPipelineUnfusedRuns;
+
+namespace {
+// A run of stages that is replaced by a single fused stage when a program is built. Every stage
+// in the run must have either no context or the same context as the others; the fused stage
+// receives that shared context. Each fused op has both lowp and highp implementations.
+struct FusedStage {
+    Op  fused;
+    int count;
+    Op  run[3];  // in pipeline order
+};
+
+constexpr FusedStage kFusedStages[] = {
+    // Image and gradient shaders start with the device coordinates and their local matrix.
+    {Op::seed_shader_matrix_translate,       2, {Op::seed_shader, Op::matrix_translate}},
+    {Op::seed_shader_matrix_scale_translate, 2, {Op::seed_shader, Op::matrix_scale_translate}},
+    {Op::seed_shader_matrix_2x3,             2, {Op::seed_shader, Op::matrix_2x3}},
+
+    // srcover into 8888, when srcover_rgba_8888 can't be used (e.g. with coverage or dither).
+    {Op::load_8888_dst_srcover_store_8888,   3, {Op::load_8888_dst, Op::srcover, Op::store_8888}},
+};
+
+std::atomic<int64_t> gFusedStageCounts[std::size(kFusedStages)];
+std::atomic<int64_t> gFusedPrograms{0};
+std::atomic<int64_t> gUnfusedPrograms{0};
+
+// Counts of the runs of two or three adjacent unfused stages, keyed by pack_unfused_run().
+struct UnfusedRunCounts {
+    SkMutex mutex;
+    THashMap<uint64_t, int64_t> counts SK_GUARDED_BY(mutex);
+};
+
+UnfusedRunCounts& unfused_run_counts() {
+    static UnfusedRunCounts* counts = new UnfusedRunCounts;
+    return *counts;
+}
+
+// Packs a run of up to three ops, 16 bits apiece. Unused entries are -1, and pack as zero.
+constexpr uint64_t pack_unfused_run(int a, int b, int c) {
+    return (uint64_t)(a + 1) | (uint64_t)(b + 1) << 16 | (uint64_t)(c + 1) << 32;
+}
+static_assert(kNumRasterPipelineHighpOps < 0xffff);
+
+// Returns the index in kFusedStages of the run that ends at `st`, or -1 if there isn't one.
+int match_fused_stage(const SkRasterPipeline::StageList* st, void** ctx) {
+    for (int i = 0; i < (int)std::size(kFusedStages); ++i) {
+        const FusedStage& fused = kFusedStages[i];
+        const SkRasterPipeline::StageList* s = st;
+        void* runCtx = nullptr;
+        int j = fused.count - 1;
+        for (; j >= 0 && s && s->stage == fused.run[j]; --j, s = s->prev) {
+            if (s->ctx) {
+                if (runCtx && runCtx != s->ctx) {
+                    break;
+                }
+                runCtx = s->ctx;
+            }
+        }
+        if (j < 0) {
+            *ctx = runCtx;
+            return i;
+        }
+    }
+    return -1;
+}
+}  // namespace
 
 SkRasterPipeline::SkRasterPipeline(SkArenaAlloc* alloc) : fAlloc(alloc) {
     this->reset();
@@ -53,6 +126,8 @@ void SkRasterPipeline::append(SkRasterPipelineOp op, void* ctx) {
     SkASSERT(op != Op::HLGinvish);                // Please use appendTransferFunction().
     SkASSERT(op != Op::stack_checkpoint);         // Please use appendStackRewind().
     SkASSERT(op != Op::stack_rewind);             // Please use appendStackRewind().
+    SkASSERT(std::none_of(std::begin(kFusedStages), std::end(kFusedStages),
+                          [&](const FusedStage& f) { return f.fused == op; }));
     this->uncheckedAppend(op, ctx);
 }
 
@@ -550,31 +625,76 @@ static void prepend_to_pipeline(SkRasterPipelineStage*& ip, SkOpts::StageFn stag
     ip->ctx = ctx;
 }
 
-bool SkRasterPipeline::buildLowpPipeline(SkRasterPipelineStage* ip) const {
+// Prepends every stage in the list (which is stored backwards), fusing runs of stages found in
+// kFusedStages.
+static void prepend_stages(SkRasterPipelineStage*& ip,
+                           const SkRasterPipeline::StageList* st,
+                           const SkOpts::StageFn ops[]) {
+    // With gRecordRasterPipelineUnfusedRuns, the unfused runs this program is built with. The
+    // stages are visited back to front, so `next` and `nextNext` are the unfused stages that
+    // follow `st`, or -1 if a fused stage or the end of the program comes first.
+    const bool recordUnfusedRuns = gRecordRasterPipelineUnfusedRuns;
+    STArray<32, uint64_t> unfusedRuns;
+    int next = -1, nextNext = -1;
+
+    while (st) {
+        void* ctx;
+        int fusedIndex = gDisableRasterPipelineFusion ? -1 : match_fused_stage(st, &ctx);
+        if (fusedIndex < 0) {
+            prepend_to_pipeline(ip, ops[(int)st->stage], st->ctx);
+            if (recordUnfusedRuns) {
+                if (next >= 0) {
+                    unfusedRuns.push_back(pack_unfused_run((int)st->stage, next, -1));
+                }
+                if (nextNext >= 0) {
+                    unfusedRuns.push_back(pack_unfused_run((int)st->stage, next, nextNext));
+                }
+                nextNext = next;
+                next = (int)st->stage;
+            }
+            st = st->prev;
+            continue;
+        }
+        const FusedStage& fused = kFusedStages[fusedIndex];
+        prepend_to_pipeline(ip, ops[(int)fused.fused], ctx);
+        gFusedStageCounts[fusedIndex].fetch_add(1, std::memory_order_relaxed);
+        for (int i = 0; i < fused.count; ++i) {
+            st = st->prev;
+        }
+        next = nextNext = -1;
+    }
+
+    if (!unfusedRuns.empty()) {
+        UnfusedRunCounts& counts = unfused_run_counts();
+        SkAutoMutexExclusive lock(counts.mutex);
+        for (uint64_t run : unfusedRuns) {
+            counts.counts[run]++;
+        }
+    }
+}
+
+bool SkRasterPipeline::buildLowpPipeline(SkRasterPipelineStage*& ip) const {
     if (gForceHighPrecisionRasterPipeline || fRewindCtx) {
         return false;
     }
-    // Stages are stored backwards in fStages; to compensate, we assemble the pipeline in reverse
-    // here, back to front.
-    prepend_to_pipeline(ip, SkOpts::just_return_lowp, /*ctx=*/nullptr);
     for (const StageList* st = fStages; st; st = st->prev) {
         int opIndex = (int)st->stage;
         if (opIndex >= kNumRasterPipelineLowpOps || !SkOpts::ops_lowp[opIndex]) {
             // This program contains a stage that doesn't exist in lowp.
             return false;
         }
-        prepend_to_pipeline(ip, SkOpts::ops_lowp[opIndex], st->ctx);
     }
+    // Stages are stored backwards in fStages; to compensate, we assemble the pipeline in reverse
+    // here, back to front.
+    prepend_to_pipeline(ip, SkOpts::just_return_lowp, /*ctx=*/nullptr);
+    prepend_stages(ip, fStages, SkOpts::ops_lowp);
     return true;
 }
 
-void SkRasterPipeline::buildHighpPipeline(SkRasterPipelineStage* ip) const {
+void SkRasterPipeline::buildHighpPipeline(SkRasterPipelineStage*& ip) const {
     // We assemble the pipeline in reverse, since the stage list is stored backwards.
     prepend_to_pipeline(ip, SkOpts::just_return_highp, /*ctx=*/nullptr);
-    for (const StageList* st = fStages; st; st = st->prev) {
-        int opIndex = (int)st->stage;
-        prepend_to_pipeline(ip, SkOpts::ops_highp[opIndex], st->ctx);
-    }
+    prepend_stages(ip, fStages, SkOpts::ops_highp);
 
     // stack_checkpoint and stack_rewind are only implemented in highp. We only need these stages
     // when generating long (or looping) pipelines from SkSL. The other stages used by the SkSL
@@ -586,14 +706,25 @@ void SkRasterPipeline::buildHighpPipeline(SkRasterPipelineStage* ip) const {
     }
 }
 
-SkRasterPipeline::StartPipelineFn SkRasterPipeline::buildPipeline(SkRasterPipelineStage* ip) const {
+SkRasterPipeline::StartPipelineFn SkRasterPipeline::buildPipeline(
+        SkRasterPipelineStage*& ip) const {
+    SkRasterPipelineStage* end = ip;
+    StartPipelineFn start_pipeline;
+
     // We try to build a lowp pipeline first; if that fails, we fall back to a highp float pipeline.
     if (this->buildLowpPipeline(ip)) {
-        return SkOpts::start_pipeline_lowp;
+        start_pipeline = SkOpts::start_pipeline_lowp;
+    } else {
+        this->buildHighpPipeline(ip);
+        start_pipeline = SkOpts::start_pipeline_highp;
     }
 
-    this->buildHighpPipeline(ip);
-    return SkOpts::start_pipeline_highp;
+    if (end - ip < this->stagesNeeded()) {
+        gFusedPrograms.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        gUnfusedPrograms.fetch_add(1, std::memory_order_relaxed);
+    }
+    return start_pipeline;
 }
 
 int SkRasterPipeline::stagesNeeded() const {
@@ -625,8 +756,10 @@ void SkRasterPipeline::run(size_t x, size_t y, size_t w, size_t h) const {
         memset(patches[i].scratch, 0, sizeof(patches[i].scratch));
     }
 
-    auto start_pipeline = this->buildPipeline(program.get() + stagesNeeded);
-    start_pipeline(x, y, x + w, y + h, program.get(),
+    // Fused stages may leave the front of `program` unused; `ip` is where the program starts.
+    SkRasterPipelineStage* ip = program.get() + stagesNeeded;
+    auto start_pipeline = this->buildPipeline(ip);
+    start_pipeline(x, y, x + w, y + h, ip,
                    SkSpan{patches.data(), numMemoryCtxs},
                    fTailPointer);
 }
@@ -650,14 +783,113 @@ std::function<void(size_t, size_t, size_t, size_t)> SkRasterPipeline::compile()
     }
     uint8_t* tailPointer = fTailPointer;
 
-    auto start_pipeline = this->buildPipeline(program + stagesNeeded);
+    SkRasterPipelineStage* ip = program + stagesNeeded;
+    auto start_pipeline = this->buildPipeline(ip);
+    TRACE_EVENT_INSTANT2("skia", "SkRasterPipeline::compile", TRACE_EVENT_SCOPE_THREAD,
+                         "stages", stagesNeeded, "fusedStages", (int)(program + stagesNeeded - ip));
     return [=](size_t x, size_t y, size_t w, size_t h) {
-        start_pipeline(x, y, x + w, y + h, program,
+        start_pipeline(x, y, x + w, y + h, ip,
                        SkSpan{patches, numMemoryCtxs},
                        tailPointer);
     };
 }
 
+SkRasterPipeline::Program SkRasterPipeline::build() const {
+    SkASSERT(!this->empty());
+    SkASSERT(!fRewindCtx && !fTailPointer);
+
+    int stagesNeeded = this->stagesNeeded();
+    SkRasterPipelineStage* program = fAlloc->makeArray<SkRasterPipelineStage>(stagesNeeded);
+    SkRasterPipelineStage* ip = program + stagesNeeded;
+    StartPipelineFn start_pipeline = this->buildPipeline(ip);
+
+    int numMemoryCtxs = fMemoryCtxInfos.size();
+    SkRasterPipeline_MemoryCtxInfo* infos =
+            fAlloc->makeArrayDefault<SkRasterPipeline_MemoryCtxInfo>(numMemoryCtxs);
+    std::copy(fMemoryCtxInfos.begin(), fMemoryCtxInfos.end(), infos);
+
+    return {start_pipeline, ip, (int)(program + stagesNeeded - ip), infos, numMemoryCtxs};
+}
+
+std::function<void(size_t, size_t, size_t, size_t)> SkRasterPipeline::Relocate(
+        const Program& src, const void* from, void* to, size_t size, SkArenaAlloc* alloc) {
+    auto relocate = [=](void* ctx) -> void* {
+        // Pointers below `from` wrap around to huge offsets, so one compare covers both ends.
+        uintptr_t offset = (uintptr_t)ctx - (uintptr_t)from;
+        return offset < size ? SkTAddOffset<void>(to, offset) : ctx;
+    };
+
+    SkRasterPipelineStage* program = alloc->makeArray<SkRasterPipelineStage>(src.numStages);
+    for (int i = 0; i < src.numStages; ++i) {
+        program[i].fn  = src.stages[i].fn;
+        program[i].ctx = relocate(src.stages[i].ctx);
+    }
+
+    int numMemoryCtxs = src.numMemoryCtxs;
+    SkRasterPipeline_MemoryCtxPatch* patches =
+            alloc->makeArray<SkRasterPipeline_MemoryCtxPatch>(numMemoryCtxs);
+    for (int i = 0; i < numMemoryCtxs; ++i) {
+        patches[i].info = src.memoryCtxInfos[i];
+        patches[i].info.context =
+                static_cast<SkRasterPipeline_MemoryCtx*>(relocate(patches[i].info.context));
+        patches[i].backup = nullptr;
+        memset(patches[i].scratch, 0, sizeof(patches[i].scratch));
+    }
+
+    auto start_pipeline = src.start;
+    return [=](size_t x, size_t y, size_t w, size_t h) {
+        start_pipeline(x, y, x + w, y + h, program,
+                       SkSpan{patches, numMemoryCtxs},
+                       /*tailPointer=*/nullptr);
+    };
+}
+
+SkRasterPipeline::FusionStats SkRasterPipeline::GetFusionStats() {
+    FusionStats stats;
+    stats.fusedPrograms = gFusedPrograms.load(std::memory_order_relaxed);
+    stats.unfusedPrograms = gUnfusedPrograms.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < std::size(kFusedStages); ++i) {
+        stats.fusedStages.push_back({GetOpName(kFusedStages[i].fused),
+                                     gFusedStageCounts[i].load(std::memory_order_relaxed)});
+    }
+
+    UnfusedRunCounts& counts = unfused_run_counts();
+    {
+        SkAutoMutexExclusive lock(counts.mutex);
+        counts.counts.foreach([&](uint64_t run, int64_t uses) {
+            FusionStats::UnfusedRun& unfused = stats.unfusedRuns.push_back();
+            unfused.count = 0;
+            for (; unfused.count < 3 && (run & 0xffff); ++unfused.count, run >>= 16) {
+                unfused.stages[unfused.count] = (Op)((run & 0xffff) - 1);
+            }
+            unfused.uses = uses;
+        });
+    }
+    std::sort(stats.unfusedRuns.begin(), stats.unfusedRuns.end(),
+              [](const FusionStats::UnfusedRun& a, const FusionStats::UnfusedRun& b) {
+                  if (a.uses != b.uses) {
+                      return a.uses > b.uses;
+                  }
+                  if (a.count != b.count) {
+                      return a.count < b.count;
+                  }
+                  return std::lexicographical_compare(a.stages, a.stages + a.count,
+                                                      b.stages, b.stages + b.count);
+              });
+    return stats;
+}
+
+void SkRasterPipeline::ResetFusionStats() {
+    gFusedPrograms.store(0, std::memory_order_relaxed);
+    gUnfusedPrograms.store(0, std::memory_order_relaxed);
+    for (std::atomic<int64_t>& count : gFusedStageCounts) {
+        count.store(0, std::memory_order_relaxed);
+    }
+    UnfusedRunCounts& counts = unfused_run_counts();
+    SkAutoMutexExclusive lock(counts.mutex);
+    counts.counts.reset();
+}
+
 void SkRasterPipeline::addMemoryContext(SkRasterPipeline_MemoryCtx* ctx,
                                         int bytesPerPixel,
                                         bool load,
@@ -19,6 +19,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <utility>
 
 class SkMatrix;
 enum class SkRasterPipelineOp;
@@ -90,6 +91,33 @@ public:
     // Allocates a thunk which amortizes run() setup cost in alloc.
     std::function<void(size_t, size_t, size_t, size_t)> compile() const;
 
+    using StartPipelineFn = void (*)(size_t, size_t, size_t, size_t,
+                                     SkRasterPipelineStage* program,
+                                     SkSpan<SkRasterPipeline_MemoryCtxPatch>,
+                                     uint8_t*);
+
+    // A built program, allocated in the pipeline's alloc. Unlike compile(), this keeps the
+    // program's stages visible, so that it can be copied with some of its contexts moved
+    // (see Relocate()). Pipelines that rewind the stack or use the tail pointer keep mutable
+    // state in the program, and can't be built this way.
+    struct Program {
+        StartPipelineFn                       start;
+        const SkRasterPipelineStage*          stages;
+        int                                   numStages;
+        const SkRasterPipeline_MemoryCtxInfo* memoryCtxInfos;
+        int                                   numMemoryCtxs;
+    };
+    Program build() const;
+
+    // Copies `program` into `alloc`, moving every stage context and memory context that points
+    // into the `size` bytes at `from` to the same offset in the `size` bytes at `to`. Returns a
+    // thunk that runs the copy, like compile().
+    static std::function<void(size_t, size_t, size_t, size_t)> Relocate(const Program&,
+                                                                        const void* from,
+                                                                        void* to,
+                                                                        size_t size,
+                                                                        SkArenaAlloc*);
+
     // Callers can inspect the stage list for debugging purposes.
     struct StageList {
         StageList*          prev;
@@ -135,15 +163,39 @@ public:
 
     bool empty() const { return fStages == nullptr; }
 
+    // When a program is built by run() or compile(), common runs of stages are replaced by a
+    // single fused stage that does the same work with fewer stage calls. These process-wide
+    // counters report how often that happened, to help decide which runs are worth fusing.
+    // Set gDisableRasterPipelineFusion to turn fusion off.
+    //
+    // Set gRecordRasterPipelineUnfusedRuns to also count the runs of stages that were built
+    // without being fused. Those counts take a lock per program, so they are off by default.
+    struct FusionStats {
+        int64_t fusedPrograms = 0;    // programs built with at least one fused stage
+        int64_t unfusedPrograms = 0;  // programs built without any
+        // How many times each fused stage was used, keyed by op name.
+        skia_private::TArray<std::pair<const char*, int64_t>> fusedStages;
+
+        // A run of two or three adjacent stages that were not fused, and how many programs
+        // were built with it. The most common runs are candidates for new fused stages.
+        struct UnfusedRun {
+            SkRasterPipelineOp stages[3];  // in pipeline order
+            int count;                     // how many of `stages` are used
+            int64_t uses;
+        };
+        // Only filled in while gRecordRasterPipelineUnfusedRuns is set. Most used first.
+        skia_private::TArray<UnfusedRun> unfusedRuns;
+    };
+    static FusionStats GetFusionStats();
+    static void ResetFusionStats();
+
 private:
-    bool buildLowpPipeline(SkRasterPipelineStage* ip) const;
-    void buildHighpPipeline(SkRasterPipelineStage* ip) const;
+    bool buildLowpPipeline(SkRasterPipelineStage*& ip) const;
+    void buildHighpPipeline(SkRasterPipelineStage*& ip) const;
 
-    using StartPipelineFn = void (*)(size_t, size_t, size_t, size_t,
-                                     SkRasterPipelineStage* program,
-                                     SkSpan<SkRasterPipeline_MemoryCtxPatch>,
-                                     uint8_t*);
-    StartPipelineFn buildPipeline(SkRasterPipelineStage*) const;
+    // Builds the program backwards from `ip`, the end of a buffer of stagesNeeded() stages, and
+    // leaves `ip` pointing to the start of the program.
+    StartPipelineFn buildPipeline(SkRasterPipelineStage*& ip) const;
 
     void uncheckedAppend(SkRasterPipelineOp, void*);
     int stagesNeeded() const;
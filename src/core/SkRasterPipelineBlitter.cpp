@@ -9,6 +9,7 @@
 #include "include/core/SkBlendMode.h"
 #include "include/core/SkBlender.h"
 #include "include/core/SkColor.h"
+#include "include/core/SkColorSpace.h"
 #include "include/core/SkColorType.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkMatrix.h"
@@ -19,14 +20,20 @@
 #include "include/core/SkSurfaceProps.h"
 #include "include/private/base/SkAssert.h"
 #include "include/private/base/SkCPUTypes.h"
+#include "include/private/base/SkMutex.h"
 #include "include/private/base/SkTemplates.h"
+#include "include/private/base/SkThreadAnnotations.h"
+#include "include/private/base/SkTo.h"
 #include "src/base/SkArenaAlloc.h"
 #include "src/core/SkBlendModePriv.h"
 #include "src/core/SkBlenderBase.h"
 #include "src/core/SkBlitter.h"
+#include "src/core/SkChecksum.h"
 #include "src/core/SkColorSpacePriv.h"
 #include "src/core/SkColorSpaceXformSteps.h"
+#include "src/core/SkCoreBlitters.h"
 #include "src/core/SkEffectPriv.h"
+#include "src/core/SkLRUCache.h"
 #include "src/core/SkMask.h"
 #include "src/core/SkMemset.h"
 #include "src/core/SkRasterPipeline.h"
@@ -35,14 +42,17 @@
 #include "src/effects/colorfilters/SkColorFilterBase.h"
 #include "src/shaders/SkShaderBase.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <functional>
 #include <optional>
 #include <utility>
 
-class SkColorSpace;
+class SkColorFilter;
 class SkShader;
+struct CachedBlitter;
 
 class SkRasterPipelineBlitter final : public SkBlitter {
 public:
@@ -56,6 +66,24 @@ public:
                              bool is_constant,
                              const SkShader* clipShader);
 
+    // Creates a blitter that shares the programs of a cached one (see CachedBlitter).
+    static SkBlitter* CreateFromCache(const SkPixmap& dst,
+                                      SkArenaAlloc* alloc,
+                                      sk_sp<CachedBlitter> cached);
+
+    // The blit programs, each built lazily on first use.
+    enum ProgramKind {
+        kRect,
+        kAntiH,
+        kMaskA8,
+        kMaskLCD16,
+        kMask3D,
+        kProgramKindCount,
+    };
+
+    // Appends the stages of one of the blit programs.
+    void appendProgram(ProgramKind, SkRasterPipeline*) const;
+
     SkRasterPipelineBlitter(SkPixmap dst,
                             SkArenaAlloc* alloc)
         : fDst(std::move(dst))
@@ -68,11 +96,15 @@ public:
     void blitAntiH (int x, int y, const SkAlpha[], const int16_t[]) override;
     void blitAntiH2(int x, int y, U8CPU a0, U8CPU a1)               override;
     void blitAntiV2(int x, int y, U8CPU a0, U8CPU a1)               override;
+    void blitAnti1 (int x, int y, U8CPU a)                          override;
     void blitMask  (const SkMask&, const SkIRect& clip)             override;
     void blitRect  (int x, int y, int width, int height)            override;
     void blitV     (int x, int y, int height, SkAlpha alpha)        override;
 
 private:
+    using Thunk = std::function<void(size_t, size_t, size_t, size_t)>;
+    const Thunk& program(ProgramKind);
+
     void blitRectWithTrace(int x, int y, int w, int h, bool trace);
     void appendLoadDst      (SkRasterPipeline*) const;
     void appendStore        (SkRasterPipeline*) const;
@@ -99,12 +131,11 @@ private:
     void   (*fMemset2D)(SkPixmap*, int x,int y, int w,int h, uint64_t color) = nullptr;
     uint64_t fMemsetColor = 0;   // Big enough for largest memsettable dst format, F16.
 
-    // Built lazily on first use.
-    std::function<void(size_t, size_t, size_t, size_t)> fBlitRect,
-                                                        fBlitAntiH,
-                                                        fBlitMaskA8,
-                                                        fBlitMaskLCD16,
-                                                        fBlitMask3D;
+    // Built lazily on first use, indexed by ProgramKind.
+    Thunk fPrograms[kProgramKindCount];
+
+    // If set, the programs are copied from here rather than built from our own pipelines.
+    sk_sp<CachedBlitter> fCached;
 
     // These values are pointed to by the blit pipelines above,
     // which allows us to adjust them from call to call.
@@ -114,6 +145,92 @@ private:
     using INHERITED = SkBlitter;
 };
 
+extern bool gForceHighPrecisionRasterPipeline;
+extern bool gDisableRasterPipelineFusion;
+
+// A blitter for a paint and destination that may be drawn with again. Paints that collapse to a
+// constant color (no shader or a constant one, any color filter, a blend mode) produce the same
+// blit programs every time, up to contexts that point into the blitter itself. So we keep a
+// prototype blitter, build its programs once, and give each later blitter a copy whose contexts
+// have been moved from the prototype to that blitter.
+struct CachedBlitter : public SkNVRefCnt<CachedBlitter> {
+    SkSTArenaAlloc<2048>     fAlloc;
+    // The cache key holds these by pointer; keeping them alive keeps the pointers unique.
+    sk_sp<SkShader>          fShader;
+    sk_sp<SkColorFilter>     fColorFilter;
+    SkRasterPipelineBlitter* fPrototype = nullptr;
+
+    SkMutex fProgramsMutex;
+    std::optional<SkRasterPipeline::Program>
+            fPrograms[SkRasterPipelineBlitter::kProgramKindCount] SK_GUARDED_BY(fProgramsMutex);
+};
+
+namespace {
+SK_BEGIN_REQUIRE_DENSE
+struct BlitterKey {
+    SkColor4f            color;
+    const SkShader*      shader;
+    const SkColorFilter* colorFilter;
+    uint64_t             colorSpaceHash;
+    uint8_t              colorType;
+    uint8_t              alphaType;
+    uint8_t              blendMode;
+    // The programs built depend on these globals too.
+    uint8_t              forceHighPrecision;
+    uint8_t              disableFusion;
+    uint8_t              padding[3] = {};
+
+    bool operator==(const BlitterKey& that) const {
+        return 0 == memcmp(this, &that, sizeof(BlitterKey));
+    }
+
+    struct Hash {
+        uint32_t operator()(const BlitterKey& key) const {
+            return SkChecksum::Hash32(&key, sizeof(BlitterKey));
+        }
+    };
+};
+SK_END_REQUIRE_DENSE
+
+struct BlitterCache {
+    SkMutex fMutex;
+    SkLRUCache<BlitterKey, sk_sp<CachedBlitter>, BlitterKey::Hash> fCache SK_GUARDED_BY(fMutex){
+            SkRasterPipelineBlitterCache::kDefaultCountLimit};
+    int64_t fHits   SK_GUARDED_BY(fMutex) = 0;
+    int64_t fMisses SK_GUARDED_BY(fMutex) = 0;
+    // Whether the count limit is above 0, so draws can skip the cache without locking.
+    std::atomic<bool> fEnabled{SkRasterPipelineBlitterCache::kDefaultCountLimit > 0};
+};
+
+BlitterCache* blitter_cache() {
+    static BlitterCache* cache = new BlitterCache;
+    return cache;
+}
+
+// Returns a key for the blitter if the paint collapses to a constant color, so that the blitter
+// can be shared with other draws.
+std::optional<BlitterKey> make_blitter_key(const SkPixmap& dst,
+                                           const SkPaint& paint,
+                                           const SkShader* clipShader) {
+    std::optional<SkBlendMode> blendMode = paint.asBlendMode();
+    const SkShader* shader = paint.getShader();
+    if (clipShader || !blendMode || (shader && !as_SB(shader)->isConstant())) {
+        return std::nullopt;
+    }
+    BlitterKey key;
+    key.color          = paint.getColor4f();
+    key.shader         = shader;
+    key.colorFilter    = paint.getColorFilter();
+    key.colorSpaceHash = dst.colorSpace() ? dst.colorSpace()->hash() : 0;
+    key.colorType      = SkToU8(dst.colorType());
+    key.alphaType      = SkToU8(dst.alphaType());
+    key.blendMode      = SkToU8(*blendMode);
+    key.forceHighPrecision = gForceHighPrecisionRasterPipeline;
+    key.disableFusion      = gDisableRasterPipelineFusion;
+    return key;
+}
+}  // namespace
+
 static SkColor4f paint_color_to_dst(const SkPaint& paint, const SkPixmap& dst) {
     SkColor4f paintColor = paint.getColor4f();
     SkColorSpaceXformSteps(sk_srgb_singleton(), kUnpremul_SkAlphaType,
@@ -121,12 +238,12 @@ static SkColor4f paint_color_to_dst(const SkPaint& paint, const SkPixmap& dst) {
     return paintColor;
 }
 
-SkBlitter* SkCreateRasterPipelineBlitter(const SkPixmap& dst,
-                                         const SkPaint& paint,
-                                         const SkMatrix& ctm,
-                                         SkArenaAlloc* alloc,
-                                         sk_sp<SkShader> clipShader,
-                                         const SkSurfaceProps& props) {
+static SkBlitter* create_blitter(const SkPixmap& dst,
+                                 const SkPaint& paint,
+                                 const SkMatrix& ctm,
+                                 SkArenaAlloc* alloc,
+                                 sk_sp<SkShader> clipShader,
+                                 const SkSurfaceProps& props) {
     SkColorSpace* dstCS = dst.colorSpace();
     SkColorType dstCT = dst.colorType();
     SkColor4f dstPaintColor = paint_color_to_dst(paint, dst);
@@ -160,6 +277,51 @@ SkBlitter* SkCreateRasterPipelineBlitter(const SkPixmap& dst,
     return nullptr;
 }
 
+SkBlitter* SkCreateRasterPipelineBlitter(const SkPixmap& dst,
+                                         const SkPaint& paint,
+                                         const SkMatrix& ctm,
+                                         SkArenaAlloc* alloc,
+                                         sk_sp<SkShader> clipShader,
+                                         const SkSurfaceProps& props) {
+    BlitterCache* cache = blitter_cache();
+    std::optional<BlitterKey> key;
+    if (cache->fEnabled.load(std::memory_order_relaxed)) {
+        key = make_blitter_key(dst, paint, clipShader.get());
+    }
+    if (key) {
+        sk_sp<CachedBlitter> cached;
+        {
+            SkAutoMutexExclusive lock(cache->fMutex);
+            if (sk_sp<CachedBlitter>* found = cache->fCache.find(*key)) {
+                cached = *found;
+                cache->fHits++;
+            } else {
+                cache->fMisses++;
+            }
+        }
+        if (!cached) {
+            // Build the prototype in the cache entry's alloc. Its pixels are never touched;
+            // blitters made from it write to their own dst.
+            cached = sk_make_sp<CachedBlitter>();
+            cached->fShader = paint.refShader();
+            cached->fColorFilter = paint.refColorFilter();
+            SkPixmap prototypeDst(dst.info(), nullptr, dst.rowBytes());
+            SkBlitter* prototype =
+                    create_blitter(prototypeDst, paint, ctm, &cached->fAlloc, nullptr, props);
+            cached->fPrototype = static_cast<SkRasterPipelineBlitter*>(prototype);
+            if (!prototype) {
+                return nullptr;
+            }
+            SkAutoMutexExclusive lock(cache->fMutex);
+            if (cache->fCache.maxCount() > 0) {
+                cache->fCache.insert_or_update(*key, cached);
+            }
+        }
+        return SkRasterPipelineBlitter::CreateFromCache(dst, alloc, std::move(cached));
+    }
+    return create_blitter(dst, paint, ctm, alloc, std::move(clipShader), props);
+}
+
 SkBlitter* SkCreateRasterPipelineBlitter(const SkPixmap& dst,
                                          const SkPaint& paint,
                                          const SkRasterPipeline& shaderPipeline,
@@ -358,6 +520,133 @@ SkBlitter* SkRasterPipelineBlitter::Create(const SkPixmap& dst,
     return blitter;
 }
 
+SkBlitter* SkRasterPipelineBlitter::CreateFromCache(const SkPixmap& dst,
+                                                    SkArenaAlloc* alloc,
+                                                    sk_sp<CachedBlitter> cached) {
+    const SkRasterPipelineBlitter* prototype = cached->fPrototype;
+    auto blitter = alloc->make<SkRasterPipelineBlitter>(dst, alloc);
+    blitter->fBlendMode   = prototype->fBlendMode;
+    blitter->fMemset2D    = prototype->fMemset2D;
+    blitter->fMemsetColor = prototype->fMemsetColor;
+    blitter->fDitherRate  = prototype->fDitherRate;
+    blitter->fDstPtr = SkRasterPipeline_MemoryCtx{
+        blitter->fDst.writable_addr(),
+        blitter->fDst.rowBytesAsPixels(),
+    };
+    blitter->fCached = std::move(cached);
+    return blitter;
+}
+
+const SkRasterPipelineBlitter::Thunk& SkRasterPipelineBlitter::program(ProgramKind kind) {
+    Thunk& thunk = fPrograms[kind];
+    if (thunk) {
+        return thunk;
+    }
+    if (fCached) {
+        // The cached programs point at the prototype's fields; ours are at the same offsets.
+        SkAutoMutexExclusive lock(fCached->fProgramsMutex);
+        std::optional<SkRasterPipeline::Program>& cachedProgram = fCached->fPrograms[kind];
+        if (!cachedProgram) {
+            SkRasterPipeline p(&fCached->fAlloc);
+            fCached->fPrototype->appendProgram(kind, &p);
+            cachedProgram = p.build();
+        }
+        thunk = SkRasterPipeline::Relocate(*cachedProgram, fCached->fPrototype, this,
+                                           sizeof(SkRasterPipelineBlitter), fAlloc);
+    } else {
+        SkRasterPipeline p(fAlloc);
+        this->appendProgram(kind, &p);
+        thunk = p.compile();
+    }
+    return thunk;
+}
+
+void SkRasterPipelineBlitter::appendProgram(ProgramKind kind, SkRasterPipeline* p) const {
+    p->extend(fColorPipeline);
+    if (kind == kMask3D) {
+        // This bit is where we differ from kMaskA8:
+        p->append(SkRasterPipelineOp::emboss, &fEmbossCtx);
+    }
+    p->appendClampIfNormalized(fDst.info());
+
+    switch (kind) {
+        case kRect:
+            if (fBlendMode == SkBlendMode::kSrcOver
+                    && (fDst.info().colorType() == kRGBA_8888_SkColorType ||
+                        fDst.info().colorType() == kBGRA_8888_SkColorType)
+                    && !fDst.colorSpace()
+                    && fDst.info().alphaType() != kUnpremul_SkAlphaType
+                    && fDitherRate == 0.0f) {
+                if (fDst.info().colorType() == kBGRA_8888_SkColorType) {
+                    p->append(SkRasterPipelineOp::swap_rb);
+                }
+                this->appendClipScale(p);
+                p->append(SkRasterPipelineOp::srcover_rgba_8888, &fDstPtr);
+                return;
+            }
+            if (fBlendMode != SkBlendMode::kSrc) {
+                this->appendLoadDst(p);
+                p->extend(fBlendPipeline);
+                this->appendClipLerp(p);
+            } else if (fClipShaderBuffer) {
+                this->appendLoadDst(p);
+                this->appendClipLerp(p);
+            }
+            break;
+
+        case kAntiH:
+            if (fBlendMode.has_value() &&
+                SkBlendMode_ShouldPreScaleCoverage(*fBlendMode, /*rgb_coverage=*/false)) {
+                p->append(SkRasterPipelineOp::scale_1_float, &fCurrentCoverage);
+                this->appendClipScale(p);
+                this->appendLoadDst(p);
+                p->extend(fBlendPipeline);
+            } else {
+                this->appendLoadDst(p);
+                p->extend(fBlendPipeline);
+                p->append(SkRasterPipelineOp::lerp_1_float, &fCurrentCoverage);
+                this->appendClipLerp(p);
+            }
+            break;
+
+        case kMaskA8:
+        case kMask3D:
+            if (fBlendMode.has_value() &&
+                SkBlendMode_ShouldPreScaleCoverage(*fBlendMode, /*rgb_coverage=*/false)) {
+                p->append(SkRasterPipelineOp::scale_u8, &fMaskPtr);
+                this->appendClipScale(p);
+                this->appendLoadDst(p);
+                p->extend(fBlendPipeline);
+            } else {
+                this->appendLoadDst(p);
+                p->extend(fBlendPipeline);
+                p->append(SkRasterPipelineOp::lerp_u8, &fMaskPtr);
+                this->appendClipLerp(p);
+            }
+            break;
+
+        case kMaskLCD16:
+            if (fBlendMode.has_value() &&
+                SkBlendMode_ShouldPreScaleCoverage(*fBlendMode, /*rgb_coverage=*/true)) {
+                // Somewhat unusually, scale_565 needs dst loaded first.
+                this->appendLoadDst(p);
+                p->append(SkRasterPipelineOp::scale_565, &fMaskPtr);
+                this->appendClipScale(p);
+                p->extend(fBlendPipeline);
+            } else {
+                this->appendLoadDst(p);
+                p->extend(fBlendPipeline);
+                p->append(SkRasterPipelineOp::lerp_565, &fMaskPtr);
+                this->appendClipLerp(p);
+            }
+            break;
+
+        case kProgramKindCount:
+            SkUNREACHABLE;
+    }
+    this->appendStore(p);
+}
+
 void SkRasterPipelineBlitter::appendLoadDst(SkRasterPipeline* p) const {
     p->appendLoadDst(fDst.info().colorType(), &fDstPtr);
     if (fDst.info().alphaType() == kUnpremul_SkAlphaType) {
@@ -397,68 +686,18 @@ void SkRasterPipelineBlitter::blitRectWithTrace(int x, int y, int w, int h, bool
         fMemset2D(&fDst, x,y, w,h, fMemsetColor);
         return;
     }
-
-    if (!fBlitRect) {
-        SkRasterPipeline p(fAlloc);
-        p.extend(fColorPipeline);
-        p.appendClampIfNormalized(fDst.info());
-        if (fBlendMode == SkBlendMode::kSrcOver
-                && (fDst.info().colorType() == kRGBA_8888_SkColorType ||
-                    fDst.info().colorType() == kBGRA_8888_SkColorType)
-                && !fDst.colorSpace()
-                && fDst.info().alphaType() != kUnpremul_SkAlphaType
-                && fDitherRate == 0.0f) {
-            if (fDst.info().colorType() == kBGRA_8888_SkColorType) {
-                p.append(SkRasterPipelineOp::swap_rb);
-            }
-            this->appendClipScale(&p);
-            p.append(SkRasterPipelineOp::srcover_rgba_8888, &fDstPtr);
-        } else {
-            if (fBlendMode != SkBlendMode::kSrc) {
-                this->appendLoadDst(&p);
-                p.extend(fBlendPipeline);
-                this->appendClipLerp(&p);
-            } else if (fClipShaderBuffer) {
-                this->appendLoadDst(&p);
-                this->appendClipLerp(&p);
-            }
-            this->appendStore(&p);
-        }
-        fBlitRect = p.compile();
-    }
-
-    fBlitRect(x,y,w,h);
+    this->program(kRect)(x,y,w,h);
 }
 
 void SkRasterPipelineBlitter::blitAntiH(int x, int y, const SkAlpha aa[], const int16_t runs[]) {
-    if (!fBlitAntiH) {
-        SkRasterPipeline p(fAlloc);
-        p.extend(fColorPipeline);
-        p.appendClampIfNormalized(fDst.info());
-        if (fBlendMode.has_value() &&
-            SkBlendMode_ShouldPreScaleCoverage(*fBlendMode, /*rgb_coverage=*/false)) {
-            p.append(SkRasterPipelineOp::scale_1_float, &fCurrentCoverage);
-            this->appendClipScale(&p);
-            this->appendLoadDst(&p);
-            p.extend(fBlendPipeline);
-        } else {
-            this->appendLoadDst(&p);
-            p.extend(fBlendPipeline);
-            p.append(SkRasterPipelineOp::lerp_1_float, &fCurrentCoverage);
-            this->appendClipLerp(&p);
-        }
-
-        this->appendStore(&p);
-        fBlitAntiH = p.compile();
-    }
-
+    const Thunk& blitAntiH = this->program(kAntiH);
     for (int16_t run = *runs; run > 0; run = *runs) {
         switch (*aa) {
             case 0x00:                                break;
             case 0xff:this->blitRectWithTrace(x,y,run, 1, false); break;
             default:
                 fCurrentCoverage = *aa * (1/255.0f);
-                fBlitAntiH(x,y,run,1);
+                blitAntiH(x,y,run,1);
         }
         x    += run;
         runs += run;
@@ -480,6 +719,13 @@ void SkRasterPipelineBlitter::blitAntiV2(int x, int y, U8CPU a0, U8CPU a1) {
     this->blitMask(mask, clip);
 }
 
+void SkRasterPipelineBlitter::blitAnti1(int x, int y, U8CPU a) {
+    SkIRect clip = {x,y, x+1,y+1};
+    uint8_t coverage = (uint8_t)a;
+    SkMask mask(&coverage, clip, 1, SkMask::kA8_Format);
+    this->blitMask(mask, clip);
+}
+
 void SkRasterPipelineBlitter::blitV(int x, int y, int height, SkAlpha alpha) {
     SkIRect clip = {x,y, x+1,y+height};
     SkMask mask(&alpha, clip,
@@ -523,78 +769,55 @@ void SkRasterPipelineBlitter::blitMask(const SkMask& mask, const SkIRect& clip)
     }
 
     // Lazily build whichever pipeline we need, specialized for each mask format.
-    if (mask.fFormat == SkMask::kA8_Format && !fBlitMaskA8) {
-        SkRasterPipeline p(fAlloc);
-        p.extend(fColorPipeline);
-        p.appendClampIfNormalized(fDst.info());
-        if (fBlendMode.has_value() &&
-            SkBlendMode_ShouldPreScaleCoverage(*fBlendMode, /*rgb_coverage=*/false)) {
-            p.append(SkRasterPipelineOp::scale_u8, &fMaskPtr);
-            this->appendClipScale(&p);
-            this->appendLoadDst(&p);
-            p.extend(fBlendPipeline);
-        } else {
-            this->appendLoadDst(&p);
-            p.extend(fBlendPipeline);
-            p.append(SkRasterPipelineOp::lerp_u8, &fMaskPtr);
-            this->appendClipLerp(&p);
-        }
-        this->appendStore(&p);
-        fBlitMaskA8 = p.compile();
-    }
-    if (mask.fFormat == SkMask::kLCD16_Format && !fBlitMaskLCD16) {
-        SkRasterPipeline p(fAlloc);
-        p.extend(fColorPipeline);
-        p.appendClampIfNormalized(fDst.info());
-        if (fBlendMode.has_value() &&
-            SkBlendMode_ShouldPreScaleCoverage(*fBlendMode, /*rgb_coverage=*/true)) {
-            // Somewhat unusually, scale_565 needs dst loaded first.
-            this->appendLoadDst(&p);
-            p.append(SkRasterPipelineOp::scale_565, &fMaskPtr);
-            this->appendClipScale(&p);
-            p.extend(fBlendPipeline);
-        } else {
-            this->appendLoadDst(&p);
-            p.extend(fBlendPipeline);
-            p.append(SkRasterPipelineOp::lerp_565, &fMaskPtr);
-            this->appendClipLerp(&p);
-        }
-        this->appendStore(&p);
-        fBlitMaskLCD16 = p.compile();
-    }
-    if (mask.fFormat == SkMask::k3D_Format && !fBlitMask3D) {
-        SkRasterPipeline p(fAlloc);
-        p.extend(fColorPipeline);
-        // This bit is where we differ from kA8_Format:
-        p.append(SkRasterPipelineOp::emboss, &fEmbossCtx);
-        // Now onward just as kA8.
-        p.appendClampIfNormalized(fDst.info());
-        if (fBlendMode.has_value() &&
-            SkBlendMode_ShouldPreScaleCoverage(*fBlendMode, /*rgb_coverage=*/false)) {
-            p.append(SkRasterPipelineOp::scale_u8, &fMaskPtr);
-            this->appendClipScale(&p);
-            this->appendLoadDst(&p);
-            p.extend(fBlendPipeline);
-        } else {
-            this->appendLoadDst(&p);
-            p.extend(fBlendPipeline);
-            p.append(SkRasterPipelineOp::lerp_u8, &fMaskPtr);
-            this->appendClipLerp(&p);
-        }
-        this->appendStore(&p);
-        fBlitMask3D = p.compile();
-    }
-
-    std::function<void(size_t,size_t,size_t,size_t)>* blitter = nullptr;
+    ProgramKind kind;
     switch (mask.fFormat) {
-        case SkMask::kA8_Format:    blitter = &fBlitMaskA8;    break;
-        case SkMask::kLCD16_Format: blitter = &fBlitMaskLCD16; break;
-        case SkMask::k3D_Format:    blitter = &fBlitMask3D;    break;
+        case SkMask::kA8_Format:    kind = kMaskA8;    break;
+        case SkMask::kLCD16_Format: kind = kMaskLCD16; break;
+        case SkMask::k3D_Format:    kind = kMask3D;    break;
         default:
             SkASSERT(false);
             return;
     }
+    this->program(kind)(clip.left(),clip.top(), clip.width(),clip.height());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+int SkRasterPipelineBlitterCache::GetCountLimit() {
+    BlitterCache* cache = blitter_cache();
+    SkAutoMutexExclusive lock(cache->fMutex);
+    return cache->fCache.maxCount();
+}
+
+int SkRasterPipelineBlitterCache::SetCountLimit(int count) {
+    BlitterCache* cache = blitter_cache();
+    SkAutoMutexExclusive lock(cache->fMutex);
+    int prev = cache->fCache.maxCount();
+    cache->fCache.setMaxCount(std::max(count, 0));
+    cache->fEnabled.store(count > 0, std::memory_order_relaxed);
+    return prev;
+}
+
+int SkRasterPipelineBlitterCache::GetCountUsed() {
+    BlitterCache* cache = blitter_cache();
+    SkAutoMutexExclusive lock(cache->fMutex);
+    return cache->fCache.count();
+}
+
+int64_t SkRasterPipelineBlitterCache::GetHitCount() {
+    BlitterCache* cache = blitter_cache();
+    SkAutoMutexExclusive lock(cache->fMutex);
+    return cache->fHits;
+}
+
+int64_t SkRasterPipelineBlitterCache::GetMissCount() {
+    BlitterCache* cache = blitter_cache();
+    SkAutoMutexExclusive lock(cache->fMutex);
+    return cache->fMisses;
+}
 
-    SkASSERT(blitter);
-    (*blitter)(clip.left(),clip.top(), clip.width(),clip.height());
+void SkRasterPipelineBlitterCache::PurgeAll() {
+    BlitterCache* cache = blitter_cache();
+    SkAutoMutexExclusive lock(cache->fMutex);
+    cache->fCache.reset();
 }
@@ -8,6 +8,8 @@
 #ifndef SkRasterPipelineOpContexts_DEFINED
 #define SkRasterPipelineOpContexts_DEFINED
 
+#include "include/core/SkTypes.h"
+
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
@@ -18,7 +20,15 @@ namespace SkSL { class TraceHook; }
 // of pixels we handle in the highp pipeline. Many of the context structs in this file are only used
 // by stages that have no lowp implementation. They can therefore use the (smaller) highp value to
 // save memory in the arena.
+//
+// Only the SKX lowp pipeline runs 32 pixels at a time, so only x86 builds that compile it in pay
+// for the wider contexts. This must not depend on SK_CPU_SSE_LEVEL: the opts translation units are
+// built with a higher level than the rest of Skia, and they all share these structs.
+#if defined(SK_CPU_X86) && defined(SK_ENABLE_AVX512_OPTS) && !defined(SK_ENABLE_OPTIMIZE_SIZE)
+inline static constexpr int SkRasterPipeline_kMaxStride = 32;
+#else
 inline static constexpr int SkRasterPipeline_kMaxStride = 16;
+#endif
 inline static constexpr int SkRasterPipeline_kMaxStride_highp = 16;
 
 // How much space to allocate for each MemoryCtx scratch buffer, as part of tail-pixel handling.
@@ -29,6 +29,8 @@
 #endif
 
 #include <algorithm>
+#include <atomic>
+#include <memory>
 
 using namespace skia_private;
 
@@ -52,6 +54,11 @@ static inline bool SkShouldPostMessageToBus(
     #define SK_DEFAULT_IMAGE_CACHE_LIMIT     (32 * 1024 * 1024)
 #endif
 
+// The number of shards of the global cache, each with its own lock. Must be a power of 2.
+#ifndef SK_RESOURCE_CACHE_SHARD_BITS
+    #define SK_RESOURCE_CACHE_SHARD_BITS     3
+#endif
+
 void SkResourceCache::Key::init(void* nameSpace, uint64_t sharedID, size_t dataSize) {
     SkASSERT(SkAlign4(dataSize) == dataSize);
 
@@ -100,6 +107,7 @@ void SkResourceCache::init() {
     // One of these should be explicit set by the caller after we return.
     fTotalByteLimit = 0;
     fDiscardableFactory = nullptr;
+    fSharedBudget = nullptr;
 }
 
 SkResourceCache::SkResourceCache(DiscardableFactory factory)
@@ -114,6 +122,14 @@ SkResourceCache::SkResourceCache(size_t byteLimit)
     fTotalByteLimit = byteLimit;
 }
 
+SkResourceCache::SkResourceCache(DiscardableFactory factory, SharedBudget* budget)
+        : fPurgeSharedIDInbox(SK_InvalidUniqueID) {
+    SkASSERT(budget);
+    this->init();
+    fDiscardableFactory = factory;
+    fSharedBudget = budget;
+}
+
 SkResourceCache::~SkResourceCache() {
     Rec* rec = fHead;
     while (rec) {
@@ -129,16 +145,21 @@ SkResourceCache::~SkResourceCache() {
 bool SkResourceCache::find(const Key& key, FindVisitor visitor, void* context) {
     this->checkMessages();
 
+    NamespaceStats* stats = fNamespaceStats.find(key.getNamespace());
+    if (!stats) {
+        stats = fNamespaceStats.set(key.getNamespace(), NamespaceStats());
+    }
     if (auto found = fHash->find(key)) {
         Rec* rec = *found;
         if (visitor(*rec, context)) {
             this->moveToHead(rec);  // for our LRU
+            stats->fHits += 1;
             return true;
         } else {
             this->remove(rec);  // stale
-            return false;
         }
     }
+    stats->fMisses += 1;
     return false;
 }
 
@@ -176,6 +197,12 @@ void SkResourceCache::add(Rec* rec, void* payload) {
     fHash->set(rec);
     rec->postAddInstall(payload);
 
+    NamespaceStats* stats = fNamespaceStats.find(rec->getKey().getNamespace());
+    if (!stats) {
+        stats = fNamespaceStats.set(rec->getKey().getNamespace(), NamespaceStats());
+    }
+    stats->fCategory = rec->getCategory();
+
     if (gDumpCacheTransactions) {
         SkString bytesStr, totalStr;
         make_size_str(rec->bytesUsed(), &bytesStr);
@@ -185,7 +212,7 @@ void SkResourceCache::add(Rec* rec, void* payload) {
     }
 
     // since the new rec may push us over-budget, we perform a purge check now
-    this->purgeAsNeeded();
+    this->purgeAsNeeded(false, /*keepFairShare=*/fSharedBudget != nullptr);
 }
 
 void SkResourceCache::remove(Rec* rec) {
@@ -198,6 +225,10 @@ void SkResourceCache::remove(Rec* rec) {
 
     fTotalBytesUsed -= used;
     fCount -= 1;
+    if (fSharedBudget) {
+        fSharedBudget->fTotalBytesUsed.fetch_sub(used, std::memory_order_relaxed);
+        fSharedBudget->fCount.fetch_sub(1, std::memory_order_relaxed);
+    }
 
     //SkDebugf("-RC count [%3d] bytes %d\n", fCount, fTotalBytesUsed);
 
@@ -212,26 +243,43 @@ void SkResourceCache::remove(Rec* rec) {
     delete rec;
 }
 
-void SkResourceCache::purgeAsNeeded(bool forcePurge) {
-    size_t byteLimit;
-    int    countLimit;
+bool SkResourceCache::isOverBudget() const {
+    // With discardable memory there is no limit based on bytes, otherwise none based on count.
+    if (fDiscardableFactory) {
+        const int count = fSharedBudget ? fSharedBudget->fCount.load(std::memory_order_relaxed)
+                                        : fCount;
+        return count >= SK_DISCARDABLEMEMORY_SCALEDIMAGECACHE_COUNT_LIMIT;
+    }
+    const size_t used = fSharedBudget
+            ? fSharedBudget->fTotalBytesUsed.load(std::memory_order_relaxed)
+            : fTotalBytesUsed;
+    return used >= this->getTotalByteLimit();
+}
 
+bool SkResourceCache::isOverFairShare() const {
+    if (!fSharedBudget) {
+        return true;  // the whole budget is ours
+    }
+    const int shares = fSharedBudget->fCacheCount;
     if (fDiscardableFactory) {
-        countLimit = SK_DISCARDABLEMEMORY_SCALEDIMAGECACHE_COUNT_LIMIT;
-        byteLimit = UINT32_MAX;  // no limit based on bytes
-    } else {
-        countLimit = SK_MaxS32; // no limit based on count
-        byteLimit = fTotalByteLimit;
+        return fCount > SK_DISCARDABLEMEMORY_SCALEDIMAGECACHE_COUNT_LIMIT / shares;
     }
+    return fTotalBytesUsed > this->getTotalByteLimit() / shares;
+}
 
+void SkResourceCache::purgeAsNeeded(bool forcePurge, bool keepFairShare) {
     Rec* rec = fTail;
     while (rec) {
-        if (!forcePurge && fTotalBytesUsed < byteLimit && fCount < countLimit) {
+        if (!forcePurge &&
+            (!this->isOverBudget() || (keepFairShare && !this->isOverFairShare()))) {
             break;
         }
 
         Rec* prev = rec->fPrev;
         if (rec->canBePurged()) {
+            if (NamespaceStats* stats = fNamespaceStats.find(rec->getKey().getNamespace())) {
+                stats->fEvictions += 1;
+            }
             this->remove(rec);
         }
         rec = prev;
@@ -295,25 +343,33 @@ void SkResourceCache::visitAll(Visitor visitor, void* context) {
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
 size_t SkResourceCache::setTotalByteLimit(size_t newLimit) {
-    size_t prevLimit = fTotalByteLimit;
-    fTotalByteLimit = newLimit;
+    size_t prevLimit;
+    if (fSharedBudget) {
+        prevLimit = fSharedBudget->fTotalByteLimit.exchange(newLimit);
+    } else {
+        prevLimit = fTotalByteLimit;
+        fTotalByteLimit = newLimit;
+    }
     if (newLimit < prevLimit) {
         this->purgeAsNeeded();
     }
     return prevLimit;
 }
 
-SkCachedData* SkResourceCache::newCachedData(size_t bytes) {
-    this->checkMessages();
-
-    if (fDiscardableFactory) {
-        SkDiscardableMemory* dm = fDiscardableFactory(bytes);
+static SkCachedData* new_cached_data(SkResourceCache::DiscardableFactory factory, size_t bytes) {
+    if (factory) {
+        SkDiscardableMemory* dm = factory(bytes);
         return dm ? new SkCachedData(bytes, dm) : nullptr;
     } else {
         return new SkCachedData(sk_malloc_throw(bytes), bytes);
     }
 }
 
+SkCachedData* SkResourceCache::newCachedData(size_t bytes) {
+    this->checkMessages();
+    return new_cached_data(fDiscardableFactory, bytes);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 void SkResourceCache::release(Rec* rec) {
@@ -369,6 +425,10 @@ void SkResourceCache::addToHead(Rec* rec) {
     }
     fTotalBytesUsed += rec->bytesUsed();
     fCount += 1;
+    if (fSharedBudget) {
+        fSharedBudget->fTotalBytesUsed.fetch_add(rec->bytesUsed(), std::memory_order_relaxed);
+        fSharedBudget->fCount.fetch_add(1, std::memory_order_relaxed);
+    }
 
     this->validate();
 }
@@ -445,9 +505,9 @@ size_t SkResourceCache::getEffectiveSingleAllocationByteLimit() const {
     // to our budget.
     if (nullptr == fDiscardableFactory) {
         if (0 == limit) {
-            limit = fTotalByteLimit;
+            limit = this->getTotalByteLimit();
         } else {
-            limit = std::min(limit, fTotalByteLimit);
+            limit = std::min(limit, this->getTotalByteLimit());
         }
     }
     return limit;
@@ -463,94 +523,164 @@ void SkResourceCache::checkMessages() {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-static SkResourceCache* gResourceCache = nullptr;
-static SkMutex& resource_cache_mutex() {
-    static SkMutex& mutex = *(new SkMutex);
-    return mutex;
-}
+namespace {
 
-/** Must hold resource_cache_mutex() when calling. */
-static SkResourceCache* get_cache() {
-    // resource_cache_mutex() is always held when this is called, so we don't need to be fancy in here.
-    resource_cache_mutex().assertHeld();
-    if (nullptr == gResourceCache) {
+// The global cache is split into shards by key hash, so that threads using different keys rarely
+// wait on each other. The shards share one budget: a shard that goes over it first purges its own
+// recs down to its fair share, and the other shards are then asked to purge theirs.
+class ShardedResourceCache {
+public:
+    static constexpr int kShardBits  = SK_RESOURCE_CACHE_SHARD_BITS;
+    static constexpr int kShardCount = 1 << kShardBits;
+
+    ShardedResourceCache() : fBudget(kShardCount) {
 #ifdef SK_USE_DISCARDABLE_SCALEDIMAGECACHE
-        gResourceCache = new SkResourceCache(SkDiscardableMemory::Create);
+        SkResourceCache::DiscardableFactory factory = SkDiscardableMemory::Create;
 #else
-        gResourceCache = new SkResourceCache(SK_DEFAULT_IMAGE_CACHE_LIMIT);
+        SkResourceCache::DiscardableFactory factory = nullptr;
+        fBudget.fTotalByteLimit = SK_DEFAULT_IMAGE_CACHE_LIMIT;
 #endif
+        for (Shard& shard : fShards) {
+            shard.fCache = std::make_unique<SkResourceCache>(factory, &fBudget);
+        }
+    }
+
+    struct Shard {
+        SkMutex                          fMutex;
+        std::unique_ptr<SkResourceCache> fCache;
+    };
+
+    int shardIndex(const SkResourceCache::Key& key) const {
+        // Use the top bits, since each shard's hash table uses the bottom ones.
+        return kShardBits ? key.hash() >> (32 - kShardBits) : 0;
     }
-    return gResourceCache;
+
+    template <typename Fn>
+    auto withShard(int index, Fn&& fn) {
+        Shard& shard = fShards[index];
+        SkAutoMutexExclusive am(shard.fMutex);
+        return fn(shard.fCache.get());
+    }
+
+    template <typename Fn>
+    void forEachShard(Fn&& fn) {
+        for (int i = 0; i < kShardCount; ++i) {
+            this->withShard(i, fn);
+        }
+    }
+
+    // Purges recs from the shards, starting after 'first', until the cache is within budget.
+    // Only one shard is locked at a time.
+    void purgeToBudget(int first) {
+        for (bool keepFairShare : {true, false}) {
+            for (int i = 1; i <= kShardCount; ++i) {
+                const bool overBudget = this->withShard((first + i) % kShardCount,
+                                                        [&](SkResourceCache* cache) {
+                    cache->purgeToBudget(keepFairShare);
+                    return cache->isOverBudget();
+                });
+                if (!overBudget) {
+                    return;
+                }
+            }
+        }
+    }
+
+    SkResourceCache::SharedBudget& budget() { return fBudget; }
+
+private:
+    SkResourceCache::SharedBudget fBudget;
+    Shard                         fShards[kShardCount];
+};
+
+}  // namespace
+
+static ShardedResourceCache* get_cache() {
+    static ShardedResourceCache* cache = new ShardedResourceCache;
+    return cache;
 }
 
 size_t SkResourceCache::GetTotalBytesUsed() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->getTotalBytesUsed();
+    return get_cache()->budget().fTotalBytesUsed.load(std::memory_order_relaxed);
 }
 
 size_t SkResourceCache::GetTotalByteLimit() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->getTotalByteLimit();
+    return get_cache()->budget().fTotalByteLimit.load();
 }
 
 size_t SkResourceCache::SetTotalByteLimit(size_t newLimit) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->setTotalByteLimit(newLimit);
+    ShardedResourceCache* cache = get_cache();
+    const size_t prevLimit = cache->budget().fTotalByteLimit.exchange(newLimit);
+    if (newLimit < prevLimit) {
+        cache->purgeToBudget(0);
+    }
+    return prevLimit;
 }
 
 SkResourceCache::DiscardableFactory SkResourceCache::GetDiscardableFactory() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->discardableFactory();
+    return get_cache()->withShard(0, [](SkResourceCache* shard) {
+        return shard->discardableFactory();
+    });
 }
 
 SkCachedData* SkResourceCache::NewCachedData(size_t bytes) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->newCachedData(bytes);
+    // Allocating doesn't touch any shard, so it doesn't need a lock.
+    return new_cached_data(GetDiscardableFactory(), bytes);
 }
 
 void SkResourceCache::Dump() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    get_cache()->dump();
+    get_cache()->forEachShard([](SkResourceCache* shard) { shard->dump(); });
 }
 
 size_t SkResourceCache::SetSingleAllocationByteLimit(size_t size) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->setSingleAllocationByteLimit(size);
+    size_t prevLimit = 0;
+    get_cache()->forEachShard([&](SkResourceCache* shard) {
+        prevLimit = shard->setSingleAllocationByteLimit(size);
+    });
+    return prevLimit;
 }
 
 size_t SkResourceCache::GetSingleAllocationByteLimit() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->getSingleAllocationByteLimit();
+    return get_cache()->withShard(0, [](SkResourceCache* shard) {
+        return shard->getSingleAllocationByteLimit();
+    });
 }
 
 size_t SkResourceCache::GetEffectiveSingleAllocationByteLimit() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->getEffectiveSingleAllocationByteLimit();
+    return get_cache()->withShard(0, [](SkResourceCache* shard) {
+        return shard->getEffectiveSingleAllocationByteLimit();
+    });
 }
 
 void SkResourceCache::PurgeAll() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->purgeAll();
+    get_cache()->forEachShard([](SkResourceCache* shard) { shard->purgeAll(); });
 }
 
 void SkResourceCache::CheckMessages() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->checkMessages();
+    get_cache()->forEachShard([](SkResourceCache* shard) { shard->checkMessages(); });
 }
 
 bool SkResourceCache::Find(const Key& key, FindVisitor visitor, void* context) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->find(key, visitor, context);
+    ShardedResourceCache* cache = get_cache();
+    return cache->withShard(cache->shardIndex(key), [&](SkResourceCache* shard) {
+        return shard->find(key, visitor, context);
+    });
 }
 
 void SkResourceCache::Add(Rec* rec, void* payload) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    get_cache()->add(rec, payload);
+    ShardedResourceCache* cache = get_cache();
+    const int index = cache->shardIndex(rec->getKey());
+    const bool overBudget = cache->withShard(index, [&](SkResourceCache* shard) {
+        shard->add(rec, payload);
+        return shard->isOverBudget();
+    });
+    if (overBudget) {
+        cache->purgeToBudget(index);
+    }
 }
 
 void SkResourceCache::VisitAll(Visitor visitor, void* context) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    get_cache()->visitAll(visitor, context);
+    get_cache()->forEachShard([&](SkResourceCache* shard) { shard->visitAll(visitor, context); });
 }
 
 void SkResourceCache::PostPurgeSharedID(uint64_t sharedID) {
@@ -617,4 +747,28 @@ void SkResourceCache::DumpMemoryStatistics(SkTraceMemoryDump* dump) {
     // Since resource could be backed by malloc or discardable, the cache always dumps detailed
     // stats to be accurate.
     VisitAll(sk_trace_dump_visitor, dump);
+
+    // Sum each namespace's counts over the shards. Like the records above, each namespace is
+    // named by its category and address.
+    THashMap<void*, NamespaceStats> totals;
+    get_cache()->forEachShard([&](SkResourceCache* shard) {
+        shard->namespaceStats().foreach([&](void* nameSpace, const NamespaceStats& stats) {
+            NamespaceStats* total = totals.find(nameSpace);
+            if (!total) {
+                total = totals.set(nameSpace, NamespaceStats());
+            }
+            total->fCategory = stats.fCategory ? stats.fCategory : total->fCategory;
+            total->fHits += stats.fHits;
+            total->fMisses += stats.fMisses;
+            total->fEvictions += stats.fEvictions;
+        });
+    });
+    totals.foreach([&](void* nameSpace, const NamespaceStats& stats) {
+        SkString dumpName = SkStringPrintf("skia/sk_resource_cache/stats/%s_%p",
+                                           stats.fCategory ? stats.fCategory : "unknown",
+                                           nameSpace);
+        dump->dumpNumericValue(dumpName.c_str(), "hits", "objects", stats.fHits);
+        dump->dumpNumericValue(dumpName.c_str(), "misses", "objects", stats.fMisses);
+        dump->dumpNumericValue(dumpName.c_str(), "evictions", "objects", stats.fEvictions);
+    });
 }
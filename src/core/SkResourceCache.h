@@ -10,7 +10,9 @@
 
 #include "include/private/base/SkDebug.h"
 #include "src/core/SkMessageBus.h"
+#include "src/core/SkTHash.h"
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 
@@ -27,6 +29,8 @@ class SkTraceMemoryDump;
  *
  *  As a convenience, a global instance is also defined, which can be safely
  *  access across threads via the static methods (e.g. FindAndLock, etc.).
+ *  The global instance is split into shards, each with its own lock, that
+ *  share one budget.
  */
 class SkResourceCache {
 public:
@@ -119,6 +123,28 @@ public:
 
     typedef const Rec* ID;
 
+    /**
+     *  Several caches can share one budget, e.g. the shards of the global cache. The bytes (or
+     *  when backed by discardable memory, the recs) of all of them count against the budget's
+     *  limit, but each cache only ever purges its own recs.
+     */
+    struct SharedBudget {
+        explicit SharedBudget(int cacheCount) : fCacheCount(cacheCount) {}
+
+        const int           fCacheCount;  // each cache's fair share is 1/fCacheCount of the limit
+        std::atomic<size_t> fTotalByteLimit{0};
+        std::atomic<size_t> fTotalBytesUsed{0};
+        std::atomic<int>    fCount{0};
+    };
+
+    /** Counts of how the recs of one Key namespace have been used. */
+    struct NamespaceStats {
+        const char* fCategory = nullptr;  // the category of the namespace's recs, once one is added
+        uint64_t    fHits = 0;
+        uint64_t    fMisses = 0;          // including stale recs
+        uint64_t    fEvictions = 0;       // recs purged to stay within the budget
+    };
+
     /**
      *  Callback function for find(). If called, the cache will have found a match for the
      *  specified Key, and will pass in the corresponding Rec, along with a caller-specified
@@ -208,6 +234,14 @@ public:
      *  changed at runtime with setTotalByteLimit.
      */
     explicit SkResourceCache(size_t byteLimit);
+
+    /**
+     *  Construct the cache to count against a budget shared with other caches. If
+     *  DiscardableFactory is not null, it is used to allocate memory as above, and the
+     *  budget's limit is on the number of recs. Otherwise, its limit is budget->fTotalByteLimit.
+     *  The budget must outlive the cache.
+     */
+    SkResourceCache(DiscardableFactory, SharedBudget*);
     ~SkResourceCache();
 
     /**
@@ -224,7 +258,9 @@ public:
     void visitAll(Visitor, void* context);
 
     size_t getTotalBytesUsed() const { return fTotalBytesUsed; }
-    size_t getTotalByteLimit() const { return fTotalByteLimit; }
+    size_t getTotalByteLimit() const {
+        return fSharedBudget ? fSharedBudget->fTotalByteLimit.load() : fTotalByteLimit;
+    }
 
     /**
      *  This is respected by SkBitmapProcState::possiblyScaleImage.
@@ -250,6 +286,25 @@ public:
         this->purgeAsNeeded(true);
     }
 
+    /**
+     *  Returns true if this cache, or the caches sharing its budget, are over the budget.
+     */
+    bool isOverBudget() const;
+
+    /**
+     *  Purge this cache's least recently used recs while isOverBudget(). If keepFairShare is
+     *  true, stop once this cache is within its fair share of a shared budget, leaving the rest
+     *  to the other caches.
+     */
+    void purgeToBudget(bool keepFairShare) {
+        this->purgeAsNeeded(false, keepFairShare);
+    }
+
+    /** Counts of the recs used by find() and add(), keyed by Key namespace. */
+    const skia_private::THashMap<void*, NamespaceStats>& namespaceStats() const {
+        return fNamespaceStats;
+    }
+
     DiscardableFactory discardableFactory() const { return fDiscardableFactory; }
 
     SkCachedData* newCachedData(size_t bytes);
@@ -273,10 +328,15 @@ private:
     size_t  fSingleAllocationByteLimit;
     int     fCount;
 
+    SharedBudget* fSharedBudget;
+
+    skia_private::THashMap<void*, NamespaceStats> fNamespaceStats;
+
     SkMessageBus<PurgeSharedIDMessage, uint32_t>::Inbox fPurgeSharedIDInbox;
 
     void checkMessages();
-    void purgeAsNeeded(bool forcePurge = false);
+    void purgeAsNeeded(bool forcePurge = false, bool keepFairShare = false);
+    bool isOverFairShare() const;
 
     // linklist management
     void moveToHead(Rec*);
@@ -106,6 +106,11 @@ SkScalerContext::SkScalerContext(sk_sp<SkTypeface> typeface, const SkScalerConte
 
 SkScalerContext::~SkScalerContext() {}
 
+std::unique_ptr<SkScalerContext> SkScalerContext::makeConcurrentContext(
+        const SkDescriptor& desc) const {
+    return fTypeface->createScalerContext(this->getEffects(), &desc);
+}
+
 /**
  * In order to call cachedDeviceLuminance, cachedPaintLuminance, or
  * cachedMaskGamma the caller must hold the mask_gamma_cache_mutex and continue
@@ -301,6 +301,24 @@ public:
         return SkToBool(fRec.fFlags & kLinearMetrics_Flag);
     }
 
+    /** Return true if several scaler contexts for this typeface can generate images at the same
+     *  time without serializing on a lock shared between them. SkStrike only generates missing
+     *  images in parallel for such scaler contexts.
+     */
+    virtual bool canGenerateImagesConcurrently() const { return false; }
+
+    /** Return a new scaler context for desc, which must describe this context, to generate images
+     *  on another thread while this one is in use. Only called if canGenerateImagesConcurrently().
+     *  Returns nullptr on failure.
+     */
+    virtual std::unique_ptr<SkScalerContext> makeConcurrentContext(const SkDescriptor& desc) const;
+
+    /** Return the version of what rasterizes this context's glyphs, such as the library it
+     *  calls, or zero if it has none. SkStrikeDiskCache does not use glyphs that another version
+     *  stored.
+     */
+    virtual uint32_t rasterizerVersion() const { return 0; }
+
     // DEPRECATED
     bool isVertical() const { return false; }
 
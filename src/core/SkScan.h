@@ -14,6 +14,7 @@
 #include "include/private/base/SkFixed.h"
 
 class SkBlitter;
+class SkExecutor;
 class SkPath;
 class SkRasterClip;
 class SkRegion;
@@ -42,6 +43,12 @@ public:
     // SkRegions together.
     static bool PathRequiresTiling(const SkIRect& bounds);
 
+    // If an executor is set, large non-convex anti-aliased path fills into blitters that can blit
+    // rows concurrently are split into horizontal bands that are filled in parallel on it. The
+    // output is identical to the serial fill. The executor must outlive any fill that may use it.
+    static void SetAAAPathExecutor(SkExecutor*);
+    static SkExecutor* GetAAAPathExecutor();
+
     ///////////////////////////////////////////////////////////////////////////
     // rasterclip
 
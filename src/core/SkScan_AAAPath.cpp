@@ -6,6 +6,7 @@
  */
 
 #include "include/core/SkColor.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkPath.h"
 #include "include/core/SkPathTypes.h"
 #include "include/core/SkRect.h"
@@ -15,7 +16,9 @@
 #include "include/private/base/SkFixed.h"
 #include "include/private/base/SkMath.h"
 #include "include/private/base/SkSafe32.h"
+#include "include/private/base/SkTemplates.h"
 #include "include/private/base/SkTo.h"
+#include "src/base/SkArenaAlloc.h"
 #include "src/base/SkTSort.h"
 #include "src/core/SkAlphaRuns.h"
 #include "src/core/SkAnalyticEdge.h"
@@ -25,8 +28,10 @@
 #include "src/core/SkMask.h"
 #include "src/core/SkScan.h"
 #include "src/core/SkScanPriv.h"
+#include "src/core/SkTaskGroup.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 
@@ -281,10 +286,12 @@ void MaskAdditiveBlitter::blitAntiRect(int     x,
 
 class RunBasedAdditiveBlitter : public AdditiveBlitter {
 public:
+    // The runs are kept in memory from the real blitter, or from runsAlloc if it is set.
     RunBasedAdditiveBlitter(SkBlitter*     realBlitter,
                             const SkIRect& ir,
                             const SkIRect& clipBounds,
-                            bool           isInverse);
+                            bool           isInverse,
+                            SkArenaAlloc*  runsAlloc = nullptr);
 
     ~RunBasedAdditiveBlitter() override { this->flush(); }
 
@@ -369,7 +376,8 @@ protected:
 RunBasedAdditiveBlitter::RunBasedAdditiveBlitter(SkBlitter*     realBlitter,
                                                  const SkIRect& ir,
                                                  const SkIRect& clipBounds,
-                                                 bool           isInverse) {
+                                                 bool           isInverse,
+                                                 SkArenaAlloc*  runsAlloc) {
     fRealBlitter = realBlitter;
 
     SkIRect sectBounds;
@@ -392,7 +400,9 @@ RunBasedAdditiveBlitter::RunBasedAdditiveBlitter(SkBlitter*     realBlitter,
     fCurrY = fTop - 1;
 
     fRunsToBuffer = realBlitter->requestRowsPreserved();
-    fRunsBuffer   = realBlitter->allocBlitMemory(fRunsToBuffer * this->getRunsSz());
+    const size_t runsBufferSz = fRunsToBuffer * this->getRunsSz();
+    fRunsBuffer = runsAlloc ? runsAlloc->makeBytesAlignedTo(runsBufferSz, alignof(int16_t))
+                            : realBlitter->allocBlitMemory(runsBufferSz);
     fCurrentRun   = -1;
 
     this->advanceRuns();
@@ -462,8 +472,9 @@ public:
     SafeRLEAdditiveBlitter(SkBlitter*     realBlitter,
                            const SkIRect& ir,
                            const SkIRect& clipBounds,
-                           bool           isInverse)
-            : RunBasedAdditiveBlitter(realBlitter, ir, clipBounds, isInverse) {}
+                           bool           isInverse,
+                           SkArenaAlloc*  runsAlloc = nullptr)
+            : RunBasedAdditiveBlitter(realBlitter, ir, clipBounds, isInverse, runsAlloc) {}
 
     void blitAntiH(int x, int y, const SkAlpha antialias[], int len) override;
     void blitAntiH(int x, int y, const SkAlpha alpha) override;
@@ -1406,6 +1417,73 @@ static bool edges_too_close(int prevRite, SkFixed ul, SkFixed ll) {
     return prevRite > SkFixedFloorToInt(ul) || prevRite > SkFixedFloorToInt(ll);
 }
 
+// Splits a fill into horizontal bands that are blitted in parallel. The calling thread walks the
+// edges once, without blitting, and calls start() at the top of each band (see aaa_fill_path()).
+class AAABands {
+public:
+    AAABands(SkExecutor* executor,
+             int bandCount,
+             SkBlitter* realBlitter,
+             const SkIRect& ir,
+             const SkIRect& clipBounds);
+
+    ~AAABands() { fTasks.wait(); }
+
+    void setWalk(SkPathFillType fillType, SkFixed leftClip, SkFixed rightClip, bool skipIntersect) {
+        fFillType      = fillType;
+        fLeftClip      = leftClip;
+        fRightClip     = rightClip;
+        fSkipIntersect = skipIntersect;
+    }
+
+    SkFixed nextTop() const { return SkIntToFixed(fBands[fStarted].fTop); }
+
+    // Copies the edges as they are at the top of the next band (at y) into the band, and starts
+    // walking and blitting the band's rows on the executor. Bands above y are skipped. Returns
+    // false after the last band.
+    bool start(const SkAnalyticEdge* prevHead,
+               const SkAnalyticEdge* nextTail,
+               SkFixed y,
+               SkFixed nextNextY);
+
+    void wait() { fTasks.wait(); }
+
+private:
+    struct Band {
+        int            fTop, fBottom;
+        SkFixed        fY, fNextNextY;
+        SkAnalyticEdge fHead, fTail;
+        SkArenaAlloc   fAlloc{4096};
+    };
+
+    void walk(Band*);
+
+    SkBlitter*                      fRealBlitter;
+    SkIRect                         fIR, fClipBounds;
+    SkPathFillType                  fFillType      = SkPathFillType::kWinding;
+    SkFixed                         fLeftClip      = 0;
+    SkFixed                         fRightClip     = 0;
+    bool                            fSkipIntersect = false;
+    int                             fStarted       = 0;
+    skia_private::AutoTArray<Band>  fBands;
+    SkTaskGroup                     fTasks;
+};
+
+static void aaa_walk_edge_rows(SkAnalyticEdge*  prevHead,
+                               SkAnalyticEdge*  nextTail,
+                               SkPathFillType   fillType,
+                               AdditiveBlitter* blitter,
+                               SkFixed          y,
+                               SkFixed          nextNextY,
+                               int              stop_y,
+                               SkFixed          leftClip,
+                               SkFixed          rightClip,
+                               bool             isUsingMask,
+                               bool             forceRLE,
+                               bool             skipIntersect,
+                               AAABands*        bands);
+
+// If bands is set, blitter is null: the walk only starts the bands as it reaches them.
 static void aaa_walk_edges(SkAnalyticEdge*  prevHead,
                            SkAnalyticEdge*  nextTail,
                            SkPathFillType   fillType,
@@ -1416,7 +1494,9 @@ static void aaa_walk_edges(SkAnalyticEdge*  prevHead,
                            SkFixed          rightClip,
                            bool             isUsingMask,
                            bool             forceRLE,
-                           bool             skipIntersect) {
+                           bool             skipIntersect,
+                           AAABands*        bands) {
+    SkASSERT(!bands || (!blitter && !isUsingMask && !forceRLE));
     prevHead->fX = prevHead->fUpperX = leftClip;
     nextTail->fX = nextTail->fUpperX = rightClip;
     SkFixed y                        = std::max(prevHead->fNext->fUpperY, SkIntToFixed(start_y));
@@ -1431,8 +1511,7 @@ static void aaa_walk_edges(SkAnalyticEdge*  prevHead,
         update_next_next_y(edge->fUpperY, y, &nextNextY);
     }
 
-    int windingMask = SkPathFillType_IsEvenOdd(fillType) ? 1 : -1;
-    bool isInverse  = SkPathFillType_IsInverse(fillType);
+    bool isInverse = SkPathFillType_IsInverse(fillType);
 
     if (isInverse && SkIntToFixed(start_y) != y) {
         int width = SkFixedFloorToInt(rightClip - leftClip);
@@ -1452,7 +1531,44 @@ static void aaa_walk_edges(SkAnalyticEdge*  prevHead,
                         false);
     }
 
+    aaa_walk_edge_rows(prevHead,
+                       nextTail,
+                       fillType,
+                       blitter,
+                       y,
+                       nextNextY,
+                       stop_y,
+                       leftClip,
+                       rightClip,
+                       isUsingMask,
+                       forceRLE,
+                       skipIntersect,
+                       bands);
+}
+
+// Walks the edges from y, where every edge from prevHead->fNext that has started is at y, down to
+// stop_y.
+static void aaa_walk_edge_rows(SkAnalyticEdge*  prevHead,
+                               SkAnalyticEdge*  nextTail,
+                               SkPathFillType   fillType,
+                               AdditiveBlitter* blitter,
+                               SkFixed          y,
+                               SkFixed          nextNextY,
+                               int              stop_y,
+                               SkFixed          leftClip,
+                               SkFixed          rightClip,
+                               bool             isUsingMask,
+                               bool             forceRLE,
+                               bool             skipIntersect,
+                               AAABands*        bands) {
+    int windingMask = SkPathFillType_IsEvenOdd(fillType) ? 1 : -1;
+    bool isInverse  = SkPathFillType_IsInverse(fillType);
+
     while (true) {
+        if (bands && y >= bands->nextTop() && !bands->start(prevHead, nextTail, y, nextNextY)) {
+            break;  // the last band walks the rest
+        }
+
         int             w               = 0;
         bool            in_interval     = isInverse;
         SkFixed         prevX           = prevHead->fX;
@@ -1508,20 +1624,22 @@ static void aaa_walk_edges(SkAnalyticEdge*  prevHead,
                 SkFixed nextLeft = std::max(leftClip, leftE->fX);
                 rite = std::min(rightClip, rite);
                 SkFixed nextRite = std::min(rightClip, currE->fX);
-                blit_trapezoid_row(
-                        blitter,
-                        y >> 16,
-                        left,
-                        rite,
-                        nextLeft,
-                        nextRite,
-                        leftDY,
-                        currE->fDY,
-                        fullAlpha,
-                        maskRow,
-                        noRealBlitter || (fullAlpha == 0xFF &&
-                                          (edges_too_close(prevRite, left, leftE->fX) ||
-                                           edges_too_close(currE, currE->fNext, nextY))));
+                if (blitter) {
+                    blit_trapezoid_row(
+                            blitter,
+                            y >> 16,
+                            left,
+                            rite,
+                            nextLeft,
+                            nextRite,
+                            leftDY,
+                            currE->fDY,
+                            fullAlpha,
+                            maskRow,
+                            noRealBlitter || (fullAlpha == 0xFF &&
+                                              (edges_too_close(prevRite, left, leftE->fX) ||
+                                               edges_too_close(currE, currE->fNext, nextY))));
+                }
                 prevRite = SkFixedCeilToInt(std::max(rite, currE->fX));
             } else {
                 if (isLeft) {
@@ -1576,7 +1694,7 @@ static void aaa_walk_edges(SkAnalyticEdge*  prevHead,
         }
 
         // was our right-edge culled away?
-        if (in_interval) {
+        if (in_interval && blitter) {
             blit_trapezoid_row(blitter,
                                y >> 16,
                                left,
@@ -1612,8 +1730,9 @@ static void aaa_fill_path(const SkPath& path,
                           int stop_y,
                           bool pathContainedInClip,
                           bool isUsingMask,
-                          bool forceRLE) {  // forceRLE implies that SkAAClip is calling us
-    SkASSERT(blitter);
+                          bool forceRLE,  // forceRLE implies that SkAAClip is calling us
+                          AAABands* bands = nullptr) {
+    SkASSERT(blitter || bands);
 
     SkAnalyticEdgeBuilder builder;
     int              count = builder.buildEdges(path, pathContainedInClip ? nullptr : &clipRect);
@@ -1672,7 +1791,6 @@ static void aaa_fill_path(const SkPath& path,
     if (!pathContainedInClip && stop_y > clipRect.fBottom) {
         stop_y = clipRect.fBottom;
     }
-
     SkFixed leftBound  = SkIntToFixed(rect.fLeft);
     SkFixed rightBound = SkIntToFixed(rect.fRight);
     if (isUsingMask) {
@@ -1685,12 +1803,16 @@ static void aaa_fill_path(const SkPath& path,
     }
 
     if (!path.isInverseFillType() && path.isConvex() && count >= 2) {
+        SkASSERT(!bands);
         aaa_walk_convex_edges(
                 &headEdge, blitter, start_y, stop_y, leftBound, rightBound, isUsingMask);
     } else {
         // We skip intersection computation if there are many points which probably already
         // give us enough fractional scan lines.
         bool skipIntersect = path.countPoints() > (stop_y - start_y) * 2;
+        if (bands) {
+            bands->setWalk(path.getFillType(), leftBound, rightBound, skipIntersect);
+        }
 
         aaa_walk_edges(&headEdge,
                        &tailEdge,
@@ -1702,7 +1824,8 @@ static void aaa_fill_path(const SkPath& path,
                        rightBound,
                        isUsingMask,
                        forceRLE,
-                       skipIntersect);
+                       skipIntersect,
+                       bands);
     }
 }
 
@@ -1725,6 +1848,124 @@ static inline bool try_blit_fat_anti_rect(SkBlitter* blitter,
     return true;
 }
 
+static SkAnalyticEdge* copy_edge(const SkAnalyticEdge* edge, SkArenaAlloc* alloc) {
+    switch (edge->fEdgeType) {
+        case SkAnalyticEdge::kLine_Type:
+            return alloc->make<SkAnalyticEdge>(*edge);
+        case SkAnalyticEdge::kQuad_Type:
+            return alloc->make<SkAnalyticQuadraticEdge>(
+                    *static_cast<const SkAnalyticQuadraticEdge*>(edge));
+        case SkAnalyticEdge::kCubic_Type:
+            return alloc->make<SkAnalyticCubicEdge>(
+                    *static_cast<const SkAnalyticCubicEdge*>(edge));
+    }
+    SkUNREACHABLE;
+}
+
+AAABands::AAABands(SkExecutor* executor,
+                   int bandCount,
+                   SkBlitter* realBlitter,
+                   const SkIRect& ir,
+                   const SkIRect& clipBounds)
+        : fRealBlitter(realBlitter)
+        , fIR(ir)
+        , fClipBounds(clipBounds)
+        , fBands(bandCount)
+        , fTasks(*executor) {
+    SkIRect bounds;
+    SkAssertResult(bounds.intersect(ir, clipBounds));
+    for (int i = 0; i < bandCount; ++i) {
+        fBands[i].fTop    = bounds.fTop + bounds.height() * i / bandCount;
+        fBands[i].fBottom = bounds.fTop + bounds.height() * (i + 1) / bandCount;
+    }
+}
+
+bool AAABands::start(const SkAnalyticEdge* prevHead,
+                     const SkAnalyticEdge* nextTail,
+                     SkFixed y,
+                     SkFixed nextNextY) {
+    // The bands are cut from the path's bounds, which also hold control points and moveTo points
+    // that no edge reaches, so the walk may start below the bottom of the first bands. They have
+    // no rows to blit.
+    while (fStarted < SkToInt(fBands.size()) && SkIntToFixed(fBands[fStarted].fBottom) <= y) {
+        ++fStarted;
+    }
+    if (fStarted == SkToInt(fBands.size())) {
+        return false;
+    }
+    Band* band = &fBands[fStarted];
+    // The walk steps through every integer y, so it stops exactly at the top of every band after
+    // the first one that it starts, where it may start below the top.
+    SkASSERT(y >= SkIntToFixed(band->fTop) && y < SkIntToFixed(band->fBottom));
+    band->fY         = y;
+    band->fNextNextY = nextNextY;
+
+    // Copy the edges that have started and the ones that start inside the band. insert_new_edges()
+    // also looks at the edge after the last one that it inserts, so copy the first edge that
+    // starts below the band as well.
+    const SkFixed bottom = SkIntToFixed(band->fBottom);
+    SkAnalyticEdge* last = &band->fHead;
+    band->fHead = *prevHead;
+    for (const SkAnalyticEdge* edge = prevHead->fNext; edge != nextTail; edge = edge->fNext) {
+        SkAnalyticEdge* copy = copy_edge(edge, &band->fAlloc);
+        copy->fPrev = last;
+        last->fNext = copy;
+        last        = copy;
+        if (edge->fUpperY >= bottom) {
+            break;
+        }
+    }
+    band->fTail       = *nextTail;
+    band->fTail.fPrev = last;
+    last->fNext       = &band->fTail;
+
+    fTasks.add([this, band] { this->walk(band); });
+    return ++fStarted < SkToInt(fBands.size());
+}
+
+void AAABands::walk(Band* band) {
+    // The bands blit their rows at the same time, so each keeps its runs in its own memory (see
+    // SkBlitter::canBlitRowsConcurrently()).
+    SafeRLEAdditiveBlitter additiveBlitter(
+            fRealBlitter, fIR, fClipBounds, false, &band->fAlloc);
+    aaa_walk_edge_rows(&band->fHead,
+                       &band->fTail,
+                       fFillType,
+                       &additiveBlitter,
+                       band->fY,
+                       band->fNextNextY,
+                       band->fBottom,
+                       fLeftClip,
+                       fRightClip,
+                       false,
+                       false,
+                       fSkipIntersect,
+                       nullptr);
+}
+
+static std::atomic<SkExecutor*> gAAAPathExecutor{nullptr};
+
+void SkScan::SetAAAPathExecutor(SkExecutor* executor) {
+    gAAAPathExecutor.store(executor, std::memory_order_relaxed);
+}
+
+SkExecutor* SkScan::GetAAAPathExecutor() {
+    return gAAAPathExecutor.load(std::memory_order_relaxed);
+}
+
+// Paths with fewer points are cheap enough to fill on a single thread.
+static constexpr int kMinPointsForBands = 1024;
+static constexpr int kMinBandHeight     = 16;
+static constexpr int kMaxBands          = 8;
+
+static int aaa_band_count(const SkPath& path, const SkIRect& ir, const SkIRect& clipBounds) {
+    SkIRect bounds;
+    if (path.countPoints() < kMinPointsForBands || !bounds.intersect(ir, clipBounds)) {
+        return 1;
+    }
+    return std::clamp(bounds.height() / kMinBandHeight, 1, kMaxBands);
+}
+
 void SkScan::AAAFillPath(const SkPath&  path,
                          SkBlitter*     blitter,
                          const SkIRect& ir,
@@ -1772,6 +2013,26 @@ void SkScan::AAAFillPath(const SkPath&  path,
         // If the filling area might not be convex, the more involved aaa_walk_edges would
         // be called and we have to clamp the alpha downto 255. The SafeRLEAdditiveBlitter
         // does that at a cost of performance.
+        SkExecutor* executor = GetAAAPathExecutor();
+        if (executor && !isInverse && !forceRLE && blitter->canBlitRowsConcurrently() &&
+            blitter->requestRowsPreserved() == 1) {
+            if (int bandCount = aaa_band_count(path, ir, clipBounds); bandCount > 1) {
+                // The bands copy the edges from a walk on this thread when it reaches them, and
+                // then walk and blit their own rows on the executor.
+                AAABands bands(executor, bandCount, blitter, ir, clipBounds);
+                aaa_fill_path(path,
+                              clipBounds,
+                              nullptr,
+                              ir.fTop,
+                              ir.fBottom,
+                              containedInClip,
+                              false,
+                              false,
+                              &bands);
+                bands.wait();
+                return;
+            }
+        }
         SafeRLEAdditiveBlitter additiveBlitter(blitter, ir, clipBounds, isInverse);
         aaa_fill_path(path,
                       clipBounds,
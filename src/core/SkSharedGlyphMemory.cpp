@@ -0,0 +1,162 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkSharedGlyphMemory.h"
+
+#include "include/private/base/SkAlign.h"
+#include "include/private/base/SkAssert.h"
+#include "include/private/base/SkMath.h"
+#include "include/private/base/SkTo.h"
+#include "src/core/SkGlyph.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+// -- SkSharedGlyphMemory --------------------------------------------------------------------------
+SkSharedGlyphMemory::SkSharedGlyphMemory(void* memory, size_t size)
+        : fMemory{static_cast<uint8_t*>(memory)}
+        , fPageCount{memory != nullptr ? SkToU32(std::min<size_t>(size / kPageSize, UINT32_MAX))
+                                       : 0} {
+    SkASSERT(reinterpret_cast<uintptr_t>(memory) % kPageSize == 0);
+    if (fPageCount > 0) {
+        fFree.push_back({0, fPageCount});
+    }
+}
+
+std::optional<SkSharedGlyphPages> SkSharedGlyphMemory::allocate(size_t size) {
+    SkASSERT(size > 0);
+    if (size > size_t{fPageCount} * kPageSize) {
+        return std::nullopt;
+    }
+    const uint32_t pageCount = SkToU32(SkAlignTo(size, kPageSize) / kPageSize);
+
+    auto found = std::find_if(fFree.begin(), fFree.end(), [&](const FreePages& free) {
+        return free.fPageCount >= pageCount;
+    });
+    if (found == fFree.end()) {
+        return std::nullopt;
+    }
+
+    const SkSharedGlyphPages pages{found->fFirstPage, pageCount, fEpoch};
+    if (found->fPageCount == pageCount) {
+        fFree.erase(found);
+    } else {
+        found->fFirstPage += pageCount;
+        found->fPageCount -= pageCount;
+    }
+    fAllocated.set(pages.fFirstPage, {pageCount, fEpoch});
+    fPagesAllocated += pageCount;
+    return pages;
+}
+
+bool SkSharedGlyphMemory::release(const SkSharedGlyphPages& pages) {
+    const Allocation* allocation = fAllocated.find(pages.fFirstPage);
+    if (allocation == nullptr ||
+        allocation->fPageCount != pages.fPageCount ||
+        allocation->fEpoch != pages.fEpoch) {
+        return false;
+    }
+    fAllocated.remove(pages.fFirstPage);
+    fPagesAllocated -= pages.fPageCount;
+
+    // Put the run back in order, and merge it with the free runs on either side.
+    auto next = std::lower_bound(fFree.begin(), fFree.end(), pages.fFirstPage,
+                                 [](const FreePages& free, uint32_t firstPage) {
+                                     return free.fFirstPage < firstPage;
+                                 });
+    const uint32_t end = pages.fFirstPage + pages.fPageCount;
+    const bool joinsNext = next != fFree.end() && next->fFirstPage == end;
+    if (next != fFree.begin()) {
+        auto prev = std::prev(next);
+        if (prev->fFirstPage + prev->fPageCount == pages.fFirstPage) {
+            prev->fPageCount += pages.fPageCount;
+            if (joinsNext) {
+                prev->fPageCount += next->fPageCount;
+                fFree.erase(next);
+            }
+            return true;
+        }
+    }
+    if (joinsNext) {
+        next->fFirstPage = pages.fFirstPage;
+        next->fPageCount += pages.fPageCount;
+        return true;
+    }
+    fFree.insert(next, {pages.fFirstPage, pages.fPageCount});
+    return true;
+}
+
+size_t SkSharedGlyphMemory::ImageBytes(SkSpan<const SkGlyph> images) {
+    size_t bytes = 0;
+    for (const SkGlyph& glyph : images) {
+        // The same images that SkGlyph::flattenImage() sends.
+        if (!glyph.isEmpty() && SkGlyphDigest::FitsInAtlas(glyph)) {
+            bytes = SkAlignTo(bytes, glyph.formatAlignment()) + glyph.imageSize();
+        }
+    }
+    return bytes;
+}
+
+// -- SkSharedGlyphImageWriter ---------------------------------------------------------------------
+uint32_t SkSharedGlyphImageWriter::write(const void* src, size_t size, size_t alignment) {
+    SkASSERT(SkIsPow2(alignment));
+    const size_t offset = SkAlignTo(fUsed, alignment);
+    SkASSERT_RELEASE(offset <= fSize && size <= fSize - offset);
+    memcpy(fRun + offset, src, size);
+    fUsed = offset + size;
+    return SkToU32(offset);
+}
+
+// -- SkSharedGlyphMemoryReader --------------------------------------------------------------------
+SkSharedGlyphMemoryReader::SkSharedGlyphMemoryReader(sk_sp<SkData> mapping)
+        : fMapping{std::move(mapping)} {
+    SkASSERT(fMapping != nullptr);
+}
+
+sk_sp<SkSharedGlyphLease> SkSharedGlyphMemoryReader::lease(const SkSharedGlyphPages& pages) {
+    const uint64_t mappedPages = fMapping->size() / SkSharedGlyphMemory::kPageSize;
+    if (pages.fPageCount == 0 ||
+        uint64_t{pages.fFirstPage} + pages.fPageCount > mappedPages) {
+        return nullptr;
+    }
+    const uint8_t* run =
+            fMapping->bytes() + size_t{pages.fFirstPage} * SkSharedGlyphMemory::kPageSize;
+    return sk_make_sp<SkSharedGlyphLease>(sk_ref_sp(this), pages, run);
+}
+
+std::vector<SkSharedGlyphPages> SkSharedGlyphMemoryReader::takeReleased() {
+    SkAutoMutexExclusive lock{fReleasedLock};
+    return std::exchange(fReleased, {});
+}
+
+void SkSharedGlyphMemoryReader::release(const SkSharedGlyphPages& pages) {
+    SkAutoMutexExclusive lock{fReleasedLock};
+    fReleased.push_back(pages);
+}
+
+// -- SkSharedGlyphLease ---------------------------------------------------------------------------
+SkSharedGlyphLease::SkSharedGlyphLease(sk_sp<SkSharedGlyphMemoryReader> reader,
+                                       const SkSharedGlyphPages& pages,
+                                       const uint8_t* run)
+        : fReader{std::move(reader)}, fPages{pages}, fRun{run} {}
+
+SkSharedGlyphLease::~SkSharedGlyphLease() {
+    fReader->release(fPages);
+}
+
+const void* SkSharedGlyphLease::find(uint32_t offset, size_t size, size_t alignment) const {
+    if (offset > this->size() || size > this->size() - offset) {
+        return nullptr;
+    }
+    const uint8_t* found = fRun + offset;
+    if (reinterpret_cast<uintptr_t>(found) % alignment != 0) {
+        return nullptr;
+    }
+    return found;
+}
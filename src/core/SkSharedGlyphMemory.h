@@ -0,0 +1,160 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkSharedGlyphMemory_DEFINED
+#define SkSharedGlyphMemory_DEFINED
+
+#include "include/core/SkData.h"
+#include "include/core/SkRefCnt.h"
+#include "include/private/base/SkMutex.h"
+#include "include/private/base/SkSpan_impl.h"
+#include "include/private/base/SkThreadAnnotations.h"
+#include "src/core/SkTHash.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+class SkGlyph;
+
+// Glyph images can be sent from an SkStrikeServer to an SkStrikeClient through memory that both
+// processes map, for example a memfd. The server's mapping is writable and the client's is
+// read-only. The memory is split into pages. For each strike it sends, the server allocates a run
+// of pages that holds all of the strike's new images, and the strike data only carries where the
+// run is and each image's offset in it. The client leases the run while it merges the strike, and
+// copies the images into the strike, so nothing the server writes later can change them.
+//
+// Runs are reclaimed with an epoch handshake. Every SkStrikeServer::writeStrikeData() starts a
+// new epoch, and each run is stamped with the epoch it was written in. The server never writes
+// to a run again. Once a strike is merged, the run it leased is queued, and the client sends it
+// back, with its epoch, in SkStrikeClient::writeReleasedGlyphMemory(). The server
+// only frees a run that is allocated with the same epoch, so a run that is returned twice, or
+// late, cannot free pages that were reused since.
+
+// A run of pages, and the epoch it was written in.
+struct SkSharedGlyphPages {
+    uint32_t fFirstPage = 0;
+    uint32_t fPageCount = 0;
+    uint32_t fEpoch = 0;
+};
+
+// The server's side of the memory: it hands out runs of pages and takes back released ones.
+// Not thread-safe.
+class SkSharedGlyphMemory {
+public:
+    inline static constexpr size_t kPageSize = 4096;
+
+    // memory must be aligned to kPageSize. Only whole pages of it are used.
+    SkSharedGlyphMemory(void* memory, size_t size);
+
+    // Start the next epoch. Runs allocated after this are stamped with it.
+    void nextEpoch() { fEpoch++; }
+    uint32_t epoch() const { return fEpoch; }
+
+    // Allocate the first free run of pages that holds size bytes, or nothing if there is none.
+    std::optional<SkSharedGlyphPages> allocate(size_t size);
+
+    // Free a run returned by the client. Returns false, and frees nothing, unless pages was
+    // allocated exactly as given, in the same epoch.
+    bool release(const SkSharedGlyphPages& pages);
+
+    // Where the server writes the run.
+    uint8_t* writableMemory(const SkSharedGlyphPages& pages) const {
+        return fMemory + pages.fFirstPage * kPageSize;
+    }
+
+    size_t bytesAllocated() const { return fPagesAllocated * kPageSize; }
+
+    // The bytes the images in the span take in a run, in the order they are flattened.
+    static size_t ImageBytes(SkSpan<const SkGlyph> images);
+
+private:
+    struct FreePages {
+        uint32_t fFirstPage;
+        uint32_t fPageCount;
+    };
+    struct Allocation {
+        uint32_t fPageCount;
+        uint32_t fEpoch;
+    };
+
+    uint8_t* const fMemory;
+    const uint32_t fPageCount;
+    uint32_t fEpoch = 0;
+    size_t fPagesAllocated = 0;
+
+    // Free runs sorted by first page, with no two adjacent.
+    std::vector<FreePages> fFree;
+
+    // Allocated runs by first page.
+    skia_private::THashMap<uint32_t, Allocation> fAllocated;
+};
+
+// Copies images into one run of pages while they are flattened.
+class SkSharedGlyphImageWriter {
+public:
+    SkSharedGlyphImageWriter(uint8_t* run, size_t size) : fRun{run}, fSize{size} {}
+
+    // Copy size bytes from src into the run, aligned to alignment, and return their offset in
+    // the run. The run must have been sized with SkSharedGlyphMemory::ImageBytes.
+    uint32_t write(const void* src, size_t size, size_t alignment);
+
+private:
+    uint8_t* const fRun;
+    const size_t fSize;
+    size_t fUsed = 0;
+};
+
+class SkSharedGlyphLease;
+
+// The client's side of the memory: its read-only mapping, and the runs that have been released.
+// Thread-safe.
+class SkSharedGlyphMemoryReader final : public SkRefCnt {
+public:
+    // mapping is the client's mapping of the memory. It stays mapped until the reader and every
+    // lease from it are deleted.
+    explicit SkSharedGlyphMemoryReader(sk_sp<SkData> mapping);
+
+    // Lease the run while a strike is merged, or return nullptr if it is not in the mapping.
+    sk_sp<SkSharedGlyphLease> lease(const SkSharedGlyphPages& pages);
+
+    // The runs released since the last call.
+    std::vector<SkSharedGlyphPages> takeReleased() SK_EXCLUDES(fReleasedLock);
+
+private:
+    friend class SkSharedGlyphLease;
+
+    void release(const SkSharedGlyphPages& pages) SK_EXCLUDES(fReleasedLock);
+
+    const sk_sp<SkData> fMapping;
+    SkMutex fReleasedLock;
+    std::vector<SkSharedGlyphPages> fReleased SK_GUARDED_BY(fReleasedLock);
+};
+
+// The client's hold on a run of pages while it copies images out. The run is released when the
+// lease is deleted.
+class SkSharedGlyphLease final : public SkRefCnt {
+public:
+    SkSharedGlyphLease(sk_sp<SkSharedGlyphMemoryReader> reader,
+                       const SkSharedGlyphPages& pages,
+                       const uint8_t* run);
+    ~SkSharedGlyphLease() override;
+
+    // Returns the size bytes at offset in the run, or nullptr if they are not in the run or are
+    // not aligned to alignment.
+    const void* find(uint32_t offset, size_t size, size_t alignment) const;
+
+    size_t size() const { return fPages.fPageCount * SkSharedGlyphMemory::kPageSize; }
+
+private:
+    const sk_sp<SkSharedGlyphMemoryReader> fReader;
+    const SkSharedGlyphPages fPages;
+    const uint8_t* const fRun;
+};
+
+#endif  // SkSharedGlyphMemory_DEFINED
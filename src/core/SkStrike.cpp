@@ -7,27 +7,36 @@
 
 #include "src/core/SkStrike.h"
 
+#include "include/core/SkData.h"
 #include "include/core/SkDrawable.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFontStyle.h"
 #include "include/core/SkMatrix.h"
 #include "include/core/SkPath.h"
 #include "include/core/SkString.h"
 #include "include/core/SkTraceMemoryDump.h"
 #include "include/core/SkTypeface.h"
+#include "include/private/base/SkAlign.h"
 #include "include/private/base/SkDebug.h"
 #include "include/private/base/SkTFitsIn.h"
+#include "include/private/base/SkTo.h"
+#include "src/core/SkChecksum.h"
 #include "src/core/SkGlyph.h"
 #include "src/core/SkMask.h"
 #include "src/core/SkReadBuffer.h"
 #include "src/core/SkScalerContext.h"
 #include "src/core/SkStrikeCache.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/core/SkWriteBuffer.h"
 #include "src/text/StrikeForGPU.h"
 
+#include <algorithm>
 #include <cctype>
+#include <cstring>
 #include <new>
 #include <optional>
 #include <utility>
+#include <vector>
 
 using namespace skglyph;
 
@@ -52,6 +61,8 @@ SkStrike::SkStrike(SkStrikeCache* strikeCache,
                         scaler->computeAxisAlignmentForHText()}
         , fStrikeSpec{strikeSpec}
         , fStrikeCache{strikeCache}
+        , fCanPrefillImages{scaler->canGenerateImagesConcurrently()}
+        , fRasterizerVersion{scaler->rasterizerVersion()}
         , fScalerContext{std::move(scaler)}
         , fPinner{std::move(pinner)} {
     SkASSERT(fScalerContext != nullptr);
@@ -87,7 +98,8 @@ void
 SkStrike::FlattenGlyphsByType(SkWriteBuffer& buffer,
                               SkSpan<SkGlyph> images,
                               SkSpan<SkGlyph> paths,
-                              SkSpan<SkGlyph> drawables) {
+                              SkSpan<SkGlyph> drawables,
+                              SkSharedGlyphImageWriter* sharedImages) {
     SkASSERT_RELEASE(SkTFitsIn<int>(images.size()) &&
                      SkTFitsIn<int>(paths.size()) &&
                      SkTFitsIn<int>(drawables.size()));
@@ -96,7 +108,7 @@ SkStrike::FlattenGlyphsByType(SkWriteBuffer& buffer,
     for (SkGlyph& glyph : images) {
         SkASSERT(SkMask::IsValidFormat(glyph.maskFormat()));
         glyph.flattenMetrics(buffer);
-        glyph.flattenImage(buffer);
+        glyph.flattenImage(buffer, sharedImages);
     }
 
     buffer.writeInt(paths.size());
@@ -114,19 +126,108 @@ SkStrike::FlattenGlyphsByType(SkWriteBuffer& buffer,
     }
 }
 
-bool SkStrike::mergeFromBuffer(SkReadBuffer& buffer) {
+bool SkStrike::mergeFromBuffer(SkReadBuffer& buffer, const SkSharedGlyphLease* sharedImages) {
+    Monitor m{this};
+    this->stopPublishing();
+    fHasUnstoredGlyphs = true;
+    return this->internalMergeFromBuffer(buffer, sharedImages);
+}
+
+// Stored glyphs start with a count and an index of that many StoredGlyphs, sorted by packed id,
+// followed by the records the index points at.
+static constexpr size_t kStoredIndexOffset = 2 * sizeof(uint32_t);
+
+bool SkStrike::setStoredGlyphs(sk_sp<SkData> stored) {
+    SkAutoMutexExclusive lock{fStrikeLock};
+    SkASSERT(fPrev == nullptr && fNext == nullptr);
+    SkASSERT(fStoredGlyphs == nullptr);
+
+    // Only check that the index fits; each record is checked when its glyph is first read.
+    uint32_t count;
+    if (stored->size() < kStoredIndexOffset) {
+        return false;
+    }
+    memcpy(&count, stored->data(), sizeof(count));
+    if (count > (stored->size() - kStoredIndexOffset) / sizeof(StoredGlyph)) {
+        return false;
+    }
+    fStoredGlyphs = std::move(stored);
+    fStoredGlyphCount = count;
+    return true;
+}
+
+SkStrike::StoredGlyph SkStrike::storedGlyphAt(size_t index) const {
+    // The index is only 4 byte aligned in the strike's file.
+    StoredGlyph stored;
+    memcpy(&stored,
+           fStoredGlyphs->bytes() + kStoredIndexOffset + index * sizeof(StoredGlyph),
+           sizeof(stored));
+    return stored;
+}
+
+std::optional<SkStrike::StoredGlyph> SkStrike::findStoredGlyph(SkPackedGlyphID packedID) const {
+    size_t lo = 0, hi = fStoredGlyphCount;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        const StoredGlyph stored = this->storedGlyphAt(mid);
+        if (stored.fPackedID == packedID.value()) {
+            return stored;
+        }
+        if (stored.fPackedID < packedID.value()) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return std::nullopt;
+}
+
+SkGlyph* SkStrike::readStoredGlyph(const StoredGlyph& stored,
+                                   SkArenaAlloc* alloc,
+                                   size_t* memoryIncrease) const {
+    SkGlyph* glyph = nullptr;
+    for (bool image : {true, false}) {
+        const uint32_t offset = image ? stored.fImageOffset : stored.fPathOffset,
+                       size   = image ? stored.fImageSize   : stored.fPathSize;
+        const uint64_t hash   = image ? stored.fImageHash   : stored.fPathHash;
+        if (size == 0) {
+            continue;
+        }
+        // Check the record before using it, in case the file was corrupted after it was written.
+        if (offset > fStoredGlyphs->size() || size > fStoredGlyphs->size() - offset ||
+            !SkIsAlign4(offset) ||
+            SkChecksum::Hash64(fStoredGlyphs->bytes() + offset, size) != hash) {
+            return nullptr;
+        }
+        SkReadBuffer buffer{fStoredGlyphs->bytes() + offset, size};
+        std::optional<SkGlyph> prototype = SkGlyph::MakeFromBuffer(buffer);
+        if (!buffer.validate(prototype.has_value() &&
+                             prototype->getPackedID().value() == stored.fPackedID)) {
+            return nullptr;
+        }
+        if (glyph == nullptr) {
+            glyph = alloc->make<SkGlyph>(prototype.value());
+            *memoryIncrease += sizeof(SkGlyph);
+        }
+        *memoryIncrease += image ? glyph->addImageInPlaceFromBuffer(buffer, alloc)
+                                 : glyph->addPathFromBuffer(buffer, alloc);
+        if (!buffer.isValid()) {
+            return nullptr;
+        }
+    }
+    return glyph;
+}
+
+bool SkStrike::internalMergeFromBuffer(SkReadBuffer& buffer,
+                                       const SkSharedGlyphLease* sharedImages) {
     // Read glyphs with images for the current strike.
     const int imagesCount = buffer.readInt();
     if (imagesCount == 0 && !buffer.isValid()) {
         return false;
     }
-
-    {
-        Monitor m{this};
-        for (int curImage = 0; curImage < imagesCount; ++curImage) {
-            if (!this->mergeGlyphAndImageFromBuffer(buffer)) {
-                return false;
-            }
+    for (int curImage = 0; curImage < imagesCount; ++curImage) {
+        if (!this->mergeGlyphAndImageFromBuffer(buffer, sharedImages)) {
+            return false;
         }
     }
 
@@ -135,12 +236,9 @@ bool SkStrike::mergeFromBuffer(SkReadBuffer& buffer) {
     if (pathsCount == 0 && !buffer.isValid()) {
         return false;
     }
-    {
-        Monitor m{this};
-        for (int curPath = 0; curPath < pathsCount; ++curPath) {
-            if (!this->mergeGlyphAndPathFromBuffer(buffer)) {
-                return false;
-            }
+    for (int curPath = 0; curPath < pathsCount; ++curPath) {
+        if (!this->mergeGlyphAndPathFromBuffer(buffer)) {
+            return false;
         }
     }
 
@@ -149,20 +247,107 @@ bool SkStrike::mergeFromBuffer(SkReadBuffer& buffer) {
     if (drawablesCount == 0 && !buffer.isValid()) {
         return false;
     }
+    for (int curDrawable = 0; curDrawable < drawablesCount; ++curDrawable) {
+        if (!this->mergeGlyphAndDrawableFromBuffer(buffer)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+sk_sp<SkData> SkStrike::flattenChangedGlyphs() {
+    std::vector<SkGlyph> images, paths;
+    SkArenaAlloc scratch{kMinAllocAmount};
     {
-        Monitor m{this};
-        for (int curDrawable = 0; curDrawable < drawablesCount; ++curDrawable) {
-            if (!this->mergeGlyphAndDrawableFromBuffer(buffer)) {
-                return false;
+        SkAutoMutexExclusive lock{fStrikeLock};
+        if (!fHasUnstoredGlyphs) {
+            return nullptr;
+        }
+        fHasUnstoredGlyphs = false;
+
+        auto addGlyph = [&](const SkGlyph& glyph) {
+            if (glyph.setImageHasBeenCalled()) {
+                images.push_back(glyph);
+            }
+            if (glyph.setPathHasBeenCalled()) {
+                paths.push_back(glyph);
+            }
+        };
+        for (const SkGlyph* glyph : fGlyphForIndex) {
+            addGlyph(*glyph);
+        }
+
+        // Keep the stored glyphs that were never asked for. Their images stay in fStoredGlyphs.
+        size_t unused = 0;
+        for (size_t i = 0; i < fStoredGlyphCount; ++i) {
+            const StoredGlyph stored = this->storedGlyphAt(i);
+            if (fDigestForPackedGlyphID.find(SkPackedGlyphID{stored.fPackedID}) == nullptr) {
+                if (const SkGlyph* glyph = this->readStoredGlyph(stored, &scratch, &unused)) {
+                    addGlyph(*glyph);
+                }
             }
         }
     }
 
-    return true;
+    // The glyphs' images and paths are never changed once set, so write them without the lock.
+    // Write the records, and index them by packed id.
+    SkBinaryWriteBuffer records{{}};
+    skia_private::THashMap<SkPackedGlyphID, StoredGlyph, SkPackedGlyphID::Hash> index;
+    for (bool image : {true, false}) {
+        for (const SkGlyph& glyph : image ? images : paths) {
+            SkASSERT(SkMask::IsValidFormat(glyph.maskFormat()));
+            StoredGlyph& stored = index[glyph.getPackedID()];
+            stored.fPackedID = glyph.getPackedID().value();
+            const size_t begin = records.bytesWritten();
+            glyph.flattenMetrics(records);
+            if (image) {
+                glyph.flattenImage(records);
+            } else {
+                glyph.flattenPath(records);
+            }
+            (image ? stored.fImageOffset : stored.fPathOffset) = SkToU32(begin);
+            (image ? stored.fImageSize : stored.fPathSize) =
+                    SkToU32(records.bytesWritten() - begin);
+        }
+    }
+    std::vector<StoredGlyph> sorted;
+    index.foreach([&](SkPackedGlyphID, const StoredGlyph& stored) { sorted.push_back(stored); });
+    std::sort(sorted.begin(), sorted.end(), [](const StoredGlyph& a, const StoredGlyph& b) {
+        return a.fPackedID < b.fPackedID;
+    });
+
+    const size_t recordsOffset = kStoredIndexOffset + sorted.size() * sizeof(StoredGlyph);
+    sk_sp<SkData> data = SkData::MakeUninitialized(recordsOffset + records.bytesWritten());
+    auto bytes = static_cast<uint8_t*>(data->writable_data());
+    records.writeToMemory(bytes + recordsOffset);
+    for (StoredGlyph& stored : sorted) {
+        for (bool image : {true, false}) {
+            uint32_t& offset = image ? stored.fImageOffset : stored.fPathOffset;
+            const uint32_t size = image ? stored.fImageSize : stored.fPathSize;
+            if (size != 0) {
+                offset += SkToU32(recordsOffset);
+                (image ? stored.fImageHash : stored.fPathHash) =
+                        SkChecksum::Hash64(bytes + offset, size);
+            }
+        }
+    }
+    const uint32_t header[2] = {SkToU32(sorted.size()), 0};
+    static_assert(sizeof(header) == kStoredIndexOffset);
+    memcpy(bytes, header, sizeof(header));
+    memcpy(bytes + kStoredIndexOffset, sorted.data(), sorted.size() * sizeof(StoredGlyph));
+    return data;
+}
+
+void SkStrike::acceptMerges() {
+    SkAutoMutexExclusive lock{fStrikeLock};
+    this->stopPublishing();
 }
 
 SkGlyph* SkStrike::mergeGlyphAndImage(SkPackedGlyphID toID, const SkGlyph& fromGlyph) {
     Monitor m{this};
+    this->stopPublishing();
+    fHasUnstoredGlyphs = true;
     // TODO(herb): remove finding the glyph when setting the metrics and image are separated
     SkGlyphDigest* digest = fDigestForPackedGlyphID.find(toID);
     if (digest != nullptr) {
@@ -186,6 +371,8 @@ SkGlyph* SkStrike::mergeGlyphAndImage(SkPackedGlyphID toID, const SkGlyph& fromG
 
 const SkPath* SkStrike::mergePath(SkGlyph* glyph, const SkPath* path, bool hairline) {
     Monitor m{this};
+    this->stopPublishing();
+    fHasUnstoredGlyphs = true;
     if (glyph->setPathHasBeenCalled()) {
         SkDEBUGFAIL("Re-adding path to existing glyph. This should not happen.");
     }
@@ -198,6 +385,7 @@ const SkPath* SkStrike::mergePath(SkGlyph* glyph, const SkPath* path, bool hairl
 
 const SkDrawable* SkStrike::mergeDrawable(SkGlyph* glyph, sk_sp<SkDrawable> drawable) {
     Monitor m{this};
+    this->stopPublishing();
     if (glyph->setDrawableHasBeenCalled()) {
         SkDEBUGFAIL("Re-adding drawable to existing glyph. This should not happen.");
     }
@@ -217,27 +405,18 @@ void SkStrike::findIntercepts(const SkScalar bounds[2], SkScalar scale, SkScalar
 
 SkSpan<const SkGlyph*> SkStrike::metrics(
         SkSpan<const SkGlyphID> glyphIDs, const SkGlyph* results[]) {
-    Monitor m{this};
-    return this->internalPrepare(glyphIDs, kMetricsOnly, results);
+    return this->prepareGlyphs(glyphIDs, kMetricsPrepared, results);
 }
 
 SkSpan<const SkGlyph*> SkStrike::preparePaths(
         SkSpan<const SkGlyphID> glyphIDs, const SkGlyph* results[]) {
-    Monitor m{this};
-    return this->internalPrepare(glyphIDs, kMetricsAndPath, results);
+    return this->prepareGlyphs(glyphIDs, kPathPrepared, results);
 }
 
 SkSpan<const SkGlyph*> SkStrike::prepareImages(
         SkSpan<const SkPackedGlyphID> glyphIDs, const SkGlyph* results[]) {
-    const SkGlyph** cursor = results;
-    Monitor m{this};
-    for (auto glyphID : glyphIDs) {
-        SkGlyph* glyph = this->glyph(glyphID);
-        this->prepareForImage(glyph);
-        *cursor++ = glyph;
-    }
-
-    return {results, glyphIDs.size()};
+    this->prefillImages(glyphIDs, GetImageExecutor());
+    return this->prepareGlyphs(glyphIDs, kImagePrepared, results);
 }
 
 SkSpan<const SkGlyph*> SkStrike::prepareDrawables(
@@ -316,9 +495,15 @@ void SkStrike::dumpMemoryStatistics(SkTraceMemoryDump* dump) const {
     dump->dumpNumericValue(dumpName.c_str(),
                            "glyph_count", "objects",
                            fDigestForPackedGlyphID.count());
+    dump->dumpNumericValue(dumpName.c_str(), "published_glyphs_size", "bytes", fPublishedBytes);
     dump->setMemoryBacking(dumpName.c_str(), "malloc", nullptr);
 }
 
+size_t SkStrike::publishedGlyphsMemoryUsed() const {
+    SkAutoMutexExclusive lock{fStrikeLock};
+    return fPublishedBytes;
+}
+
 SkGlyph* SkStrike::glyph(SkGlyphDigest digest) {
     return fGlyphForIndex[digest.index()];
 }
@@ -338,8 +523,13 @@ SkGlyphDigest SkStrike::digestFor(ActionType actionType, SkPackedGlyphID packedG
     if (digestPtr != nullptr) {
         glyph = fGlyphForIndex[digestPtr->index()];
     } else {
-        glyph = fAlloc.make<SkGlyph>(fScalerContext->makeGlyph(packedGlyphID, &fAlloc));
-        fMemoryIncrease += sizeof(SkGlyph);
+        std::optional<StoredGlyph> stored = this->findStoredGlyph(packedGlyphID);
+        glyph = stored.has_value() ? this->readStoredGlyph(*stored, &fAlloc, &fMemoryIncrease)
+                                   : nullptr;
+        if (glyph == nullptr) {
+            glyph = fAlloc.make<SkGlyph>(fScalerContext->makeGlyph(packedGlyphID, &fAlloc));
+            fMemoryIncrease += sizeof(SkGlyph);
+        }
         digestPtr = this->addGlyphAndDigest(glyph);
     }
 
@@ -359,6 +549,7 @@ SkGlyphDigest* SkStrike::addGlyphAndDigest(SkGlyph* glyph) {
 bool SkStrike::prepareForImage(SkGlyph* glyph) {
     if (glyph->setImage(&fAlloc, fScalerContext.get())) {
         fMemoryIncrease += glyph->imageSize();
+        fHasUnstoredGlyphs = true;
     }
     return glyph->image() != nullptr;
 }
@@ -366,6 +557,7 @@ bool SkStrike::prepareForImage(SkGlyph* glyph) {
 bool SkStrike::prepareForPath(SkGlyph* glyph) {
     if (glyph->setPath(&fAlloc, fScalerContext.get())) {
         fMemoryIncrease += glyph->path()->approximateBytesUsed();
+        fHasUnstoredGlyphs = true;
     }
     return glyph->path() !=nullptr;
 }
@@ -399,13 +591,14 @@ SkGlyph* SkStrike::mergeGlyphFromBuffer(SkReadBuffer& buffer) {
     return glyph;
 }
 
-bool SkStrike::mergeGlyphAndImageFromBuffer(SkReadBuffer& buffer) {
+bool SkStrike::mergeGlyphAndImageFromBuffer(SkReadBuffer& buffer,
+                                            const SkSharedGlyphLease* sharedImages) {
     SkASSERT(buffer.isValid());
     SkGlyph* glyph = this->mergeGlyphFromBuffer(buffer);
     if (!buffer.validate(glyph != nullptr)) {
         return false;
     }
-    fMemoryIncrease += glyph->addImageFromBuffer(buffer, &fAlloc);
+    fMemoryIncrease += glyph->addImageFromBuffer(buffer, &fAlloc, sharedImages);
     return buffer.isValid();
 }
 
@@ -429,20 +622,191 @@ bool SkStrike::mergeGlyphAndDrawableFromBuffer(SkReadBuffer& buffer) {
     return buffer.isValid();
 }
 
-SkSpan<const SkGlyph*> SkStrike::internalPrepare(
-        SkSpan<const SkGlyphID> glyphIDs, PathDetail pathDetail, const SkGlyph** results) {
-    const SkGlyph** cursor = results;
-    for (auto glyphID : glyphIDs) {
-        SkGlyph* glyph = this->glyph(SkPackedGlyphID{glyphID});
-        if (pathDetail == kMetricsAndPath) {
-            this->prepareForPath(glyph);
+template <typename GlyphIDType>
+SkSpan<const SkGlyph*> SkStrike::prepareGlyphs(SkSpan<const GlyphIDType> glyphIDs,
+                                               Prepared prepared,
+                                               const SkGlyph* results[]) {
+    bool missed = false;
+    for (size_t i = 0; i < glyphIDs.size(); ++i) {
+        results[i] = this->findPublishedGlyph(SkPackedGlyphID{glyphIDs[i]}, prepared);
+        missed |= results[i] == nullptr;
+    }
+
+    if (missed) {
+        Monitor m{this};
+        for (size_t i = 0; i < glyphIDs.size(); ++i) {
+            if (results[i] != nullptr) {
+                continue;
+            }
+            SkGlyph* glyph = this->glyph(SkPackedGlyphID{glyphIDs[i]});
+            if (prepared == kImagePrepared) {
+                this->prepareForImage(glyph);
+            } else if (prepared == kPathPrepared) {
+                this->prepareForPath(glyph);
+            }
+            this->publishGlyph(glyph, prepared);
+            results[i] = glyph;
         }
-        *cursor++ = glyph;
     }
 
     return {results, glyphIDs.size()};
 }
 
+void SkStrike::prefillImages(SkSpan<const SkPackedGlyphID> glyphIDs, SkExecutor* executor) {
+    if (!fCanPrefillImages || executor == nullptr || glyphIDs.size() < 2 * kMinImagesPerTask) {
+        return;
+    }
+
+    const size_t missing = std::count_if(glyphIDs.begin(), glyphIDs.end(), [&](auto packedID) {
+        return this->findPublishedGlyph(packedID, kImagePrepared) == nullptr;
+    });
+    if (missing < 2 * kMinImagesPerTask) {
+        return;
+    }
+
+    // Collect the glyphs that need an image, and a copy of each for a task to generate into.
+    std::vector<SkGlyph*> glyphs;
+    std::vector<SkGlyph> images;
+    const SkScalerContext* strikeScaler;
+    {
+        Monitor m{this};
+        strikeScaler = fScalerContext.get();
+        skia_private::THashSet<const SkGlyph*> seen;
+        for (SkPackedGlyphID packedID : glyphIDs) {
+            SkGlyph* glyph = this->glyph(packedID);
+            // Color glyphs can be drawn from the strike's drawables; leave them to prepareImages.
+            if (glyph->setImageHasBeenCalled() ||
+                glyph->maskFormat() == SkMask::kARGB32_Format ||
+                seen.contains(glyph)) {
+                continue;
+            }
+            seen.add(glyph);
+            glyphs.push_back(glyph);
+            images.push_back(*glyph);
+        }
+    }
+
+    const size_t taskCount = std::min(kMaxImageTasks, images.size() / kMinImagesPerTask);
+    if (taskCount < 2) {
+        return;
+    }
+
+    // The copies share the strike glyphs' paths, which don't change once they are set.
+    std::vector<std::unique_ptr<SkArenaAlloc>> allocs(taskCount);
+    SkTaskGroup tasks{*executor};
+    tasks.batch(SkToInt(taskCount), [&](int task) {
+        const size_t begin = images.size() * task / taskCount,
+                     end   = images.size() * (task + 1) / taskCount;
+        std::unique_ptr<SkScalerContext> scaler =
+                strikeScaler->makeConcurrentContext(fStrikeSpec.descriptor());
+        if (scaler == nullptr) {
+            scaler = fStrikeSpec.createScalerContext();
+        }
+        allocs[task] = std::make_unique<SkArenaAlloc>(kMinAllocAmount);
+        for (size_t i = begin; i < end; ++i) {
+            images[i].setImage(allocs[task].get(), scaler.get());
+        }
+    });
+    tasks.wait();
+
+    Monitor m{this};
+    for (size_t i = 0; i < glyphs.size(); ++i) {
+        // Another thread may have generated the image while the lock was released.
+        if (glyphs[i]->setImage(&fAlloc, images[i].image())) {
+            fMemoryIncrease += glyphs[i]->imageSize();
+            fHasUnstoredGlyphs = true;
+        }
+        this->publishGlyph(glyphs[i], kImagePrepared);
+    }
+}
+
+static std::atomic<SkExecutor*> gImageExecutor{nullptr};
+
+void SkStrike::SetImageExecutor(SkExecutor* executor) {
+    gImageExecutor.store(executor, std::memory_order_relaxed);
+}
+
+SkExecutor* SkStrike::GetImageExecutor() {
+    return gImageExecutor.load(std::memory_order_relaxed);
+}
+
+const SkGlyph* SkStrike::findPublishedGlyph(SkPackedGlyphID packedID, Prepared prepared) const {
+    const PublishedGlyphs* table = fPublishedGlyphs.load(std::memory_order_acquire);
+    if (table == nullptr) {
+        return nullptr;
+    }
+    // The table is never full, so the probe ends at an empty slot.
+    for (size_t i = packedID.hash() & table->fMask;; i = (i + 1) & table->fMask) {
+        const uintptr_t entry = table->fSlots[i].load(std::memory_order_acquire);
+        const SkGlyph* glyph = reinterpret_cast<const SkGlyph*>(entry & ~uintptr_t{kPreparedMask});
+        if (glyph == nullptr) {
+            return nullptr;
+        }
+        if (glyph->getPackedID() == packedID) {
+            return (entry & prepared) == prepared ? glyph : nullptr;
+        }
+    }
+}
+
+void SkStrike::publishGlyph(SkGlyph* glyph, Prepared prepared) {
+    static_assert(alignof(SkGlyph) > kPreparedMask);
+    if (fAcceptsMerges) {
+        return;
+    }
+
+    // Only one thread publishes at a time, so the table and its slots can't change between the
+    // loads and stores below.
+    const PublishedGlyphs* table = fPublishedGlyphs.load(std::memory_order_relaxed);
+    auto findSlot = [](const PublishedGlyphs* in, const SkGlyph* g) {
+        for (size_t i = g->getPackedID().hash() & in->fMask;; i = (i + 1) & in->fMask) {
+            const uintptr_t entry = in->fSlots[i].load(std::memory_order_relaxed);
+            if (entry == 0 ||
+                (entry & ~uintptr_t{kPreparedMask}) == reinterpret_cast<uintptr_t>(g)) {
+                return &in->fSlots[i];
+            }
+        }
+    };
+
+    std::atomic<uintptr_t>* slot = table != nullptr ? findSlot(table, glyph) : nullptr;
+    const uintptr_t current = slot != nullptr ? slot->load(std::memory_order_relaxed) : 0;
+    if (current == 0) {
+        // A new glyph. Grow the table first if this would fill more than half of it.
+        const size_t capacity = table != nullptr ? table->fMask + 1 : 0;
+        if (2 * (fPublishedCount + 1) > capacity) {
+            const size_t newCapacity = std::max(2 * capacity, kMinPublishedCapacity);
+            auto grown = fAlloc.make<PublishedGlyphs>(PublishedGlyphs{
+                    newCapacity - 1, fAlloc.makeArray<std::atomic<uintptr_t>>(newCapacity)});
+            const size_t tableBytes =
+                    sizeof(PublishedGlyphs) + newCapacity * sizeof(std::atomic<uintptr_t>);
+            fPublishedBytes += tableBytes;
+            fMemoryIncrease += tableBytes;
+            for (size_t i = 0; i < capacity; ++i) {
+                if (const uintptr_t entry = table->fSlots[i].load(std::memory_order_relaxed)) {
+                    const SkGlyph* published =
+                            reinterpret_cast<const SkGlyph*>(entry & ~uintptr_t{kPreparedMask});
+                    findSlot(grown, published)->store(entry, std::memory_order_relaxed);
+                }
+            }
+            fPublishedGlyphs.store(grown, std::memory_order_release);
+            table = grown;
+            slot = findSlot(table, glyph);
+        }
+        fPublishedCount++;
+    }
+
+    const uintptr_t entry = reinterpret_cast<uintptr_t>(glyph) | prepared | current;
+    if (entry != current) {
+        slot->store(entry, std::memory_order_release);
+    }
+}
+
+void SkStrike::stopPublishing() {
+    if (!fAcceptsMerges) {
+        fAcceptsMerges = true;
+        fPublishedGlyphs.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
 void SkStrike::updateMemoryUsage(size_t increase) {
     if (increase > 0) {
         // fRemoved and the cache's total memory are managed under the cache's lock. This allows
@@ -21,14 +21,21 @@
 #include "src/core/SkTHash.h"
 #include "src/text/StrikeForGPU.h"
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <vector>
 
+class SkData;
 class SkDescriptor;
 class SkDrawable;
+class SkExecutor;
 class SkPath;
 class SkReadBuffer;
+class SkSharedGlyphImageWriter;
+class SkSharedGlyphLease;
 class SkStrikeCache;
 class SkTraceMemoryDump;
 class SkWriteBuffer;
@@ -56,11 +63,35 @@ public:
     bool prepareForPath(SkGlyph*) override SK_REQUIRES(fStrikeLock);
     bool prepareForDrawable(SkGlyph*) override SK_REQUIRES(fStrikeLock);
 
-    bool mergeFromBuffer(SkReadBuffer& buffer) SK_EXCLUDES(fStrikeLock);
+    // Merge glyphs flattened by FlattenGlyphsByType. If their images were flattened into a run of
+    // shared glyph memory, sharedImages is the lease on the run. The images are copied out of it,
+    // so the lease only has to last for the merge.
+    bool mergeFromBuffer(SkReadBuffer& buffer, const SkSharedGlyphLease* sharedImages = nullptr)
+            SK_EXCLUDES(fStrikeLock);
+
+    // Stop serving glyphs without the lock (see findPublishedGlyph). Merges may rewrite the
+    // metrics of glyphs that already exist, so a strike that is merged into must call this before
+    // other threads can find it. Every merge calls it as well.
+    void acceptMerges() SK_EXCLUDES(fStrikeLock);
+
+    // Serve the glyphs in stored, flattened by flattenChangedGlyphs(), instead of making them
+    // with the scaler context. Nothing in stored is read now: stored starts with an index sorted
+    // by packed id, which is searched in place, and each glyph's records are checked and read
+    // when it is first asked for. Their images are used in place in stored. Returns false, and
+    // keeps nothing, if the index does not fit in stored. For a strike that is not in its cache
+    // yet.
+    bool setStoredGlyphs(sk_sp<SkData> stored) SK_EXCLUDES(fStrikeLock);
+
+    // Flatten the glyphs that have images or paths, including stored glyphs that were never asked
+    // for, in the form read by setStoredGlyphs. Drawables are not included. Returns nullptr if no
+    // glyph has gained an image or path since the strike was made, loaded or last flattened.
+    sk_sp<SkData> flattenChangedGlyphs() SK_EXCLUDES(fStrikeLock);
+    // If sharedImages is not null, the images are copied into it instead of the buffer.
     static void FlattenGlyphsByType(SkWriteBuffer& buffer,
                                     SkSpan<SkGlyph> images,
                                     SkSpan<SkGlyph> paths,
-                                    SkSpan<SkGlyph> drawables);
+                                    SkSpan<SkGlyph> drawables,
+                                    SkSharedGlyphImageWriter* sharedImages = nullptr);
 
     // Lookup (or create if needed) the returned glyph using toID. If that glyph is not initialized
     // with an image, then use the information in fromGlyph to initialize the width, height top,
@@ -99,6 +130,26 @@ public:
     SkSpan<const SkGlyph*> prepareDrawables(
             SkSpan<const SkGlyphID> glyphIDs, const SkGlyph* results[]) SK_EXCLUDES(fStrikeLock);
 
+    // Generate the missing images for glyphIDs in parallel on executor, each task with its own
+    // scaler context (see SkScalerContext::makeConcurrentContext()), and add them to the strike
+    // in a single critical section. Does nothing if executor is nullptr, if the scaler contexts
+    // would serialize on a shared lock (see canPrefillImages()), or if too few images are missing
+    // to be worth splitting up.
+    void prefillImages(SkSpan<const SkPackedGlyphID> glyphIDs, SkExecutor* executor)
+            SK_EXCLUDES(fStrikeLock);
+
+    // True if the strike's scaler contexts can generate images concurrently, so that
+    // prefillImages() can do anything.
+    bool canPrefillImages() const { return fCanPrefillImages; }
+
+    // The version of the scaler context's rasterizer (see SkScalerContext::rasterizerVersion).
+    uint32_t rasterizerVersion() const { return fRasterizerVersion; }
+
+    // The executor prepareImages() and the CPU glyph painter use to prefill images. See
+    // SkGraphics::SetGlyphImageExecutor().
+    static void SetImageExecutor(SkExecutor*);
+    static SkExecutor* GetImageExecutor();
+
     // SkStrikeForGPU APIs
     const SkDescriptor& getDescriptor() const override {
         return fStrikeSpec.descriptor();
@@ -131,6 +182,10 @@ public:
     void dump() const SK_EXCLUDES(fStrikeLock);
     void dumpMemoryStatistics(SkTraceMemoryDump* dump) const SK_EXCLUDES(fStrikeLock);
 
+    // The bytes taken by the tables of published glyphs, including the ones that were outgrown
+    // (see findPublishedGlyph). They are part of the strike's memory use.
+    size_t publishedGlyphsMemoryUsed() const SK_EXCLUDES(fStrikeLock);
+
     SkGlyph* glyph(SkGlyphDigest) SK_REQUIRES(fStrikeLock);
 
 private:
@@ -145,30 +200,75 @@ private:
     // Generate the glyph digest information and update structures to add the glyph.
     SkGlyphDigest* addGlyphAndDigest(SkGlyph* glyph) SK_REQUIRES(fStrikeLock);
 
+    bool internalMergeFromBuffer(SkReadBuffer& buffer, const SkSharedGlyphLease* sharedImages)
+            SK_REQUIRES(fStrikeLock);
     SkGlyph* mergeGlyphFromBuffer(SkReadBuffer& buffer) SK_REQUIRES(fStrikeLock);
-    bool mergeGlyphAndImageFromBuffer(SkReadBuffer& buffer) SK_REQUIRES(fStrikeLock);
+    bool mergeGlyphAndImageFromBuffer(SkReadBuffer& buffer,
+                                      const SkSharedGlyphLease* sharedImages)
+            SK_REQUIRES(fStrikeLock);
     bool mergeGlyphAndPathFromBuffer(SkReadBuffer& buffer) SK_REQUIRES(fStrikeLock);
     bool mergeGlyphAndDrawableFromBuffer(SkReadBuffer& buffer) SK_REQUIRES(fStrikeLock);
 
+    // An entry in the index of fStoredGlyphs: where a glyph's image and path records are, and
+    // their hashes. A size of 0 means the glyph has no such record.
+    struct StoredGlyph {
+        uint32_t fPackedID = 0;
+        uint32_t fImageOffset = 0;
+        uint32_t fImageSize = 0;
+        uint32_t fPathOffset = 0;
+        uint32_t fPathSize = 0;
+        uint32_t fPadding = 0;
+        uint64_t fImageHash = 0;
+        uint64_t fPathHash = 0;
+    };
+
+    StoredGlyph storedGlyphAt(size_t index) const SK_REQUIRES(fStrikeLock);
+    std::optional<StoredGlyph> findStoredGlyph(SkPackedGlyphID) const SK_REQUIRES(fStrikeLock);
+
+    // Check and read a stored glyph into alloc, adding the bytes allocated to memoryIncrease.
+    // Returns nullptr if its records don't check out.
+    SkGlyph* readStoredGlyph(const StoredGlyph& stored,
+                             SkArenaAlloc* alloc,
+                             size_t* memoryIncrease) const SK_REQUIRES(fStrikeLock);
+
     // Maintain memory use statistics.
     void updateMemoryUsage(size_t increase) SK_EXCLUDES(fStrikeLock);
 
-    enum PathDetail {
-        kMetricsOnly,
-        kMetricsAndPath
+    // What has been prepared for a published glyph. These are stored in the low bits of the
+    // glyph's pointer in fPublishedGlyphs.
+    enum Prepared : uintptr_t {
+        kMetricsPrepared = 0,
+        kImagePrepared   = 1 << 0,
+        kPathPrepared    = 1 << 1,
+        kPreparedMask    = kImagePrepared | kPathPrepared,
     };
 
-    // internalPrepare will only be called with a mutex already held.
-    SkSpan<const SkGlyph*> internalPrepare(
-            SkSpan<const SkGlyphID> glyphIDs,
-            PathDetail pathDetail,
-            const SkGlyph** results) SK_REQUIRES(fStrikeLock);
+    // Return the glyphs for glyphIDs with 'prepared' done. Glyphs which were already published
+    // with 'prepared' are found without taking the lock; the lock is taken once, for the glyphs
+    // that miss.
+    template <typename GlyphIDType>
+    SkSpan<const SkGlyph*> prepareGlyphs(SkSpan<const GlyphIDType> glyphIDs,
+                                         Prepared prepared,
+                                         const SkGlyph* results[]) SK_EXCLUDES(fStrikeLock);
+
+    // Return the glyph for packedID if it has been published with at least 'prepared', otherwise
+    // return nullptr. Does not take the lock.
+    const SkGlyph* findPublishedGlyph(SkPackedGlyphID packedID, Prepared prepared) const;
+
+    // Make glyph, with 'prepared' done, visible to findPublishedGlyph, unless the strike accepts
+    // merges.
+    void publishGlyph(SkGlyph* glyph, Prepared prepared) SK_REQUIRES(fStrikeLock);
+
+    // Unpublish the table, and publish no more glyphs.
+    void stopPublishing() SK_REQUIRES(fStrikeLock);
 
     // The following are const and need no mutex protection.
     const SkFontMetrics               fFontMetrics;
     const SkGlyphPositionRoundingSpec fRoundingSpec;
     const SkStrikeSpec                fStrikeSpec;
     SkStrikeCache* const              fStrikeCache;
+    const bool                        fCanPrefillImages;
+    const uint32_t                    fRasterizerVersion;
 
     // This mutex provides protection for this specific SkStrike.
     mutable SkMutex fStrikeLock;
@@ -187,6 +287,16 @@ private:
     // Context that corresponds to the glyph information in this strike.
     const std::unique_ptr<SkScalerContext> fScalerContext SK_GUARDED_BY(fStrikeLock);
 
+    // The glyphs stored for this strike by an earlier process, which are read as they are asked
+    // for. The images of stored glyphs point into fStoredGlyphs, so it lives as long as the
+    // strike.
+    sk_sp<SkData> fStoredGlyphs SK_GUARDED_BY(fStrikeLock);
+    size_t fStoredGlyphCount SK_GUARDED_BY(fStrikeLock) {0};
+
+    // Whether a glyph gained an image or path since the strike was made, loaded or last
+    // flattened by flattenChangedGlyphs().
+    bool fHasUnstoredGlyphs SK_GUARDED_BY(fStrikeLock) {false};
+
     // Used while changing the strike to track memory increase.
     size_t fMemoryIncrease SK_GUARDED_BY(fStrikeLock) {0};
 
@@ -197,6 +307,31 @@ private:
 
     SkArenaAlloc            fAlloc SK_GUARDED_BY(fStrikeLock) {kMinAllocAmount};
 
+    // Every prefill task makes its own scaler context, so only split the work when each task
+    // gets a few images.
+    inline static constexpr size_t kMinImagesPerTask = 16;
+    inline static constexpr size_t kMaxImageTasks = 8;
+
+    // An open addressed table of glyphs whose metrics, and maybe image or path, are final,
+    // probed linearly from the hash of their packed id. Each slot is a glyph pointer or'ed with
+    // the Prepared bits that are done for it. Slots are only stored while holding fStrikeLock,
+    // and after the glyph's fields have been written, so a reader that loads a slot can read
+    // those fields without the lock: they are never changed again, and the glyph lives as long as
+    // the strike. The table is kept at most half full. To grow it, a copy twice the size is
+    // filled and then published in fPublishedGlyphs; readers may still be probing the old table,
+    // so it stays in fAlloc until the strike is deleted. All the tables, the outgrown ones too,
+    // are counted in fPublishedBytes and in the strike's memory use. Merges can rewrite glyphs, so
+    // a strike that accepts them publishes no table.
+    struct PublishedGlyphs {
+        size_t                  fMask;   // capacity - 1; the capacity is a power of 2
+        std::atomic<uintptr_t>* fSlots;
+    };
+    inline static constexpr size_t kMinPublishedCapacity = 64;
+    std::atomic<const PublishedGlyphs*> fPublishedGlyphs{nullptr};
+    size_t fPublishedCount SK_GUARDED_BY(fStrikeLock) {0};
+    size_t fPublishedBytes SK_GUARDED_BY(fStrikeLock) {0};
+    bool fAcceptsMerges SK_GUARDED_BY(fStrikeLock) {false};
+
     // The following are protected by the SkStrikeCache's mutex.
     SkStrike*                       fNext{nullptr};
     SkStrike*                       fPrev{nullptr};
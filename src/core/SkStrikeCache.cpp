@@ -7,6 +7,7 @@
 
 #include "src/core/SkStrikeCache.h"
 
+#include "include/core/SkData.h"
 #include "include/core/SkGraphics.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkTraceMemoryDump.h"
@@ -15,10 +16,12 @@
 #include "include/private/base/SkMutex.h"
 #include "src/core/SkDescriptor.h"
 #include "src/core/SkStrike.h"
+#include "src/core/SkStrikeDiskCache.h"
 #include "src/core/SkStrikeSpec.h"
 
 #include <algorithm>
 #include <utility>
+#include <vector>
 
 class SkScalerContext;
 struct SkFontMetrics;
@@ -37,10 +40,36 @@ SkStrikeCache* SkStrikeCache::GlobalStrikeCache() {
 }
 
 auto SkStrikeCache::findOrCreateStrike(const SkStrikeSpec& strikeSpec) -> sk_sp<SkStrike> {
+    sk_sp<SkStrikeDiskCache> diskCache;
+    {
+        SkAutoMutexExclusive ac(fLock);
+        sk_sp<SkStrike> strike = this->internalFindStrikeOrNull(strikeSpec.descriptor());
+        if (strike == nullptr && fDiskCache == nullptr) {
+            strike = this->internalCreateStrike(strikeSpec);
+        }
+        if (strike != nullptr) {
+            this->internalPurge();
+            return strike;
+        }
+        diskCache = fDiskCache;
+    }
+
+    // Finding the stored glyphs maps the strike's file, and the first time a typeface is seen,
+    // opens its font data, so make the strike without holding the lock. It is complete
+    // before other threads can find it.
+    auto loaded = sk_make_sp<SkStrike>(
+            this, strikeSpec, strikeSpec.createScalerContext(), nullptr, nullptr);
+    if (sk_sp<SkData> glyphs = diskCache->load(
+                strikeSpec.descriptor(), strikeSpec.typeface(), loaded->rasterizerVersion())) {
+        loaded->setStoredGlyphs(std::move(glyphs));
+    }
+
     SkAutoMutexExclusive ac(fLock);
+    // Another thread may have added the strike while the lock was released.
     sk_sp<SkStrike> strike = this->internalFindStrikeOrNull(strikeSpec.descriptor());
     if (strike == nullptr) {
-        strike = this->internalCreateStrike(strikeSpec);
+        this->internalAttachToHead(loaded);
+        strike = std::move(loaded);
     }
     this->internalPurge();
     return strike;
@@ -127,7 +156,11 @@ sk_sp<SkStrike> SkStrikeCache::createStrike(
         SkFontMetrics* maybeMetrics,
         std::unique_ptr<SkStrikePinner> pinner) {
     SkAutoMutexExclusive ac(fLock);
-    return this->internalCreateStrike(strikeSpec, maybeMetrics, std::move(pinner));
+    sk_sp<SkStrike> strike =
+            this->internalCreateStrike(strikeSpec, maybeMetrics, std::move(pinner));
+    // These strikes are filled by merges, so mark them before other threads can find them.
+    strike->acceptMerges();
+    return strike;
 }
 
 auto SkStrikeCache::internalCreateStrike(
@@ -193,6 +226,45 @@ int SkStrikeCache::setCacheCountLimit(int newCount) {
     return prevCount;
 }
 
+void SkStrikeCache::setDiskCache(sk_sp<SkStrikeDiskCache> diskCache) {
+    SkAutoMutexExclusive ac(fLock);
+    fDiskCache = std::move(diskCache);
+}
+
+sk_sp<SkStrikeDiskCache> SkStrikeCache::getDiskCache() const {
+    SkAutoMutexExclusive ac(fLock);
+    return fDiskCache;
+}
+
+void SkStrikeCache::writeToDiskCache() {
+    sk_sp<SkStrikeDiskCache> diskCache;
+    std::vector<sk_sp<SkStrike>> strikes;
+    {
+        SkAutoMutexExclusive ac(fLock);
+        if (fDiskCache == nullptr) {
+            return;
+        }
+        diskCache = fDiskCache;
+        for (SkStrike* strike = fHead; strike != nullptr; strike = strike->fNext) {
+            if (strike->fPinner == nullptr) {
+                strikes.push_back(sk_ref_sp(strike));
+            }
+        }
+    }
+
+    // Flatten and write the strikes without holding the lock. Strikes whose glyphs are all in
+    // their file already are skipped.
+    for (const sk_sp<SkStrike>& strike : strikes) {
+        if (sk_sp<SkData> glyphs = strike->flattenChangedGlyphs()) {
+            const SkStrikeSpec& strikeSpec = strike->strikeSpec();
+            diskCache->store(strikeSpec.descriptor(),
+                             strikeSpec.typeface(),
+                             strike->rasterizerVersion(),
+                             *glyphs);
+        }
+    }
+}
+
 void SkStrikeCache::forEachStrike(std::function<void(const SkStrike&)> visitor) const {
     SkAutoMutexExclusive ac(fLock);
 
@@ -13,6 +13,7 @@
 #include "include/private/base/SkMutex.h"
 #include "include/private/base/SkThreadAnnotations.h"
 #include "src/core/SkStrike.h"
+#include "src/core/SkStrikeDiskCache.h"
 #include "src/core/SkTHash.h"
 #include "src/text/StrikeForGPU.h"
 
@@ -46,6 +47,8 @@ public:
 
     sk_sp<SkStrike> findStrike(const SkDescriptor& desc) SK_EXCLUDES(fLock);
 
+    // Create a strike to fill with SkStrike::mergeFromBuffer(). It always looks glyphs up under
+    // its lock (see SkStrike::acceptMerges()).
     sk_sp<SkStrike> createStrike(
             const SkStrikeSpec& strikeSpec,
             SkFontMetrics* maybeMetrics = nullptr,
@@ -74,6 +77,13 @@ public:
     size_t setCacheSizeLimit(size_t limit) SK_EXCLUDES(fLock);
     size_t getTotalMemoryUsed() const SK_EXCLUDES(fLock);
 
+    // When a disk cache is set, new strikes read the glyphs stored for them in it as they are
+    // asked for, instead of making them with their scaler context, and writeToDiskCache() stores
+    // the glyphs of the strikes in the cache. Pinned strikes are neither loaded nor stored.
+    void setDiskCache(sk_sp<SkStrikeDiskCache> diskCache) SK_EXCLUDES(fLock);
+    sk_sp<SkStrikeDiskCache> getDiskCache() const SK_EXCLUDES(fLock);
+    void writeToDiskCache() SK_EXCLUDES(fLock);
+
 private:
     friend class SkStrike;  // for SkStrike::updateDelta
     static constexpr char kGlyphCacheDumpName[] = "skia/sk_glyph_cache";
@@ -112,6 +122,7 @@ private:
     int32_t fCacheCountLimit{SK_DEFAULT_FONT_CACHE_COUNT_LIMIT};
     int32_t fCacheCount SK_GUARDED_BY(fLock) {0};
     int32_t fPinnerCount SK_GUARDED_BY(fLock) {0};
+    sk_sp<SkStrikeDiskCache> fDiskCache SK_GUARDED_BY(fLock);
 };
 
 #endif  // SkStrikeCache_DEFINED
@@ -0,0 +1,203 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkStrikeDiskCache.h"
+
+#include "include/core/SkData.h"
+#include "include/core/SkFontArguments.h"
+#include "include/core/SkFontStyle.h"
+#include "include/core/SkStream.h"
+#include "include/core/SkTypeface.h"
+#include "include/private/base/SkTFitsIn.h"
+#include "include/private/base/SkTemplates.h"
+#include "include/private/base/SkTo.h"
+#include "src/base/SkTime.h"
+#include "src/core/SkChecksum.h"
+#include "src/core/SkDescriptor.h"
+#include "src/core/SkFontDescriptor.h"
+#include "src/core/SkScalerContext.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <optional>
+
+namespace {
+// Strike files start with this header, followed by the key and the glyphs. Change kVersion when
+// the glyph serialization or the glyphs a scaler context makes change; fRasterizerVersion covers
+// changes in the libraries the scaler contexts call. The glyphs check their own records as they
+// are read (see SkStrike::setStoredGlyphs), so the header only covers the key and the file's size.
+struct Header {
+    static constexpr uint32_t kMagic = SkSetFourByteTag('s', 'k', 'g', 'c');
+    static constexpr uint32_t kVersion = 3;
+
+    uint32_t fMagic;
+    uint32_t fVersion;
+    uint32_t fRasterizerVersion;
+    uint32_t fKeySize;
+    uint32_t fGlyphsSize;
+};
+}  // namespace
+
+// Identify the font data without reading all of it: its length, its collection index, its 'head'
+// table, which holds the font's checksum and modification date, its family name and style, and
+// its variation position. The typeface's factory id tells apart backends that rasterize the same
+// font data differently.
+static uint64_t hash_font_identity(const SkTypeface& typeface) {
+    int ttcIndex = 0;
+    std::unique_ptr<SkStreamAsset> stream = typeface.openStream(&ttcIndex);
+    if (stream == nullptr) {
+        return 0;
+    }
+    SkFontDescriptor descriptor;
+    bool isLocal = false;
+    typeface.getFontDescriptor(&descriptor, &isLocal);
+    const uint64_t identity[] = {
+            stream->getLength(), (uint64_t)ttcIndex, (uint64_t)descriptor.getFactoryId()};
+    uint64_t hash = SkChecksum::Hash64(identity, sizeof(identity));
+
+    uint8_t head[54];
+    const size_t headSize = typeface.getTableData(SkSetFourByteTag('h', 'e', 'a', 'd'),
+                                                  0, sizeof(head), head);
+    hash = SkChecksum::Hash64(head, headSize, hash);
+
+    SkString familyName;
+    typeface.getFamilyName(&familyName);
+    hash = SkChecksum::Hash64(familyName.c_str(), familyName.size(), hash);
+    const SkFontStyle style = typeface.fontStyle();
+    const int styleBits[] = {style.weight(), style.width(), style.slant()};
+    hash = SkChecksum::Hash64(styleBits, sizeof(styleBits), hash);
+
+    // Variable fonts share their font data between instances.
+    const int axisCount = typeface.getVariationDesignPosition(nullptr, 0);
+    if (axisCount > 0) {
+        skia_private::AutoSTArray<8, SkFontArguments::VariationPosition::Coordinate>
+                coordinates(axisCount);
+        if (typeface.getVariationDesignPosition(coordinates.get(), axisCount) == axisCount) {
+            hash = SkChecksum::Hash64(
+                    coordinates.get(), axisCount * sizeof(coordinates[0]), hash);
+        }
+    }
+    return hash != 0 ? hash : 1;
+}
+
+SkStrikeDiskCache::SkStrikeDiskCache(const char* directory) : fDirectory{directory} {}
+
+sk_sp<SkData> SkStrikeDiskCache::makeKey(const SkDescriptor& desc, const SkTypeface& typeface) {
+    std::optional<uint64_t> fontHash;
+    {
+        SkAutoMutexExclusive lock{fMutex};
+        if (const uint64_t* found = fFontHashes.find(typeface.uniqueID())) {
+            fontHash = *found;
+        }
+    }
+    if (!fontHash.has_value()) {
+        // Opening the font data can be slow, so don't block other typefaces' lookups on it.
+        // Threads that race here compute the same hash.
+        fontHash = hash_font_identity(typeface);
+        SkAutoMutexExclusive lock{fMutex};
+        fFontHashes.set(typeface.uniqueID(), *fontHash);
+    }
+    uint32_t recLength;
+    const void* rec = desc.findEntry(kRec_SkDescriptorTag, &recLength);
+    if (*fontHash == 0 || rec == nullptr || recLength != sizeof(SkScalerContextRec)) {
+        return nullptr;
+    }
+
+    // The key is the descriptor with the typeface id, and the checksum that covers it, cleared,
+    // followed by the font hash.
+    sk_sp<SkData> key = SkData::MakeUninitialized(desc.getLength() + sizeof(uint64_t));
+    auto bytes = static_cast<char*>(key->writable_data());
+    memcpy(bytes, &desc, desc.getLength());
+    memset(bytes, 0, sizeof(uint32_t));
+
+    SkScalerContextRec normalized = *static_cast<const SkScalerContextRec*>(rec);
+    normalized.fTypefaceID = 0;
+    memcpy(bytes + (static_cast<const char*>(rec) - reinterpret_cast<const char*>(&desc)),
+           &normalized, sizeof(normalized));
+
+    memcpy(bytes + desc.getLength(), &*fontHash, sizeof(uint64_t));
+    return key;
+}
+
+SkString SkStrikeDiskCache::pathForKey(const SkData& key) const {
+    return SkStringPrintf("%s/%016llx.skglyphs",
+                          fDirectory.c_str(),
+                          (unsigned long long)SkChecksum::Hash64(key.data(), key.size()));
+}
+
+sk_sp<SkData> SkStrikeDiskCache::load(const SkDescriptor& desc,
+                                      const SkTypeface& typeface,
+                                      uint32_t rasterizerVersion) {
+    sk_sp<SkData> key = this->makeKey(desc, typeface);
+    if (key == nullptr) {
+        return nullptr;
+    }
+    sk_sp<SkData> file = SkData::MakeFromFileName(this->pathForKey(*key).c_str());
+    if (file == nullptr || file->size() < sizeof(Header)) {
+        return nullptr;
+    }
+
+    Header header;
+    memcpy(&header, file->data(), sizeof(header));
+    const size_t glyphsOffset = sizeof(Header) + header.fKeySize;
+    if (header.fMagic != Header::kMagic ||
+        header.fVersion != Header::kVersion ||
+        header.fRasterizerVersion != rasterizerVersion ||
+        header.fKeySize != key->size() ||
+        file->size() != glyphsOffset + header.fGlyphsSize ||
+        memcmp(file->bytes() + sizeof(Header), key->data(), key->size()) != 0) {
+        return nullptr;
+    }
+    return SkData::MakeSubset(file.get(), glyphsOffset, header.fGlyphsSize);
+}
+
+bool SkStrikeDiskCache::store(const SkDescriptor& desc,
+                              const SkTypeface& typeface,
+                              uint32_t rasterizerVersion,
+                              const SkData& glyphs) {
+    sk_sp<SkData> key = this->makeKey(desc, typeface);
+    if (key == nullptr || !SkTFitsIn<uint32_t>(glyphs.size())) {
+        return false;
+    }
+    const Header header = {Header::kMagic,
+                           Header::kVersion,
+                           rasterizerVersion,
+                           SkToU32(key->size()),
+                           SkToU32(glyphs.size())};
+
+    // Write to a temporary file, and rename it over the strike's file, so that other processes
+    // never load a partly written file.
+    static std::atomic<uint32_t> gNextTempFile{0};
+    const SkString path = this->pathForKey(*key);
+    const SkString tempPath = SkStringPrintf("%s.%llx.%u.tmp",
+                                             path.c_str(),
+                                             (unsigned long long)SkTime::GetNSecs(),
+                                             gNextTempFile++);
+    bool written;
+    {
+        SkFILEWStream stream{tempPath.c_str()};
+        written = stream.isValid() &&
+                  stream.write(&header, sizeof(header)) &&
+                  stream.write(key->data(), key->size()) &&
+                  stream.write(glyphs.data(), glyphs.size());
+    }
+    if (!written) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        // Some platforms don't rename over an existing file.
+        std::remove(path.c_str());
+        if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkStrikeDiskCache_DEFINED
+#define SkStrikeDiskCache_DEFINED
+
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkString.h"
+#include "include/core/SkTypeface.h"
+#include "include/core/SkTypes.h"
+#include "include/private/base/SkMutex.h"
+#include "include/private/base/SkThreadAnnotations.h"
+#include "src/core/SkTHash.h"
+
+#include <cstdint>
+
+class SkData;
+class SkDescriptor;
+class SkTypeface;
+
+// Persists the flattened glyphs of strikes in a directory, one file per strike, so that a later
+// process can load them instead of rasterizing them again. A strike's file is keyed by its
+// SkDescriptor, with the process specific typeface id replaced by a hash of what identifies the
+// typeface's font data without reading all of it, and the typeface's backend (see
+// hash_font_identity). The file's header holds the version of the scaler context's rasterizer,
+// so that glyphs are made again after, say, the FreeType library is updated. Strikes for
+// typefaces that can't open their font data are not persisted.
+class SkStrikeDiskCache final : public SkRefCnt {
+public:
+    explicit SkStrikeDiskCache(const char* directory);
+
+    const SkString& directory() const { return fDirectory; }
+
+    // Return the glyphs last stored for the strike, or nullptr if there are none or the file
+    // doesn't match the strike. The data is memory mapped from the strike's file, and strikes use
+    // the images in it in place. Only the file's header and key are read here.
+    sk_sp<SkData> load(const SkDescriptor&, const SkTypeface&, uint32_t rasterizerVersion)
+            SK_EXCLUDES(fMutex);
+
+    // Replace the glyphs stored for the strike. Return false if they could not be written.
+    bool store(const SkDescriptor&,
+               const SkTypeface&,
+               uint32_t rasterizerVersion,
+               const SkData& glyphs) SK_EXCLUDES(fMutex);
+
+private:
+    // Return the key for the strike, or nullptr if it can't be persisted.
+    sk_sp<SkData> makeKey(const SkDescriptor&, const SkTypeface&) SK_EXCLUDES(fMutex);
+    SkString pathForKey(const SkData& key) const;
+
+    const SkString fDirectory;
+
+    SkMutex fMutex;
+    // Typeface ids are never reused in a process, so each typeface's font hash only needs to be
+    // computed once. 0 means the typeface has no font data.
+    skia_private::THashMap<SkTypefaceID, uint64_t> fFontHashes SK_GUARDED_BY(fMutex);
+};
+
+#endif  // SkStrikeDiskCache_DEFINED
@@ -0,0 +1,589 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkThreadedBitmapDevice.h"
+
+#include "include/core/SkBBHFactory.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkDrawable.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkM44.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkSurface.h"
+#include "include/private/base/SkTArray.h"
+#include "include/private/base/SkTPin.h"
+#include "include/private/base/SkTemplates.h"
+#include "src/core/SkCanvasPriv.h"
+#include "src/core/SkRecordDraw.h"
+#include "src/core/SkRecords.h"
+#include "src/core/SkTaskGroup.h"
+#include "src/core/SkTraceEvent.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+using namespace skia_private;
+
+namespace {
+
+// Bands shorter than this aren't worth the per-band playback overhead.
+constexpr int kMinBandHeight = 64;
+constexpr int kMaxDefaultBands = 64;
+
+int default_band_count(int height) {
+    return SkTPin(height / kMinBandHeight, 1, kMaxDefaultBands);
+}
+
+enum class OpKind { kSave, kSaveLayer, kRestore, kDraw, kState };
+
+struct ClassifyOp {
+    OpKind operator()(const SkRecords::Save&)       { return OpKind::kSave; }
+    OpKind operator()(const SkRecords::SaveLayer&)  { return OpKind::kSaveLayer; }
+    OpKind operator()(const SkRecords::SaveBehind&) { return OpKind::kSaveLayer; }
+    OpKind operator()(const SkRecords::Restore&)    { return OpKind::kRestore; }
+    OpKind operator()(const SkRecords::NoOp&)       { return OpKind::kState; }
+    // Annotations don't affect raster output, and are done once they have been played.
+    OpKind operator()(const SkRecords::DrawAnnotation&) { return OpKind::kDraw; }
+
+    template <typename T>
+    OpKind operator()(const T&) {
+        return (T::kTags & SkRecords::kDraw_Tag) ? OpKind::kDraw : OpKind::kState;
+    }
+};
+
+// Applies an op's change to the matrix, if it is a matrix op. These mirror SkRecords::Draw,
+// played from an identity matrix.
+struct ApplyMatrixOp {
+    bool operator()(const SkRecords::SetMatrix& r) { fCTM = SkM44(r.matrix);    return true; }
+    bool operator()(const SkRecords::SetM44& r)    { fCTM = r.matrix;           return true; }
+    bool operator()(const SkRecords::Concat& r)    { fCTM.preConcat(r.matrix);  return true; }
+    bool operator()(const SkRecords::Concat44& r)  { fCTM.preConcat(r.matrix);  return true; }
+    bool operator()(const SkRecords::Translate& r) { fCTM.preTranslate(r.dx, r.dy); return true; }
+    bool operator()(const SkRecords::Scale& r)     { fCTM.preScale(r.sx, r.sy); return true; }
+
+    template <typename T>
+    bool operator()(const T&) { return false; }
+
+    SkM44 fCTM;
+};
+
+struct IsSetM44 {
+    bool operator()(const SkRecords::SetM44&) { return true; }
+
+    template <typename T>
+    bool operator()(const T&) { return false; }
+};
+
+enum class ClipKind { kNone, kClip, kReset };
+
+struct ClassifyClip {
+    ClipKind operator()(const SkRecords::ClipPath&)   { return ClipKind::kClip; }
+    ClipKind operator()(const SkRecords::ClipRRect&)  { return ClipKind::kClip; }
+    ClipKind operator()(const SkRecords::ClipRect&)   { return ClipKind::kClip; }
+    ClipKind operator()(const SkRecords::ClipRegion&) { return ClipKind::kClip; }
+    ClipKind operator()(const SkRecords::ClipShader&) { return ClipKind::kClip; }
+    ClipKind operator()(const SkRecords::ResetClip&)  { return ClipKind::kReset; }
+
+    template <typename T>
+    ClipKind operator()(const T&) { return ClipKind::kNone; }
+};
+
+// Replaces every op before 'limit' that can no longer affect future draws with a NoOp, and
+// defrags the record. Returns the number of ops removed.
+int compact(SkRecord* record, OpKind kinds[], int limit) {
+    auto remove = [&](int i) {
+        record->replace<SkRecords::NoOp>(i);
+        kinds[i] = OpKind::kState;
+    };
+
+    // Everything in a closed save block, and every draw, has been fully resolved. What's left
+    // are the saves, clips and matrix changes that still apply to draws recorded later.
+    TArray<int> saves;
+    for (int i = 0; i < limit; ++i) {
+        switch (kinds[i]) {
+            case OpKind::kSave:
+            case OpKind::kSaveLayer:
+                saves.push_back(i);
+                break;
+            case OpKind::kRestore:
+                if (!saves.empty()) {
+                    for (int j = saves.back(); j < i; ++j) {
+                        remove(j);
+                    }
+                    saves.pop_back();
+                }
+                remove(i);
+                break;
+            case OpKind::kDraw:
+                remove(i);
+                break;
+            case OpKind::kState:
+                break;
+        }
+    }
+
+    // The saves left are all still open, so the state ops between them apply in order. Fold
+    // each run of matrix ops into one SetM44, and drop the clips a ResetClip undoes. Otherwise
+    // every flush would replay every state change recorded since the surface was made.
+    ApplyMatrixOp matrix;
+    int runBegin = -1, runEnd = -1;
+    auto endRun = [&] {
+        if (runBegin >= 0 && (runBegin != runEnd || !record->visit(runEnd, IsSetM44()))) {
+            for (int j = runBegin; j < runEnd; ++j) {
+                remove(j);
+            }
+            new (record->replace<SkRecords::SetM44>(runEnd)) SkRecords::SetM44{matrix.fCTM};
+        }
+        runBegin = runEnd = -1;
+    };
+    for (int i = 0, frameBegin = 0; i < limit; ++i) {
+        if (kinds[i] != OpKind::kState) {
+            endRun();
+            frameBegin = i + 1;
+        } else if (record->visit(i, matrix)) {
+            runBegin = runBegin < 0 ? i : runBegin;
+            runEnd = i;
+        } else if (const ClipKind clip = record->visit(i, ClassifyClip());
+                   clip != ClipKind::kNone) {
+            // A clip depends on the matrix before it, so it ends the run. NoOps don't.
+            endRun();
+            if (clip == ClipKind::kReset) {
+                for (int j = frameBegin; j < i; ++j) {
+                    if (record->visit(j, ClassifyClip()) != ClipKind::kNone) {
+                        remove(j);
+                    }
+                }
+            }
+        }
+    }
+    endRun();
+
+    const int before = record->count();
+    record->defrag();
+    return before - record->count();
+}
+
+// A run of ops played either by every band in parallel, or by one canvas over the whole device.
+struct Segment {
+    int  fBegin, fEnd;
+    bool fSerial;
+};
+
+}  // namespace
+
+SkThreadedBitmapDevice::SkThreadedBitmapDevice(const SkBitmap& bitmap,
+                                               const SkSurfaceProps& props,
+                                               SkExecutor* executor,
+                                               int bandCount)
+        : SkBitmapDevice(bitmap, props)
+        , fExecutor(executor ? executor : &SkExecutor::GetDefault())
+        , fRequestedBandCount(bandCount)
+        , fBandCount(bandCount > 0 ? std::min(bandCount, std::max(bitmap.height(), 1))
+                                   : default_band_count(bitmap.height()))
+        , fRecord(sk_make_sp<SkRecord>())
+        , fRecorder(fRecord.get(), SkRect::Make(bitmap.dimensions())) {}
+
+SkThreadedBitmapDevice::~SkThreadedBitmapDevice() = default;
+
+void SkThreadedBitmapDevice::willSaveLayer() {
+    fOpenLayers.push_back({fRecord->count(), fRecorder.getSaveCount()});
+}
+
+void SkThreadedBitmapDevice::willRestore() {
+    if (!fOpenLayers.empty() && fOpenLayers.back().fSaveCount == fRecorder.getSaveCount() - 1) {
+        fOpenLayers.pop_back();
+    }
+}
+
+void SkThreadedBitmapDevice::flushPendingDraws() {
+    // Ops inside a layer that is still open can't be drawn yet: their result depends on how the
+    // layer is eventually restored.
+    const int limit = fOpenLayers.empty() ? fRecord->count() : fOpenLayers[0].fOpIndex;
+    if (limit <= fResolvedOps) {
+        return;
+    }
+
+    SkPixmap dst;
+    if (!this->SkBitmapDevice::onPeekPixels(&dst)) {
+        return;
+    }
+    TRACE_EVENT1("skia", TRACE_FUNC, "ops", limit);
+
+    const SkIRect deviceBounds = SkIRect::MakeSize(dst.dimensions());
+    AutoTArray<SkRect> bounds(fRecord->count());
+    AutoTMalloc<SkBBoxHierarchy::Metadata> meta(fRecord->count());
+    SkRecordFillBounds(SkRect::Make(deviceBounds), *fRecord, bounds.get(), meta);
+
+    // Top-level layers are played serially: a layer's backdrop and restore read pixels from
+    // every band, and rasterizing its contents once per band would cost a full layer per band.
+    // Everything else is split into bands.
+    AutoTArray<OpKind> kinds(limit);
+    TArray<Segment> segments;
+    for (int i = 0, layerDepth = 0, saveDepth = 0; i < limit; ++i) {
+        kinds[i] = fRecord->visit(i, ClassifyOp());
+        if (layerDepth == 0 && kinds[i] == OpKind::kSaveLayer) {
+            segments.push_back({i, i, true});
+            layerDepth = 1;
+            saveDepth = 0;
+        } else if (layerDepth > 0) {
+            if (kinds[i] == OpKind::kSave || kinds[i] == OpKind::kSaveLayer) {
+                saveDepth++;
+            } else if (kinds[i] == OpKind::kRestore && saveDepth-- == 0) {
+                layerDepth = 0;
+            }
+        } else if (segments.empty() || segments.back().fSerial) {
+            segments.push_back({i, i, false});
+        }
+        segments.back().fEnd = i + 1;
+    }
+
+    // Build each band's command list: the ops whose bounds touch its rows, in record order.
+    const int bandHeight = (deviceBounds.height() + fBandCount - 1) / fBandCount;
+    TArray<TArray<int>> bandOps;
+    bandOps.push_back_n(fBandCount);
+    for (const Segment& segment : segments) {
+        if (segment.fSerial) {
+            continue;
+        }
+        for (int i = segment.fBegin; i < segment.fEnd; ++i) {
+            // Like SkCanvas's quick reject, allow a pixel of slop for antialiasing.
+            SkIRect opBounds = bounds[i].roundOut().makeOutset(1, 1);
+            if (!opBounds.intersect(deviceBounds)) {
+                continue;
+            }
+            const int first = opBounds.fTop / bandHeight,
+                      last  = (opBounds.fBottom - 1) / bandHeight;
+            for (int b = first; b <= last; ++b) {
+                bandOps[b].push_back(i);
+            }
+        }
+    }
+
+    SkBitmap bitmap;
+    bitmap.installPixels(dst);
+
+    // Each band plays back into its own canvas over the shared pixels. The band devices cover
+    // the whole device and are only limited in the rows they may write, so every draw is
+    // rasterized exactly as it would be by a serial draw.
+    TArray<std::unique_ptr<SkCanvas>> bandCanvases;
+    TArray<int> bandCursors;
+    bandCanvases.push_back_n(fBandCount);
+    bandCursors.push_back_n(fBandCount, 0);
+
+    std::unique_ptr<SkCanvas> serialCanvas;
+    int serialCursor = 0;
+
+    for (const Segment& segment : segments) {
+        if (segment.fSerial) {
+            if (!serialCanvas) {
+                serialCanvas = std::make_unique<SkCanvas>(bitmap, this->surfaceProps());
+            }
+            SkRecords::Draw draw(serialCanvas.get(), nullptr, nullptr, 0);
+            // Catch up on the matrix, clip and save state set by the ops since the last layer.
+            for (; serialCursor < segment.fBegin; ++serialCursor) {
+                if (kinds[serialCursor] != OpKind::kDraw) {
+                    fRecord->visit(serialCursor, draw);
+                }
+            }
+            for (int i = segment.fBegin; i < segment.fEnd; ++i) {
+                fRecord->visit(i, draw);
+            }
+            serialCursor = segment.fEnd;
+            continue;
+        }
+
+        SkTaskGroup bands(*fExecutor);
+        bands.batch(fBandCount, [&](int b) {
+            const TArray<int>& ops = bandOps[b];
+            int& cursor = bandCursors[b];
+            if (cursor == ops.size() || ops[cursor] >= segment.fEnd) {
+                return;
+            }
+            if (!bandCanvases[b]) {
+                auto device = sk_make_sp<SkBitmapDevice>(bitmap, this->surfaceProps());
+                device->setBlitBounds(SkIRect::MakeLTRB(0, b * bandHeight,
+                                                        deviceBounds.width(),
+                                                        std::min((b + 1) * bandHeight,
+                                                                 deviceBounds.height())));
+                bandCanvases[b] = std::make_unique<SkCanvas>(std::move(device));
+            }
+            SkRecords::Draw draw(bandCanvases[b].get(), nullptr, nullptr, 0);
+            for (; cursor < ops.size() && ops[cursor] < segment.fEnd; ++cursor) {
+                fRecord->visit(ops[cursor], draw);
+            }
+        });
+        bands.wait();
+    }
+
+    const int removed = compact(fRecord.get(), kinds.get(), limit);
+    for (OpenLayer& layer : fOpenLayers) {
+        layer.fOpIndex -= removed;
+    }
+    fResolvedOps = limit - removed;
+}
+
+sk_sp<SkSurface> SkThreadedBitmapDevice::makeSurface(const SkImageInfo& info,
+                                                     const SkSurfaceProps& props) {
+    return SkSurfaces::RasterThreaded(info, fExecutor, fRequestedBandCount, &props);
+}
+
+bool SkThreadedBitmapDevice::onReadPixels(const SkPixmap& pm, int x, int y) {
+    this->flushPendingDraws();
+    return this->SkBitmapDevice::onReadPixels(pm, x, y);
+}
+
+bool SkThreadedBitmapDevice::onWritePixels(const SkPixmap& pm, int x, int y) {
+    this->flushPendingDraws();
+    return this->SkBitmapDevice::onWritePixels(pm, x, y);
+}
+
+bool SkThreadedBitmapDevice::onPeekPixels(SkPixmap* pmap) {
+    this->flushPendingDraws();
+    return this->SkBitmapDevice::onPeekPixels(pmap);
+}
+
+bool SkThreadedBitmapDevice::onAccessPixels(SkPixmap* pmap) {
+    this->flushPendingDraws();
+    return this->SkBitmapDevice::onAccessPixels(pmap);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+SkThreadedRasterCanvas::SkThreadedRasterCanvas(sk_sp<SkThreadedBitmapDevice> device)
+        : INHERITED(device)
+        , fDevice(std::move(device)) {}
+
+SkThreadedRasterCanvas::~SkThreadedRasterCanvas() = default;
+
+bool SkThreadedRasterCanvas::notifyDraw() {
+    return this->predrawNotify();
+}
+
+void SkThreadedRasterCanvas::willSave() {
+    this->drawRecorder()->save();
+}
+
+SkCanvas::SaveLayerStrategy SkThreadedRasterCanvas::getSaveLayerStrategy(
+        const SaveLayerRec& rec) {
+    fDevice->willSaveLayer();
+    this->drawRecorder()->saveLayer(rec);
+    this->INHERITED::getSaveLayerStrategy(rec);
+    // The layer is drawn when the recording is played back.
+    return kNoLayer_SaveLayerStrategy;
+}
+
+bool SkThreadedRasterCanvas::onDoSaveBehind(const SkRect* bounds) {
+    fDevice->willSaveLayer();
+    SkCanvasPriv::SaveBehind(this->drawRecorder(), bounds);
+    this->INHERITED::onDoSaveBehind(bounds);
+    return false;
+}
+
+void SkThreadedRasterCanvas::willRestore() {
+    fDevice->willRestore();
+    this->drawRecorder()->restore();
+}
+
+void SkThreadedRasterCanvas::didConcat44(const SkM44& m) {
+    this->drawRecorder()->concat(m);
+}
+
+void SkThreadedRasterCanvas::didSetM44(const SkM44& m) {
+    this->drawRecorder()->setMatrix(m);
+}
+
+void SkThreadedRasterCanvas::didScale(SkScalar x, SkScalar y) {
+    this->drawRecorder()->scale(x, y);
+}
+
+void SkThreadedRasterCanvas::didTranslate(SkScalar x, SkScalar y) {
+    this->drawRecorder()->translate(x, y);
+}
+
+void SkThreadedRasterCanvas::onClipRect(const SkRect& rect, SkClipOp op, ClipEdgeStyle edgeStyle) {
+    this->drawRecorder()->clipRect(rect, op, kSoft_ClipEdgeStyle == edgeStyle);
+    this->INHERITED::onClipRect(rect, op, edgeStyle);
+}
+
+void SkThreadedRasterCanvas::onClipRRect(const SkRRect& rrect, SkClipOp op,
+                                         ClipEdgeStyle edgeStyle) {
+    this->drawRecorder()->clipRRect(rrect, op, kSoft_ClipEdgeStyle == edgeStyle);
+    this->INHERITED::onClipRRect(rrect, op, edgeStyle);
+}
+
+void SkThreadedRasterCanvas::onClipPath(const SkPath& path, SkClipOp op, ClipEdgeStyle edgeStyle) {
+    this->drawRecorder()->clipPath(path, op, kSoft_ClipEdgeStyle == edgeStyle);
+    this->INHERITED::onClipPath(path, op, edgeStyle);
+}
+
+void SkThreadedRasterCanvas::onClipShader(sk_sp<SkShader> sh, SkClipOp op) {
+    this->drawRecorder()->clipShader(sh, op);
+    this->INHERITED::onClipShader(std::move(sh), op);
+}
+
+void SkThreadedRasterCanvas::onClipRegion(const SkRegion& deviceRgn, SkClipOp op) {
+    this->drawRecorder()->clipRegion(deviceRgn, op);
+    this->INHERITED::onClipRegion(deviceRgn, op);
+}
+
+void SkThreadedRasterCanvas::onResetClip() {
+    SkCanvasPriv::ResetClip(this->drawRecorder());
+    this->INHERITED::onResetClip();
+}
+
+// Draws have already been preprocessed by the public SkCanvas entry points, so they go straight
+// to the recorder's hooks, recording exactly what SkPictureRecorder would.
+#define RECORD_DRAW(call)             \
+    if (this->notifyDraw()) {         \
+        this->drawRecorder()->call;   \
+    }
+
+void SkThreadedRasterCanvas::onDrawPaint(const SkPaint& paint) {
+    RECORD_DRAW(onDrawPaint(paint))
+}
+
+void SkThreadedRasterCanvas::onDrawBehind(const SkPaint& paint) {
+    if (this->notifyDraw()) {
+        SkCanvasPriv::DrawBehind(this->drawRecorder(), paint);
+    }
+}
+
+void SkThreadedRasterCanvas::onDrawPoints(PointMode mode, size_t count, const SkPoint pts[],
+                                          const SkPaint& paint) {
+    RECORD_DRAW(onDrawPoints(mode, count, pts, paint))
+}
+
+void SkThreadedRasterCanvas::onDrawRect(const SkRect& rect, const SkPaint& paint) {
+    RECORD_DRAW(onDrawRect(rect, paint))
+}
+
+void SkThreadedRasterCanvas::onDrawRegion(const SkRegion& region, const SkPaint& paint) {
+    RECORD_DRAW(onDrawRegion(region, paint))
+}
+
+void SkThreadedRasterCanvas::onDrawOval(const SkRect& rect, const SkPaint& paint) {
+    RECORD_DRAW(onDrawOval(rect, paint))
+}
+
+void SkThreadedRasterCanvas::onDrawArc(const SkRect& rect, SkScalar startAngle,
+                                       SkScalar sweepAngle, bool useCenter,
+                                       const SkPaint& paint) {
+    RECORD_DRAW(onDrawArc(rect, startAngle, sweepAngle, useCenter, paint))
+}
+
+void SkThreadedRasterCanvas::onDrawRRect(const SkRRect& rrect, const SkPaint& paint) {
+    RECORD_DRAW(onDrawRRect(rrect, paint))
+}
+
+void SkThreadedRasterCanvas::onDrawDRRect(const SkRRect& outer, const SkRRect& inner,
+                                          const SkPaint& paint) {
+    RECORD_DRAW(onDrawDRRect(outer, inner, paint))
+}
+
+void SkThreadedRasterCanvas::onDrawPath(const SkPath& path, const SkPaint& paint) {
+    RECORD_DRAW(onDrawPath(path, paint))
+}
+
+void SkThreadedRasterCanvas::onDrawImage2(const SkImage* image, SkScalar left, SkScalar top,
+                                          const SkSamplingOptions& sampling,
+                                          const SkPaint* paint) {
+    RECORD_DRAW(onDrawImage2(image, left, top, sampling, paint))
+}
+
+void SkThreadedRasterCanvas::onDrawImageRect2(const SkImage* image, const SkRect& src,
+                                              const SkRect& dst,
+                                              const SkSamplingOptions& sampling,
+                                              const SkPaint* paint,
+                                              SrcRectConstraint constraint) {
+    RECORD_DRAW(onDrawImageRect2(image, src, dst, sampling, paint, constraint))
+}
+
+void SkThreadedRasterCanvas::onDrawImageLattice2(const SkImage* image, const Lattice& lattice,
+                                                 const SkRect& dst, SkFilterMode filter,
+                                                 const SkPaint* paint) {
+    RECORD_DRAW(onDrawImageLattice2(image, lattice, dst, filter, paint))
+}
+
+void SkThreadedRasterCanvas::onDrawAtlas2(const SkImage* image, const SkRSXform xform[],
+                                          const SkRect tex[], const SkColor colors[], int count,
+                                          SkBlendMode mode, const SkSamplingOptions& sampling,
+                                          const SkRect* cull, const SkPaint* paint) {
+    RECORD_DRAW(onDrawAtlas2(image, xform, tex, colors, count, mode, sampling, cull, paint))
+}
+
+void SkThreadedRasterCanvas::onDrawGlyphRunList(const sktext::GlyphRunList& list,
+                                                const SkPaint& paint) {
+    RECORD_DRAW(onDrawGlyphRunList(list, paint))
+}
+
+void SkThreadedRasterCanvas::onDrawTextBlob(const SkTextBlob* blob, SkScalar x, SkScalar y,
+                                            const SkPaint& paint) {
+    RECORD_DRAW(onDrawTextBlob(blob, x, y, paint))
+}
+
+void SkThreadedRasterCanvas::onDrawSlug(const sktext::gpu::Slug* slug, const SkPaint& paint) {
+    RECORD_DRAW(onDrawSlug(slug, paint))
+}
+
+void SkThreadedRasterCanvas::onDrawPatch(const SkPoint cubics[12], const SkColor colors[4],
+                                         const SkPoint texCoords[4], SkBlendMode mode,
+                                         const SkPaint& paint) {
+    RECORD_DRAW(onDrawPatch(cubics, colors, texCoords, mode, paint))
+}
+
+void SkThreadedRasterCanvas::onDrawVerticesObject(const SkVertices* vertices, SkBlendMode mode,
+                                                  const SkPaint& paint) {
+    RECORD_DRAW(onDrawVerticesObject(vertices, mode, paint))
+}
+
+void SkThreadedRasterCanvas::onDrawMesh(const SkMesh& mesh, sk_sp<SkBlender> blender,
+                                        const SkPaint& paint) {
+    RECORD_DRAW(onDrawMesh(mesh, std::move(blender), paint))
+}
+
+void SkThreadedRasterCanvas::onDrawShadowRec(const SkPath& path, const SkDrawShadowRec& rec) {
+    RECORD_DRAW(onDrawShadowRec(path, rec))
+}
+
+void SkThreadedRasterCanvas::onDrawPicture(const SkPicture* picture, const SkMatrix* matrix,
+                                           const SkPaint* paint) {
+    // Record the picture's ops rather than the picture, so that each band only plays the ops
+    // that touch it. Layers inside the picture are then seen, and played serially, like any
+    // other layer.
+    this->SkCanvas::onDrawPicture(picture, matrix, paint);
+}
+
+void SkThreadedRasterCanvas::onDrawDrawable(SkDrawable* drawable, const SkMatrix* matrix) {
+    // A drawable can change before the flush, so record what it draws now.
+    this->drawPicture(drawable->makePictureSnapshot(), matrix, nullptr);
+}
+
+void SkThreadedRasterCanvas::onDrawAnnotation(const SkRect& rect, const char key[],
+                                              SkData* value) {
+    this->drawRecorder()->onDrawAnnotation(rect, key, value);
+}
+
+void SkThreadedRasterCanvas::onDrawEdgeAAQuad(const SkRect& rect, const SkPoint clip[4],
+                                              QuadAAFlags aa, const SkColor4f& color,
+                                              SkBlendMode mode) {
+    RECORD_DRAW(onDrawEdgeAAQuad(rect, clip, aa, color, mode))
+}
+
+void SkThreadedRasterCanvas::onDrawEdgeAAImageSet2(const ImageSetEntry set[], int count,
+                                                   const SkPoint dstClips[],
+                                                   const SkMatrix preViewMatrices[],
+                                                   const SkSamplingOptions& sampling,
+                                                   const SkPaint* paint,
+                                                   SrcRectConstraint constraint) {
+    RECORD_DRAW(onDrawEdgeAAImageSet2(set, count, dstClips, preViewMatrices, sampling, paint,
+                                      constraint))
+}
+
+#undef RECORD_DRAW
@@ -0,0 +1,182 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkThreadedBitmapDevice_DEFINED
+#define SkThreadedBitmapDevice_DEFINED
+
+#include "include/core/SkCanvas.h"
+#include "include/core/SkCanvasVirtualEnforcer.h"
+#include "include/core/SkRefCnt.h"
+#include "include/private/base/SkTDArray.h"
+#include "src/core/SkBitmapDevice.h"
+#include "src/core/SkRecord.h"
+#include "src/core/SkRecorder.h"
+
+#include <cstddef>
+
+class SkBitmap;
+class SkData;
+class SkDrawable;
+class SkExecutor;
+class SkImage;
+class SkMatrix;
+class SkPaint;
+class SkPath;
+class SkPicture;
+class SkPixmap;
+class SkRRect;
+class SkRegion;
+class SkShader;
+class SkSurface;
+class SkSurfaceProps;
+class SkTextBlob;
+class SkVertices;
+enum class SkBlendMode;
+enum class SkClipOp;
+struct SkDrawShadowRec;
+struct SkPoint;
+struct SkRSXform;
+struct SkRect;
+namespace sktext { class GlyphRunList; }
+namespace sktext::gpu { class Slug; }
+
+// An SkBitmapDevice that defers drawing: draws made through an SkThreadedRasterCanvas are
+// recorded into an SkRecord, and rasterized later by flushPendingDraws(). The flush splits the
+// device into horizontal bands, builds a per-band command list from the recorded ops' bounds,
+// and plays each band back in parallel on an SkExecutor. Every band draws with the same matrix
+// and clip as the serial path, and is only limited in which rows it may write (see
+// SkBitmapDevice::setBlitBounds()), so the output is identical. Top-level layers read rows that
+// other bands write, so they are played on a single thread. Nested pictures are recorded op by
+// op, so their layers are too.
+//
+// Pending draws are flushed automatically before the device's pixels are read, peeked, accessed
+// or written.
+class SkThreadedBitmapDevice final : public SkBitmapDevice {
+public:
+    // If bandCount <= 0, a band count is chosen from the device height.
+    SkThreadedBitmapDevice(const SkBitmap&, const SkSurfaceProps&, SkExecutor*, int bandCount);
+    ~SkThreadedBitmapDevice() override;
+
+    SkRecorder* drawRecorder() { return &fRecorder; }
+
+    // Called by SkThreadedRasterCanvas around recorded saveLayer()/restore() calls. Draws
+    // inside a layer that is still open cannot be resolved yet, so flushes stop at the
+    // outermost open layer.
+    void willSaveLayer();
+    void willRestore();
+
+    // Rasterize all recorded draws that can be resolved into the device's pixels.
+    void flushPendingDraws();
+
+    int bandCount() const { return fBandCount; }
+
+    // Surfaces made from this device are threaded on the same executor.
+    sk_sp<SkSurface> makeSurface(const SkImageInfo&, const SkSurfaceProps&) override;
+
+protected:
+    bool onReadPixels(const SkPixmap&, int x, int y) override;
+    bool onWritePixels(const SkPixmap&, int x, int y) override;
+    bool onPeekPixels(SkPixmap*) override;
+    bool onAccessPixels(SkPixmap*) override;
+
+private:
+    struct OpenLayer {
+        int fOpIndex;    // index of the SaveLayer/SaveBehind op in fRecord
+        int fSaveCount;  // fRecorder's save count before the layer was saved
+    };
+
+    SkExecutor*           fExecutor;
+    const int             fRequestedBandCount;  // as passed in, <= 0 to choose from the height
+    const int             fBandCount;
+    sk_sp<SkRecord>       fRecord;
+    SkRecorder            fRecorder;
+    SkTDArray<OpenLayer>  fOpenLayers;
+    int                   fResolvedOps = 0;  // leading ops already played by a flush
+};
+
+// The canvas for an SkThreadedBitmapDevice. Matrix and clip calls are applied both to the
+// device, so queries like getDeviceClipBounds() and quickReject() see the real state, and to the
+// device's recorder. Draw calls are only recorded.
+class SkThreadedRasterCanvas final : public SkCanvasVirtualEnforcer<SkCanvas> {
+public:
+    explicit SkThreadedRasterCanvas(sk_sp<SkThreadedBitmapDevice>);
+    ~SkThreadedRasterCanvas() override;
+
+    SkThreadedBitmapDevice* threadedDevice() const { return fDevice.get(); }
+
+protected:
+    void willSave() override;
+    SaveLayerStrategy getSaveLayerStrategy(const SaveLayerRec&) override;
+    bool onDoSaveBehind(const SkRect*) override;
+    void willRestore() override;
+
+    void didConcat44(const SkM44&) override;
+    void didSetM44(const SkM44&) override;
+    void didScale(SkScalar, SkScalar) override;
+    void didTranslate(SkScalar, SkScalar) override;
+
+    void onDrawDRRect(const SkRRect&, const SkRRect&, const SkPaint&) override;
+    void onDrawGlyphRunList(const sktext::GlyphRunList&, const SkPaint&) override;
+    void onDrawTextBlob(const SkTextBlob* blob, SkScalar x, SkScalar y,
+                        const SkPaint& paint) override;
+    void onDrawSlug(const sktext::gpu::Slug* slug, const SkPaint& paint) override;
+    void onDrawPatch(const SkPoint cubics[12], const SkColor colors[4],
+                     const SkPoint texCoords[4], SkBlendMode, const SkPaint& paint) override;
+
+    void onDrawPaint(const SkPaint&) override;
+    void onDrawBehind(const SkPaint&) override;
+    void onDrawPoints(PointMode, size_t count, const SkPoint pts[], const SkPaint&) override;
+    void onDrawRect(const SkRect&, const SkPaint&) override;
+    void onDrawRegion(const SkRegion&, const SkPaint&) override;
+    void onDrawOval(const SkRect&, const SkPaint&) override;
+    void onDrawArc(const SkRect&, SkScalar, SkScalar, bool, const SkPaint&) override;
+    void onDrawRRect(const SkRRect&, const SkPaint&) override;
+    void onDrawPath(const SkPath&, const SkPaint&) override;
+
+    void onDrawImage2(const SkImage*, SkScalar, SkScalar, const SkSamplingOptions&,
+                      const SkPaint*) override;
+    void onDrawImageRect2(const SkImage*, const SkRect&, const SkRect&, const SkSamplingOptions&,
+                          const SkPaint*, SrcRectConstraint) override;
+    void onDrawImageLattice2(const SkImage*, const Lattice&, const SkRect&, SkFilterMode,
+                             const SkPaint*) override;
+    void onDrawAtlas2(const SkImage*, const SkRSXform[], const SkRect[], const SkColor[], int,
+                      SkBlendMode, const SkSamplingOptions&, const SkRect*,
+                      const SkPaint*) override;
+
+    void onDrawVerticesObject(const SkVertices*, SkBlendMode, const SkPaint&) override;
+    void onDrawMesh(const SkMesh&, sk_sp<SkBlender>, const SkPaint&) override;
+    void onDrawShadowRec(const SkPath&, const SkDrawShadowRec&) override;
+
+    void onClipRect(const SkRect&, SkClipOp, ClipEdgeStyle) override;
+    void onClipRRect(const SkRRect&, SkClipOp, ClipEdgeStyle) override;
+    void onClipPath(const SkPath&, SkClipOp, ClipEdgeStyle) override;
+    void onClipShader(sk_sp<SkShader>, SkClipOp) override;
+    void onClipRegion(const SkRegion&, SkClipOp) override;
+    void onResetClip() override;
+
+    void onDrawPicture(const SkPicture*, const SkMatrix*, const SkPaint*) override;
+    void onDrawDrawable(SkDrawable*, const SkMatrix*) override;
+    void onDrawAnnotation(const SkRect&, const char[], SkData*) override;
+
+    void onDrawEdgeAAQuad(const SkRect&, const SkPoint[4], QuadAAFlags, const SkColor4f&,
+                          SkBlendMode) override;
+    void onDrawEdgeAAImageSet2(const ImageSetEntry[], int count, const SkPoint[], const SkMatrix[],
+                               const SkSamplingOptions&, const SkPaint*,
+                               SrcRectConstraint) override;
+
+private:
+    SkRecorder* drawRecorder() const { return fDevice->drawRecorder(); }
+
+    // Gives the owning surface a chance to copy-on-write before a draw is recorded.
+    bool notifyDraw();
+
+    sk_sp<SkThreadedBitmapDevice> fDevice;
+
+    using INHERITED = SkCanvasVirtualEnforcer<SkCanvas>;
+};
+
+#endif  // SkThreadedBitmapDevice_DEFINED
@@ -13,6 +13,7 @@
 #include "include/core/SkColorType.h"
 #include "include/core/SkData.h"
 #include "include/core/SkDataTable.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkPixmap.h"
 #include "include/core/SkRefCnt.h"
@@ -27,8 +28,10 @@
 #include "modules/skcms/skcms.h"
 #include "src/base/SkMSAN.h"
 #include "src/codec/SkPngPriv.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/encode/SkImageEncoderFns.h"
 #include "src/encode/SkImageEncoderPriv.h"
+#include "src/encode/SkPngFilters.h"
 #include "src/image/SkImage_Base.h"
 
 #include <algorithm>
@@ -42,6 +45,8 @@
 #include <png.h>
 #include <pngconf.h>
 
+#include "zlib.h"  // NO_G3_REWRITE
+
 class GrDirectContext;
 class SkImage;
 
@@ -87,6 +92,14 @@ public:
     int pngBytesPerPixel() const { return fPngBytesPerPixel; }
     transform_scanline_proc proc() const { return fProc; }
 
+    // Used when the encoder filters and compresses the rows itself.
+    SkExecutor* executor() const { return fExecutor; }
+    int filters() const { return fFilters; }
+    int zlibLevel() const { return fZLibLevel; }
+    // The bytes of a pixel in the file, once the filler is stripped from rows that have one.
+    int filePixelBytes() const { return fStripFiller ? fPngBytesPerPixel - 2 : fPngBytesPerPixel; }
+    bool stripFiller() const { return fStripFiller; }
+
     ~SkPngEncoderMgr() { png_destroy_write_struct(&fPngPtr, &fInfoPtr); }
 
 private:
@@ -96,6 +109,10 @@ private:
     png_infop fInfoPtr;
     int fPngBytesPerPixel;
     transform_scanline_proc fProc;
+    SkExecutor* fExecutor = nullptr;
+    int fFilters = 0;
+    int fZLibLevel = 0;
+    bool fStripFiller = false;
 };
 
 std::unique_ptr<SkPngEncoderMgr> SkPngEncoderMgr::Make(SkWStream* stream) {
@@ -229,10 +246,13 @@ bool SkPngEncoderMgr::setHeader(const SkImageInfo& srcInfo, const SkPngEncoder::
     int filters = (int)options.fFilterFlags & (int)SkPngEncoder::FilterFlag::kAll;
     SkASSERT(filters == (int)options.fFilterFlags);
     png_set_filter(fPngPtr, PNG_FILTER_TYPE_BASE, filters);
+    fFilters = filters;
 
     int zlibLevel = std::min(std::max(0, options.fZLibLevel), 9);
     SkASSERT(zlibLevel == options.fZLibLevel);
     png_set_compression_level(fPngPtr, zlibLevel);
+    fZLibLevel = zlibLevel;
+    fExecutor = options.fExecutor;
 
     // Set comments in tEXt chunk
     const sk_sp<SkDataTable>& comments = options.fComments;
@@ -437,6 +457,7 @@ bool SkPngEncoderMgr::writeInfo(const SkImageInfo& srcInfo) {
         // For kOpaque, kRGBA_F16, we will keep the row as RGBA and tell libpng
         // to skip the alpha channel.
         png_set_filler(fPngPtr, 0, PNG_FILLER_AFTER);
+        fStripFiller = true;
     }
 
     return true;
@@ -444,6 +465,281 @@ bool SkPngEncoderMgr::writeInfo(const SkImageInfo& srcInfo) {
 
 void SkPngEncoderMgr::chooseProc(const SkImageInfo& srcInfo) { fProc = choose_proc(srcInfo); }
 
+namespace {
+// Rows are compressed in strips of about this many bytes.
+constexpr size_t kStripBytes = 256 * 1024;
+// The deflate window. Each strip is primed with this much of the data before it.
+constexpr size_t kWindowBytes = 32 * 1024;
+// zlib takes at most this many bytes at a time.
+constexpr size_t kMaxZLibChunk = 1 << 30;
+
+struct CompressedStrip {
+    std::vector<uint8_t> fData;
+    // The Adler-32 checksum and size of the filtered rows, before compression.
+    uint32_t fAdler = 0;
+    size_t fFilteredSize = 0;
+    bool fSuccess = false;
+};
+}  // namespace
+
+static int zlib_strategy(int filters) {
+    // libpng's default strategy.
+    return filters == PNG_FILTER_NONE ? Z_DEFAULT_STRATEGY : Z_FILTERED;
+}
+
+// The two byte header of a zlib stream with a 32K window, as deflate() would write it.
+static void zlib_header(int level, int strategy, uint8_t header[2]) {
+    int levelFlags;
+    if (strategy >= Z_HUFFMAN_ONLY || level < 2) {
+        levelFlags = 0;
+    } else if (level < 6) {
+        levelFlags = 1;
+    } else if (level == 6) {
+        levelFlags = 2;
+    } else {
+        levelFlags = 3;
+    }
+    int value = (0x78 << 8) | (levelFlags << 6);
+    value += 31 - (value % 31);
+    header[0] = value >> 8;
+    header[1] = value & 0xFF;
+}
+
+static void transform_row(const SkPngEncoderMgr& mgr, const SkPixmap& src, int y, uint8_t* dst) {
+    const void* srcRow = src.addr(0, y);
+    sk_msan_assert_initialized(srcRow,
+                               (const uint8_t*)srcRow + (src.width() << src.shiftPerPixel()));
+    mgr.proc()((char*)dst, (const char*)srcRow, src.width(),
+               SkColorTypeBytesPerPixel(src.colorType()));
+    if (mgr.stripFiller()) {
+        // Like png_set_filler(PNG_FILLER_AFTER), drop the last channel of each pixel.
+        const int srcBytes = mgr.pngBytesPerPixel();
+        const int dstBytes = mgr.filePixelBytes();
+        for (int x = 1; x < src.width(); ++x) {
+            memmove(dst + x * dstBytes, dst + x * srcBytes, dstBytes);
+        }
+    }
+}
+
+static uint32_t adler32_of(const uint8_t* data, size_t size) {
+    uLong adler = adler32(0, nullptr, 0);
+    while (size > 0) {
+        const size_t chunk = std::min(size, kMaxZLibChunk);
+        adler = adler32(adler, data, chunk);
+        data += chunk;
+        size -= chunk;
+    }
+    return adler;
+}
+
+// Filters rows [startRow, endRow) and compresses them as raw deflate blocks, primed with the
+// filtered rows before them. The blocks end with a sync flush so that the next strip's blocks
+// can follow them, unless finish is set, which makes these the last blocks of the stream.
+static bool compress_strip(const SkPngEncoderMgr& mgr,
+                           const SkPixmap& src,
+                           int startRow,
+                           int endRow,
+                           bool finish,
+                           CompressedStrip* strip) {
+    const size_t transformedBytes = mgr.pngBytesPerPixel() * src.width();
+    const size_t rowBytes = mgr.filePixelBytes() * src.width();
+    const size_t stride = 1 + rowBytes;
+
+    // Filter enough of the rows before the strip to fill the window. Filtering a row only
+    // depends on the row above it, so these are the same bytes the previous strip compresses.
+    const int primeRows = std::min<int>(startRow, (kWindowBytes + stride - 1) / stride);
+    const int firstRow = startRow - primeRows;
+
+    std::vector<uint8_t> filtered((endRow - firstRow) * stride);
+    std::vector<uint8_t> rows(2 * transformedBytes);
+    std::vector<uint8_t> scratch(stride);
+    uint8_t* prevRow = rows.data();
+    uint8_t* row = rows.data() + transformedBytes;
+    if (firstRow > 0) {
+        transform_row(mgr, src, firstRow - 1, prevRow);
+    } else {
+        memset(prevRow, 0, transformedBytes);
+    }
+    for (int y = firstRow; y < endRow; ++y) {
+        transform_row(mgr, src, y, row);
+        SkPngFilters::FilterRow(mgr.filters(), mgr.filePixelBytes(), prevRow, row, rowBytes,
+                                filtered.data() + (y - firstRow) * stride, scratch.data());
+        std::swap(prevRow, row);
+    }
+
+    const uint8_t* input = filtered.data() + primeRows * stride;
+    const size_t inputSize = (endRow - startRow) * stride;
+    strip->fAdler = adler32_of(input, inputSize);
+    strip->fFilteredSize = inputSize;
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    // A negative window size makes raw deflate blocks, without a zlib header or checksum.
+    if (deflateInit2(&stream, mgr.zlibLevel(), Z_DEFLATED, -15, 8, zlib_strategy(mgr.filters()))
+            != Z_OK) {
+        return false;
+    }
+    // zlib's fastest level can compress much worse after a preset dictionary, and gains little
+    // from one, so its strips are compressed on their own.
+    if (primeRows > 0 && mgr.zlibLevel() > 1) {
+        const size_t dictionarySize = std::min(kWindowBytes, primeRows * stride);
+        if (deflateSetDictionary(&stream, input - dictionarySize, dictionarySize) != Z_OK) {
+            deflateEnd(&stream);
+            return false;
+        }
+    }
+
+    std::vector<uint8_t>& data = strip->fData;
+    // Leave room for the sync flush's empty stored block.
+    data.resize(deflateBound(&stream, inputSize) + 16);
+    stream.next_out = data.data();
+    stream.avail_out = std::min(data.size(), kMaxZLibChunk);
+
+    size_t remaining = inputSize;
+    bool success = true;
+    for (;;) {
+        if (stream.avail_in == 0 && remaining > 0) {
+            const size_t chunk = std::min(remaining, kMaxZLibChunk);
+            stream.next_in = const_cast<Bytef*>(input + (inputSize - remaining));
+            stream.avail_in = chunk;
+            remaining -= chunk;
+        }
+        if (stream.avail_out == 0) {
+            const size_t used = stream.next_out - data.data();
+            data.resize(2 * data.size());
+            stream.next_out = data.data() + used;
+            stream.avail_out = std::min(data.size() - used, kMaxZLibChunk);
+        }
+        const int flush = remaining > 0 ? Z_NO_FLUSH : (finish ? Z_FINISH : Z_SYNC_FLUSH);
+        const int err = deflate(&stream, flush);
+        if (err == Z_STREAM_END) {
+            break;
+        }
+        if (err != Z_OK && err != Z_BUF_ERROR) {
+            success = false;
+            break;
+        }
+        if (flush == Z_SYNC_FLUSH && stream.avail_in == 0 && stream.avail_out != 0) {
+            break;
+        }
+    }
+    data.resize(stream.next_out - data.data());
+    deflateEnd(&stream);
+    return success;
+}
+
+// Writes prefix, data and suffix as one IDAT chunk.
+static bool write_idat(png_structp png_ptr,
+                       const uint8_t* prefix, size_t prefixSize,
+                       const uint8_t* data, size_t size,
+                       const uint8_t* suffix, size_t suffixSize) {
+    if (setjmp(png_jmpbuf(png_ptr))) {
+        return false;
+    }
+    static constexpr png_byte kIDAT[5] = {'I', 'D', 'A', 'T', '\0'};
+    png_write_chunk_start(png_ptr, kIDAT, prefixSize + size + suffixSize);
+    if (prefixSize > 0) {
+        png_write_chunk_data(png_ptr, prefix, prefixSize);
+    }
+    png_write_chunk_data(png_ptr, data, size);
+    if (suffixSize > 0) {
+        png_write_chunk_data(png_ptr, suffix, suffixSize);
+    }
+    png_write_chunk_end(png_ptr);
+    return true;
+}
+
+static bool write_iend(png_structp png_ptr) {
+    if (setjmp(png_jmpbuf(png_ptr))) {
+        return false;
+    }
+    // png_write_end() expects libpng to have written the IDAT chunks, so write IEND directly.
+    static constexpr png_byte kIEND[5] = {'I', 'E', 'N', 'D', '\0'};
+    png_write_chunk(png_ptr, kIEND, nullptr, 0);
+    png_write_flush(png_ptr);
+    return true;
+}
+
+// Filters rows and compresses them into one zlib stream, which it writes as IDAT chunks of up to
+// 8K, like libpng does.
+class SkPngRowCompressor {
+public:
+    static std::unique_ptr<SkPngRowCompressor> Make(const SkPngEncoderMgr& mgr, int width) {
+        std::unique_ptr<SkPngRowCompressor> compressor(new SkPngRowCompressor(mgr, width));
+        if (deflateInit2(&compressor->fStream, mgr.zlibLevel(), Z_DEFLATED, 15, 8,
+                         zlib_strategy(mgr.filters())) != Z_OK) {
+            return nullptr;
+        }
+        compressor->fInitialized = true;
+        return compressor;
+    }
+
+    ~SkPngRowCompressor() {
+        if (fInitialized) {
+            deflateEnd(&fStream);
+        }
+    }
+
+    // Filters row, which has been transformed by the encoder's proc, against the row before it,
+    // and compresses it. finish ends the stream.
+    bool writeRow(png_structp png_ptr, const uint8_t* row, bool finish) {
+        SkPngFilters::FilterRow(fFilters, fPixelBytes, fPrevRow.data(), row, fRowBytes,
+                                fFiltered.data(), fScratch.data());
+        memcpy(fPrevRow.data(), row, fRowBytes);
+
+        fStream.next_in = fFiltered.data();
+        fStream.avail_in = fFiltered.size();
+        const int flush = finish ? Z_FINISH : Z_NO_FLUSH;
+        for (;;) {
+            if (fStream.avail_out == 0 && !this->writeIDAT(png_ptr)) {
+                return false;
+            }
+            const int err = deflate(&fStream, flush);
+            if (err == Z_STREAM_END) {
+                return this->writeIDAT(png_ptr);
+            }
+            if (err != Z_OK && err != Z_BUF_ERROR) {
+                return false;
+            }
+            if (!finish && fStream.avail_in == 0 && fStream.avail_out != 0) {
+                return true;
+            }
+        }
+    }
+
+private:
+    static constexpr size_t kIDATBytes = 8192;
+
+    SkPngRowCompressor(const SkPngEncoderMgr& mgr, int width)
+            : fFilters(mgr.filters())
+            , fPixelBytes(mgr.filePixelBytes())
+            , fRowBytes(mgr.filePixelBytes() * width)
+            , fPrevRow(fRowBytes, 0)
+            , fFiltered(1 + fRowBytes)
+            , fScratch(1 + fRowBytes) {
+        memset(&fStream, 0, sizeof(fStream));
+        fStream.next_out = fBuffer;
+        fStream.avail_out = kIDATBytes;
+    }
+
+    bool writeIDAT(png_structp png_ptr) {
+        const size_t size = kIDATBytes - fStream.avail_out;
+        fStream.next_out = fBuffer;
+        fStream.avail_out = kIDATBytes;
+        return size == 0 || write_idat(png_ptr, nullptr, 0, fBuffer, size, nullptr, 0);
+    }
+
+    const int fFilters;
+    const int fPixelBytes;
+    const size_t fRowBytes;
+    std::vector<uint8_t> fPrevRow;
+    std::vector<uint8_t> fFiltered;
+    std::vector<uint8_t> fScratch;
+    z_stream fStream;
+    bool fInitialized = false;
+    uint8_t fBuffer[kIDATBytes];
+};
+
 SkPngEncoderImpl::SkPngEncoderImpl(std::unique_ptr<SkPngEncoderMgr> encoderMgr, const SkPixmap& src)
         : SkEncoder(src, encoderMgr->pngBytesPerPixel() * src.width())
         , fEncoderMgr(std::move(encoderMgr)) {}
@@ -451,29 +747,90 @@ SkPngEncoderImpl::SkPngEncoderImpl(std::unique_ptr<SkPngEncoderMgr> encoderMgr,
 SkPngEncoderImpl::~SkPngEncoderImpl() {}
 
 bool SkPngEncoderImpl::onEncodeRows(int numRows) {
-    if (setjmp(png_jmpbuf(fEncoderMgr->pngPtr()))) {
-        return false;
+    if (fEncoderMgr->executor()) {
+        return this->encodeStrips(numRows);
     }
 
-    const void* srcRow = fSrc.addr(0, fCurrRow);
-    for (int y = 0; y < numRows; y++) {
-        sk_msan_assert_initialized(srcRow,
-                                   (const uint8_t*)srcRow + (fSrc.width() << fSrc.shiftPerPixel()));
-        fEncoderMgr->proc()((char*)fStorage.get(),
-                            (const char*)srcRow,
-                            fSrc.width(),
-                            SkColorTypeBytesPerPixel(fSrc.colorType()));
+    // Rather than handing rows to libpng, filter them with SkPngFilters, which is much faster at
+    // choosing filters, and compress them here.
+    if (!fRowCompressor) {
+        fRowCompressor = SkPngRowCompressor::Make(*fEncoderMgr, fSrc.width());
+        if (!fRowCompressor) {
+            return false;
+        }
+    }
 
-        png_bytep rowPtr = (png_bytep)fStorage.get();
-        png_write_rows(fEncoderMgr->pngPtr(), &rowPtr, 1);
-        srcRow = SkTAddOffset<const void>(srcRow, fSrc.rowBytes());
+    uint8_t* row = fStorage.get();
+    for (int y = fCurrRow; y < fCurrRow + numRows; y++) {
+        transform_row(*fEncoderMgr, fSrc, y, row);
+        if (!fRowCompressor->writeRow(fEncoderMgr->pngPtr(), row, y == fSrc.height() - 1)) {
+            return false;
+        }
     }
 
     fCurrRow += numRows;
     if (fCurrRow == fSrc.height()) {
-        png_write_end(fEncoderMgr->pngPtr(), fEncoderMgr->infoPtr());
+        return write_iend(fEncoderMgr->pngPtr());
+    }
+
+    return true;
+}
+
+bool SkPngEncoderImpl::encodeStrips(int numRows) {
+    const int endRow = fCurrRow + numRows;
+    const bool finish = endRow == fSrc.height();
+    const size_t stride = 1 + fEncoderMgr->filePixelBytes() * fSrc.width();
+    const int rowsPerStrip = std::max<int>(1, kStripBytes / stride);
+    const int stripCount = (numRows + rowsPerStrip - 1) / rowsPerStrip;
+
+    std::vector<CompressedStrip> strips(stripCount);
+    const int startRow = fCurrRow;
+    auto compress = [&](int i) {
+        const int stripStart = startRow + i * rowsPerStrip;
+        const int stripEnd = std::min(stripStart + rowsPerStrip, endRow);
+        strips[i].fSuccess = compress_strip(*fEncoderMgr, fSrc, stripStart, stripEnd,
+                                            finish && stripEnd == endRow, &strips[i]);
+    };
+    if (stripCount == 1) {
+        compress(0);
+    } else {
+        SkTaskGroup taskGroup(*fEncoderMgr->executor());
+        taskGroup.batch(stripCount, compress);
+        taskGroup.wait();
+    }
+
+    for (int i = 0; i < stripCount; ++i) {
+        const CompressedStrip& strip = strips[i];
+        if (!strip.fSuccess) {
+            return false;
+        }
+        fAdler = adler32_combine(fAdler, strip.fAdler, strip.fFilteredSize);
+
+        uint8_t header[2];
+        size_t headerSize = 0;
+        if (startRow == 0 && i == 0) {
+            zlib_header(fEncoderMgr->zlibLevel(), zlib_strategy(fEncoderMgr->filters()), header);
+            headerSize = sizeof(header);
+        }
+        uint8_t checksum[4];
+        size_t checksumSize = 0;
+        if (finish && i == stripCount - 1) {
+            checksum[0] = fAdler >> 24;
+            checksum[1] = (fAdler >> 16) & 0xFF;
+            checksum[2] = (fAdler >> 8) & 0xFF;
+            checksum[3] = fAdler & 0xFF;
+            checksumSize = sizeof(checksum);
+        }
+        if (!write_idat(fEncoderMgr->pngPtr(), header, headerSize,
+                        strip.fData.data(), strip.fData.size(), checksum, checksumSize)) {
+            return false;
+        }
     }
 
+    fCurrRow = endRow;
+    if (finish) {
+        return write_iend(fEncoderMgr->pngPtr());
+    }
     return true;
 }
 
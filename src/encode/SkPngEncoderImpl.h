@@ -10,10 +10,12 @@
 
 #include "include/encode/SkEncoder.h"
 
+#include <cstdint>
 #include <memory>
 
 class SkPixmap;
 class SkPngEncoderMgr;
+class SkPngRowCompressor;
 
 class SkPngEncoderImpl : public SkEncoder {
 public:
@@ -25,5 +27,16 @@ public:
 protected:
     bool onEncodeRows(int numRows) override;
     std::unique_ptr<SkPngEncoderMgr> fEncoderMgr;
+
+private:
+    // Filters and compresses the rows in strips on the options' executor, and writes the IDAT
+    // chunks directly.
+    bool encodeStrips(int numRows);
+
+    // Filters and compresses the rows when there is no executor.
+    std::unique_ptr<SkPngRowCompressor> fRowCompressor;
+
+    // The Adler-32 checksum of the filtered rows written so far.
+    uint32_t fAdler = 1;
 };
 #endif
@@ -0,0 +1,228 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/encode/SkPngFilters.h"
+
+#include "include/encode/SkPngEncoder.h"
+#include "include/private/base/SkAssert.h"
+#include "src/base/SkUtils.h"
+#include "src/base/SkVx.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+namespace {
+
+// The filter type byte that starts each filtered row.
+enum FilterType : uint8_t {
+    kNone_FilterType = 0,
+    kSub_FilterType = 1,
+    kUp_FilterType = 2,
+    kAvg_FilterType = 3,
+    kPaeth_FilterType = 4,
+};
+
+template <int N> using U8 = skvx::Vec<N, uint8_t>;
+
+// Each filter subtracts a prediction from each byte of the row, made from the byte to its left
+// (a), the byte above it (b) and the byte above and to the left (c). An encoder knows all of
+// them, so unlike when decoding, every byte of a row can be filtered at once.
+struct NoneFilter {
+    static constexpr FilterType kType = kNone_FilterType;
+    template <int N> static U8<N> Predict(U8<N>, U8<N>, U8<N>) { return 0; }
+};
+
+struct SubFilter {
+    static constexpr FilterType kType = kSub_FilterType;
+    template <int N> static U8<N> Predict(U8<N> a, U8<N>, U8<N>) { return a; }
+};
+
+struct UpFilter {
+    static constexpr FilterType kType = kUp_FilterType;
+    template <int N> static U8<N> Predict(U8<N>, U8<N> b, U8<N>) { return b; }
+};
+
+struct AvgFilter {
+    static constexpr FilterType kType = kAvg_FilterType;
+    template <int N> static U8<N> Predict(U8<N> a, U8<N> b, U8<N>) {
+        // (a + b) >> 1, without overflowing 8 bits.
+        return (a & b) + ((a ^ b) >> 1);
+    }
+};
+
+struct PaethFilter {
+    static constexpr FilterType kType = kPaeth_FilterType;
+    template <int N> static U8<N> Predict(U8<N> a, U8<N> b, U8<N> c) {
+        // pa = |b - c|, pb = |a - c| and pc = |a + b - 2c|, all in 8 bits. When b - c and a - c
+        // have the same sign, pc is pa + pb, which only has to saturate to compare correctly
+        // with them. Otherwise it is |pa - pb|.
+        const U8<N> pa = skvx::max(b, c) - skvx::min(b, c);
+        const U8<N> pb = skvx::max(a, c) - skvx::min(a, c);
+        const U8<N> pc = skvx::if_then_else((b >= c) == (a >= c),
+                                            skvx::saturated_add(pa, pb),
+                                            skvx::max(pa, pb) - skvx::min(pa, pb));
+        return skvx::if_then_else((pa <= pb) & (pa <= pc), a,
+                                  skvx::if_then_else(pb <= pc, b, c));
+    }
+};
+
+// The absolute values of the filtered bytes as signed values. Their sum estimates how well the
+// row compresses.
+template <int N> U8<N> signed_abs(U8<N> filtered) {
+    return skvx::min(filtered, U8<N>(0) - filtered);
+}
+
+// The filtered row is measured in blocks of this many bytes, so that a filter can be abandoned
+// once its sum is larger than that of a filter tried before it.
+constexpr size_t kBlockBytes = 256;
+
+// Writes the filter type and the filtered row to dst. If measure is set, returns the sum of the
+// absolute values of the filtered bytes, or stops early and returns a sum of at least limit once
+// the sum reaches limit.
+template <typename Filter>
+uint64_t filter_row(int bpp,
+                    const uint8_t* prev,
+                    const uint8_t* row,
+                    size_t rowBytes,
+                    uint8_t* dst,
+                    bool measure,
+                    uint64_t limit) {
+    dst[0] = Filter::kType;
+    dst += 1;
+
+    uint64_t sum = 0;
+    auto filter_byte = [&](size_t i, uint8_t left, uint8_t upLeft) {
+        const U8<1> filtered = U8<1>(row[i]) - Filter::Predict(U8<1>(left),
+                                                               U8<1>(prev[i]),
+                                                               U8<1>(upLeft));
+        dst[i] = filtered[0];
+        sum += signed_abs(filtered)[0];
+    };
+
+    // The first pixel has no pixels to its left, which filters treat as zeros.
+    const size_t first = std::min<size_t>(bpp, rowBytes);
+    for (size_t i = 0; i < first; ++i) {
+        filter_byte(i, 0, 0);
+    }
+
+    size_t i = first;
+    while (i < rowBytes) {
+        const size_t blockEnd = std::min(rowBytes, i + kBlockBytes);
+        // Pairs of bytes summed as 16-bit lanes. A block adds at most 16 * 256 to a lane.
+        skvx::Vec<8, uint16_t> sums(0);
+        for (; i + 16 <= blockEnd; i += 16) {
+            const U8<16> filtered = U8<16>::Load(row + i) -
+                                    Filter::Predict(U8<16>::Load(row + i - bpp),
+                                                    U8<16>::Load(prev + i),
+                                                    U8<16>::Load(prev + i - bpp));
+            filtered.store(dst + i);
+            if (measure) {
+                const auto pairs = sk_bit_cast<skvx::Vec<8, uint16_t>>(signed_abs(filtered));
+                sums += (pairs & 0xFF) + (pairs >> 8);
+            }
+        }
+        for (; i < blockEnd; ++i) {
+            filter_byte(i, row[i - bpp], prev[i - bpp]);
+        }
+        if (measure) {
+            for (int lane = 0; lane < 8; ++lane) {
+                sum += sums[lane];
+            }
+            if (sum >= limit) {
+                break;
+            }
+        }
+    }
+    return sum;
+}
+
+uint64_t apply_filter(FilterType type,
+                      int bpp,
+                      const uint8_t* prev,
+                      const uint8_t* row,
+                      size_t rowBytes,
+                      uint8_t* dst,
+                      bool measure,
+                      uint64_t limit) {
+    switch (type) {
+        case kNone_FilterType:
+            if (!measure) {
+                dst[0] = kNone_FilterType;
+                memcpy(dst + 1, row, rowBytes);
+                return 0;
+            }
+            return filter_row<NoneFilter>(bpp, prev, row, rowBytes, dst, measure, limit);
+        case kSub_FilterType:
+            return filter_row<SubFilter>(bpp, prev, row, rowBytes, dst, measure, limit);
+        case kUp_FilterType:
+            return filter_row<UpFilter>(bpp, prev, row, rowBytes, dst, measure, limit);
+        case kAvg_FilterType:
+            return filter_row<AvgFilter>(bpp, prev, row, rowBytes, dst, measure, limit);
+        case kPaeth_FilterType:
+            return filter_row<PaethFilter>(bpp, prev, row, rowBytes, dst, measure, limit);
+    }
+    SkUNREACHABLE;
+}
+
+}  // namespace
+
+namespace SkPngFilters {
+
+void FilterRow(int filters,
+               int bpp,
+               const uint8_t* prevRow,
+               const uint8_t* row,
+               size_t rowBytes,
+               uint8_t* dst,
+               uint8_t* scratch) {
+    static constexpr std::pair<SkPngEncoder::FilterFlag, FilterType> kFilters[] = {
+            {SkPngEncoder::FilterFlag::kNone, kNone_FilterType},
+            {SkPngEncoder::FilterFlag::kSub, kSub_FilterType},
+            {SkPngEncoder::FilterFlag::kUp, kUp_FilterType},
+            {SkPngEncoder::FilterFlag::kAvg, kAvg_FilterType},
+            {SkPngEncoder::FilterFlag::kPaeth, kPaeth_FilterType},
+    };
+
+    int candidates = 0;
+    for (const auto& [flag, type] : kFilters) {
+        candidates += (filters & (int)flag) ? 1 : 0;
+    }
+    if (candidates == 0) {
+        // Like libpng, an empty set of filters means its default, which for the images Skia
+        // encodes is all of them.
+        filters = (int)SkPngEncoder::FilterFlag::kAll;
+        candidates = std::size(kFilters);
+    }
+
+    uint8_t* best = dst;
+    uint8_t* trial = scratch;
+    uint64_t bestSum = UINT64_MAX;
+    for (const auto& [flag, type] : kFilters) {
+        if (!(filters & (int)flag)) {
+            continue;
+        }
+        if (candidates == 1) {
+            apply_filter(type, bpp, prevRow, row, rowBytes, dst, /*measure=*/false, 0);
+            return;
+        }
+        // Like libpng, the first filter with the minimum sum wins, so a filter is abandoned as
+        // soon as its sum reaches the best sum so far.
+        const uint64_t sum = apply_filter(type, bpp, prevRow, row, rowBytes, trial,
+                                          /*measure=*/true, bestSum);
+        if (sum < bestSum) {
+            bestSum = sum;
+            std::swap(best, trial);
+        }
+    }
+    if (best != dst) {
+        memcpy(dst, best, 1 + rowBytes);
+    }
+}
+
+}  // namespace SkPngFilters
@@ -0,0 +1,38 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkPngFilters_DEFINED
+#define SkPngFilters_DEFINED
+
+#include <cstddef>
+#include <cstdint>
+
+// PNG row filtering for encoders that compress the rows themselves instead of handing them to
+// libpng.
+namespace SkPngFilters {
+
+/**
+ *  Filters a row of rowBytes bytes, with bpp bytes per pixel, against the row above it.
+ *  prevRow is all zeros for the first row of the image.
+ *
+ *  filters is a mask of SkPngEncoder::FilterFlag values. If it holds several filters, the one
+ *  whose output has the minimum sum of absolute differences is used, like libpng does.
+ *
+ *  Writes the filter type byte followed by the rowBytes filtered bytes to dst. scratch must also
+ *  have room for 1 + rowBytes bytes.
+ */
+void FilterRow(int filters,
+               int bpp,
+               const uint8_t* prevRow,
+               const uint8_t* row,
+               size_t rowBytes,
+               uint8_t* dst,
+               uint8_t* scratch);
+
+}  // namespace SkPngFilters
+
+#endif  // SkPngFilters_DEFINED
@@ -10,6 +10,7 @@
 #include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkCapabilities.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkMallocPixelRef.h"
 #include "include/core/SkPixelRef.h"
@@ -23,6 +24,7 @@
 #include "src/core/SkImageInfoPriv.h"
 #include "src/core/SkImagePriv.h"
 #include "src/core/SkSurfacePriv.h"
+#include "src/core/SkThreadedBitmapDevice.h"
 
 #include <cstdint>
 #include <cstring>
@@ -73,18 +75,45 @@ SkSurface_Raster::SkSurface_Raster(const SkImageInfo& info, sk_sp<SkPixelRef> pr
     fWeOwnThePixels = true;
 }
 
-SkCanvas* SkSurface_Raster::onNewCanvas() { return new SkCanvas(fBitmap, this->props()); }
+SkSurface_Raster::SkSurface_Raster(const SkImageInfo& info, sk_sp<SkPixelRef> pr,
+                                   const SkSurfaceProps* props,
+                                   SkExecutor* executor, int bandCount)
+    : SkSurface_Raster(info, std::move(pr), props)
+{
+    fExecutor = executor ? executor : &SkExecutor::GetDefault();
+    fBandCount = bandCount;
+}
+
+SkCanvas* SkSurface_Raster::onNewCanvas() {
+    if (fExecutor) {
+        return new SkThreadedRasterCanvas(
+                sk_make_sp<SkThreadedBitmapDevice>(fBitmap, this->props(), fExecutor, fBandCount));
+    }
+    return new SkCanvas(fBitmap, this->props());
+}
+
+void SkSurface_Raster::flushPendingDraws() {
+    if (fExecutor) {
+        static_cast<SkThreadedRasterCanvas*>(this->getCachedCanvas())->threadedDevice()
+                ->flushPendingDraws();
+    }
+}
 
 sk_sp<SkSurface> SkSurface_Raster::onNewSurface(const SkImageInfo& info) {
+    if (fExecutor) {
+        return SkSurfaces::RasterThreaded(info, fExecutor, fBandCount, &this->props());
+    }
     return SkSurfaces::Raster(info, &this->props());
 }
 
 void SkSurface_Raster::onDraw(SkCanvas* canvas, SkScalar x, SkScalar y,
                               const SkSamplingOptions& sampling, const SkPaint* paint) {
+    this->flushPendingDraws();
     canvas->drawImage(fBitmap.asImage().get(), x, y, sampling, paint);
 }
 
 sk_sp<SkImage> SkSurface_Raster::onNewImageSnapshot(const SkIRect* subset) {
+    this->flushPendingDraws();
     if (subset) {
         SkASSERT(SkIRect::MakeWH(fBitmap.width(), fBitmap.height()).contains(*subset));
         SkBitmap dst;
@@ -111,6 +140,7 @@ sk_sp<SkImage> SkSurface_Raster::onNewImageSnapshot(const SkIRect* subset) {
 }
 
 void SkSurface_Raster::onWritePixels(const SkPixmap& src, int x, int y) {
+    this->flushPendingDraws();
     fBitmap.writePixels(src, x, y);
 }
 
@@ -198,4 +228,19 @@ sk_sp<SkSurface> Raster(const SkImageInfo& info, size_t rowBytes, const SkSurfac
     return sk_make_sp<SkSurface_Raster>(info, std::move(pr), props);
 }
 
+sk_sp<SkSurface> RasterThreaded(const SkImageInfo& info,
+                                SkExecutor* executor,
+                                int bandCount,
+                                const SkSurfaceProps* props) {
+    if (!SkSurfaceValidateRasterInfo(info)) {
+        return nullptr;
+    }
+
+    sk_sp<SkPixelRef> pr = SkMallocPixelRef::MakeAllocate(info, 0);
+    if (!pr) {
+        return nullptr;
+    }
+    return sk_make_sp<SkSurface_Raster>(info, std::move(pr), props, executor, bandCount);
+}
+
 }  // namespace SkSurfaces
@@ -19,6 +19,7 @@
 
 class SkCanvas;
 class SkCapabilities;
+class SkExecutor;
 class SkImage;
 class SkPaint;
 class SkPixelRef;
@@ -33,6 +34,9 @@ public:
                      void (*releaseProc)(void* pixels, void* context), void* context,
                      const SkSurfaceProps*);
     SkSurface_Raster(const SkImageInfo& info, sk_sp<SkPixelRef>, const SkSurfaceProps*);
+    // Draws are recorded, then rasterized in bands on the executor (see SkThreadedBitmapDevice).
+    SkSurface_Raster(const SkImageInfo& info, sk_sp<SkPixelRef>, const SkSurfaceProps*,
+                     SkExecutor*, int bandCount);
 
     // From SkSurface.h
     SkImageInfo imageInfo() const override { return fBitmap.info(); }
@@ -50,8 +54,13 @@ public:
     sk_sp<const SkCapabilities> onCapabilities() override;
 
 private:
+    // Rasterizes any draws still recorded by a threaded canvas.
+    void flushPendingDraws();
+
     SkBitmap    fBitmap;
     bool        fWeOwnThePixels;
+    SkExecutor* fExecutor = nullptr;
+    int         fBandCount = 0;
 
     using INHERITED = SkSurface_Base;
 };
@@ -12,6 +12,12 @@
 #define SK_OPTS_NS skx
 #include "src/opts/SkRasterPipeline_opts.h"
 
+#if defined(SK_ENABLE_AVX512_OPTS)
+    // Init_skx() is only called when SK_ENABLE_AVX512_OPTS is set, which is also what widens the
+    // shared contexts to fit the 32-pixel lowp stages.
+    static_assert(SK_OPTS_NS::raster_pipeline_lowp_stride() <= SkRasterPipeline_kMaxStride);
+#endif
+
 namespace SkOpts {
     void Init_skx() {
         raster_pipeline_lowp_stride  = SK_OPTS_NS::raster_pipeline_lowp_stride();
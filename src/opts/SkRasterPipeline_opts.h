@@ -5038,6 +5038,33 @@ STAGE(bicubic_clamp_8888, const SkRasterPipeline_GatherCtx* ctx) {
     }
 }
 
+// ~~~~~~ Fused stages ~~~~~~ //
+// SkRasterPipeline substitutes these for common runs of stages when it builds a program; see
+// kFusedStages in SkRasterPipeline.cpp. Each one runs the bodies of its stages back to back, so
+// its results are bit-identical to the unfused run.
+
+#define FUSED_ARGS dx,dy,base, r,g,b,a, dr,dg,db,da
+
+STAGE(seed_shader_matrix_translate, const float* m) {
+    seed_shader_k(nullptr, FUSED_ARGS);
+    matrix_translate_k(m, FUSED_ARGS);
+}
+STAGE(seed_shader_matrix_scale_translate, const float* m) {
+    seed_shader_k(nullptr, FUSED_ARGS);
+    matrix_scale_translate_k(m, FUSED_ARGS);
+}
+STAGE(seed_shader_matrix_2x3, const float* m) {
+    seed_shader_k(nullptr, FUSED_ARGS);
+    matrix_2x3_k(m, FUSED_ARGS);
+}
+STAGE(load_8888_dst_srcover_store_8888, const SkRasterPipeline_MemoryCtx* ctx) {
+    load_8888_dst_k(ctx, FUSED_ARGS);
+    srcover_k(nullptr, FUSED_ARGS);
+    store_8888_k(ctx, FUSED_ARGS);
+}
+
+#undef FUSED_ARGS
+
 // ~~~~~~ skgpu::Swizzle stage ~~~~~~ //
 
 STAGE(swizzle, void* ctx) {
@@ -5080,7 +5107,10 @@ namespace lowp {
 
 #else  // We are compiling vector code with Clang... let's make some lowp stages!
 
-#if defined(JUMPER_IS_SKX) || defined(JUMPER_IS_HSW) || defined(JUMPER_IS_LASX)
+#if defined(JUMPER_IS_SKX)
+    // 32 lanes of U16 fill one 512-bit register, twice the pixels per stage call of HSW.
+    template <typename T> using V = Vec<32, T>;
+#elif defined(JUMPER_IS_HSW) || defined(JUMPER_IS_LASX)
     template <typename T> using V = Vec<16, T>;
 #else
     template <typename T> using V = Vec<8, T>;
@@ -5415,8 +5445,9 @@ SI U32 trunc_(F x) { return (U32)cast<I32>(x); }
 // Use approximate instructions and one Newton-Raphson step to calculate 1/x.
 SI F rcp_precise(F x) {
 #if defined(JUMPER_IS_SKX)
-    F e = _mm512_rcp14_ps(x);
-    return _mm512_fnmadd_ps(x, e, _mm512_set1_ps(2.0f)) * e;
+    __m512 lo,hi;
+    split(x, &lo,&hi);
+    return join<F>(SK_OPTS_NS::rcp_precise(lo), SK_OPTS_NS::rcp_precise(hi));
 #elif defined(JUMPER_IS_HSW)
     __m256 lo,hi;
     split(x, &lo,&hi);
@@ -5443,7 +5474,9 @@ SI F rcp_precise(F x) {
 }
 SI F sqrt_(F x) {
 #if defined(JUMPER_IS_SKX)
-    return _mm512_sqrt_ps(x);
+    __m512 lo,hi;
+    split(x, &lo,&hi);
+    return join<F>(_mm512_sqrt_ps(lo), _mm512_sqrt_ps(hi));
 #elif defined(JUMPER_IS_HSW)
     __m256 lo,hi;
     split(x, &lo,&hi);
@@ -5488,7 +5521,9 @@ SI F floor_(F x) {
     split(x, &lo,&hi);
     return join<F>(vrndmq_f32(lo), vrndmq_f32(hi));
 #elif defined(JUMPER_IS_SKX)
-    return _mm512_floor_ps(x);
+    __m512 lo,hi;
+    split(x, &lo,&hi);
+    return join<F>(_mm512_floor_ps(lo), _mm512_floor_ps(hi));
 #elif defined(JUMPER_IS_HSW)
     __m256 lo,hi;
     split(x, &lo,&hi);
@@ -5518,7 +5553,7 @@ SI F floor_(F x) {
 // Note: on neon this is a saturating multiply while the others are not.
 SI I16 scaled_mult(I16 a, I16 b) {
 #if defined(JUMPER_IS_SKX)
-    return (I16)_mm256_mulhrs_epi16((__m256i)a, (__m256i)b);
+    return (I16)_mm512_mulhrs_epi16((__m512i)a, (__m512i)b);
 #elif defined(JUMPER_IS_HSW)
     return (I16)_mm256_mulhrs_epi16((__m256i)a, (__m256i)b);
 #elif defined(JUMPER_IS_SSE41) || defined(JUMPER_IS_AVX)
@@ -5564,8 +5599,10 @@ SI F abs_(F x) { return sk_bit_cast<F>( sk_bit_cast<I32>(x) & 0x7fffffff ); }
 
 STAGE_GG(seed_shader, NoCtx) {
     static constexpr float iota[] = {
-        0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f,
-        8.5f, 9.5f,10.5f,11.5f,12.5f,13.5f,14.5f,15.5f,
+         0.5f,  1.5f,  2.5f,  3.5f,  4.5f,  5.5f,  6.5f,  7.5f,
+         8.5f,  9.5f, 10.5f, 11.5f, 12.5f, 13.5f, 14.5f, 15.5f,
+        16.5f, 17.5f, 18.5f, 19.5f, 20.5f, 21.5f, 22.5f, 23.5f,
+        24.5f, 25.5f, 26.5f, 27.5f, 28.5f, 29.5f, 30.5f, 31.5f,
     };
     static_assert(std::size(iota) >= SkRasterPipeline_kMaxStride);
 
@@ -5807,17 +5844,29 @@ SI void store(T* ptr, V v) {
         return V{ ptr[ix[ 0]], ptr[ix[ 1]], ptr[ix[ 2]], ptr[ix[ 3]],
                   ptr[ix[ 4]], ptr[ix[ 5]], ptr[ix[ 6]], ptr[ix[ 7]],
                   ptr[ix[ 8]], ptr[ix[ 9]], ptr[ix[10]], ptr[ix[11]],
-                  ptr[ix[12]], ptr[ix[13]], ptr[ix[14]], ptr[ix[15]], };
+                  ptr[ix[12]], ptr[ix[13]], ptr[ix[14]], ptr[ix[15]],
+                  ptr[ix[16]], ptr[ix[17]], ptr[ix[18]], ptr[ix[19]],
+                  ptr[ix[20]], ptr[ix[21]], ptr[ix[22]], ptr[ix[23]],
+                  ptr[ix[24]], ptr[ix[25]], ptr[ix[26]], ptr[ix[27]],
+                  ptr[ix[28]], ptr[ix[29]], ptr[ix[30]], ptr[ix[31]], };
     }
 
     template<>
     F gather(const float* ptr, U32 ix) {
-        return _mm512_i32gather_ps((__m512i)ix, ptr, 4);
+        __m512i lo, hi;
+        split(ix, &lo, &hi);
+
+        return join<F>(_mm512_i32gather_ps(lo, ptr, 4),
+                       _mm512_i32gather_ps(hi, ptr, 4));
     }
 
     template<>
     U32 gather(const uint32_t* ptr, U32 ix) {
-        return (U32)_mm512_i32gather_epi32((__m512i)ix, ptr, 4);
+        __m512i lo, hi;
+        split(ix, &lo, &hi);
+
+        return join<U32>(_mm512_i32gather_epi32(lo, ptr, 4),
+                         _mm512_i32gather_epi32(hi, ptr, 4));
     }
 
 #elif defined(JUMPER_IS_HSW)
@@ -5867,10 +5916,20 @@ SI void store(T* ptr, V v) {
 
 SI void from_8888(U32 rgba, U16* r, U16* g, U16* b, U16* a) {
 #if defined(JUMPER_IS_SKX)
-    rgba = (U32)_mm512_permutexvar_epi64(_mm512_setr_epi64(0,1,4,5,2,3,6,7), (__m512i)rgba);
+    // Gather the even 128-bit lanes into one half and the odd ones into the other, so that the
+    // in-lane _mm512_packus_epi32() in cast_U16() produces pixels back in order.
+    __m512i _0123,_4567;
+    split(rgba, &_0123, &_4567);
+    __m512i _0246 = _mm512_permutex2var_epi64(_0123, _mm512_setr_epi64(0,1, 4,5,  8, 9, 12,13),
+                                              _4567),
+            _1357 = _mm512_permutex2var_epi64(_0123, _mm512_setr_epi64(2,3, 6,7, 10,11, 14,15),
+                                              _4567);
+    rgba = join<U32>(_0246, _1357);
+
     auto cast_U16 = [](U32 v) -> U16 {
-        return (U16)_mm256_packus_epi32(_mm512_castsi512_si256((__m512i)v),
-                    _mm512_extracti64x4_epi64((__m512i)v, 1));
+        __m512i _0246,_1357;
+        split(v, &_0246,&_1357);
+        return (U16)_mm512_packus_epi32(_0246,_1357);
     };
 #elif defined(JUMPER_IS_HSW)
     // Swap the middle 128-bit lanes to make _mm256_packus_epi32() in cast_U16() work out nicely.
@@ -6576,6 +6635,26 @@ STAGE_PP(srcover_rgba_8888, const SkRasterPipeline_MemoryCtx* ctx) {
     store_8888_(ptr, r,g,b,a);
 }
 
+// ~~~~~~ Fused stages ~~~~~~ //
+
+STAGE_GG(seed_shader_matrix_translate, const float* m) {
+    seed_shader_k(nullptr, dx,dy, x,y);
+    matrix_translate_k(m, dx,dy, x,y);
+}
+STAGE_GG(seed_shader_matrix_scale_translate, const float* m) {
+    seed_shader_k(nullptr, dx,dy, x,y);
+    matrix_scale_translate_k(m, dx,dy, x,y);
+}
+STAGE_GG(seed_shader_matrix_2x3, const float* m) {
+    seed_shader_k(nullptr, dx,dy, x,y);
+    matrix_2x3_k(m, dx,dy, x,y);
+}
+STAGE_PP(load_8888_dst_srcover_store_8888, const SkRasterPipeline_MemoryCtx* ctx) {
+    load_8888_dst_k(ctx, dx,dy, r,g,b,a, dr,dg,db,da);
+    srcover_k(nullptr, dx,dy, r,g,b,a, dr,dg,db,da);
+    store_8888_k(ctx, dx,dy, r,g,b,a, dr,dg,db,da);
+}
+
 // ~~~~~~ skgpu::Swizzle stage ~~~~~~ //
 
 STAGE_PP(swizzle, void* ctx) {
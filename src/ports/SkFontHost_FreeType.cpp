@@ -208,13 +208,25 @@ public:
     std::unique_ptr<SkColor[]> fSkPalette;
 
     static std::unique_ptr<FaceRec> Make(const SkTypeface_FreeType* typeface);
+    // Like Make, but opens the face in a FreeType library of its own, so that it can be used
+    // without f_t_mutex() while the typeface's shared face is in use on other threads.
+    static std::unique_ptr<FaceRec> MakeUnshared(const SkTypeface_FreeType* typeface);
     ~FaceRec();
 
+    FT_Library library() const {
+        return fOwnLibrary ? fOwnLibrary->library() : gFTLibrary->library();
+    }
+
 private:
-    FaceRec(std::unique_ptr<SkStreamAsset> stream);
+    FaceRec(std::unique_ptr<SkStreamAsset> stream, std::unique_ptr<FreeTypeLibrary> ownLibrary);
+    static std::unique_ptr<FaceRec> Open(const SkTypeface_FreeType* typeface,
+                                         std::unique_ptr<FreeTypeLibrary> ownLibrary);
     void setupAxes(const SkFontData& data);
     void setupPalette(const SkFontData& data);
 
+    // The library the face is in, or nullptr if it is in gFTLibrary.
+    std::unique_ptr<FreeTypeLibrary> fOwnLibrary;
+
     // Private to ref_ft_library and unref_ft_library
     static int gFTCount;
 
@@ -266,8 +278,10 @@ extern "C" {
     static void sk_ft_stream_close(FT_Stream) {}
 }
 
-SkTypeface_FreeType::FaceRec::FaceRec(std::unique_ptr<SkStreamAsset> stream)
+SkTypeface_FreeType::FaceRec::FaceRec(std::unique_ptr<SkStreamAsset> stream,
+                                      std::unique_ptr<FreeTypeLibrary> ownLibrary)
         : fSkStream(std::move(stream))
+        , fOwnLibrary(std::move(ownLibrary))
 {
     sk_bzero(&fFTStream, sizeof(fFTStream));
     fFTStream.size = fSkStream->getLength();
@@ -275,11 +289,17 @@ SkTypeface_FreeType::FaceRec::FaceRec(std::unique_ptr<SkStreamAsset> stream)
     fFTStream.read  = sk_ft_stream_io;
     fFTStream.close = sk_ft_stream_close;
 
-    f_t_mutex().assertHeld();
-    ref_ft_library();
+    if (!fOwnLibrary) {
+        f_t_mutex().assertHeld();
+        ref_ft_library();
+    }
 }
 
 SkTypeface_FreeType::FaceRec::~FaceRec() {
+    if (fOwnLibrary) {
+        fFace.reset(); // Must release face before the library, the library frees existing faces.
+        return;
+    }
     f_t_mutex().assertHeld();
     fFace.reset(); // Must release face before the library, the library frees existing faces.
     unref_ft_library();
@@ -371,13 +391,28 @@ void SkTypeface_FreeType::FaceRec::setupPalette(const SkFontData& data) {
 std::unique_ptr<SkTypeface_FreeType::FaceRec>
 SkTypeface_FreeType::FaceRec::Make(const SkTypeface_FreeType* typeface) {
     f_t_mutex().assertHeld();
+    return Open(typeface, nullptr);
+}
+
+// Will return nullptr on failure
+std::unique_ptr<SkTypeface_FreeType::FaceRec>
+SkTypeface_FreeType::FaceRec::MakeUnshared(const SkTypeface_FreeType* typeface) {
+    auto library = std::make_unique<FreeTypeLibrary>();
+    if (!library->library()) {
+        return nullptr;
+    }
+    return Open(typeface, std::move(library));
+}
 
+std::unique_ptr<SkTypeface_FreeType::FaceRec>
+SkTypeface_FreeType::FaceRec::Open(const SkTypeface_FreeType* typeface,
+                                   std::unique_ptr<FreeTypeLibrary> ownLibrary) {
     std::unique_ptr<SkFontData> data = typeface->makeFontData();
     if (nullptr == data || !data->hasStream()) {
         return nullptr;
     }
 
-    std::unique_ptr<FaceRec> rec(new FaceRec(data->detachStream()));
+    std::unique_ptr<FaceRec> rec(new FaceRec(data->detachStream(), std::move(ownLibrary)));
 
     FT_Open_Args args;
     memset(&args, 0, sizeof(args));
@@ -393,7 +428,7 @@ SkTypeface_FreeType::FaceRec::Make(const SkTypeface_FreeType* typeface) {
 
     {
         FT_Face rawFace;
-        FT_Error err = FT_Open_Face(gFTLibrary->library(), &args, data->getIndex(), &rawFace);
+        FT_Error err = FT_Open_Face(rec->library(), &args, data->getIndex(), &rawFace);
         if (err) {
             SK_TRACEFTR(err, "unable to open font '%x'", (uint32_t)typeface->uniqueID());
             return nullptr;
@@ -439,21 +474,28 @@ private:
 
 class SkScalerContext_FreeType : public SkScalerContext {
 public:
+    // If ownFaceRec is not nullptr, the context uses it instead of the typeface's shared face.
     SkScalerContext_FreeType(sk_sp<SkTypeface_FreeType>,
                              const SkScalerContextEffects&,
-                             const SkDescriptor* desc);
+                             const SkDescriptor* desc,
+                             std::unique_ptr<SkTypeface_FreeType::FaceRec> ownFaceRec = nullptr);
     ~SkScalerContext_FreeType() override;
 
     bool success() const {
         return fFTSize != nullptr && fFace != nullptr;
     }
 
+    // makeConcurrentContext() gives each context a face of its own, outside f_t_mutex().
+    bool canGenerateImagesConcurrently() const override { return true; }
+    std::unique_ptr<SkScalerContext> makeConcurrentContext(const SkDescriptor&) const override;
+
 protected:
     GlyphMetrics generateMetrics(const SkGlyph&, SkArenaAlloc*) override;
     void generateImage(const SkGlyph&, void*) override;
     bool generatePath(const SkGlyph& glyph, SkPath* path) override;
     sk_sp<SkDrawable> generateDrawable(const SkGlyph&) override;
     void generateFontMetrics(SkFontMetrics*) override;
+    uint32_t rasterizerVersion() const override { return fRasterizerVersion; }
 
 private:
     struct ScalerContextBits {
@@ -466,7 +508,12 @@ private:
     // This value was chosen by eyeballing the result in Firefox and trying to match it.
     static const FT_Pos kBitmapEmboldenStrength = 1 << 6;
 
-    SkTypeface_FreeType::FaceRec* fFaceRec; // Borrowed face from the typeface's FaceRec.
+    // A face only this context uses (see makeConcurrentContext()), or nullptr.
+    std::unique_ptr<SkTypeface_FreeType::FaceRec> fOwnFaceRec;
+    // Guards fFace: f_t_mutex() for the typeface's shared face, else fOwnFaceMutex.
+    SkMutex   fOwnFaceMutex;
+    SkMutex*  fFTMutex;
+    SkTypeface_FreeType::FaceRec* fFaceRec; // fOwnFaceRec, or borrowed from the typeface.
     FT_Face   fFace;  // Borrowed face from fFaceRec.
     FT_Size   fFTSize;  // The size to apply to the fFace.
     FT_Int    fStrikeIndex; // The bitmap strike for the fFace (or -1 if none).
@@ -486,15 +533,16 @@ private:
     uint32_t  fLoadGlyphFlags;
     bool      fDoLinearMetrics;
     bool      fLCDIsVert;
+    uint32_t  fRasterizerVersion = 0;
 
     FT_Error setupSize();
-    // Caller must lock f_t_mutex() before calling this function.
+    // Caller must lock fFTMutex before calling this function.
     static bool getBoundsOfCurrentOutlineGlyph(FT_GlyphSlot glyph, SkRect* bounds);
-    // Caller must lock f_t_mutex() before calling this function.
+    // Caller must lock fFTMutex before calling this function.
     bool getCBoxForLetter(char letter, FT_BBox* bbox);
     static void updateGlyphBoundsIfSubpixel(const SkGlyph&, SkRect* bounds, bool subpixel);
     void updateGlyphBoundsIfLCD(GlyphMetrics* mx);
-    // Caller must lock f_t_mutex() before calling this function.
+    // Caller must lock fFTMutex before calling this function.
     // update FreeType2 glyph slot with glyph emboldened
     void emboldenIfNeeded(FT_Face face, FT_GlyphSlot glyph, SkGlyphID gid);
     bool shouldSubpixelBitmap(const SkGlyph&, const SkMatrix&);
@@ -891,14 +939,19 @@ static FT_Int chooseBitmapStrike(FT_Face face, FT_F26Dot6 scaleY) {
 
 SkScalerContext_FreeType::SkScalerContext_FreeType(sk_sp<SkTypeface_FreeType> typeface,
                                                    const SkScalerContextEffects& effects,
-                                                   const SkDescriptor* desc)
+                                                   const SkDescriptor* desc,
+                                                   std::unique_ptr<SkTypeface_FreeType::FaceRec>
+                                                           ownFaceRec)
     : SkScalerContext(std::move(typeface), effects, desc)
+    , fOwnFaceRec(std::move(ownFaceRec))
+    , fFTMutex(fOwnFaceRec ? &fOwnFaceMutex : &f_t_mutex())
     , fFace(nullptr)
     , fFTSize(nullptr)
     , fStrikeIndex(-1)
 {
-    SkAutoMutexExclusive  ac(f_t_mutex());
-    fFaceRec = static_cast<SkTypeface_FreeType*>(this->getTypeface())->getFaceRec();
+    SkAutoMutexExclusive  ac(*fFTMutex);
+    fFaceRec = fOwnFaceRec ? fOwnFaceRec.get()
+                           : static_cast<SkTypeface_FreeType*>(this->getTypeface())->getFaceRec();
 
     // load the font file
     if (nullptr == fFaceRec) {
@@ -908,6 +961,12 @@ SkScalerContext_FreeType::SkScalerContext_FreeType(sk_sp<SkTypeface_FreeType> ty
 
     fLCDIsVert = SkToBool(fRec.fFlags & SkScalerContext::kLCD_Vertical_Flag);
 
+    // FreeType is usually a shared library, so ask it for its version rather than trusting the
+    // headers this was built with.
+    FT_Int major, minor, patch;
+    FT_Library_Version(fFaceRec->library(), &major, &minor, &patch);
+    fRasterizerVersion = (uint32_t)major << 16 | (uint32_t)minor << 8 | (uint32_t)patch;
+
     // compute the flags we send to Load_Glyph
     bool linearMetrics = this->isLinearMetrics();
     {
@@ -1075,20 +1134,40 @@ SkScalerContext_FreeType::SkScalerContext_FreeType(sk_sp<SkTypeface_FreeType> ty
 }
 
 SkScalerContext_FreeType::~SkScalerContext_FreeType() {
-    SkAutoMutexExclusive  ac(f_t_mutex());
+    SkAutoMutexExclusive  ac(*fFTMutex);
 
     if (fFTSize != nullptr) {
         FT_Done_Size(fFTSize);
     }
 
     fFaceRec = nullptr;
+    if (fOwnFaceRec) {
+        // The next concurrent context of the typeface can use the face without opening it again.
+        static_cast<SkTypeface_FreeType*>(this->getTypeface())
+                ->returnUnsharedFaceRec(std::move(fOwnFaceRec));
+    }
+}
+
+std::unique_ptr<SkScalerContext> SkScalerContext_FreeType::makeConcurrentContext(
+        const SkDescriptor& desc) const {
+    auto typeface = sk_ref_sp(static_cast<SkTypeface_FreeType*>(this->getTypeface()));
+    std::unique_ptr<SkTypeface_FreeType::FaceRec> faceRec = typeface->takeUnsharedFaceRec();
+    if (!faceRec) {
+        return nullptr;
+    }
+    auto c = std::make_unique<SkScalerContext_FreeType>(
+            std::move(typeface), this->getEffects(), &desc, std::move(faceRec));
+    if (!c->success()) {
+        return nullptr;
+    }
+    return c;
 }
 
 /*  We call this before each use of the fFace, since we may be sharing
     this face with other context (at different sizes).
 */
 FT_Error SkScalerContext_FreeType::setupSize() {
-    f_t_mutex().assertHeld();
+    fFTMutex->assertHeld();
     FT_Error err = FT_Activate_Size(fFTSize);
     if (err != 0) {
         return err;
@@ -1168,7 +1247,7 @@ bool SkScalerContext_FreeType::shouldSubpixelBitmap(const SkGlyph& glyph, const
 
 SkScalerContext::GlyphMetrics SkScalerContext_FreeType::generateMetrics(const SkGlyph& glyph,
                                                                         SkArenaAlloc* alloc) {
-    SkAutoMutexExclusive  ac(f_t_mutex());
+    SkAutoMutexExclusive  ac(*fFTMutex);
 
     GlyphMetrics mx(glyph.maskFormat());
 
@@ -1347,7 +1426,7 @@ SkScalerContext::GlyphMetrics SkScalerContext_FreeType::generateMetrics(const Sk
 }
 
 void SkScalerContext_FreeType::generateImage(const SkGlyph& glyph, void* imageBuffer) {
-    SkAutoMutexExclusive  ac(f_t_mutex());
+    SkAutoMutexExclusive  ac(*fFTMutex);
 
     if (this->setupSize()) {
         sk_bzero(imageBuffer, glyph.imageSize());
@@ -1420,7 +1499,7 @@ sk_sp<SkDrawable> SkScalerContext_FreeType::generateDrawable(const SkGlyph& glyp
     // It should be possible to draw the drawable straight out of the FT_Face. However, this would
     // mean locking each time any such drawable is drawn. To avoid locking, this implementation
     // creates drawables backed as pictures so that they can be played back later without locking.
-    SkAutoMutexExclusive  ac(f_t_mutex());
+    SkAutoMutexExclusive  ac(*fFTMutex);
 
     if (this->setupSize()) {
         return nullptr;
@@ -1471,7 +1550,7 @@ sk_sp<SkDrawable> SkScalerContext_FreeType::generateDrawable(const SkGlyph& glyp
 bool SkScalerContext_FreeType::generatePath(const SkGlyph& glyph, SkPath* path) {
     SkASSERT(path);
 
-    SkAutoMutexExclusive  ac(f_t_mutex());
+    SkAutoMutexExclusive  ac(*fFTMutex);
 
     SkGlyphID glyphID = glyph.getGlyphID();
     // FT_IS_SCALABLE is documented to mean the face contains outline glyphs.
@@ -1513,7 +1592,7 @@ void SkScalerContext_FreeType::generateFontMetrics(SkFontMetrics* metrics) {
         return;
     }
 
-    SkAutoMutexExclusive ac(f_t_mutex());
+    SkAutoMutexExclusive ac(*fFTMutex);
 
     if (this->setupSize()) {
         sk_bzero(metrics, sizeof(*metrics));
@@ -1714,8 +1793,9 @@ SkTypeface_FreeType::~SkTypeface_FreeType() {
     }
 }
 
-// Just made up, so we don't end up storing 1000s of entries
-constexpr int kMaxC2GCacheCount = 512;
+// Enough for the pages of the unichars that text in one or two large scripts, like CJK, uses
+// most, so we don't end up storing the whole cmap.
+constexpr size_t kMaxC2GCacheBytes = 64 * 1024;
 
 void SkTypeface_FreeType::onCharsToGlyphs(const SkUnichar uni[], int count,
                                           SkGlyphID glyphs[]) const {
@@ -1727,13 +1807,7 @@ void SkTypeface_FreeType::onCharsToGlyphs(const SkUnichar uni[], int count,
     {
         // Optimistically use a shared lock.
         SkAutoSharedMutexShared ama(fC2GCacheMutex);
-        for (i = 0; i < count; ++i) {
-            int index = fC2GCache.findGlyphIndex(uni[i]);
-            if (index < 0) {
-                break;
-            }
-            glyphs[i] = SkToU16(index);
-        }
+        i = fC2GCache.findGlyphs(uni, count, glyphs);
         if (i == count) {
             // we're done, no need to access the freetype objects
             return;
@@ -1756,11 +1830,11 @@ void SkTypeface_FreeType::onCharsToGlyphs(const SkUnichar uni[], int count,
             glyphs[i] = SkToU16(index);
         } else {
             glyphs[i] = SkToU16(FT_Get_Char_Index(face, c));
-            fC2GCache.insertCharAndGlyph(~index, c, glyphs[i]);
+            fC2GCache.insertCharAndGlyph(c, glyphs[i]);
         }
     }
 
-    if (fC2GCache.count() > kMaxC2GCacheCount) {
+    if (fC2GCache.bytesUsed() > kMaxC2GCacheBytes) {
         fC2GCache.reset();
     }
 }
@@ -1934,6 +2008,28 @@ SkTypeface_FreeType::FaceRec* SkTypeface_FreeType::getFaceRec() const {
     return fFaceRec.get();
 }
 
+// As many faces as SkStrike::prefillImages() runs tasks at once.
+static constexpr int kMaxUnsharedFaceRecs = 8;
+
+std::unique_ptr<SkTypeface_FreeType::FaceRec> SkTypeface_FreeType::takeUnsharedFaceRec() const {
+    {
+        SkAutoMutexExclusive lock(fUnsharedFaceRecsMutex);
+        if (!fUnsharedFaceRecs.empty()) {
+            std::unique_ptr<FaceRec> faceRec = std::move(fUnsharedFaceRecs.back());
+            fUnsharedFaceRecs.pop_back();
+            return faceRec;
+        }
+    }
+    return FaceRec::MakeUnshared(this);
+}
+
+void SkTypeface_FreeType::returnUnsharedFaceRec(std::unique_ptr<FaceRec> faceRec) const {
+    SkAutoMutexExclusive lock(fUnsharedFaceRecsMutex);
+    if (fUnsharedFaceRecs.size() < kMaxUnsharedFaceRecs) {
+        fUnsharedFaceRecs.push_back(std::move(faceRec));
+    }
+}
+
 std::unique_ptr<SkFontData> SkTypeface_FreeType::makeFontData() const {
     return this->onMakeFontData();
 }
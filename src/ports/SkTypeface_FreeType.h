@@ -39,6 +39,13 @@ public:
     class FaceRec;
     FaceRec* getFaceRec() const;
 
+    /** Take a face that is not shared with other threads (see FaceRec::MakeUnshared()) from the
+     *  faces given back with returnUnsharedFaceRec(), or open a new one. Return nullptr on failure.
+     */
+    std::unique_ptr<FaceRec> takeUnsharedFaceRec() const;
+    /** Keep a face from takeUnsharedFaceRec() for the next caller, unless enough are kept. */
+    void returnUnsharedFaceRec(std::unique_ptr<FaceRec>) const;
+
     static constexpr SkTypeface::FactoryId FactoryId = SkSetFourByteTag('f','r','e','e');
     static sk_sp<SkTypeface> MakeFromStream(std::unique_ptr<SkStreamAsset>, const SkFontArguments&);
 
@@ -80,6 +87,10 @@ private:
     mutable SkOnce fFTFaceOnce;
     mutable std::unique_ptr<FaceRec> fFaceRec;
 
+    mutable SkMutex fUnsharedFaceRecsMutex;
+    mutable skia_private::TArray<std::unique_ptr<FaceRec>> fUnsharedFaceRecs
+            SK_GUARDED_BY(fUnsharedFaceRecsMutex);
+
     mutable SkSharedMutex fC2GCacheMutex;
     mutable SkCharToGlyphCache fC2GCache;
 
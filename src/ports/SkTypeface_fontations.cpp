@@ -454,6 +454,9 @@ public:
         return true;
     }
 
+    // Fontations takes no global lock, so several scaler contexts can rasterize at once.
+    bool canGenerateImagesConcurrently() const override { return true; }
+
 protected:
     struct ScalerContextBits {
         using value_type = uint16_t;
@@ -33,6 +33,7 @@
 #include "src/core/SkGlyph.h"
 #include "src/core/SkReadBuffer.h"
 #include "src/core/SkScalerContext.h"
+#include "src/core/SkSharedGlyphMemory.h"
 #include "src/core/SkStrike.h"
 #include "src/core/SkStrikeCache.h"
 #include "src/core/SkStrikeSpec.h"
@@ -99,7 +100,7 @@ public:
         return glyph->drawable() != nullptr;
     }
 
-    void writePendingGlyphs(SkWriteBuffer& buffer);
+    void writePendingGlyphs(SkWriteBuffer& buffer, SkSharedGlyphMemory* sharedMemory);
 
     SkDiscardableHandleId discardableHandleId() const { return fDiscardableHandleId; }
 
@@ -165,7 +166,7 @@ RemoteStrike::RemoteStrike(
     SkASSERT(fContext != nullptr);
 }
 
-void RemoteStrike::writePendingGlyphs(SkWriteBuffer& buffer) {
+void RemoteStrike::writePendingGlyphs(SkWriteBuffer& buffer, SkSharedGlyphMemory* sharedMemory) {
     SkASSERT(this->hasPendingGlyphs());
 
     buffer.writeUInt(fContext->getTypeface()->uniqueID());
@@ -196,8 +197,28 @@ void RemoteStrike::writePendingGlyphs(SkWriteBuffer& buffer) {
         this->prepareForDrawable(&glyph);
     }
 
+    // Put the images in a run of the shared glyph memory, if there is one with space for them.
+    std::optional<SkSharedGlyphPages> pages;
+    if (sharedMemory != nullptr) {
+        if (const size_t imageBytes = SkSharedGlyphMemory::ImageBytes(fMasksToSend);
+            imageBytes > 0) {
+            pages = sharedMemory->allocate(imageBytes);
+        }
+    }
+    buffer.writeBool(pages.has_value());
+
     // Send all the pending glyph information.
-    SkStrike::FlattenGlyphsByType(buffer, fMasksToSend, fPathsToSend, fDrawablesToSend);
+    if (pages.has_value()) {
+        buffer.writeUInt(pages->fFirstPage);
+        buffer.writeUInt(pages->fPageCount);
+        buffer.writeUInt(pages->fEpoch);
+        SkSharedGlyphImageWriter sharedImages{sharedMemory->writableMemory(*pages),
+                                              pages->fPageCount * SkSharedGlyphMemory::kPageSize};
+        SkStrike::FlattenGlyphsByType(
+                buffer, fMasksToSend, fPathsToSend, fDrawablesToSend, &sharedImages);
+    } else {
+        SkStrike::FlattenGlyphsByType(buffer, fMasksToSend, fPathsToSend, fDrawablesToSend);
+    }
 
     // Reset all the sending data.
     fMasksToSend.clear();
@@ -269,6 +290,9 @@ public:
 
     // SkStrikeServer API methods
     void writeStrikeData(std::vector<uint8_t>* memory);
+    void setSharedGlyphMemory(void* memory, size_t size);
+    bool readReleasedGlyphMemory(const void* memory, size_t memorySize);
+    size_t sharedGlyphMemoryUsed() const;
 
     sk_sp<sktext::StrikeForGPU> findOrCreateScopedStrike(const SkStrikeSpec& strikeSpec) override;
 
@@ -299,6 +323,7 @@ private:
     SkStrikeServer::DiscardableHandleManager* const fDiscardableHandleManager;
     THashSet<SkTypefaceID> fCachedTypefaces;
     size_t fMaxEntriesInDescriptorMap = kMaxEntriesInDescriptorMap;
+    std::optional<SkSharedGlyphMemory> fSharedGlyphMemory;
 
     // State cached until the next serialization.
     THashSet<RemoteStrike*> fRemoteStrikesToSend;
@@ -317,6 +342,37 @@ size_t SkStrikeServerImpl::remoteStrikeMapSizeForTesting() const {
     return fDescToRemoteStrike.size();
 }
 
+void SkStrikeServerImpl::setSharedGlyphMemory(void* memory, size_t size) {
+    SkASSERT(!fSharedGlyphMemory.has_value());
+    fSharedGlyphMemory.emplace(memory, size);
+}
+
+bool SkStrikeServerImpl::readReleasedGlyphMemory(const void* memory, size_t memorySize) {
+    if (!fSharedGlyphMemory.has_value()) {
+        return false;
+    }
+
+    SkReadBuffer buffer{memory, memorySize};
+    const int releasedCount = buffer.readInt();
+    bool allReleased = buffer.validate(releasedCount >= 0);
+    for (int i = 0; i < releasedCount && buffer.isValid(); ++i) {
+        SkSharedGlyphPages pages;
+        pages.fFirstPage = buffer.readUInt();
+        pages.fPageCount = buffer.readUInt();
+        pages.fEpoch = buffer.readUInt();
+        // Pages that are not allocated with this epoch were already released, and may have been
+        // written again since, so leave them alone.
+        if (buffer.isValid() && !fSharedGlyphMemory->release(pages)) {
+            allReleased = false;
+        }
+    }
+    return buffer.isValid() && allReleased;
+}
+
+size_t SkStrikeServerImpl::sharedGlyphMemoryUsed() const {
+    return fSharedGlyphMemory.has_value() ? fSharedGlyphMemory->bytesAllocated() : 0;
+}
+
 void SkStrikeServerImpl::writeStrikeData(std::vector<uint8_t>* memory) {
     // We can use the default SkSerialProcs because we do not currently need to encode any SkImages.
     SkBinaryWriteBuffer buffer{nullptr, 0, {}};
@@ -338,6 +394,11 @@ void SkStrikeServerImpl::writeStrikeData(std::vector<uint8_t>* memory) {
         return;
     }
 
+    // Images written to the shared glyph memory from here on are part of a new epoch.
+    if (fSharedGlyphMemory.has_value()) {
+        fSharedGlyphMemory->nextEpoch();
+    }
+
     // Send newly seen typefaces.
     SkASSERT_RELEASE(SkTFitsIn<int>(fTypefacesToSend.size()));
     buffer.writeInt(fTypefacesToSend.size());
@@ -351,7 +412,9 @@ void SkStrikeServerImpl::writeStrikeData(std::vector<uint8_t>* memory) {
     fRemoteStrikesToSend.foreach(
             [&](RemoteStrike* strike) {
                 if (strike->hasPendingGlyphs()) {
-                    strike->writePendingGlyphs(buffer);
+                    strike->writePendingGlyphs(
+                            buffer,
+                            fSharedGlyphMemory.has_value() ? &*fSharedGlyphMemory : nullptr);
                     strike->resetScalerContext();
                 }
             }
@@ -556,6 +619,18 @@ void SkStrikeServer::writeStrikeData(std::vector<uint8_t>* memory) {
     fImpl->writeStrikeData(memory);
 }
 
+void SkStrikeServer::setSharedGlyphMemory(void* memory, size_t size) {
+    fImpl->setSharedGlyphMemory(memory, size);
+}
+
+bool SkStrikeServer::readReleasedGlyphMemory(const void* memory, size_t memorySize) {
+    return fImpl->readReleasedGlyphMemory(memory, memorySize);
+}
+
+size_t SkStrikeServer::sharedGlyphMemoryUsed() const {
+    return fImpl->sharedGlyphMemoryUsed();
+}
+
 SkStrikeServerImpl* SkStrikeServer::impl() { return fImpl.get(); }
 
 void SkStrikeServer::setMaxEntriesInDescriptorMapForTesting(size_t count) {
@@ -589,6 +664,8 @@ public:
                                 SkStrikeCache* strikeCache = nullptr);
 
     bool readStrikeData(const volatile void* memory, size_t memorySize);
+    void setSharedGlyphMemory(sk_sp<SkData> mapping);
+    void writeReleasedGlyphMemory(std::vector<uint8_t>* memory);
     bool translateTypefaceID(SkAutoDescriptor* descriptor) const;
     sk_sp<SkTypeface> retrieveTypefaceUsingServerID(SkTypefaceID) const;
 
@@ -611,6 +688,7 @@ private:
     sk_sp<SkStrikeClient::DiscardableHandleManager> fDiscardableHandleManager;
     SkStrikeCache* const fStrikeCache;
     const bool fIsLogging;
+    sk_sp<SkSharedGlyphMemoryReader> fSharedGlyphMemory;
 };
 
 SkStrikeClientImpl::SkStrikeClientImpl(
@@ -739,7 +817,25 @@ bool SkStrikeClientImpl::readStrikeData(const volatile void* memory, size_t memo
         // Make sure this strike is pinned on the GPU side.
         strike->verifyPinnedStrike();
 
-        if (!strike->mergeFromBuffer(buffer)) {
+        // The strike's images may be in a run of the shared glyph memory.
+        sk_sp<SkSharedGlyphLease> sharedImages;
+        if (buffer.readBool()) {
+            SkSharedGlyphPages pages;
+            pages.fFirstPage = buffer.readUInt();
+            pages.fPageCount = buffer.readUInt();
+            pages.fEpoch = buffer.readUInt();
+            if (buffer.isValid() && fSharedGlyphMemory != nullptr) {
+                sharedImages = fSharedGlyphMemory->lease(pages);
+            }
+            if (!buffer.validate(sharedImages != nullptr)) {
+                postError(__LINE__);
+                return false;
+            }
+        }
+
+        // The images are copied out of the run, so the lease is dropped here and the run is
+        // queued for writeReleasedGlyphMemory().
+        if (!strike->mergeFromBuffer(buffer, sharedImages.get())) {
             postError(__LINE__);
             return false;
         }
@@ -748,6 +844,36 @@ bool SkStrikeClientImpl::readStrikeData(const volatile void* memory, size_t memo
     return true;
 }
 
+void SkStrikeClientImpl::setSharedGlyphMemory(sk_sp<SkData> mapping) {
+    SkASSERT(fSharedGlyphMemory == nullptr);
+    fSharedGlyphMemory = mapping != nullptr
+                                 ? sk_make_sp<SkSharedGlyphMemoryReader>(std::move(mapping))
+                                 : nullptr;
+}
+
+void SkStrikeClientImpl::writeReleasedGlyphMemory(std::vector<uint8_t>* memory) {
+    memory->clear();
+    if (fSharedGlyphMemory == nullptr) {
+        return;
+    }
+    const std::vector<SkSharedGlyphPages> released = fSharedGlyphMemory->takeReleased();
+    if (released.empty()) {
+        return;
+    }
+
+    SkBinaryWriteBuffer buffer{nullptr, 0, {}};
+    SkASSERT_RELEASE(SkTFitsIn<int>(released.size()));
+    buffer.writeInt(released.size());
+    for (const SkSharedGlyphPages& pages : released) {
+        buffer.writeUInt(pages.fFirstPage);
+        buffer.writeUInt(pages.fPageCount);
+        buffer.writeUInt(pages.fEpoch);
+    }
+
+    auto data = buffer.snapshotAsData();
+    memory->assign(data->bytes(), data->bytes() + data->size());
+}
+
 bool SkStrikeClientImpl::translateTypefaceID(SkAutoDescriptor* toChange) const {
     SkDescriptor& descriptor = *toChange->getDesc();
 
@@ -805,6 +931,14 @@ bool SkStrikeClient::readStrikeData(const volatile void* memory, size_t memorySi
     return fImpl->readStrikeData(memory, memorySize);
 }
 
+void SkStrikeClient::setSharedGlyphMemory(sk_sp<SkData> mapping) {
+    fImpl->setSharedGlyphMemory(std::move(mapping));
+}
+
+void SkStrikeClient::writeReleasedGlyphMemory(std::vector<uint8_t>* memory) {
+    fImpl->writeReleasedGlyphMemory(memory);
+}
+
 sk_sp<SkTypeface> SkStrikeClient::retrieveTypefaceUsingServerIDForTest(
         SkTypefaceID typefaceID) const {
     return fImpl->retrieveTypefaceUsingServerID(typefaceID);
@@ -7,6 +7,8 @@
 
 #include "src/utils/SkCharToGlyphCache.h"
 
+#include <cstring>
+
 SkCharToGlyphCache::SkCharToGlyphCache() {
     this->reset();
 }
@@ -14,116 +16,43 @@ SkCharToGlyphCache::SkCharToGlyphCache() {
 SkCharToGlyphCache::~SkCharToGlyphCache() {}
 
 void SkCharToGlyphCache::reset() {
-    fK32.reset();
-    fV16.reset();
-
-    // Add sentinels so we can always rely on these to stop linear searches (in either direction)
-    // Neither is a legal unichar, so we don't care what glyphID we use.
-    //
-    *fK32.append() = 0x80000000;    *fV16.append() = 0;
-    *fK32.append() = 0x7FFFFFFF;    *fV16.append() = 0;
-
-    fDenom = 0;
+    fGlyphs.reset();
+    memset(fBMPPages, 0, sizeof(fBMPPages));
+    fOtherPages.reset();
+    fCount = 0;
 }
 
-// Determined experimentally. For N much larger, the slope technique is faster.
-// For N much smaller, a simple search is faster.
-//
-constexpr int kSmallCountLimit = 16;
-
-// To use slope technique we need at least 2 real entries (+2 sentinels) hence the min of 4
-//
-constexpr int kMinCountForSlope = 4;
-
-static int find_simple(const SkUnichar base[], int count, SkUnichar value) {
-    int index;
-    for (index = 0;; ++index) {
-        if (value <= base[index]) {
-            if (value < base[index]) {
-                index = ~index; // not found
-            }
-            break;
+int SkCharToGlyphCache::findGlyphs(const SkUnichar uni[], int count, SkGlyphID glyphs[]) const {
+    for (int i = 0; i < count; ++i) {
+        const int glyph = this->findGlyphIndex(uni[i]);
+        if (glyph < 0) {
+            return i;
         }
+        glyphs[i] = SkToU16(glyph);
     }
-    return index;
+    return count;
 }
 
-static int find_with_slope(const SkUnichar base[], int count, SkUnichar value, double denom) {
-    SkASSERT(count >= kMinCountForSlope);
+void SkCharToGlyphCache::insertCharAndGlyph(SkUnichar unichar, SkGlyphID glyph) {
+    SkASSERT(this->findGlyphIndex(unichar) < 0);
+    if ((uint32_t)unichar > (uint32_t)kMaxUnichar || glyph == kNotCached) {
+        // Not a legal unichar or glyphID, so there is nothing to cache.
+        return;
+    }
 
-    int index;
-    if (value <= base[1]) {
-        index = 1;
-        if (value < base[index]) {
-            index = ~index;
-        }
-    } else if (value >= base[count - 2]) {
-        index = count - 2;
-        if (value > base[index]) {
-            index = ~(index + 1);
+    int page = this->findPage(unichar);
+    if (page < 0) {
+        page = fGlyphs.size();
+        SkGlyphID* glyphs = fGlyphs.append(kPageSize);
+        for (int i = 0; i < kPageSize; ++i) {
+            glyphs[i] = kNotCached;
         }
-    } else {
-        // make our guess based on the "slope" of the current values
-//        index = 1 + (int64_t)(count - 2) * (value - base[1]) / (base[count - 2] - base[1]);
-        index = 1 + (int)(denom * (count - 2) * (value - base[1]));
-        SkASSERT(index >= 1 && index <= count - 2);
-
-        if (value >= base[index]) {
-            for (;; ++index) {
-                if (value <= base[index]) {
-                    if (value < base[index]) {
-                        index = ~index; // not found
-                    }
-                    break;
-                }
-            }
+        if (unichar < 0x10000) {
+            fBMPPages[unichar >> kPageBits] = page + 1;
         } else {
-            for (--index;; --index) {
-                SkASSERT(index >= 0);
-                if (value >= base[index]) {
-                    if (value > base[index]) {
-                        index = ~(index + 1);
-                    }
-                    break;
-                }
-            }
+            fOtherPages.set(unichar >> kPageBits, page);
         }
     }
-    return index;
-}
-
-int SkCharToGlyphCache::findGlyphIndex(SkUnichar unichar) const {
-    const int count = fK32.size();
-    int index;
-    if (count <= kSmallCountLimit) {
-        index = find_simple(fK32.begin(), count, unichar);
-    } else {
-        index = find_with_slope(fK32.begin(), count, unichar, fDenom);
-    }
-    if (index >= 0) {
-        return fV16[index];
-    }
-    return index;
-}
-
-void SkCharToGlyphCache::insertCharAndGlyph(int index, SkUnichar unichar, SkGlyphID glyph) {
-    SkASSERT(fK32.size() == fV16.size());
-    SkASSERT(index < fK32.size());
-    SkASSERT(unichar < fK32[index]);
-
-    *fK32.insert(index) = unichar;
-    *fV16.insert(index) = glyph;
-
-    // if we've changed the first [1] or last [count-2] entry, recompute our slope
-    const int count = fK32.size();
-    if (count >= kMinCountForSlope && (index == 1 || index == count - 2)) {
-        SkASSERT(index >= 1 && index <= count - 2);
-        fDenom = 1.0 / ((double)fK32[count - 2] - fK32[1]);
-    }
-
-#ifdef SK_DEBUG
-    for (int i = 1; i < fK32.size(); ++i) {
-        SkASSERT(fK32[i-1] < fK32[i]);
-    }
-#endif
+    fGlyphs[page + (unichar & kPageMask)] = glyph;
+    fCount += 1;
 }
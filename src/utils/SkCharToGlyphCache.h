@@ -11,9 +11,17 @@
 #include "include/core/SkTypes.h"
 #include "include/private/base/SkTDArray.h"
 #include "include/private/base/SkTo.h"
+#include "src/core/SkTHash.h"
 
+#include <cstddef>
 #include <cstdint>
 
+/**
+ *  Caches the glyphIDs of unichars in pages of 256 consecutive unichars, so that a lookup is two
+ *  array reads however many unichars are cached. Pages in the BMP are found in a direct-mapped
+ *  table, and pages in the other planes in a hash table. Scripts with large alphabets, like
+ *  CJK, only add the pages their text uses.
+ */
 class SkCharToGlyphCache {
 public:
     SkCharToGlyphCache();
@@ -21,30 +29,46 @@ public:
 
     // return number of unichars cached
     int count() const {
-        return fK32.size();
+        return fCount;
+    }
+
+    // return the bytes used by the cache's pages
+    size_t bytesUsed() const {
+        return fGlyphs.size() * sizeof(SkGlyphID);
     }
 
     void reset();       // forget all cache entries (to save memory)
 
     /**
-     *  Given a unichar, return its glyphID (if the return value is positive), else return
-     *  ~index of where to insert the computed glyphID.
+     *  Given a unichar, return its glyphID if it is cached, else return a negative value.
      *
-     *  int result = cache.charToGlyph(unichar);
+     *  int result = cache.findGlyphIndex(unichar);
      *  if (result >= 0) {
      *      glyphID = result;
      *  } else {
      *      glyphID = compute_glyph_using_typeface(unichar);
-     *      cache.insertCharAndGlyph(~result, unichar, glyphID);
+     *      cache.insertCharAndGlyph(unichar, glyphID);
      *  }
      */
-    int findGlyphIndex(SkUnichar c) const;
+    int findGlyphIndex(SkUnichar unichar) const {
+        const int page = this->findPage(unichar);
+        if (page < 0) {
+            return -1;
+        }
+        const SkGlyphID glyph = fGlyphs[page + (unichar & kPageMask)];
+        return glyph != kNotCached ? glyph : -1;
+    }
+
+    /**
+     *  Set glyphs[i] to the glyphID of uni[i], stopping at the first unichar that is not cached.
+     *  Returns the number of glyphIDs found.
+     */
+    int findGlyphs(const SkUnichar uni[], int count, SkGlyphID glyphs[]) const;
 
     /**
-     *  Insert a new char/glyph pair into the cache at the specified index.
-     *  See charToGlyph() for how to compute the bit-not of the index.
+     *  Insert a new char/glyph pair into the cache. The unichar must not be cached yet.
      */
-    void insertCharAndGlyph(int index, SkUnichar, SkGlyphID);
+    void insertCharAndGlyph(SkUnichar, SkGlyphID);
 
     // helper to pre-seed an entry in the cache
     void addCharAndGlyph(SkUnichar unichar, SkGlyphID glyph) {
@@ -52,14 +76,39 @@ public:
         if (index >= 0) {
             SkASSERT(SkToU16(index) == glyph);
         } else {
-            this->insertCharAndGlyph(~index, unichar, glyph);
+            this->insertCharAndGlyph(unichar, glyph);
         }
     }
 
 private:
-    SkTDArray<int32_t>   fK32;
-    SkTDArray<uint16_t>  fV16;
-    double               fDenom;
+    static constexpr int kPageBits = 8;
+    static constexpr int kPageSize = 1 << kPageBits;
+    static constexpr int kPageMask = kPageSize - 1;
+    static constexpr int kBMPPageCount = 0x10000 >> kPageBits;
+    static constexpr SkUnichar kMaxUnichar = 0x10FFFF;
+
+    // Fonts have at most 0xFFFF glyphs, so 0xFFFF is never a glyphID.
+    static constexpr SkGlyphID kNotCached = 0xFFFF;
+
+    // Returns the index in fGlyphs of the page that holds unichar, or -1.
+    int findPage(SkUnichar unichar) const {
+        if ((uint32_t)unichar < 0x10000) {
+            return fBMPPages[unichar >> kPageBits] - 1;
+        }
+        if ((uint32_t)unichar > (uint32_t)kMaxUnichar) {
+            return -1;
+        }
+        const int* page = fOtherPages.find(unichar >> kPageBits);
+        return page != nullptr ? *page : -1;
+    }
+
+    // The pages, kPageSize glyphIDs each, in the order they were added.
+    SkTDArray<SkGlyphID>             fGlyphs;
+    // The index in fGlyphs of each page in the BMP, plus one; zero if there is no page.
+    int                              fBMPPages[kBMPPageCount];
+    // The index in fGlyphs of each page in the other planes.
+    skia_private::THashMap<int, int> fOtherPages;
+    int                              fCount;
 };
 
 #endif
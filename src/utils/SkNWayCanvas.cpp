@@ -237,6 +237,13 @@ void SkNWayCanvas::onDrawRect(const SkRect& rect, const SkPaint& paint) {
     }
 }
 
+void SkNWayCanvas::onDrawRects(const SkRect rects[], int count, const SkPaint& paint) {
+    Iter iter(fList);
+    while (iter.next()) {
+        iter->experimental_DrawRects(rects, count, paint);
+    }
+}
+
 void SkNWayCanvas::onDrawRegion(const SkRegion& region, const SkPaint& paint) {
     Iter iter(fList);
     while (iter.next()) {
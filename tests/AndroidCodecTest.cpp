@@ -8,9 +8,12 @@
 #include "include/codec/SkAndroidCodec.h"
 #include "include/codec/SkCodec.h"
 #include "include/codec/SkEncodedImageFormat.h"
+#include "include/core/SkBitmap.h"
 #include "include/core/SkColorSpace.h"
 #include "include/core/SkData.h"
 #include "include/core/SkImageInfo.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkSize.h"
 #include "include/core/SkString.h"
@@ -19,6 +22,7 @@
 #include "modules/skcms/skcms.h"
 #include "tests/Test.h"
 #include "tools/Resources.h"
+#include "tools/ToolUtils.h"
 
 #include <cstdint>
 #include <cstring>
@@ -272,3 +276,110 @@ DEF_TEST(AndroidCodec_PQ, r) {
     static constexpr skcms_Matrix3x3 kExpected = SkNamedGamut::kRec2020;
     REPORTER_ASSERT(r, 0 == memcmp(&matrix, &kExpected, sizeof(skcms_Matrix3x3)));
 }
+
+// Checks that the thumbnail of subset is exactly the rect in the image decoded at a scale.
+static void check_thumbnail(skiatest::Reporter* r,
+                            SkAndroidCodec* codec,
+                            const SkIRect& subset,
+                            const SkBitmap& scaled,
+                            const SkIRect& rect) {
+    const SkImageInfo info = scaled.info().makeDimensions(rect.size());
+    SkBitmap thumbnail;
+    thumbnail.allocPixels(info);
+    const SkCodec::Result result = codec->getThumbnail(thumbnail.pixmap(), &subset);
+    REPORTER_ASSERT(r, result == SkCodec::kSuccess, "%s", SkCodec::ResultToString(result));
+
+    SkPixmap expected;
+    REPORTER_ASSERT(r, scaled.pixmap().extractSubset(&expected, rect));
+    REPORTER_ASSERT(r, ToolUtils::equal_pixels(expected, thumbnail.pixmap()),
+                    "subset (%d, %d, %d, %d) at %dx%d", subset.left(), subset.top(),
+                    subset.right(), subset.bottom(), info.width(), info.height());
+}
+
+// Decodes the image at path scaled to size, with a codec of its own.
+static SkBitmap decode_scaled(skiatest::Reporter* r, const char* path, SkISize size) {
+    SkBitmap scaled;
+    std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(GetResourceAsData(path));
+    if (!codec) {
+        return scaled;
+    }
+    scaled.allocPixels(codec->getInfo().makeDimensions(size));
+    if (codec->getPixels(scaled.pixmap()) != SkCodec::kSuccess) {
+        ERRORF(r, "Failed to decode %s at %dx%d", path, size.width(), size.height());
+    }
+    return scaled;
+}
+
+DEF_TEST(AndroidCodec_thumbnail, r) {
+    if (GetResourcePath().isEmpty()) {
+        return;
+    }
+
+    // A JPEG's thumbnail is decoded at the smallest DCT scale at which the subset covers it, so
+    // a thumbnail the size of a scaled image is exactly that image.
+    for (const char* path : {"images/mandrill_512_q075.jpg", "images/mandrill_restart.jpg"}) {
+        auto codec = SkAndroidCodec::MakeFromData(GetResourceAsData(path));
+        if (!codec) {
+            ERRORF(r, "Failed to create codec from %s", path);
+            continue;
+        }
+        const SkIRect bounds = SkIRect::MakeSize(codec->getInfo().dimensions());
+        for (int num = 1; num <= 8; ++num) {
+            const SkBitmap scaled =
+                    decode_scaled(r, path, codec->codec()->getScaledDimensions(num / 8.0f));
+            check_thumbnail(r, codec.get(), bounds, scaled, scaled.bounds());
+        }
+    }
+
+    // These subsets map to whole pixels in the images at 1/4, so their thumbnails of that size
+    // only decode those pixels. In mandrill_restart.jpg, the rows above the subset are skipped by
+    // decoding from a restart marker.
+    {
+        const char* path = "images/mandrill_512_q075.jpg";
+        auto codec = SkAndroidCodec::MakeFromData(GetResourceAsData(path));
+        check_thumbnail(r, codec.get(), SkIRect::MakeLTRB(128, 64, 384, 320),
+                        decode_scaled(r, path, {128, 128}), SkIRect::MakeLTRB(32, 16, 96, 80));
+    }
+    {
+        // 507x509 at 1/4 is 127x128.
+        const char* path = "images/mandrill_restart.jpg";
+        auto codec = SkAndroidCodec::MakeFromData(GetResourceAsData(path));
+        check_thumbnail(r, codec.get(), SkIRect::MakeLTRB(0, 256, 507, 509),
+                        decode_scaled(r, path, {127, 128}), SkIRect::MakeLTRB(0, 64, 127, 128));
+    }
+
+    // Other images are sampled by the largest sample size that covers the thumbnail.
+    {
+        const char* path = "images/mandrill_512.png";
+        auto codec = SkAndroidCodec::MakeFromData(GetResourceAsData(path));
+        const SkIRect bounds = SkIRect::MakeSize(codec->getInfo().dimensions());
+        for (int sampleSize : {1, 2, 3}) {
+            auto sampler = SkAndroidCodec::MakeFromData(GetResourceAsData(path));
+            SkBitmap sampled;
+            sampled.allocPixels(codec->getInfo().makeDimensions(
+                    sampler->getSampledDimensions(sampleSize)));
+            SkAndroidCodec::AndroidOptions options;
+            options.fSampleSize = sampleSize;
+            REPORTER_ASSERT(r, sampler->getAndroidPixels(sampled.info(),
+                                                         sampled.getPixels(),
+                                                         sampled.rowBytes(),
+                                                         &options) == SkCodec::kSuccess);
+            check_thumbnail(r, codec.get(), bounds, sampled, sampled.bounds());
+        }
+    }
+
+    // Any size is allowed, even larger than the subset, but not an empty or invalid subset.
+    {
+        const char* path = "images/mandrill_512_q075.jpg";
+        auto codec = SkAndroidCodec::MakeFromData(GetResourceAsData(path));
+        SkBitmap thumbnail;
+        thumbnail.allocPixels(codec->getInfo().makeWH(100, 75));
+        REPORTER_ASSERT(r, codec->getThumbnail(thumbnail.pixmap()) == SkCodec::kSuccess);
+        const SkIRect small = SkIRect::MakeXYWH(200, 200, 30, 30);
+        REPORTER_ASSERT(r, codec->getThumbnail(thumbnail.pixmap(), &small) == SkCodec::kSuccess);
+        for (const SkIRect& invalid : {SkIRect::MakeEmpty(), SkIRect::MakeXYWH(500, 0, 20, 20)}) {
+            REPORTER_ASSERT(r, codec->getThumbnail(thumbnail.pixmap(), &invalid) ==
+                                       SkCodec::kInvalidParameters);
+        }
+    }
+}
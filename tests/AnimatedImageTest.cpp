@@ -13,6 +13,7 @@
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkPicture.h"
 #include "include/core/SkRect.h"
@@ -484,3 +485,69 @@ DEF_TEST(AnimatedImage, r) {
         }
     }
 }
+
+DEF_TEST(AnimatedImage_LookAhead, r) {
+    if (GetResourcePath().isEmpty()) {
+        return;
+    }
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    for (const char* file : { "images/alphabetAnim.gif",
+                              "images/colorTables.gif",
+                              "images/required.gif",
+                              "images/stoplight.webp",
+                              "images/required.webp",
+                              }) {
+        auto data = GetResourceAsData(file);
+        if (!data) {
+            ERRORF(r, "Could not get %s", file);
+            continue;
+        }
+
+        // Play the animation twice, with and without the frame cache and look-ahead, and reset
+        // it part of the way through, so that frames are decoded ahead, found in the cache and
+        // decoded from the closest cached frame they depend on.
+        auto expected = SkAnimatedImage::Make(SkAndroidCodec::MakeFromData(data));
+        auto androidCodec = SkAndroidCodec::MakeFromData(data);
+        if (!expected || !androidCodec) {
+            ERRORF(r, "Could not create animated image for %s", file);
+            continue;
+        }
+        const auto info = androidCodec->getInfo();
+        auto animatedImage = SkAnimatedImage::Make(std::move(androidCodec), info, info.bounds(),
+                                                   nullptr, executor.get(), 3);
+        if (!animatedImage) {
+            ERRORF(r, "Could not create animated image with look-ahead for %s", file);
+            continue;
+        }
+        expected->setRepetitionCount(1);
+        animatedImage->setRepetitionCount(1);
+
+        const auto imageInfo = info.makeAlphaType(kPremul_SkAlphaType);
+        auto draw = [&imageInfo](const sk_sp<SkAnimatedImage>& image) {
+            SkBitmap bm;
+            bm.allocPixels(imageInfo);
+            bm.eraseColor(SK_ColorTRANSPARENT);
+            SkCanvas canvas(bm);
+            image->draw(&canvas);
+            return bm;
+        };
+
+        const int resetAt = expected->getFrameCount() / 2;
+        for (int i = 0;; ++i) {
+            if (!compare_bitmaps(r, file, i, draw(expected), draw(animatedImage))) {
+                break;
+            }
+            if (i == resetAt) {
+                expected->reset();
+                animatedImage->reset();
+                continue;
+            }
+            const int duration = expected->decodeNextFrame();
+            REPORTER_ASSERT(r, duration == animatedImage->decodeNextFrame());
+            if (duration == SkAnimatedImage::kFinished) {
+                REPORTER_ASSERT(r, animatedImage->isFinished());
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkColor.h"
+#include "include/core/SkColorPriv.h"
+#include "include/private/SkColorData.h"
+#include "src/base/SkRandom.h"
+#include "src/core/SkBlitMask.h"
+#include "tests/Test.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// The portable kernels, built for the baseline CPU of this file, to check the ones SkOpts picks
+// for this CPU against.
+#define SK_OPTS_NS BlitMaskOptsTest
+
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-function"
+#elif defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-function"
+#endif
+
+#include "src/opts/SkBlitMask_opts.h"
+
+#if defined(__clang__)
+#pragma clang diagnostic pop
+#elif defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+// The scalar LCD16 blend, which the SIMD kernels match exactly for opaque colors. With translucent
+// colors the SSE2 kernel always uses the max of the coverages for alpha.
+static SkPMColor reference_lcd16(SkColor color, SkPMColor dst, uint16_t mask) {
+    auto upscale_31_to_32 = [](int value) { return value + (value >> 4); };
+    auto blend_32 = [](int src, int dst, int scale) { return dst + ((src - dst) * scale >> 5); };
+
+    const int srcA = SkAlpha255To256(SkColorGetA(color));
+    int maskR = upscale_31_to_32(SkGetPackedR16(mask) >> (SK_R16_BITS - 5)) * srcA >> 8;
+    int maskG = upscale_31_to_32(SkGetPackedG16(mask) >> (SK_G16_BITS - 5)) * srcA >> 8;
+    int maskB = upscale_31_to_32(SkGetPackedB16(mask) >> (SK_B16_BITS - 5)) * srcA >> 8;
+
+    const int dstA = SkGetPackedA32(dst);
+    const int maskA = (srcA - 1) < dstA ? std::min(maskR, std::min(maskG, maskB))
+                                        : std::max(maskR, std::max(maskG, maskB));
+    return SkPackARGB32(blend_32(0xFF, dstA, maskA),
+                        blend_32(SkColorGetR(color), SkGetPackedR32(dst), maskR),
+                        blend_32(SkColorGetG(color), SkGetPackedG32(dst), maskG),
+                        blend_32(SkColorGetB(color), SkGetPackedB32(dst), maskB));
+}
+
+DEF_TEST(BlitMask_LCD16, r) {
+    SkRandom rand;
+    // Widths that cover full 8 pixel groups, tails, and both.
+    for (int width : {1, 7, 8, 13, 16, 37}) {
+        constexpr int kHeight = 5;
+        const SkColor colors[] = {SK_ColorBLACK, SK_ColorWHITE, 0xFF336699,
+                                  rand.nextU() | 0xFF000000};
+        for (SkColor color : colors) {
+            std::vector<uint16_t> mask(width * kHeight);
+            std::vector<SkPMColor> dst(width * kHeight), expected(width * kHeight);
+            for (int i = 0; i < width * kHeight; ++i) {
+                // Include empty and full coverage, which take shortcuts.
+                switch (rand.nextULessThan(4)) {
+                    case 0:  mask[i] = 0;      break;
+                    case 1:  mask[i] = 0xFFFF; break;
+                    default: mask[i] = rand.nextU() & 0xFFFF; break;
+                }
+                // Both opaque and translucent dsts.
+                dst[i] = SkPreMultiplyColor(rand.nextU() | (rand.nextBool() ? 0xFF000000 : 0));
+                expected[i] = reference_lcd16(color, dst[i], mask[i]);
+            }
+
+            SkOpts::blit_mask_d32_lcd16(dst.data(), width * sizeof(SkPMColor),
+                                        mask.data(), width * sizeof(uint16_t),
+                                        color, width, kHeight);
+            for (int i = 0; i < width * kHeight; ++i) {
+                REPORTER_ASSERT(r, dst[i] == expected[i],
+                                "width %d color %08x mask %04x: got %08x, want %08x",
+                                width, color, mask[i], dst[i], expected[i]);
+            }
+        }
+    }
+}
+
+DEF_TEST(BlitMask_A8, r) {
+    // Zero coverage leaves the dst alone, and full coverage of an opaque color replaces it.
+    SkRandom rand;
+    for (int width : {3, 8, 29}) {
+        for (SkColor color : {SK_ColorBLACK, 0xFF336699, 0x80336699}) {
+            std::vector<SkAlpha> mask(width);
+            std::vector<SkPMColor> dst(width), original(width);
+            for (int i = 0; i < width; ++i) {
+                mask[i] = (i % 3 == 0) ? 0x00 : (i % 3 == 1) ? 0xFF : rand.nextU() & 0xFF;
+                original[i] = dst[i] = SkPreMultiplyColor(rand.nextU());
+            }
+
+            SkOpts::blit_mask_d32_a8(dst.data(), 0, mask.data(), 0, color, width, 1);
+            for (int i = 0; i < width; ++i) {
+                if (mask[i] == 0x00) {
+                    REPORTER_ASSERT(r, dst[i] == original[i]);
+                } else if (mask[i] == 0xFF && SkColorGetA(color) == 0xFF) {
+                    REPORTER_ASSERT(r, dst[i] == SkPreMultiplyColor(color));
+                }
+            }
+        }
+    }
+}
+
+// Fills a row with masks that include empty and full coverage, which take shortcuts, and with
+// both opaque and translucent dsts.
+template <typename Mask>
+static void fill_row(SkRandom* rand, Mask* mask, SkPMColor* dst, int width, Mask full) {
+    for (int i = 0; i < width; ++i) {
+        switch (rand->nextULessThan(4)) {
+            case 0:  mask[i] = 0;    break;
+            case 1:  mask[i] = full; break;
+            default: mask[i] = rand->nextU() & full; break;
+        }
+        dst[i] = SkPreMultiplyColor(rand->nextU() | (rand->nextBool() ? 0xFF000000 : 0));
+    }
+}
+
+// SkOpts picks the kernels for this CPU. They must draw the same pixels as the portable ones, for
+// every width and dst alignment, so that the output does not depend on the CPU.
+template <typename Mask, typename Blit>
+static void check_against_portable(skiatest::Reporter* r, Blit* optsBlit, Blit* portableBlit,
+                                   Mask full) {
+    SkOpts::Init_BlitMask();
+    SkRandom rand;
+    const SkColor colors[] = {SK_ColorBLACK, SK_ColorWHITE, 0xFF336699, 0x80336699, 0x10FFEEDD,
+                              0x00000000, rand.nextU(), rand.nextU() | 0xFF000000};
+    constexpr int kHeight = 3;
+    for (int width : {1, 3, 4, 7, 8, 9, 15, 16, 17, 31, 64, 77}) {
+        for (int offset = 0; offset < 4; ++offset) {
+            const int rowBytes = (width + offset) * sizeof(SkPMColor);
+            for (SkColor color : colors) {
+                std::vector<Mask> mask(width * kHeight);
+                std::vector<SkPMColor> dst((width + offset) * kHeight);
+                for (int y = 0; y < kHeight; ++y) {
+                    fill_row(&rand, mask.data() + y * width,
+                             dst.data() + y * (width + offset) + offset, width, full);
+                }
+                std::vector<SkPMColor> expected = dst;
+
+                optsBlit(dst.data() + offset, rowBytes, mask.data(), width * sizeof(Mask),
+                         color, width, kHeight);
+                portableBlit(expected.data() + offset, rowBytes, mask.data(),
+                             width * sizeof(Mask), color, width, kHeight);
+                for (size_t i = 0; i < dst.size(); ++i) {
+                    REPORTER_ASSERT(r, dst[i] == expected[i],
+                                    "width %d offset %d color %08x: got %08x, want %08x",
+                                    width, offset, color, dst[i], expected[i]);
+                }
+            }
+        }
+    }
+}
+
+DEF_TEST(BlitMask_LCD16_Opts, r) {
+    check_against_portable<uint16_t>(r, SkOpts::blit_mask_d32_lcd16,
+                                     BlitMaskOptsTest::blit_mask_d32_lcd16, 0xFFFF);
+}
+
+DEF_TEST(BlitMask_A8_Opts, r) {
+    check_against_portable<SkAlpha>(r, SkOpts::blit_mask_d32_a8,
+                                    BlitMaskOptsTest::blit_mask_d32_a8, 0xFF);
+}
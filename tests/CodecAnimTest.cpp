@@ -21,6 +21,7 @@
 #include "include/core/SkSize.h"
 #include "include/core/SkString.h"
 #include "include/core/SkTypes.h"
+#include "include/private/base/SkTo.h"
 #include "tests/CodecPriv.h"
 #include "tests/Test.h"
 #include "tools/Resources.h"
@@ -585,7 +586,12 @@ DEF_TEST(EncodedOriginToMatrixTest, r) {
 
 #if defined(SK_ENABLE_SKOTTIE)
 
+#include "include/core/SkExecutor.h"
 #include "modules/skresources/src/SkAnimCodecPlayer.h"
+#include "src/base/SkRandom.h"
+
+#include <deque>
+#include <functional>
 
 DEF_TEST(AnimCodecPlayer, r) {
     static constexpr struct {
@@ -630,4 +636,100 @@ DEF_TEST(AnimCodecPlayer, r) {
     }
 }
 
+DEF_TEST(AnimCodecPlayer_LookAhead, r) {
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    for (const char* file : { "images/alphabetAnim.gif",
+                              "images/required.gif",
+                              "images/required.webp",
+                              "images/stoplight.webp",
+                              "images/stoplight_h.webp" }) {
+        sk_sp<SkData> data = GetResourceAsData(file);
+        std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(data);
+        if (!codec) {
+            continue;
+        }
+        const std::vector<SkCodec::FrameInfo> frameInfos = codec->getFrameInfo();
+        std::vector<uint32_t> frameTimes;
+        uint32_t msec = 0;
+        for (const SkCodec::FrameInfo& frameInfo : frameInfos) {
+            frameTimes.push_back(msec);
+            msec += frameInfo.fDuration;
+        }
+
+        // Play the frames in order without look-ahead, for reference.
+        SkAnimCodecPlayer expected(std::move(codec));
+        std::vector<sk_sp<SkImage>> expectedFrames;
+        for (uint32_t frameTime : frameTimes) {
+            expected.seek(frameTime);
+            expectedFrames.push_back(expected.getFrame());
+        }
+
+        // Then in order and in a shuffled order, with look-ahead, so that frames are decoded
+        // ahead, found in the cache, and decoded from the closest cached frame they depend on.
+        SkAnimCodecPlayer player(SkCodec::MakeFromData(data), executor.get(), 3);
+        const int frameCount = SkToInt(frameTimes.size());
+        std::vector<int> order;
+        for (int i = 0; i < frameCount; ++i) {
+            order.push_back(i);
+        }
+        SkRandom random;
+        for (int i = 0; i < frameCount; ++i) {
+            order.push_back(random.nextULessThan(frameCount));
+        }
+        for (int i : order) {
+            if (!expectedFrames[i]) {
+                continue;
+            }
+            player.seek(frameTimes[i]);
+            sk_sp<SkImage> frame = player.getFrame();
+            REPORTER_ASSERT(r, frame && ToolUtils::equal_pixels(frame.get(),
+                                                                expectedFrames[i].get()),
+                            "%s frame %d", file, i);
+        }
+    }
+}
+
+DEF_TEST(AnimCodecPlayer_DecodesQueuedFrame, r) {
+    // Only runs its work when it is borrowed, like an executor that is busy with other work.
+    class HeldExecutor final : public SkExecutor {
+    public:
+        void add(std::function<void(void)> work) override { fWork.push_back(std::move(work)); }
+        void borrow() override {
+            if (!fWork.empty()) {
+                std::function<void(void)> work = std::move(fWork.front());
+                fWork.pop_front();
+                work();
+            }
+        }
+        size_t queued() const { return fWork.size(); }
+
+    private:
+        std::deque<std::function<void(void)>> fWork;
+    };
+
+    sk_sp<SkData> data = GetResourceAsData("images/alphabetAnim.gif");
+    std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(data);
+    if (!codec) {
+        return;
+    }
+    const std::vector<SkCodec::FrameInfo> frameInfos = codec->getFrameInfo();
+    REPORTER_ASSERT(r, frameInfos.size() > 2);
+    const uint32_t frame2Time = frameInfos[0].fDuration + frameInfos[1].fDuration;
+
+    SkAnimCodecPlayer expected(std::move(codec));
+    expected.seek(frame2Time);
+    sk_sp<SkImage> expectedFrame = expected.getFrame();
+
+    // The frames after the first are queued, but never start. The player decodes the one it
+    // shows itself instead of waiting for them.
+    HeldExecutor executor;
+    SkAnimCodecPlayer player(SkCodec::MakeFromData(data), &executor, 3);
+    REPORTER_ASSERT(r, player.getFrame());
+    REPORTER_ASSERT(r, executor.queued() > 0);
+    player.seek(frame2Time);
+    sk_sp<SkImage> frame = player.getFrame();
+    REPORTER_ASSERT(r, frame && expectedFrame &&
+                       ToolUtils::equal_pixels(frame.get(), expectedFrame.get()));
+}
+
 #endif
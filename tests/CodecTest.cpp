@@ -19,6 +19,7 @@
 #include "include/core/SkColorType.h"
 #include "include/core/SkData.h"
 #include "include/core/SkDataTable.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkImageGenerator.h"
 #include "include/core/SkImageInfo.h"
@@ -1073,6 +1074,105 @@ DEF_TEST(Codec_jpeg_rewind, r) {
     REPORTER_ASSERT(r, SkCodec::kIncompleteInput == result);
 }
 
+DEF_TEST(Codec_jpeg_executor, r) {
+    // A 4:2:0 JPEG with a restart marker at the start of each row of MCUs, which SkJpegCodec
+    // decodes in bands when it has an executor.
+    const char* path = "images/mandrill_restart.jpg";
+    sk_sp<SkData> data(GetResourceAsData(path));
+    if (!data) {
+        return;
+    }
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+
+    for (SkColorType colorType : {kN32_SkColorType, kRGB_565_SkColorType, kRGBA_F16_SkColorType}) {
+        for (size_t size : {data->size(), data->size() / 2}) {
+            sk_sp<SkData> subset = SkData::MakeSubset(data.get(), 0, size);
+            std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(subset);
+            if (!codec) {
+                ERRORF(r, "Unable to create codec '%s'.", path);
+                return;
+            }
+            const SkImageInfo info = codec->getInfo().makeColorType(colorType);
+
+            SkBitmap serial;
+            serial.allocPixels(info);
+            serial.eraseColor(SK_ColorTRANSPARENT);
+            const SkCodec::Result expected = codec->getPixels(serial.pixmap());
+
+            // Bands only decode complete images; a truncated one is decoded serially.
+            SkBitmap threaded;
+            threaded.allocPixels(info);
+            threaded.eraseColor(SK_ColorTRANSPARENT);
+            SkCodec::Options options;
+            options.fExecutor = executor.get();
+            const SkCodec::Result result = codec->getPixels(threaded.pixmap(), &options);
+
+            REPORTER_ASSERT(r, result == expected, "%s vs %s", SkCodec::ResultToString(result),
+                            SkCodec::ResultToString(expected));
+            REPORTER_ASSERT(r, ToolUtils::equal_pixels(serial, threaded),
+                            "color type %d, %zu bytes", colorType, size);
+        }
+    }
+}
+
+DEF_TEST(Codec_jpeg_skipToRestart, r) {
+    // Skipping far enough into a scanline decode of this image decodes it from a restart marker
+    // instead. The rows after should be the same as when no rows are skipped.
+    const char* path = "images/mandrill_restart.jpg";
+    sk_sp<SkData> data(GetResourceAsData(path));
+    if (!data) {
+        return;
+    }
+    std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(data);
+    if (!codec) {
+        ERRORF(r, "Unable to create codec '%s'.", path);
+        return;
+    }
+
+    for (float scale : {1.0f, 0.5f, 0.375f, 0.125f}) {
+        const SkImageInfo info = codec->getInfo().makeDimensions(
+                codec->getScaledDimensions(scale));
+        const SkIRect allColumns = SkIRect::MakeSize(info.dimensions());
+        const SkIRect someColumns =
+                SkIRect::MakeLTRB(info.width() / 3, 0, info.width() * 3 / 4, info.height());
+        for (const SkIRect& columns : {allColumns, someColumns}) {
+            SkCodec::Options options;
+            options.fSubset = &columns;
+            SkBitmap expected;
+            expected.allocPixels(info.makeWH(columns.width(), info.height()));
+            if (codec->startScanlineDecode(info, &options) != SkCodec::kSuccess ||
+                codec->getScanlines(expected.getPixels(), info.height(), expected.rowBytes()) !=
+                        info.height()) {
+                ERRORF(r, "Failed to decode '%s' at %dx%d.", path, info.width(), info.height());
+                continue;
+            }
+
+            // The image's MCUs are 16 rows tall, so this starts at one.
+            const int mcuRowTop = (int)(10 * 16 * scale);
+            for (int top : {info.height() / 4, mcuRowTop, info.height() / 2 + 3,
+                            info.height() - 1}) {
+                if (codec->startScanlineDecode(info, &options) != SkCodec::kSuccess) {
+                    ERRORF(r, "Failed to start scanline decode of '%s'.", path);
+                    continue;
+                }
+                REPORTER_ASSERT(r, codec->skipScanlines(top));
+
+                SkBitmap rows;
+                rows.allocPixels(info.makeWH(columns.width(), info.height() - top));
+                REPORTER_ASSERT(r, codec->getScanlines(rows.getPixels(),
+                                                       rows.height(),
+                                                       rows.rowBytes()) == rows.height());
+                SkPixmap expectedRows;
+                REPORTER_ASSERT(r, expected.pixmap().extractSubset(
+                        &expectedRows, SkIRect::MakeLTRB(0, top, columns.width(), info.height())));
+                REPORTER_ASSERT(r, ToolUtils::equal_pixels(expectedRows, rows.pixmap()),
+                                "%dx%d, columns %d to %d, from row %d", info.width(),
+                                info.height(), columns.left(), columns.right(), top);
+            }
+        }
+    }
+}
+
 static void check_color_xform(skiatest::Reporter* r, const char* path) {
     std::unique_ptr<SkAndroidCodec> codec(SkAndroidCodec::MakeFromStream(GetResourceAsStream(path)));
 
@@ -0,0 +1,147 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkBlendMode.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkPictureRecorder.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+#include "include/utils/SkNWayCanvas.h"
+#include "src/base/SkRandom.h"
+#include "tests/Test.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+static constexpr int kW = 200, kH = 150;
+
+static std::vector<SkRect> random_rects(int count) {
+    SkRandom rand;
+    std::vector<SkRect> rects;
+    for (int i = 0; i < count; ++i) {
+        // Some rects are unsorted, or larger than the canvas.
+        rects.push_back(SkRect::MakeLTRB(rand.nextRangeF(-30, kW + 10),
+                                         rand.nextRangeF(-30, kH + 10),
+                                         rand.nextRangeF(-10, kW + 30),
+                                         rand.nextRangeF(-10, kH + 30)));
+        if (i % 3 == 0) {
+            rects.back().setXYWH(rand.nextRangeF(0, kW), rand.nextRangeF(0, kH),
+                                 rand.nextRangeF(0, 8), rand.nextRangeF(0, 8));
+        }
+    }
+    return rects;
+}
+
+static SkBitmap draw(const std::function<void(SkCanvas*)>& fn) {
+    SkBitmap bm;
+    bm.allocN32Pixels(kW, kH);
+    bm.eraseColor(SK_ColorWHITE);
+    SkCanvas canvas(bm);
+    fn(&canvas);
+    return bm;
+}
+
+// Returns the largest difference between any two channels of the bitmaps.
+static int max_diff(const SkBitmap& a, const SkBitmap& b) {
+    int diff = 0;
+    for (int y = 0; y < kH; ++y) {
+        for (int x = 0; x < kW; ++x) {
+            const SkColor ca = a.getColor(x, y), cb = b.getColor(x, y);
+            for (int shift : {0, 8, 16, 24}) {
+                diff = std::max(diff, std::abs((int)((ca >> shift) & 0xFF) -
+                                               (int)((cb >> shift) & 0xFF)));
+            }
+        }
+    }
+    return diff;
+}
+
+static void check_matches_draw_rect(skiatest::Reporter* r,
+                                    const std::vector<SkRect>& rects,
+                                    const SkPaint& paint,
+                                    const std::function<void(SkCanvas*)>& setup) {
+    const SkBitmap expected = draw([&](SkCanvas* canvas) {
+        setup(canvas);
+        for (const SkRect& rect : rects) {
+            canvas->drawRect(rect, paint);
+        }
+    });
+    const SkBitmap actual = draw([&](SkCanvas* canvas) {
+        setup(canvas);
+        canvas->experimental_DrawRects(rects.data(), (int)rects.size(), paint);
+    });
+    const int diff = max_diff(expected, actual);
+    REPORTER_ASSERT(r, diff == 0, "aa %d mode %d style %d: diff %d",
+                    paint.isAntiAlias(), (int)paint.getBlendMode_or(SkBlendMode::kSrcOver),
+                    (int)paint.getStyle(), diff);
+}
+
+DEF_TEST(DrawRects_MatchesDrawRect, r) {
+    const std::vector<SkRect> rects = random_rects(200);
+
+    for (bool aa : {false, true}) {
+        for (SkBlendMode mode : {SkBlendMode::kSrcOver, SkBlendMode::kSrc,
+                                 SkBlendMode::kMultiply}) {
+            for (SkPaint::Style style : {SkPaint::kFill_Style, SkPaint::kStroke_Style}) {
+                SkPaint paint;
+                paint.setAntiAlias(aa);
+                paint.setBlendMode(mode);
+                paint.setColor(0x80336699);
+                paint.setStyle(style);
+                paint.setStrokeWidth(3);
+
+                check_matches_draw_rect(r, rects, paint, [&](SkCanvas* canvas) {
+                    canvas->clipRect(SkRect::MakeLTRB(5.5f, 10, 190, 140.5f), aa);
+                });
+                check_matches_draw_rect(r, rects, paint, [&](SkCanvas* canvas) {
+                    canvas->translate(3.25f, -2.5f);
+                    canvas->scale(0.75f, 1.25f);
+                });
+                check_matches_draw_rect(r, rects, paint, [&](SkCanvas* canvas) {
+                    canvas->rotate(10);
+                });
+            }
+        }
+    }
+}
+
+DEF_TEST(DrawRects_Recorded, r) {
+    // Canvases that intercept draws see the rects, in order.
+    const std::vector<SkRect> rects = random_rects(50);
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setBlendMode(SkBlendMode::kDifference);
+    paint.setColor(SK_ColorCYAN);
+
+    const SkBitmap expected = draw([&](SkCanvas* canvas) {
+        for (const SkRect& rect : rects) {
+            canvas->drawRect(rect, paint);
+        }
+    });
+
+    SkPictureRecorder recorder;
+    recorder.beginRecording(SkRect::MakeWH(kW, kH))
+            ->experimental_DrawRects(rects.data(), (int)rects.size(), paint);
+    sk_sp<SkPicture> picture = recorder.finishRecordingAsPicture();
+    REPORTER_ASSERT(r, picture->approximateOpCount() == (int)rects.size());
+    REPORTER_ASSERT(r, max_diff(expected, draw([&](SkCanvas* canvas) {
+        canvas->drawPicture(picture);
+    })) == 0);
+
+    REPORTER_ASSERT(r, max_diff(expected, draw([&](SkCanvas* canvas) {
+        SkNWayCanvas nway(kW, kH);
+        nway.addCanvas(canvas);
+        nway.experimental_DrawRects(rects.data(), (int)rects.size(), paint);
+    })) == 0);
+}
@@ -15,6 +15,7 @@
 #include "include/core/SkColorType.h"
 #include "include/core/SkData.h"
 #include "include/core/SkDataTable.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkPixmap.h"
@@ -28,15 +29,20 @@
 #include "include/encode/SkWebpEncoder.h"
 #include "include/private/base/SkMalloc.h"
 #include "include/private/base/SkTemplates.h"
+#include "src/base/SkRandom.h"
 #include "src/core/SkImageInfoPriv.h"
+#include "src/encode/SkPngFilters.h"
 #include "tests/Test.h"
 #include "tools/DecodeUtils.h"
+#include "tools/ToolUtils.h"
 
 #include <png.h>
 #include <webp/decode.h>
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <cstdlib>
 #include <initializer_list>
 #include <memory>
 #include <string>
@@ -343,6 +349,134 @@ DEF_TEST(Encode_PngOptions, r) {
     REPORTER_ASSERT(r, almost_equals(bm0, bm2, 0));
 }
 
+// Reverses the filter of a row the way a decoder does, one byte at a time.
+static void unfilter_png_row(int bpp, const uint8_t* prevRow, const uint8_t* filtered,
+                             size_t rowBytes, uint8_t* row) {
+    const uint8_t type = filtered[0];
+    filtered += 1;
+    for (size_t i = 0; i < rowBytes; ++i) {
+        const int a = i >= (size_t)bpp ? row[i - bpp] : 0;
+        const int b = prevRow[i];
+        const int c = i >= (size_t)bpp ? prevRow[i - bpp] : 0;
+        int prediction = 0;
+        switch (type) {
+            case 1: prediction = a; break;
+            case 2: prediction = b; break;
+            case 3: prediction = (a + b) / 2; break;
+            case 4: {
+                const int p = a + b - c;
+                const int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+                prediction = pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+                break;
+            }
+        }
+        row[i] = filtered[i] + prediction;
+    }
+}
+
+DEF_TEST(Encode_PngFilters, r) {
+    using FilterFlag = SkPngEncoder::FilterFlag;
+    SkRandom random;
+    for (int bpp : {1, 2, 3, 4, 6, 8}) {
+        for (int width : {1, 2, 5, 17, 33, 100}) {
+            const size_t rowBytes = bpp * width;
+            std::vector<uint8_t> prevRow(rowBytes), row(rowBytes), unfiltered(rowBytes);
+            std::vector<uint8_t> filtered(1 + rowBytes), scratch(1 + rowBytes);
+            for (size_t i = 0; i < rowBytes; ++i) {
+                // Mostly smooth, so that different filters win on different rows.
+                prevRow[i] = 3 * i + random.nextULessThan(4);
+                row[i] = prevRow[i] + random.nextULessThan(16);
+            }
+            for (FilterFlag filters : {FilterFlag::kNone, FilterFlag::kSub, FilterFlag::kUp,
+                                       FilterFlag::kAvg, FilterFlag::kPaeth, FilterFlag::kAll,
+                                       FilterFlag::kZero}) {
+                SkPngFilters::FilterRow((int)filters, bpp, prevRow.data(), row.data(), rowBytes,
+                                        filtered.data(), scratch.data());
+                REPORTER_ASSERT(r, filtered[0] <= 4);
+                if (filters != FilterFlag::kAll && filters != FilterFlag::kZero) {
+                    REPORTER_ASSERT(r, (int)filters == 0x08 << filtered[0]);
+                }
+                unfilter_png_row(bpp, prevRow.data(), filtered.data(), rowBytes,
+                                 unfiltered.data());
+                REPORTER_ASSERT(r, unfiltered == row, "bpp %d width %d filters 0x%x",
+                                bpp, width, (int)filters);
+            }
+        }
+    }
+}
+
+static sk_sp<SkData> encode_png_in_chunks(const SkPixmap& src,
+                                          const SkPngEncoder::Options& options,
+                                          int rowsPerChunk) {
+    SkDynamicMemoryWStream dst;
+    std::unique_ptr<SkEncoder> encoder = SkPngEncoder::Make(&dst, src, options);
+    if (!encoder) {
+        return nullptr;
+    }
+    for (int y = 0; y < src.height(); y += rowsPerChunk) {
+        if (!encoder->encodeRows(rowsPerChunk)) {
+            return nullptr;
+        }
+    }
+    return dst.detachAsData();
+}
+
+DEF_TEST(Encode_PngExecutor, r) {
+    // Large enough for many strips, with both smooth and noisy areas.
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(701, 923);
+    SkRandom random;
+    for (int y = 0; y < bitmap.height(); ++y) {
+        for (int x = 0; x < bitmap.width(); ++x) {
+            const U8CPU noise = y < bitmap.height() / 2 ? 0 : random.nextULessThan(256);
+            *bitmap.getAddr32(x, y) = SkPreMultiplyARGB(255 - (x + y) / 8, x & 0xFF,
+                                                        y & 0xFF, noise);
+        }
+    }
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    for (SkColorType colorType : {kN32_SkColorType, kGray_8_SkColorType, kRGBA_F16_SkColorType}) {
+        for (SkAlphaType alphaType : {kPremul_SkAlphaType, kOpaque_SkAlphaType}) {
+            if (colorType == kGray_8_SkColorType && alphaType != kOpaque_SkAlphaType) {
+                continue;
+            }
+            SkBitmap converted;
+            converted.allocPixels(bitmap.info().makeColorType(colorType).makeAlphaType(alphaType));
+            REPORTER_ASSERT(r, bitmap.readPixels(converted.pixmap()));
+
+            for (auto [filters, zlibLevel] : {std::make_pair(SkPngEncoder::FilterFlag::kAll, 6),
+                                              std::make_pair(SkPngEncoder::FilterFlag::kNone, 1),
+                                              std::make_pair(SkPngEncoder::FilterFlag::kPaeth, 0),
+                                              std::make_pair(SkPngEncoder::FilterFlag::kSub |
+                                                             SkPngEncoder::FilterFlag::kAvg, 9)}) {
+                SkPngEncoder::Options options;
+                options.fFilterFlags = filters;
+                options.fZLibLevel = zlibLevel;
+                sk_sp<SkData> serial = SkPngEncoder::Encode(nullptr, converted.asImage().get(),
+                                                            options);
+                options.fExecutor = executor.get();
+                sk_sp<SkData> parallel = SkPngEncoder::Encode(nullptr, converted.asImage().get(),
+                                                              options);
+                sk_sp<SkData> chunked = encode_png_in_chunks(converted.pixmap(), options, 37);
+                REPORTER_ASSERT(r, serial && parallel && chunked);
+                if (!serial || !parallel || !chunked) {
+                    continue;
+                }
+
+                SkBitmap expected;
+                REPORTER_ASSERT(r, SkImages::DeferredFromEncodedData(serial)
+                                           ->asLegacyBitmap(&expected));
+                for (const sk_sp<SkData>& data : {parallel, chunked}) {
+                    SkBitmap actual;
+                    REPORTER_ASSERT(r, SkImages::DeferredFromEncodedData(data)
+                                               ->asLegacyBitmap(&actual));
+                    REPORTER_ASSERT(r, ToolUtils::equal_pixels(expected, actual));
+                }
+            }
+        }
+    }
+}
+
 #ifndef SK_BUILD_FOR_GOOGLE3
 DEF_TEST(Encode_WebpQuality, r) {
     SkBitmap bm;
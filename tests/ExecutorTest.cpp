@@ -0,0 +1,47 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkExecutor.h"
+#include "src/core/SkTaskGroup.h"
+#include "tests/Test.h"
+
+#include <atomic>
+#include <memory>
+
+static void test_nested_batches(skiatest::Reporter* r, SkExecutor& executor) {
+    constexpr int kOuter = 100, kInner = 50;
+    std::atomic<int> ran{0};
+
+    SkTaskGroup tasks(executor);
+    tasks.batch(kOuter, [&](int) {
+        // Tasks batched from inside a task, and waited on while other threads are busy.
+        SkTaskGroup subtasks(executor);
+        subtasks.batch(kInner, [&](int) { ran.fetch_add(1, std::memory_order_relaxed); });
+        subtasks.wait();
+    });
+    tasks.wait();
+
+    REPORTER_ASSERT(r, ran.load() == kOuter * kInner, "%d", ran.load());
+}
+
+DEF_TEST(Executor_WorkStealing, r) {
+    for (int threads : {1, 2, 4, 0}) {
+        std::unique_ptr<SkExecutor> executor = SkExecutor::MakeWorkStealingThreadPool(threads);
+        test_nested_batches(r, *executor);
+    }
+}
+
+DEF_TEST(Executor_WorkStealing_NoBorrowing, r) {
+    // Without borrowing, wait() just spins until the pool's own threads have run everything.
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeWorkStealingThreadPool(4, false);
+
+    std::atomic<int> ran{0};
+    SkTaskGroup tasks(*executor);
+    tasks.batch(10000, [&](int) { ran.fetch_add(1, std::memory_order_relaxed); });
+    tasks.wait();
+    REPORTER_ASSERT(r, ran.load() == 10000);
+}
@@ -5,17 +5,30 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkGraphics.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkPaint.h"
 #include "include/core/SkPath.h"
 #include "include/core/SkPathTypes.h"
+#include "include/core/SkPoint.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkScalar.h"
 #include "include/core/SkTypes.h"
+#include "src/base/SkRandom.h"
 #include "src/core/SkBlitter.h"
 #include "src/core/SkScan.h"
 #include "tests/Test.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
 
 struct FakeBlitter : public SkBlitter {
     FakeBlitter()
@@ -52,3 +65,129 @@ DEF_TEST(FillPathInverse, reporter) {
 
     REPORTER_ASSERT(reporter, blitter.m_blitCount == expected_lines);
 }
+
+// Large anti-aliased fills are split into bands when a path fill executor is set. The bands must
+// produce exactly the pixels of a single-threaded fill.
+DEF_SERIAL_TEST(FillPath_AAABands, reporter) {
+    constexpr int kW = 256, kH = 300;
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+
+    auto check = [&](const char* name, const std::function<void(SkCanvas*)>& draw) {
+        SkBitmap expected, actual;
+        for (SkBitmap* bm : {&expected, &actual}) {
+            bm->allocPixels(SkImageInfo::MakeN32Premul(kW, kH));
+            bm->eraseColor(SK_ColorWHITE);
+        }
+        SkCanvas serial(expected), banded(actual);
+        SkExecutor* prev = SkGraphics::SetPathFillExecutor(nullptr);
+        draw(&serial);
+        SkGraphics::SetPathFillExecutor(executor.get());
+        draw(&banded);
+        SkGraphics::SetPathFillExecutor(prev);
+        int maxDiff = 0;
+        for (int y = 0; y < kH; ++y) {
+            for (int x = 0; x < kW; ++x) {
+                const SkColor e = expected.getColor(x, y), a = actual.getColor(x, y);
+                for (int shift : {0, 8, 16, 24}) {
+                    maxDiff = std::max(maxDiff, std::abs((int)((e >> shift) & 0xFF) -
+                                                         (int)((a >> shift) & 0xFF)));
+                }
+            }
+        }
+        REPORTER_ASSERT(reporter, maxDiff == 0, "%s: max diff %d", name, maxDiff);
+    };
+
+    SkRandom rand;
+    SkPath polygon, curves;
+    polygon.moveTo(kW / 2, 0);
+    for (int i = 0; i < 3000; ++i) {
+        polygon.lineTo(rand.nextRangeF(-10, kW + 10), rand.nextRangeF(0, kH));
+    }
+    curves.moveTo(0, 0);
+    for (int i = 0; i < 600; ++i) {
+        curves.cubicTo(rand.nextRangeF(0, kW), rand.nextRangeF(0, kH),
+                       rand.nextRangeF(0, kW), rand.nextRangeF(0, kH),
+                       rand.nextRangeF(0, kW), rand.nextRangeF(0, kH));
+    }
+
+    for (SkPathFillType fillType : {SkPathFillType::kWinding, SkPathFillType::kEvenOdd}) {
+        for (const SkPath* path : {&polygon, &curves}) {
+            SkPath filled = *path;
+            filled.setFillType(fillType);
+            SkPaint paint;
+            paint.setAntiAlias(true);
+            paint.setColor(0xC0336699);
+            check("fill", [&](SkCanvas* canvas) { canvas->drawPath(filled, paint); });
+            check("clipped", [&](SkCanvas* canvas) {
+                canvas->clipRect(SkRect::MakeLTRB(17, 33.5f, 201, 250), /*doAntiAlias=*/false);
+                canvas->translate(0.3f, -20.6f);
+                canvas->drawPath(filled, paint);
+            });
+        }
+    }
+
+    // 8 bands of this path start at rows 0, 37, 75, 112, 150, ... The edges that start at row 149
+    // are inserted around one that has already started there, and the last of them crosses the
+    // edge that starts at the top of the next band. The serial fill refines row 149 for that.
+    SkPath lookahead;
+    lookahead.moveTo(0, 0);
+    for (int i = 0; i < 1100; ++i) {
+        lookahead.lineTo(rand.nextRangeF(0, kW), rand.nextRangeF(0, 100));
+    }
+    lookahead.close();
+    lookahead.moveTo(150, 120);
+    lookahead.lineTo(160, 200);
+    lookahead.lineTo(150, 280);
+    lookahead.close();
+    lookahead.moveTo(100, 149);
+    lookahead.lineTo(210, 149);
+    lookahead.lineTo(255, 165);
+    lookahead.close();
+    lookahead.moveTo(190, 150);
+    lookahead.lineTo(195, kH);
+    lookahead.lineTo(250, kH);
+    lookahead.close();
+    SkPaint fill;
+    fill.setAntiAlias(true);
+    check("lookahead", [&](SkCanvas* canvas) { canvas->drawPath(lookahead, fill); });
+
+    // The bounds of these paths reach above their edges, through a stray moveTo or the control
+    // points of curves, so the bands at the top of the bounds have no rows to fill.
+    SkPath strayMove, outsideControls;
+    strayMove.moveTo(kW / 2, 150);
+    for (int i = 0; i < 1100; ++i) {
+        strayMove.lineTo(rand.nextRangeF(0, kW), rand.nextRangeF(150, kH));
+    }
+    strayMove.moveTo(10, 5);
+    outsideControls.moveTo(0, 250);
+    for (int i = 0; i < 400; ++i) {
+        outsideControls.cubicTo(rand.nextRangeF(0, kW), 0,
+                                rand.nextRangeF(0, kW), 0,
+                                rand.nextRangeF(0, kW), 250);
+    }
+    for (SkPathFillType fillType : {SkPathFillType::kWinding, SkPathFillType::kInverseWinding}) {
+        for (const SkPath* path : {&strayMove, &outsideControls}) {
+            SkPath filled = *path;
+            filled.setFillType(fillType);
+            check("bounds above edges", [&](SkCanvas* canvas) { canvas->drawPath(filled, fill); });
+        }
+    }
+
+    SkPaint stroke;
+    stroke.setAntiAlias(true);
+    stroke.setStyle(SkPaint::kStroke_Style);
+    stroke.setStrokeWidth(1.5f);
+    check("stroke", [&](SkCanvas* canvas) { canvas->drawPath(curves, stroke); });
+
+    // Edges that cross the seams of the bands at every angle, with coverage accumulated in the
+    // rows just above and below them.
+    SkPath wavy;
+    for (int i = 0; i < 1200; ++i) {
+        const float angle  = i * 2 * SK_ScalarPI / 1200,
+                    radius = 110 + 12 * std::sin(angle * 23);
+        const SkPoint p = {kW / 2 + radius * std::sin(angle),
+                           kH / 2 - 1.2f * radius * std::cos(angle)};
+        i == 0 ? wavy.moveTo(p) : wavy.lineTo(p);
+    }
+    check("wavy", [&](SkCanvas* canvas) { canvas->drawPath(wavy, fill); });
+}
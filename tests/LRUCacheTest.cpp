@@ -70,3 +70,25 @@ DEF_TEST(LRUCacheRandom, r) {
     }
     REPORTER_ASSERT(r, 0 == instances);
 }
+
+DEF_TEST(LRUCachePeekAndRemoveLRU, r) {
+    int instances = 0;
+    {
+        SkLRUCache<int, std::unique_ptr<Value>> test(10);
+        REPORTER_ASSERT(r, !test.peekLRU());
+        test.removeLRU();  // no-op when empty
+
+        for (int k = 0; k < 3; k++) {
+            test.insert(k, std::make_unique<Value>(k, &instances));
+        }
+        REPORTER_ASSERT(r, test.find(0));  // 1 is now the least recently used.
+        REPORTER_ASSERT(r, 1 == (*test.peekLRU())->fValue);
+        REPORTER_ASSERT(r, 1 == (*test.peekLRU())->fValue);  // peeking doesn't reorder
+
+        test.removeLRU();
+        REPORTER_ASSERT(r, 2 == instances);
+        REPORTER_ASSERT(r, !test.find(1));
+        REPORTER_ASSERT(r, 2 == (*test.peekLRU())->fValue);
+    }
+    REPORTER_ASSERT(r, 0 == instances);
+}
@@ -11,6 +11,7 @@
 #include "include/core/SkClipOp.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFont.h"
 #include "include/core/SkFontStyle.h"
 #include "include/core/SkImage.h" // IWYU pragma: keep
@@ -22,6 +23,7 @@
 #include "include/core/SkPicture.h"
 #include "include/core/SkPictureRecorder.h"
 #include "include/core/SkPixelRef.h"
+#include "include/core/SkPixmap.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkSamplingOptions.h"
@@ -34,10 +36,12 @@
 #include "src/core/SkPicturePriv.h"
 #include "src/core/SkRectPriv.h"
 #include "tests/Test.h"
+#include "tools/ToolUtils.h"
 #include "tools/fonts/FontToolUtils.h"
 
 #include <cstddef>
 #include <memory>
+#include <utility>
 #include <vector>
 
 class SkRRect;
@@ -924,3 +928,71 @@ DEF_TEST(Picture_nested_op_count, r) {
     check(make_pic(10, leaf1),  10,  10);
     check(make_pic(10, leaf10), 10, 100);
 }
+
+DEF_TEST(Picture_playbackParallel, r) {
+    auto make_pic = [](bool useBBH) {
+        SkRTreeFactory factory;
+        SkPictureRecorder rec;
+        SkCanvas* c = rec.beginRecording({0,0, 200,150}, useBBH ? &factory : nullptr);
+        SkRandom rand;
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        for (int i = 0; i < 100; i++) {
+            paint.setColor(rand.nextU() | 0xFF000000);
+            // Curved edges rasterize differently when clipped at a tile boundary, so stick to
+            // pixel-aligned rects, which every tile draws exactly as a single playback would.
+            const SkScalar x = SkIntToScalar(rand.nextULessThan(200)),
+                           y = SkIntToScalar(rand.nextULessThan(150)),
+                           s = SkIntToScalar(2 * rand.nextRangeU(1, 20));
+            paint.setStyle(i % 2 ? SkPaint::kFill_Style : SkPaint::kStroke_Style);
+            paint.setStrokeWidth(2);
+            c->drawRect(SkRect::MakeXYWH(x, y, s, s), paint);
+            if (i == 50) {
+                SkPaint layerPaint;
+                layerPaint.setAlphaf(0.5f);
+                c->saveLayer(nullptr, &layerPaint);
+            }
+        }
+        c->restore();
+        return rec.finishRecordingAsPicture();
+    };
+
+    for (bool useBBH : {false, true}) {
+        sk_sp<SkPicture> pic = make_pic(useBBH);
+        for (auto [scale, useExecutor] : {std::pair(1.0f, true), std::pair(2.0f, true),
+                                          std::pair(3.0f, true), std::pair(2.0f, false)}) {
+            const SkMatrix matrix = SkMatrix::Scale(scale, scale);
+            const SkImageInfo info = SkImageInfo::MakeN32Premul(SkScalarCeilToInt(200 * scale),
+                                                                SkScalarCeilToInt(150 * scale));
+            SkBitmap expected, actual;
+            expected.allocPixels(info);
+            actual.allocPixels(info);
+            expected.eraseColor(SK_ColorWHITE);
+            actual.eraseColor(SK_ColorWHITE);
+
+            SkCanvas canvas(expected);
+            canvas.drawPicture(pic, &matrix, nullptr);
+
+            // Without an executor, the tiles are played back serially on this thread.
+            std::unique_ptr<SkExecutor> executor =
+                    useExecutor ? SkExecutor::MakeFIFOThreadPool(4) : nullptr;
+            const SkISize tileSize = {37, 29};
+            const int tileColumns = (info.width() + tileSize.width() - 1) / tileSize.width(),
+                      tileRows = (info.height() + tileSize.height() - 1) / tileSize.height();
+            std::vector<std::unique_ptr<SkCanvas>> tiles(tileColumns * tileRows);
+            pic->playbackParallel([&](int i, const SkIRect& tileBounds) {
+                SkPixmap subset;
+                if (!actual.pixmap().extractSubset(&subset, tileBounds)) {
+                    return (SkCanvas*)nullptr;
+                }
+                tiles[i] = SkCanvas::MakeRasterDirect(subset.info(),
+                                                      subset.writable_addr(),
+                                                      subset.rowBytes());
+                return tiles[i].get();
+            }, tileSize, executor.get(), &matrix);
+
+            REPORTER_ASSERT(r, ToolUtils::equal_pixels(expected, actual),
+                            "useBBH %d, scale %g, useExecutor %d", useBBH, scale, useExecutor);
+        }
+    }
+}
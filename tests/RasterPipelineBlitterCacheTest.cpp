@@ -0,0 +1,120 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkBlendMode.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkColorFilter.h"
+#include "include/core/SkColorSpace.h"
+#include "include/core/SkGraphics.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkShader.h"
+#include "include/effects/SkGradientShader.h"
+#include "src/base/SkRandom.h"
+#include "tests/Test.h"
+#include "tools/ToolUtils.h"
+
+// Constant shaders are cached by identity, so every pass shares `constantShader`.
+static void draw(SkCanvas* canvas, const sk_sp<SkShader>& constantShader) {
+    const SkPoint pts[] = {{0, 0}, {64, 64}};
+    const SkColor colors[] = {SK_ColorRED, SK_ColorBLUE};
+    sk_sp<SkShader> gradient = SkGradientShader::MakeLinear(pts, colors, nullptr, 2,
+                                                            SkTileMode::kClamp);
+    sk_sp<SkColorFilter> filter = SkColorFilters::Blend(0x8000ff00, SkBlendMode::kSrcOver);
+    const SkBlendMode modes[] = {SkBlendMode::kSrcOver, SkBlendMode::kSrc, SkBlendMode::kMultiply};
+
+    SkRandom rand;
+    canvas->clear(SK_ColorWHITE);
+    for (int i = 0; i < 60; ++i) {
+        SkPaint paint;
+        paint.setAntiAlias(i % 2);
+        paint.setColor(i % 5 ? 0x80ff4020 : SK_ColorCYAN);
+        paint.setBlendMode(modes[i % 3]);
+        if (i % 7 == 0) {
+            paint.setColorFilter(filter);
+        }
+        if (i % 11 == 0) {
+            // Not cacheable; mixes uncached blitters in with the cached ones.
+            paint.setShader(gradient);
+        } else if (i % 13 == 0) {
+            paint.setShader(constantShader);
+        }
+        SkRect r = SkRect::MakeXYWH(rand.nextRangeF(-4, 60), rand.nextRangeF(-4, 60),
+                                    rand.nextRangeF(1, 20), rand.nextRangeF(1, 20));
+        if (i % 3) {
+            canvas->drawOval(r, paint);
+        } else {
+            canvas->drawRect(r, paint);
+        }
+    }
+}
+
+extern bool gForceHighPrecisionRasterPipeline;
+
+// Cached blitters must draw exactly what freshly built ones do.
+DEF_SERIAL_TEST(RasterPipelineBlitterCache, r) {
+    const int prevLimit = SkGraphics::GetRasterPipelineBlitterCacheCountLimit();
+    sk_sp<SkShader> magenta = SkShaders::Color(SK_ColorMAGENTA);
+
+    // These destinations use SkRasterPipelineBlitter for solid colors.
+    const SkImageInfo infos[] = {
+        SkImageInfo::Make(64, 64, kRGB_565_SkColorType, kOpaque_SkAlphaType),
+        SkImageInfo::Make(64, 64, kRGBA_F16_SkColorType, kPremul_SkAlphaType,
+                          SkColorSpace::MakeSRGBLinear()),
+        SkImageInfo::Make(64, 64, kRGBA_8888_SkColorType, kPremul_SkAlphaType,
+                          SkColorSpace::MakeRGB(SkNamedTransferFn::k2Dot2, SkNamedGamut::kRec2020)),
+    };
+    for (const SkImageInfo& info : infos) {
+        SkBitmap expected, actual;
+        expected.allocPixels(info);
+        actual.allocPixels(info);
+
+        // With the cache disabled, as it is by default, draws don't even look it up.
+        SkGraphics::SetRasterPipelineBlitterCacheCountLimit(0);
+        const int64_t disabledHits = SkGraphics::GetRasterPipelineBlitterCacheHitCount(),
+                      disabledMisses = SkGraphics::GetRasterPipelineBlitterCacheMissCount();
+        SkCanvas expectedCanvas(expected);
+        draw(&expectedCanvas, magenta);
+        REPORTER_ASSERT(r, SkGraphics::GetRasterPipelineBlitterCacheCountUsed() == 0);
+        REPORTER_ASSERT(r, SkGraphics::GetRasterPipelineBlitterCacheHitCount() == disabledHits);
+        REPORTER_ASSERT(r, SkGraphics::GetRasterPipelineBlitterCacheMissCount() == disabledMisses);
+
+        // Draw twice, so the second pass only sees cache hits.
+        SkGraphics::SetRasterPipelineBlitterCacheCountLimit(128);
+        SkGraphics::PurgeRasterPipelineBlitterCache();
+        SkCanvas actualCanvas(actual);
+        draw(&actualCanvas, magenta);
+        const int64_t hits = SkGraphics::GetRasterPipelineBlitterCacheHitCount(),
+                      misses = SkGraphics::GetRasterPipelineBlitterCacheMissCount();
+        draw(&actualCanvas, magenta);
+        REPORTER_ASSERT(r, SkGraphics::GetRasterPipelineBlitterCacheCountUsed() > 0);
+        REPORTER_ASSERT(r, SkGraphics::GetRasterPipelineBlitterCacheHitCount() > hits);
+        REPORTER_ASSERT(r, SkGraphics::GetRasterPipelineBlitterCacheMissCount() == misses);
+
+        REPORTER_ASSERT(r, ToolUtils::equal_pixels(expected, actual),
+                        "%s", ToolUtils::colortype_name(info.colorType()));
+
+        // Forcing highp changes the programs, so the ones cached above must not be used.
+        const int64_t lowpMisses = SkGraphics::GetRasterPipelineBlitterCacheMissCount();
+        gForceHighPrecisionRasterPipeline = true;
+        actualCanvas.clear(SK_ColorTRANSPARENT);
+        draw(&actualCanvas, magenta);
+        REPORTER_ASSERT(r, SkGraphics::GetRasterPipelineBlitterCacheMissCount() > lowpMisses);
+
+        SkGraphics::SetRasterPipelineBlitterCacheCountLimit(0);
+        expectedCanvas.clear(SK_ColorTRANSPARENT);
+        draw(&expectedCanvas, magenta);
+        gForceHighPrecisionRasterPipeline = false;
+        REPORTER_ASSERT(r, ToolUtils::equal_pixels(expected, actual),
+                        "%s highp", ToolUtils::colortype_name(info.colorType()));
+    }
+
+    SkGraphics::SetRasterPipelineBlitterCacheCountLimit(prevLimit);
+}
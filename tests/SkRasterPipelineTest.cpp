@@ -15,8 +15,10 @@
 #include "src/sksl/tracing/SkSLTraceHook.h"
 #include "tests/Test.h"
 
+#include <algorithm>
 #include <cmath>
 #include <numeric>
+#include <vector>
 
 using namespace skia_private;
 
@@ -3450,3 +3452,129 @@ DEF_TEST(SkRasterPipeline_stack_rewind, r) {
         stack.validate(r);
     }
 }
+
+extern bool gDisableRasterPipelineFusion;
+extern bool gForceHighPrecisionRasterPipeline;
+extern bool gRecordRasterPipelineUnfusedRuns;
+
+// Serial, because it toggles globals and checks process-wide counters.
+DEF_SERIAL_TEST(SkRasterPipeline_fusion, r) {
+    // Sample a small image through each kind of matrix, and srcover the result onto a
+    // destination. With fusion these become seed_shader_matrix_* and
+    // load_8888_dst_srcover_store_8888 stages, and must produce exactly the same pixels.
+    constexpr int kSrcW = 8, kSrcH = 8, kDstW = 41, kDstH = 3;
+    uint32_t src[kSrcW * kSrcH];
+    for (int i = 0; i < kSrcW * kSrcH; ++i) {
+        src[i] = 0x80000000 | (i << 16) | ((0x7f - i) << 8) | (i & 0x1f);
+    }
+    SkRasterPipeline_GatherCtx gatherCtx;
+    gatherCtx.pixels = src;
+    gatherCtx.stride = kSrcW;
+    gatherCtx.width  = kSrcW;
+    gatherCtx.height = kSrcH;
+
+    const float translate[]      = {-3.5f, 2.25f};
+    const float scaleTranslate[] = {0.25f, 1.5f, 1, -0.5f};
+    const float affine[]         = {0.2f, -0.3f, 2.5f, 0.15f, 0.4f, -1};
+    const struct {
+        SkRasterPipelineOp matrixOp;
+        const float*       matrix;
+    } kMatrices[] = {
+        {SkRasterPipelineOp::matrix_translate,       translate},
+        {SkRasterPipelineOp::matrix_scale_translate, scaleTranslate},
+        {SkRasterPipelineOp::matrix_2x3,             affine},
+    };
+
+    auto draw = [&](bool highp, bool fuse, SkRasterPipelineOp matrixOp, const float* matrix,
+                    uint32_t dst[]) {
+        for (int i = 0; i < kDstW * kDstH; ++i) {
+            dst[i] = 0xff000000 | (i * 0x010305);
+        }
+        SkRasterPipeline_MemoryCtx dstCtx = {dst, kDstW};
+
+        gForceHighPrecisionRasterPipeline = highp;
+        gDisableRasterPipelineFusion = !fuse;
+
+        SkRasterPipeline_<256> p;
+        p.append(SkRasterPipelineOp::seed_shader);
+        p.append(matrixOp, matrix);
+        p.append(SkRasterPipelineOp::gather_8888, &gatherCtx);
+        p.append(SkRasterPipelineOp::load_8888_dst, &dstCtx);
+        p.append(SkRasterPipelineOp::srcover);
+        p.append(SkRasterPipelineOp::store_8888, &dstCtx);
+        p.run(0, 0, kDstW, kDstH);
+
+        gForceHighPrecisionRasterPipeline = false;
+        gDisableRasterPipelineFusion = false;
+    };
+
+    SkRasterPipeline::ResetFusionStats();
+    for (bool highp : {false, true}) {
+        for (const auto& m : kMatrices) {
+            uint32_t expected[kDstW * kDstH], actual[kDstW * kDstH];
+            draw(highp, /*fuse=*/false, m.matrixOp, m.matrix, expected);
+            draw(highp, /*fuse=*/true,  m.matrixOp, m.matrix, actual);
+            REPORTER_ASSERT(r, 0 == memcmp(expected, actual, sizeof(expected)),
+                            "%s %s", highp ? "highp" : "lowp",
+                            SkRasterPipeline::GetOpName(m.matrixOp));
+        }
+    }
+
+    // Each fused stage was used once per precision, and the programs built with fusion disabled
+    // were counted as unfused.
+    SkRasterPipeline::FusionStats stats = SkRasterPipeline::GetFusionStats();
+    REPORTER_ASSERT(r, stats.fusedPrograms == 6);
+    REPORTER_ASSERT(r, stats.unfusedPrograms == 6);
+    REPORTER_ASSERT(r, stats.fusedStages.size() == 4);
+    for (const auto& [name, count] : stats.fusedStages) {
+        REPORTER_ASSERT(r, count == (strcmp(name, "load_8888_dst_srcover_store_8888") ? 2 : 6),
+                        "%s: %lld", name, (long long)count);
+    }
+
+    // Stages in a run that use different contexts are not fused.
+    uint32_t dst[2] = {0, 0}, other[2] = {0xff0000ff, 0xff0000ff};
+    SkRasterPipeline_MemoryCtx dstCtx = {dst, 0}, otherCtx = {other, 0};
+    SkRasterPipeline::ResetFusionStats();
+    SkArenaAlloc alloc(/*firstHeapAllocation=*/256);
+    SkRasterPipeline p(&alloc);
+    p.appendConstantColor(&alloc, SkColor4f{0, 0, 0, 0.5f});
+    p.append(SkRasterPipelineOp::load_8888_dst, &otherCtx);
+    p.append(SkRasterPipelineOp::srcover);
+    p.append(SkRasterPipelineOp::store_8888, &dstCtx);
+    p.run(0, 0, 2, 1);
+    REPORTER_ASSERT(r, (dst[0] & 0xff) >= 0x7f && (dst[0] >> 24) == 0xff, "%08x", dst[0]);
+    REPORTER_ASSERT(r, SkRasterPipeline::GetFusionStats().unfusedPrograms == 1);
+
+    // Runs of unfused stages are counted, and a fused stage ends a run.
+    SkRasterPipeline::ResetFusionStats();
+    gRecordRasterPipelineUnfusedRuns = true;
+    const float perspective[] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+    SkRasterPipeline_<256> q;
+    q.append(SkRasterPipelineOp::seed_shader);
+    q.append(SkRasterPipelineOp::matrix_perspective, perspective);
+    q.append(SkRasterPipelineOp::gather_8888, &gatherCtx);
+    q.append(SkRasterPipelineOp::load_8888_dst, &dstCtx);
+    q.append(SkRasterPipelineOp::srcover);
+    q.append(SkRasterPipelineOp::store_8888, &dstCtx);
+    q.run(0, 0, 2, 1);
+    q.run(0, 0, 2, 1);
+    gRecordRasterPipelineUnfusedRuns = false;
+
+    stats = SkRasterPipeline::GetFusionStats();
+    REPORTER_ASSERT(r, stats.fusedPrograms == 2);
+    using Op = SkRasterPipelineOp;
+    const std::vector<std::vector<Op>> kExpectedRuns = {
+        {Op::matrix_perspective, Op::gather_8888},
+        {Op::seed_shader, Op::matrix_perspective},
+        {Op::seed_shader, Op::matrix_perspective, Op::gather_8888},
+    };
+    REPORTER_ASSERT(r, stats.unfusedRuns.size() == (int)kExpectedRuns.size());
+    for (const SkRasterPipeline::FusionStats::UnfusedRun& run : stats.unfusedRuns) {
+        std::vector<Op> stages(run.stages, run.stages + run.count);
+        REPORTER_ASSERT(r, std::find(kExpectedRuns.begin(), kExpectedRuns.end(), stages) !=
+                           kExpectedRuns.end());
+        REPORTER_ASSERT(r, run.uses == 2);
+    }
+    SkRasterPipeline::ResetFusionStats();
+    REPORTER_ASSERT(r, SkRasterPipeline::GetFusionStats().unfusedRuns.empty());
+}
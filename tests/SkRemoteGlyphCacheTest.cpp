@@ -40,6 +40,7 @@
 #include "src/core/SkFontPriv.h"
 #include "src/core/SkGlyph.h"
 #include "src/core/SkReadBuffer.h"
+#include "src/core/SkStrikeCache.h"
 #include "src/core/SkStrikeSpec.h"
 #include "src/core/SkTHash.h"
 #include "src/core/SkTypeface_remote.h"
@@ -64,6 +65,11 @@
 #include <optional>
 #include <vector>
 
+#if defined(SK_BUILD_FOR_UNIX) && defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 using namespace skia_private;
 using Slug = sktext::gpu::Slug;
 
@@ -608,6 +614,78 @@ DEF_TEST(SkRemoteGlyphCache_ClientMemoryAccounting, reporter) {
     discardableManager->unlockAndDeleteAll();
 }
 
+#if defined(SK_BUILD_FOR_UNIX) && defined(__linux__)
+static constexpr size_t kSharedGlyphMemorySize = 1 << 16;
+
+DEF_TEST(SkRemoteGlyphCache_SharedGlyphMemory, reporter) {
+    sk_sp<DiscardableManager> discardableManager = sk_make_sp<DiscardableManager>();
+    SkStrikeServer server(discardableManager.get());
+    SkStrikeCache clientCache, otherClientCache;
+    SkStrikeClient client(discardableManager, false, &clientCache);
+    SkStrikeClient clientWithoutSharedMemory(discardableManager, false, &otherClientCache);
+
+    // Map one memfd twice, writable for the server and read-only for the client, as the two
+    // processes would.
+    const int fd = memfd_create("SkRemoteGlyphCache_SharedGlyphMemory", MFD_CLOEXEC);
+    if (fd < 0 || ftruncate(fd, kSharedGlyphMemorySize) != 0) {
+        ERRORF(reporter, "Could not make a memfd");
+        return;
+    }
+    void* writable =
+            mmap(nullptr, kSharedGlyphMemorySize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    void* readOnly = mmap(nullptr, kSharedGlyphMemorySize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (writable == MAP_FAILED || readOnly == MAP_FAILED) {
+        ERRORF(reporter, "Could not map the memfd");
+        return;
+    }
+    server.setSharedGlyphMemory(writable, kSharedGlyphMemorySize);
+    client.setSharedGlyphMemory(SkData::MakeWithProc(
+            readOnly, kSharedGlyphMemorySize,
+            [](const void* ptr, void*) { munmap(const_cast<void*>(ptr), kSharedGlyphMemorySize); },
+            nullptr));
+
+    // Server.
+    auto serverTypeface = ToolUtils::CreateTestTypeface("monospace", SkFontStyle());
+
+    int glyphCount = 10;
+    auto serverBlob = buildTextBlob(serverTypeface, glyphCount, 12);
+
+    const SkSurfaceProps props;
+    std::unique_ptr<SkCanvas> cache_diff_canvas =
+            server.makeAnalysisCanvas(100, 100, props, nullptr, true, true);
+    SkPaint paint;
+    cache_diff_canvas->drawTextBlob(serverBlob.get(), 0, 20, paint);
+
+    std::vector<uint8_t> serverStrikeData;
+    server.writeStrikeData(&serverStrikeData);
+    REPORTER_ASSERT(reporter, server.sharedGlyphMemoryUsed() > 0);
+
+    // Client.
+    REPORTER_ASSERT(reporter,
+                    client.readStrikeData(serverStrikeData.data(), serverStrikeData.size()));
+    REPORTER_ASSERT(reporter,
+                    !clientWithoutSharedMemory.readStrikeData(serverStrikeData.data(),
+                                                              serverStrikeData.size()));
+
+    // The client copied the images into its strikes, so the memory is released while the strikes
+    // are still pinned. The server can write it again, but only once.
+    std::vector<uint8_t> releasedData;
+    client.writeReleasedGlyphMemory(&releasedData);
+    REPORTER_ASSERT(reporter, !releasedData.empty());
+    REPORTER_ASSERT(reporter,
+                    server.readReleasedGlyphMemory(releasedData.data(), releasedData.size()));
+    REPORTER_ASSERT(reporter, server.sharedGlyphMemoryUsed() == 0);
+    REPORTER_ASSERT(reporter,
+                    !server.readReleasedGlyphMemory(releasedData.data(), releasedData.size()));
+    client.writeReleasedGlyphMemory(&releasedData);
+    REPORTER_ASSERT(reporter, releasedData.empty());
+
+    discardableManager->unlockAndDeleteAll();
+    munmap(writable, kSharedGlyphMemorySize);
+}
+#endif
+
 DEF_TEST(SkRemoteGlyphCache_PurgesServerEntries, reporter) {
     sk_sp<DiscardableManager> discardableManager = sk_make_sp<DiscardableManager>();
     SkStrikeServer server(discardableManager.get());
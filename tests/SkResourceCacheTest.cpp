@@ -17,20 +17,25 @@
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkSamplingOptions.h"
 #include "include/core/SkSize.h"
+#include "include/core/SkString.h"
 #include "include/core/SkSurface.h"
+#include "include/core/SkTraceMemoryDump.h"
 #include "include/core/SkTypes.h"
 #include "include/private/chromium/SkDiscardableMemory.h"
 #include "src/core/SkBitmapCache.h"
 #include "src/core/SkCachedData.h"
 #include "src/core/SkMipmap.h"
 #include "src/core/SkResourceCache.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/image/SkImage_Base.h"
 #include "src/lazy/SkDiscardableMemoryPool.h"
 #include "tests/Test.h"
 
 #include <array>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <initializer_list>
 #include <memory>
 
@@ -306,3 +311,114 @@ DEF_TEST(ResourceCache_purge, reporter) {
         }
     }
 }
+
+static bool test_rec_visitor(const SkResourceCache::Rec&, void*) { return true; }
+
+static bool contains(SkResourceCache* cache, int32_t data) {
+    return cache->find(TestKey(0, data), test_rec_visitor, nullptr);
+}
+
+static void add_purgeable(SkResourceCache* cache, int32_t data, int* flags) {
+    auto rec = std::make_unique<TestRec>(0, data, flags);
+    rec->fCanBePurged = true;
+    cache->add(rec.release());
+}
+
+/*
+ *  Test caches sharing a budget, each purging its own recs.
+ */
+DEF_TEST(ResourceCache_sharedBudget, reporter) {
+    SkResourceCache::SharedBudget budget(2);
+    budget.fTotalByteLimit = 4608;  // 4.5 recs
+    SkResourceCache a(nullptr, &budget), b(nullptr, &budget);
+    int flags = 0;
+
+    for (int32_t data : {1, 2, 3}) {
+        add_purgeable(&a, data, &flags);
+    }
+    REPORTER_ASSERT(reporter, !a.isOverBudget());
+
+    // b stays within its fair share, so it purges nothing of its own...
+    add_purgeable(&b, 4, &flags);
+    add_purgeable(&b, 5, &flags);
+    REPORTER_ASSERT(reporter, b.getTotalBytesUsed() == 2048);
+    REPORTER_ASSERT(reporter, budget.fTotalBytesUsed == 5120);
+    REPORTER_ASSERT(reporter, a.isOverBudget() && b.isOverBudget());
+
+    // ... and a, over its share, purges its least recently used rec.
+    REPORTER_ASSERT(reporter, contains(&a, 1));
+    a.purgeToBudget(/*keepFairShare=*/true);
+    REPORTER_ASSERT(reporter, !a.isOverBudget());
+    REPORTER_ASSERT(reporter, budget.fTotalBytesUsed == 4096 && budget.fCount == 4);
+    REPORTER_ASSERT(reporter, contains(&a, 1));
+    REPORTER_ASSERT(reporter, !contains(&a, 2));
+    REPORTER_ASSERT(reporter, contains(&a, 3));
+
+    const SkResourceCache::NamespaceStats* stats = a.namespaceStats().find(&gTestNamespace);
+    REPORTER_ASSERT(reporter, stats);
+    REPORTER_ASSERT(reporter, stats->fHits == 3 && stats->fMisses == 1 && stats->fEvictions == 1);
+    REPORTER_ASSERT(reporter, !strcmp(stats->fCategory, "test-category"));
+
+    a.purgeAll();
+    b.purgeAll();
+    REPORTER_ASSERT(reporter, budget.fTotalBytesUsed == 0 && budget.fCount == 0);
+}
+
+namespace {
+class StatsDump : public SkTraceMemoryDump {
+public:
+    void dumpNumericValue(const char* dumpName, const char* valueName, const char* units,
+                          uint64_t value) override {
+        if (SkString(dumpName).equals(fName)) {
+            if (!strcmp(valueName, "hits")) { fHits = value; }
+            if (!strcmp(valueName, "misses")) { fMisses = value; }
+        }
+    }
+    void setMemoryBacking(const char*, const char*, const char*) override {}
+    void setDiscardableMemoryBacking(const char*, const SkDiscardableMemory&) override {}
+    LevelOfDetail getRequestedDetails() const override {
+        return SkTraceMemoryDump::kObjectsBreakdowns_LevelOfDetail;
+    }
+
+    SkString fName = SkStringPrintf("skia/sk_resource_cache/stats/test-category_%p",
+                                    &gTestNamespace);
+    uint64_t fHits = 0, fMisses = 0;
+};
+}  // namespace
+
+/*
+ *  Test the global cache, which is sharded, from several threads at once.
+ */
+DEF_SERIAL_TEST(ResourceCache_globalSharded, reporter) {
+    constexpr size_t kLimit = 64 * 1024;
+    const size_t prevLimit = SkResourceCache::SetTotalByteLimit(kLimit);
+
+    StatsDump before;
+    SkResourceCache::DumpMemoryStatistics(&before);
+
+    constexpr int kThreads = 8, kRecs = 500;
+    static int flags[kThreads];
+    std::atomic<int> hits{0};
+    SkTaskGroup().batch(kThreads, [&](int thread) {
+        for (int i = 0; i < kRecs; ++i) {
+            const int32_t data = thread * kRecs + i;
+            auto rec = std::make_unique<TestRec>(0, data, &flags[thread]);
+            rec->fCanBePurged = true;
+            SkResourceCache::Add(rec.release());
+            if (SkResourceCache::Find(TestKey(0, data), test_rec_visitor, nullptr)) {
+                hits++;
+            }
+        }
+    });
+    REPORTER_ASSERT(reporter, SkResourceCache::GetTotalBytesUsed() < kLimit);
+
+    // Other threads may purge a rec between it being added and found, but every find is counted
+    // exactly once, in the shard of its key.
+    StatsDump after;
+    SkResourceCache::DumpMemoryStatistics(&after);
+    REPORTER_ASSERT(reporter, after.fHits - before.fHits == (uint64_t)hits.load());
+    REPORTER_ASSERT(reporter,
+                    after.fMisses - before.fMisses == (uint64_t)(kThreads * kRecs - hits.load()));
+
+    SkResourceCache::SetTotalByteLimit(prevLimit);
+}
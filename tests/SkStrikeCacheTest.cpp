@@ -5,6 +5,7 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkData.h"
 #include "include/core/SkFont.h"
 #include "include/core/SkFontStyle.h"
 #include "include/core/SkMatrix.h"
@@ -12,14 +13,25 @@
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkSurfaceProps.h"
 #include "include/core/SkTypeface.h"
+#include "include/core/SkSpan.h"
+#include "include/core/SkString.h"
+#include "src/core/SkGlyph.h"
+#include "src/core/SkOSFile.h"
 #include "src/core/SkScalerContext.h"
 #include "src/core/SkStrike.h"  // IWYU pragma: keep
 #include "src/core/SkStrikeCache.h"
+#include "src/core/SkStrikeDiskCache.h"
 #include "src/core/SkStrikeSpec.h"
+#include "src/utils/SkOSPath.h"
 #include "tests/Test.h"
 #include "tools/ToolUtils.h"
 #include "tools/fonts/FontToolUtils.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
 DEF_TEST(SkStrikeCache_CachePurge, Reporter) {
     SkStrikeCache cache;
 
@@ -61,3 +73,141 @@ DEF_TEST(SkStrikeCache_CachePurge, Reporter) {
 
 
 }
+
+DEF_TEST(SkStrikeCache_DiskCache, reporter) {
+    SkString tmpDir = skiatest::GetTmpDir();
+    if (tmpDir.isEmpty()) {
+        return;
+    }
+    SkString dir = SkOSPath::Join(tmpDir.c_str(), "strike_disk_cache");
+    sk_mkdir(dir.c_str());
+    sk_sp<SkStrikeDiskCache> diskCache = sk_make_sp<SkStrikeDiskCache>(dir.c_str());
+
+    SkFont font = ToolUtils::DefaultFont();
+    font.setEdging(SkFont::Edging::kAntiAlias);
+    font.setTypeface(ToolUtils::CreatePortableTypeface("serif", SkFontStyle::Normal()));
+    font.setSize(12);
+    auto makeSpec = [&](const SkFont& f) {
+        return SkStrikeSpec::MakeMask(f, SkPaint(), SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                                      SkScalerContextFlags::kNone, SkMatrix::I());
+    };
+    const SkStrikeSpec strikeSpec = makeSpec(font);
+    // The memory the glyphs take if their images are used in place. Rasterizing an image may
+    // make the glyph's path as well, so the stored glyphs have more paths than were asked for.
+    // The strike also counts the tables it finds them in without its lock.
+    auto inPlaceBytes = [](std::vector<const SkGlyph*> glyphs) {
+        std::sort(glyphs.begin(), glyphs.end());
+        glyphs.erase(std::unique(glyphs.begin(), glyphs.end()), glyphs.end());
+        size_t bytes = 0;
+        for (const SkGlyph* glyph : glyphs) {
+            bytes += sizeof(SkGlyph);
+            if (glyph->setPathHasBeenCalled() && glyph->path() != nullptr) {
+                bytes += glyph->path()->approximateBytesUsed();
+            }
+        }
+        return bytes;
+    };
+
+    std::vector<SkPackedGlyphID> packedIDs;
+    std::vector<SkGlyphID> glyphIDs;
+    for (SkUnichar c = ' '; c < 0x7F; c++) {
+        glyphIDs.push_back(font.unicharToGlyph(c));
+        packedIDs.push_back(SkPackedGlyphID{glyphIDs.back()});
+    }
+    std::vector<const SkGlyph*> written(packedIDs.size()), loaded(packedIDs.size()), paths(10);
+
+    // Rasterize the glyphs, and write them to the disk cache.
+    SkStrikeCache writer;
+    writer.setDiskCache(diskCache);
+    sk_sp<SkStrike> writtenStrike = strikeSpec.findOrCreateStrike(&writer);
+    writtenStrike->prepareImages(packedIDs, written.data());
+    writtenStrike->preparePaths(SkSpan(glyphIDs).first(10), paths.data());
+    writer.writeToDiskCache();
+
+    // A new cache without the disk cache rasterizes every glyph.
+    SkStrikeCache plain;
+    sk_sp<SkStrike> plainStrike = strikeSpec.findOrCreateStrike(&plain);
+    const size_t emptyStrikeSize = plain.getTotalMemoryUsed();
+
+    // A new cache with the disk cache reads the written glyphs only when they are asked for, and
+    // uses their images in place. Until then, the strike holds nothing more than an empty one.
+    SkStrikeCache reader;
+    reader.setDiskCache(diskCache);
+    sk_sp<SkStrike> loadedStrike = strikeSpec.findOrCreateStrike(&reader);
+    const size_t loadedStrikeSize = reader.getTotalMemoryUsed();
+    REPORTER_ASSERT(reporter, loadedStrikeSize == emptyStrikeSize);
+    loadedStrike->prepareImages(packedIDs, loaded.data());
+    REPORTER_ASSERT(reporter, loadedStrike->publishedGlyphsMemoryUsed() > 0);
+    REPORTER_ASSERT(reporter,
+                    reader.getTotalMemoryUsed() - loadedStrikeSize ==
+                    inPlaceBytes(loaded) + loadedStrike->publishedGlyphsMemoryUsed());
+
+    for (size_t i = 0; i < packedIDs.size(); ++i) {
+        const SkGlyph* w = written[i];
+        const SkGlyph* l = loaded[i];
+        REPORTER_ASSERT(reporter, l->getPackedID() == w->getPackedID());
+        REPORTER_ASSERT(reporter, l->iRect() == w->iRect());
+        REPORTER_ASSERT(reporter, l->advanceX() == w->advanceX());
+        REPORTER_ASSERT(reporter, l->maskFormat() == w->maskFormat());
+        REPORTER_ASSERT(reporter, (l->image() == nullptr) == (w->image() == nullptr));
+        if (l->image() != nullptr && w->image() != nullptr) {
+            REPORTER_ASSERT(reporter, memcmp(l->image(), w->image(), w->imageSize()) == 0);
+        }
+    }
+
+    // The written paths came with their glyphs.
+    const size_t loadedGlyphsSize = reader.getTotalMemoryUsed();
+    loadedStrike->preparePaths(SkSpan(glyphIDs).first(10), paths.data());
+    REPORTER_ASSERT(reporter, reader.getTotalMemoryUsed() == loadedGlyphsSize);
+
+    // When a strike gains a glyph, the glyphs that were stored but never asked for are written
+    // again with it.
+    SkStrikeCache rewriter;
+    rewriter.setDiskCache(diskCache);
+    const SkPackedGlyphID newID{glyphIDs[33], SkFixed{SK_FixedHalf}, SkFixed{0}};
+    const SkGlyph* newGlyph;
+    strikeSpec.findOrCreateStrike(&rewriter)->prepareImages({&newID, 1}, &newGlyph);
+    rewriter.writeToDiskCache();
+    SkStrikeCache rereader;
+    rereader.setDiskCache(diskCache);
+    sk_sp<SkStrike> reloadedStrike = strikeSpec.findOrCreateStrike(&rereader);
+    const size_t reloadedStrikeSize = rereader.getTotalMemoryUsed();
+    reloadedStrike->prepareImages(packedIDs, loaded.data());
+    REPORTER_ASSERT(reporter, reloadedStrikeSize == loadedStrikeSize);
+    REPORTER_ASSERT(reporter,
+                    rereader.getTotalMemoryUsed() - reloadedStrikeSize ==
+                    inPlaceBytes(loaded) + reloadedStrike->publishedGlyphsMemoryUsed());
+
+    // Glyphs that another version of the rasterizer stored are not used.
+    const uint32_t rasterizerVersion = writtenStrike->rasterizerVersion();
+    REPORTER_ASSERT(reporter, diskCache->load(strikeSpec.descriptor(), strikeSpec.typeface(),
+                                              rasterizerVersion) != nullptr);
+    REPORTER_ASSERT(reporter, diskCache->load(strikeSpec.descriptor(), strikeSpec.typeface(),
+                                              rasterizerVersion + 1) == nullptr);
+
+    // Strikes that only served stored glyphs are not written again.
+    auto removeFiles = [&] {
+        int removed = 0;
+        SkOSFile::Iter files{dir.c_str()};
+        for (SkString name; files.next(&name);) {
+            std::remove(SkOSPath::Join(dir.c_str(), name.c_str()).c_str());
+            removed++;
+        }
+        return removed;
+    };
+    REPORTER_ASSERT(reporter, removeFiles() > 0);
+    rereader.writeToDiskCache();
+    REPORTER_ASSERT(reporter, removeFiles() == 0);
+
+    // Other strikes have nothing stored.
+    const size_t readerSize = reader.getTotalMemoryUsed(),
+                 plainSize = plain.getTotalMemoryUsed();
+    font.setSize(24);
+    sk_sp<SkStrike> otherStrike = makeSpec(font).findOrCreateStrike(&reader);
+    sk_sp<SkStrike> otherPlainStrike = makeSpec(font).findOrCreateStrike(&plain);
+    REPORTER_ASSERT(reporter, reader.getTotalMemoryUsed() - readerSize ==
+                              plain.getTotalMemoryUsed() - plainSize);
+
+    removeFiles();
+    std::remove(dir.c_str());
+}
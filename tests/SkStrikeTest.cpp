@@ -30,6 +30,7 @@
 #include "src/core/SkMask.h"
 #include "src/core/SkReadBuffer.h"
 #include "src/core/SkScalerContext.h"
+#include "src/core/SkSharedGlyphMemory.h"
 #include "src/core/SkStrike.h"
 #include "src/core/SkStrikeCache.h"
 #include "src/core/SkStrikeSpec.h"
@@ -37,18 +38,30 @@
 #include "src/core/SkWriteBuffer.h"
 #include "src/text/StrikeForGPU.h"
 #include "tests/Test.h"
+#include "tools/Resources.h"
 #include "tools/ToolUtils.h"
 #include "tools/fonts/FontToolUtils.h"
 
+#ifdef SK_TYPEFACE_FACTORY_FREETYPE
+#include "src/ports/SkTypeface_FreeType.h"
+#endif
+
 #include <atomic>
+#include <cstring>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <initializer_list>
 #include <memory>
+#include <optional>
 #include <tuple>
 #include <vector>
 
+#if defined(SK_BUILD_FOR_UNIX) && defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 using namespace skia_private;
 
 using namespace sktext;
@@ -172,6 +185,73 @@ DEF_TEST(SkStrikeMultiThread, Reporter) {
     }
 }
 
+DEF_TEST(SkStrike_PrepareMultiThread, reporter) {
+    // Glyphs that have been prepared are found without the strike's lock. Check that concurrent
+    // lookups, which mix glyphs that are and are not yet prepared, always return glyphs with the
+    // requested work done. Use more glyphs than the published table starts with, so it grows
+    // while other threads read it.
+    SkFont font = ToolUtils::DefaultFont();
+    font.setEdging(SkFont::Edging::kAntiAlias);
+    font.setSubpixel(true);
+    font.setTypeface(ToolUtils::CreatePortableTypeface("serif", SkFontStyle::Normal()));
+    SkStrikeSpec strikeSpec = SkStrikeSpec::MakeMask(
+            font, SkPaint(), SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+            SkScalerContextFlags::kNone, SkMatrix::I());
+
+    std::vector<SkGlyphID> glyphIDs;
+    std::vector<SkPackedGlyphID> packedIDs;
+    for (SkUnichar c = ' '; c < 0x7F; c++) {
+        glyphIDs.push_back(font.unicharToGlyph(c));
+        packedIDs.push_back(SkPackedGlyphID{glyphIDs.back()});
+        packedIDs.push_back(SkPackedGlyphID(glyphIDs.back(), SkFixed{SK_FixedHalf}, SkFixed{0}));
+    }
+
+    static constexpr int kThreadCount = 4;
+    auto executor = SkExecutor::MakeFIFOThreadPool(kThreadCount);
+    for (int tries = 0; tries < 20; tries++) {
+        // Strikes made by createStrike() accept merges, and never publish their glyphs.
+        SkStrikeCache strikeCache;
+        sk_sp<SkStrike> strike = strikeSpec.findOrCreateStrike(&strikeCache);
+        std::atomic<int> failures{0};
+        SkTaskGroup(*executor).batch(kThreadCount, [&](int threadIndex) {
+            std::vector<const SkGlyph*> results(packedIDs.size());
+            for (int i = 0; i < 20; i++) {
+                const size_t start = (threadIndex * 7 + i * 5) % glyphIDs.size();
+                const auto ids = SkSpan(glyphIDs).subspan(start);
+                const auto packed = SkSpan(packedIDs).subspan(start);
+                switch ((threadIndex + i) % 3) {
+                    case 0:
+                        for (auto [id, glyph] : SkMakeZip(packed,
+                                                          strike->prepareImages(packed,
+                                                                                results.data()))) {
+                            if (glyph->getPackedID() != id || !glyph->setImageHasBeenCalled()) {
+                                failures++;
+                            }
+                        }
+                        break;
+                    case 1:
+                        for (auto [id, glyph] : SkMakeZip(ids, strike->preparePaths(
+                                                                      ids, results.data()))) {
+                            if (glyph->getGlyphID() != id || !glyph->setPathHasBeenCalled()) {
+                                failures++;
+                            }
+                        }
+                        break;
+                    case 2:
+                        for (auto [id, glyph] : SkMakeZip(ids, strike->metrics(
+                                                                      ids, results.data()))) {
+                            if (glyph->getGlyphID() != id) {
+                                failures++;
+                            }
+                        }
+                        break;
+                }
+            }
+        });
+        REPORTER_ASSERT(reporter, failures == 0, "failures %d", failures.load());
+    }
+}
+
 class SkGlyphTestPeer {
 public:
     static void SetGlyph(SkGlyph* glyph) {
@@ -193,8 +273,86 @@ public:
         SkAutoMutexExclusive m{strike->fStrikeLock};
         return strike->glyph(packedID);
     }
+
+    static bool IsPublished(SkStrike* strike, SkPackedGlyphID packedID) {
+        return strike->findPublishedGlyph(packedID, SkStrike::kMetricsPrepared) != nullptr;
+    }
 };
 
+DEF_TEST(SkStrike_PublishesEveryGlyph, reporter) {
+    // Every prepared glyph is found without the lock, however many the strike holds.
+    SkFont font = ToolUtils::DefaultFont();
+    font.setSubpixel(true);
+    font.setTypeface(ToolUtils::CreatePortableTypeface("serif", SkFontStyle::Normal()));
+    SkStrikeSpec strikeSpec = SkStrikeSpec::MakeMask(
+            font, SkPaint(), SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+            SkScalerContextFlags::kNone, SkMatrix::I());
+
+    std::vector<SkPackedGlyphID> packedIDs;
+    for (SkUnichar c = ' '; c < 0x7F; c++) {
+        for (SkFixed x : {0, SK_FixedQuarter, SK_FixedHalf, 3 * SK_FixedQuarter}) {
+            packedIDs.push_back(SkPackedGlyphID(font.unicharToGlyph(c), x, SkFixed{0}));
+        }
+    }
+
+    SkStrikeCache strikeCache;
+    sk_sp<SkStrike> strike = strikeSpec.findOrCreateStrike(&strikeCache);
+    std::vector<const SkGlyph*> results(packedIDs.size());
+    strike->prepareImages(packedIDs, results.data());
+    for (SkPackedGlyphID packedID : packedIDs) {
+        REPORTER_ASSERT(reporter, SkStrikeTestingPeer::IsPublished(strike.get(), packedID));
+    }
+
+    // The last table has at least two slots per glyph, and the outgrown tables, which readers may
+    // still be probing, add about as many again. They all count in the strike's memory use.
+    const size_t tableBytes = strike->publishedGlyphsMemoryUsed();
+    REPORTER_ASSERT(reporter, tableBytes > 3 * packedIDs.size() * sizeof(uintptr_t));
+    REPORTER_ASSERT(reporter, strikeCache.getTotalMemoryUsed() > tableBytes);
+}
+
+DEF_TEST(SkStrike_MergeStopsPublishing, reporter) {
+    // A merge can write to glyphs that other threads have already found, so a strike that is
+    // merged into must stop serving glyphs without its lock.
+    SkFont font = ToolUtils::DefaultFont();
+    font.setTypeface(ToolUtils::CreatePortableTypeface("serif", SkFontStyle::Normal()));
+    SkStrikeSpec strikeSpec = SkStrikeSpec::MakeMask(
+            font, SkPaint(), SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+            SkScalerContextFlags::kNone, SkMatrix::I());
+    const SkPackedGlyphID packedID{font.unicharToGlyph('A')};
+    const SkGlyph* results[1];
+
+    SkStrikeCache strikeCache;
+    sk_sp<SkStrike> strike = strikeSpec.findOrCreateStrike(&strikeCache);
+
+    // Flatten an image for the glyph before the strike makes its own.
+    SkArenaAlloc alloc{256};
+    SkGlyph incoming = *SkStrikeTestingPeer::GetGlyph(strike.get(), packedID);
+    REPORTER_ASSERT(reporter, !incoming.isEmpty() && !incoming.setImageHasBeenCalled());
+    std::vector<uint8_t> pixels(incoming.imageSize(), 0x5A);
+    incoming.setImage(&alloc, pixels.data());
+    SkBinaryWriteBuffer writeBuffer({});
+    SkStrike::FlattenGlyphsByType(writeBuffer, SkSpan(&incoming, 1), {}, {});
+    sk_sp<SkData> data = writeBuffer.snapshotAsData();
+
+    const SkGlyph* glyph = strike->prepareImages(SkSpan(&packedID, 1), results)[0];
+    const void* image = glyph->image();
+    REPORTER_ASSERT(reporter, SkStrikeTestingPeer::IsPublished(strike.get(), packedID));
+
+    SkReadBuffer readBuffer{data->data(), data->size()};
+    REPORTER_ASSERT(reporter, strike->mergeFromBuffer(readBuffer));
+    REPORTER_ASSERT(reporter, !SkStrikeTestingPeer::IsPublished(strike.get(), packedID));
+    // The image that readers may hold is kept.
+    REPORTER_ASSERT(reporter, glyph->image() == image);
+
+    strike->prepareImages(SkSpan(&packedID, 1), results);
+    REPORTER_ASSERT(reporter, !SkStrikeTestingPeer::IsPublished(strike.get(), packedID));
+
+    SkStrikeCache otherCache;
+    sk_sp<SkStrike> created = otherCache.createStrike(strikeSpec);
+    created->prepareImages(SkSpan(&packedID, 1), results);
+    REPORTER_ASSERT(reporter, !SkStrikeTestingPeer::IsPublished(created.get(), packedID));
+}
+
 DEF_TEST(SkStrike_FlattenByType, reporter) {
     std::vector<SkGlyph> imagesToSend;
     std::vector<SkGlyph> pathsToSend;
@@ -292,3 +450,343 @@ DEF_TEST(SkStrike_FlattenByType, reporter) {
     REPORTER_ASSERT(reporter, dstDrawableGlyph->setDrawableHasBeenCalled());
     REPORTER_ASSERT(reporter, dstDrawableGlyph->drawable() != nullptr);
 }
+
+#if defined(SK_BUILD_FOR_UNIX) && defined(__linux__)
+static constexpr size_t kSharedGlyphMemorySize = 1 << 16;
+
+// Map one memfd twice, writable for the server and read-only for the client, as two processes
+// would. The test runner is multithreaded, so it is not safe to fork a second process. Returns the
+// writable mapping, which the caller unmaps, or nullptr.
+static void* map_shared_glyph_memory(skiatest::Reporter* reporter,
+                                     const char* name,
+                                     sk_sp<SkData>* readOnlyMapping) {
+    const int fd = memfd_create(name, MFD_CLOEXEC);
+    if (fd < 0 || ftruncate(fd, kSharedGlyphMemorySize) != 0) {
+        ERRORF(reporter, "Could not make a memfd");
+        return nullptr;
+    }
+    void* writable =
+            mmap(nullptr, kSharedGlyphMemorySize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    void* readOnly = mmap(nullptr, kSharedGlyphMemorySize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (writable == MAP_FAILED || readOnly == MAP_FAILED) {
+        ERRORF(reporter, "Could not map the memfd");
+        return nullptr;
+    }
+    *readOnlyMapping = SkData::MakeWithProc(
+            readOnly, kSharedGlyphMemorySize,
+            [](const void* ptr, void*) { munmap(const_cast<void*>(ptr), kSharedGlyphMemorySize); },
+            nullptr);
+    return writable;
+}
+
+DEF_TEST(SkStrike_FlattenIntoSharedMemory, reporter) {
+    sk_sp<SkData> mapping;
+    void* writable =
+            map_shared_glyph_memory(reporter, "SkStrike_FlattenIntoSharedMemory", &mapping);
+    if (writable == nullptr) {
+        return;
+    }
+    const void* readOnly = mapping->data();
+
+    SkFont font = ToolUtils::DefaultFont();
+    font.setEdging(SkFont::Edging::kAntiAlias);
+    font.setSize(24);
+    font.setTypeface(ToolUtils::CreatePortableTypeface("serif", SkFontStyle::Normal()));
+    SkStrikeSpec strikeSpec = SkStrikeSpec::MakeMask(
+            font, SkPaint(), SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+            SkScalerContextFlags::kNone, SkMatrix::I());
+
+    std::vector<SkPackedGlyphID> packedIDs;
+    for (SkUnichar c = '!'; c < 0x7F; c++) {
+        packedIDs.push_back(SkPackedGlyphID{font.unicharToGlyph(c)});
+    }
+    SkStrikeCache srcCache;
+    sk_sp<SkStrike> srcStrike = strikeSpec.findOrCreateStrike(&srcCache);
+    std::vector<const SkGlyph*> srcGlyphs(packedIDs.size());
+    srcStrike->prepareImages(packedIDs, srcGlyphs.data());
+    std::vector<SkGlyph> images;
+    for (const SkGlyph* glyph : srcGlyphs) {
+        images.push_back(*glyph);
+    }
+
+    SkBinaryWriteBuffer inlineBuffer({});
+    SkStrike::FlattenGlyphsByType(inlineBuffer, images, {}, {});
+    const size_t inlineSize = inlineBuffer.bytesWritten();
+
+    // The server writes the images into a run of pages, and only their offsets into the buffer.
+    SkSharedGlyphMemory memory{writable, kSharedGlyphMemorySize};
+    memory.nextEpoch();
+    std::optional<SkSharedGlyphPages> pages =
+            memory.allocate(SkSharedGlyphMemory::ImageBytes(images));
+    if (!pages.has_value()) {
+        ERRORF(reporter, "The images don't fit in the shared memory");
+        munmap(writable, kSharedGlyphMemorySize);
+        return;
+    }
+    SkSharedGlyphImageWriter sharedImages{memory.writableMemory(*pages),
+                                          pages->fPageCount * SkSharedGlyphMemory::kPageSize};
+    SkBinaryWriteBuffer writeBuffer({});
+    SkStrike::FlattenGlyphsByType(writeBuffer, images, {}, {}, &sharedImages);
+    auto data = writeBuffer.snapshotAsData();
+    REPORTER_ASSERT(reporter, data->size() * 4 < inlineSize, "%zu", data->size());
+
+    // The client copies the images out of its read-only mapping, and releases the run once the
+    // strike is merged.
+    auto reader = sk_make_sp<SkSharedGlyphMemoryReader>(std::move(mapping));
+    SkStrikeCache dstCache;
+    sk_sp<SkStrike> dstStrike = strikeSpec.findOrCreateStrike(&dstCache);
+    SkReadBuffer readBuffer{data->data(), data->size()};
+    REPORTER_ASSERT(reporter,
+                    dstStrike->mergeFromBuffer(readBuffer, reader->lease(*pages).get()));
+    std::vector<SkSharedGlyphPages> released = reader->takeReleased();
+
+    // The server writes over the run. The glyphs the client merged don't change.
+    memset(memory.writableMemory(*pages), 0xA5, pages->fPageCount * SkSharedGlyphMemory::kPageSize);
+    auto mapped = static_cast<const uint8_t*>(readOnly);
+    for (const SkGlyph& srcGlyph : images) {
+        const SkGlyph* dstGlyph =
+                SkStrikeTestingPeer::GetGlyph(dstStrike.get(), srcGlyph.getPackedID());
+        REPORTER_ASSERT(reporter, dstGlyph->iRect() == srcGlyph.iRect());
+        if (srcGlyph.image() == nullptr) {
+            continue;
+        }
+        auto dstImage = static_cast<const uint8_t*>(dstGlyph->image());
+        REPORTER_ASSERT(reporter,
+                        dstImage < mapped || mapped + kSharedGlyphMemorySize <= dstImage);
+        REPORTER_ASSERT(reporter,
+                        memcmp(dstImage, srcGlyph.image(), srcGlyph.imageSize()) == 0,
+                        "glyph %d differs", srcGlyph.getGlyphID());
+    }
+
+    // The server takes the run back once, for its epoch.
+    REPORTER_ASSERT(reporter, released.size() == 1);
+    REPORTER_ASSERT(reporter, memory.release(released[0]));
+    REPORTER_ASSERT(reporter, memory.bytesAllocated() == 0);
+    REPORTER_ASSERT(reporter, !memory.release(released[0]));
+
+    // Once the pages are written again in a later epoch, the old run can't free them.
+    memory.nextEpoch();
+    std::optional<SkSharedGlyphPages> reused = memory.allocate(SkSharedGlyphMemory::kPageSize);
+    REPORTER_ASSERT(reporter, reused.has_value() && reused->fFirstPage == pages->fFirstPage);
+    REPORTER_ASSERT(reporter, !memory.release(*pages));
+    REPORTER_ASSERT(reporter, memory.release(*reused));
+
+    munmap(writable, kSharedGlyphMemorySize);
+}
+
+DEF_TEST(SkStrike_SharedMemoryReclaim, reporter) {
+    sk_sp<SkData> mapping;
+    void* writable = map_shared_glyph_memory(reporter, "SkStrike_SharedMemoryReclaim", &mapping);
+    if (writable == nullptr) {
+        return;
+    }
+    auto mapped = static_cast<const uint8_t*>(mapping->data());
+    SkSharedGlyphMemory memory{writable, kSharedGlyphMemorySize};
+    auto reader = sk_make_sp<SkSharedGlyphMemoryReader>(std::move(mapping));
+
+    SkFont font = ToolUtils::DefaultFont();
+    font.setEdging(SkFont::Edging::kAntiAlias);
+    font.setTypeface(ToolUtils::CreatePortableTypeface("serif", SkFontStyle::Normal()));
+    std::vector<SkGlyphID> glyphIDs;
+    for (SkUnichar c = '!'; c < 0x7F; c++) {
+        glyphIDs.push_back(font.unicharToGlyph(c));
+    }
+
+    // What the server sends for one strike: the images it rasterized, the run of pages it wrote
+    // them into, and the strike data that says where they are in the run.
+    struct Sent {
+        SkStrikeSpec strikeSpec;
+        std::vector<SkGlyph> images;
+        SkSharedGlyphPages pages;
+        sk_sp<SkData> data;
+    };
+    SkStrikeCache serverCache;
+    auto send = [&](SkScalar size, SkSpan<const SkGlyphID> ids) -> std::optional<Sent> {
+        font.setSize(size);
+        Sent sent{SkStrikeSpec::MakeMask(font, SkPaint(),
+                                         SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                                         SkScalerContextFlags::kNone, SkMatrix::I()),
+                  {}, {}, nullptr};
+        std::vector<SkPackedGlyphID> packedIDs(ids.begin(), ids.end());
+        std::vector<const SkGlyph*> glyphs(packedIDs.size());
+        sent.strikeSpec.findOrCreateStrike(&serverCache)->prepareImages(packedIDs, glyphs.data());
+        for (const SkGlyph* glyph : glyphs) {
+            sent.images.push_back(*glyph);
+        }
+
+        memory.nextEpoch();
+        std::optional<SkSharedGlyphPages> pages =
+                memory.allocate(SkSharedGlyphMemory::ImageBytes(sent.images));
+        if (!pages.has_value()) {
+            ERRORF(reporter, "The images don't fit in the shared memory");
+            return std::nullopt;
+        }
+        sent.pages = *pages;
+        SkSharedGlyphImageWriter sharedImages{memory.writableMemory(*pages),
+                                              pages->fPageCount * SkSharedGlyphMemory::kPageSize};
+        SkBinaryWriteBuffer writeBuffer({});
+        SkStrike::FlattenGlyphsByType(writeBuffer, sent.images, {}, {}, &sharedImages);
+        sent.data = writeBuffer.snapshotAsData();
+        return sent;
+    };
+
+    // The client merges the strike data into a strike of its own cache, which copies the images
+    // out of the read-only mapping. The run is released as soon as the strike is merged.
+    auto receive = [&](const Sent& sent) {
+        auto cache = std::make_unique<SkStrikeCache>();
+        sk_sp<SkStrike> strike = sent.strikeSpec.findOrCreateStrike(cache.get());
+        SkReadBuffer readBuffer{sent.data->data(), sent.data->size()};
+        REPORTER_ASSERT(reporter,
+                        strike->mergeFromBuffer(readBuffer, reader->lease(sent.pages).get()));
+        std::vector<SkSharedGlyphPages> released = reader->takeReleased();
+        REPORTER_ASSERT(reporter, released.size() == 1);
+        REPORTER_ASSERT(reporter, released[0].fFirstPage == sent.pages.fFirstPage &&
+                                  released[0].fEpoch == sent.pages.fEpoch);
+        return cache;
+    };
+    auto checkPixels = [&](SkStrikeCache* cache, const Sent& sent, const char* name) {
+        sk_sp<SkStrike> strike = sent.strikeSpec.findOrCreateStrike(cache);
+        for (const SkGlyph& image : sent.images) {
+            const SkGlyph* glyph =
+                    SkStrikeTestingPeer::GetGlyph(strike.get(), image.getPackedID());
+            REPORTER_ASSERT(reporter, glyph->iRect() == image.iRect());
+            if (image.image() == nullptr) {
+                continue;
+            }
+            auto pixels = static_cast<const uint8_t*>(glyph->image());
+            REPORTER_ASSERT(reporter,
+                            pixels < mapped || mapped + kSharedGlyphMemorySize <= pixels);
+            REPORTER_ASSERT(reporter, memcmp(pixels, image.image(), image.imageSize()) == 0,
+                            "strike %s, glyph %d differs", name, image.getGlyphID());
+        }
+    };
+    auto overlap = [](const SkSharedGlyphPages& a, const SkSharedGlyphPages& b) {
+        return a.fFirstPage < b.fFirstPage + b.fPageCount &&
+               b.fFirstPage < a.fFirstPage + a.fPageCount;
+    };
+
+    std::optional<Sent> a = send(12, glyphIDs);
+    std::optional<Sent> b = send(16, glyphIDs);
+    if (!a || !b) {
+        munmap(writable, kSharedGlyphMemorySize);
+        return;
+    }
+    std::unique_ptr<SkStrikeCache> clientA = receive(*a), clientB = receive(*b);
+    REPORTER_ASSERT(reporter, !overlap(a->pages, b->pages));
+    checkPixels(clientA.get(), *a, "a");
+    checkPixels(clientB.get(), *b, "b");
+
+    // The server reclaims the run of a, while the client's strike a is still alive.
+    REPORTER_ASSERT(reporter, memory.release(a->pages));
+
+    // The server writes other glyphs over the pages of a. The client reads the new pixels, and
+    // the images of a and b, which it copied, are untouched.
+    std::vector<SkGlyphID> otherIDs(glyphIDs.rbegin(), glyphIDs.rbegin() + glyphIDs.size() / 2);
+    std::optional<Sent> c = send(12, otherIDs);
+    if (!c) {
+        munmap(writable, kSharedGlyphMemorySize);
+        return;
+    }
+    REPORTER_ASSERT(reporter, c->pages.fFirstPage == a->pages.fFirstPage);
+    REPORTER_ASSERT(reporter, !overlap(c->pages, b->pages));
+    std::unique_ptr<SkStrikeCache> clientC = receive(*c);
+    checkPixels(clientC.get(), *c, "c");
+    checkPixels(clientA.get(), *a, "a");
+    checkPixels(clientB.get(), *b, "b");
+
+    // Releasing a again, late, does not free the pages that c uses now.
+    const size_t bytesAllocated = memory.bytesAllocated();
+    REPORTER_ASSERT(reporter, !memory.release(a->pages));
+    REPORTER_ASSERT(reporter, memory.bytesAllocated() == bytesAllocated);
+    checkPixels(clientC.get(), *c, "c");
+
+    // Once the other runs are returned, all the memory is reclaimed.
+    REPORTER_ASSERT(reporter, memory.release(b->pages));
+    REPORTER_ASSERT(reporter, memory.release(c->pages));
+    REPORTER_ASSERT(reporter, memory.bytesAllocated() == 0);
+    checkPixels(clientA.get(), *a, "a");
+
+    munmap(writable, kSharedGlyphMemorySize);
+}
+#endif
+
+// Images generated in parallel by prefillImages() must match images generated one at a time.
+static void test_prefill_images(skiatest::Reporter* reporter, sk_sp<SkTypeface> typeface) {
+    SkFont font = ToolUtils::DefaultFont();
+    font.setEdging(SkFont::Edging::kAntiAlias);
+    font.setSubpixel(true);
+    font.setSize(24);
+    font.setTypeface(std::move(typeface));
+    SkStrikeSpec strikeSpec = SkStrikeSpec::MakeMask(
+            font, SkPaint(), SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+            SkScalerContextFlags::kNone, SkMatrix::I());
+
+    // Repeat the glyphs, so that duplicates are only generated once.
+    std::vector<SkPackedGlyphID> packedIDs;
+    for (int repeat = 0; repeat < 2; repeat++) {
+        for (SkUnichar c = ' '; c < 0x7F; c++) {
+            const SkGlyphID glyphID = font.unicharToGlyph(c);
+            packedIDs.push_back(SkPackedGlyphID{glyphID});
+            packedIDs.push_back(SkPackedGlyphID(glyphID, SkFixed{SK_FixedHalf}, SkFixed{0}));
+        }
+    }
+
+    SkStrikeCache serialCache, prefillCache;
+    sk_sp<SkStrike> serialStrike = strikeSpec.findOrCreateStrike(&serialCache);
+    sk_sp<SkStrike> prefillStrike = strikeSpec.findOrCreateStrike(&prefillCache);
+    auto executor = SkExecutor::MakeFIFOThreadPool(4);
+    REPORTER_ASSERT(reporter, prefillStrike->canPrefillImages());
+    prefillStrike->prefillImages(packedIDs, executor.get());
+
+    int prefilled = 0;
+    for (SkPackedGlyphID packedID : packedIDs) {
+        const SkGlyph* glyph = SkStrikeTestingPeer::GetGlyph(prefillStrike.get(), packedID);
+        prefilled += glyph->setImageHasBeenCalled() ? 1 : 0;
+    }
+    REPORTER_ASSERT(reporter, prefilled == SkToInt(packedIDs.size()), "%d", prefilled);
+
+    std::vector<const SkGlyph*> serialGlyphs(packedIDs.size()), prefillGlyphs(packedIDs.size());
+    serialStrike->prepareImages(packedIDs, serialGlyphs.data());
+    prefillStrike->prepareImages(packedIDs, prefillGlyphs.data());
+    for (auto [serial, prefill] : SkMakeZip(serialGlyphs, prefillGlyphs)) {
+        REPORTER_ASSERT(reporter, serial->getPackedID() == prefill->getPackedID());
+        REPORTER_ASSERT(reporter, serial->iRect() == prefill->iRect());
+        if (serial->image() != nullptr && prefill->image() != nullptr) {
+            REPORTER_ASSERT(reporter,
+                            memcmp(serial->image(), prefill->image(), serial->imageSize()) == 0,
+                            "glyph %d differs", serial->getGlyphID());
+        } else {
+            REPORTER_ASSERT(reporter, serial->image() == prefill->image());
+        }
+    }
+}
+
+DEF_TEST(SkStrike_PrefillImages, reporter) {
+    test_prefill_images(reporter, ToolUtils::CreatePortableTypeface("serif", SkFontStyle()));
+}
+
+#ifdef SK_TYPEFACE_FACTORY_FREETYPE
+DEF_TEST(SkStrike_PrefillImagesFreeType, reporter) {
+    // Each task opens the font in a FreeType library of its own.
+    sk_sp<SkTypeface> typeface = SkTypeface_FreeType::MakeFromStream(
+            GetResourceAsStream("fonts/Roboto-Regular.ttf"), SkFontArguments());
+    if (!typeface) {
+        ERRORF(reporter, "Could not load fonts/Roboto-Regular.ttf");
+        return;
+    }
+    test_prefill_images(reporter, std::move(typeface));
+}
+#endif
+
+DEF_TEST(SkStrike_PrefillImagesNeedsConcurrentScaler, reporter) {
+    // Scaler contexts that can't make contexts which generate images concurrently, like the empty
+    // typeface's, are never used in parallel.
+    SkFont font{SkTypeface::MakeEmpty(), 24};
+    SkStrikeSpec strikeSpec = SkStrikeSpec::MakeMask(
+            font, SkPaint(), SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+            SkScalerContextFlags::kNone, SkMatrix::I());
+    SkStrikeCache strikeCache;
+    sk_sp<SkStrike> strike = strikeSpec.findOrCreateStrike(&strikeCache);
+    REPORTER_ASSERT(reporter, !strike->canPrefillImages());
+}
@@ -34,7 +34,9 @@
 
 #include <cmath>
 #include <cstdlib>
+#include <iterator>
 #include <utility>
+#include <vector>
 
 void TestReadPixels(skiatest::Reporter* reporter,
                     GrDirectContext* dContext,
@@ -294,7 +296,7 @@ DEF_TEST(chartoglyph_cache, reporter) {
             index = cache.findGlyphIndex(c);
         }
         REPORTER_ASSERT(reporter, index < 0);
-        cache.insertCharAndGlyph(~index, c, glyph);
+        cache.insertCharAndGlyph(c, glyph);
 
         UnicharGen gen2(step);
         for (int j = 0; j <= i; ++j) {
@@ -308,3 +310,48 @@ DEF_TEST(chartoglyph_cache, reporter) {
         }
     }
 }
+
+DEF_TEST(chartoglyph_cache_pages, reporter) {
+    SkCharToGlyphCache cache;
+
+    // Unichars spread over the BMP and the other planes, including the ends of each plane.
+    std::vector<SkUnichar> unichars;
+    for (SkUnichar c = 0; c <= 0x10FFFF; c += 0x3FF) {
+        unichars.push_back(c);
+    }
+    unichars.push_back(0xFFFF);
+    unichars.push_back(0x10000);
+    unichars.push_back(0x10FFFF);
+    for (SkUnichar c : unichars) {
+        REPORTER_ASSERT(reporter, cache.findGlyphIndex(c) < 0);
+        cache.insertCharAndGlyph(c, hash_to_glyph(c) & 0x7FFF);
+    }
+    REPORTER_ASSERT(reporter, cache.count() == SkToInt(unichars.size()));
+    for (SkUnichar c : unichars) {
+        REPORTER_ASSERT(reporter, cache.findGlyphIndex(c) == (hash_to_glyph(c) & 0x7FFF));
+        REPORTER_ASSERT(reporter, cache.findGlyphIndex(c ^ 1) < 0);
+    }
+
+    // Values that aren't unichars are never cached.
+    for (SkUnichar c : {-1, 0x110000, 0x7FFFFFFF}) {
+        cache.insertCharAndGlyph(c, 1);
+        REPORTER_ASSERT(reporter, cache.findGlyphIndex(c) < 0);
+    }
+    REPORTER_ASSERT(reporter, cache.count() == SkToInt(unichars.size()));
+
+    // The bulk lookup stops at the first unichar that isn't cached.
+    std::vector<SkGlyphID> glyphs(unichars.size());
+    REPORTER_ASSERT(reporter, cache.findGlyphs(unichars.data(), SkToInt(unichars.size()),
+                                               glyphs.data()) == SkToInt(unichars.size()));
+    for (size_t i = 0; i < unichars.size(); ++i) {
+        REPORTER_ASSERT(reporter, glyphs[i] == (hash_to_glyph(unichars[i]) & 0x7FFF));
+    }
+    const SkUnichar text[] = {unichars[1], unichars[1] + 1, unichars[2]};
+    REPORTER_ASSERT(reporter, cache.findGlyphs(text, std::size(text), glyphs.data()) == 1);
+    const SkUnichar invalid[] = {unichars[1], -1};
+    REPORTER_ASSERT(reporter, cache.findGlyphs(invalid, std::size(invalid), glyphs.data()) == 1);
+
+    cache.reset();
+    REPORTER_ASSERT(reporter, cache.count() == 0 && cache.bytesUsed() == 0);
+    REPORTER_ASSERT(reporter, cache.findGlyphIndex(unichars[1]) < 0);
+}
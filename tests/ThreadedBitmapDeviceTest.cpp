@@ -0,0 +1,254 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkBlendMode.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkDrawable.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkPath.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkPictureRecorder.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkRRect.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkSurface.h"
+#include "include/effects/SkGradientShader.h"
+#include "include/effects/SkImageFilters.h"
+#include "src/base/SkRandom.h"
+#include "src/core/SkCanvasPriv.h"
+#include "tests/Test.h"
+#include "tools/ToolUtils.h"
+
+#include <functional>
+#include <memory>
+
+static constexpr int kW = 300, kH = 500;
+
+// Draw into a regular raster surface and a threaded one, and check the pixels match exactly.
+static void check_matches_serial(skiatest::Reporter* r,
+                                 const std::function<void(SkCanvas*)>& draw,
+                                 int bandCount) {
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(kW, kH);
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+
+    sk_sp<SkSurface> serial = SkSurfaces::Raster(info);
+    sk_sp<SkSurface> threaded = SkSurfaces::RasterThreaded(info, executor.get(), bandCount);
+    REPORTER_ASSERT(r, serial && threaded);
+    if (!serial || !threaded) {
+        return;
+    }
+    draw(serial->getCanvas());
+    draw(threaded->getCanvas());
+
+    SkBitmap expected, actual;
+    expected.allocPixels(info);
+    actual.allocPixels(info);
+    REPORTER_ASSERT(r, serial->readPixels(expected, 0, 0));
+    REPORTER_ASSERT(r, threaded->readPixels(actual, 0, 0));
+    REPORTER_ASSERT(r, ToolUtils::equal_pixels(expected, actual),
+                    "bandCount %d", bandCount);
+}
+
+static void draw_random_shapes(SkCanvas* canvas) {
+    SkRandom rand;
+    const SkPoint pts[] = {{0, 0}, {kW, kH}};
+    const SkColor colors[] = {SK_ColorBLUE, SK_ColorYELLOW};
+    canvas->clear(SK_ColorWHITE);
+    for (int i = 0; i < 200; ++i) {
+        SkPaint paint;
+        paint.setAntiAlias(rand.nextBool());
+        paint.setColor(rand.nextU() | 0x80000000);
+        if (rand.nextBool()) {
+            paint.setStyle(SkPaint::kStroke_Style);
+            paint.setStrokeWidth(rand.nextRangeF(0, 6));
+        }
+        if (i % 17 == 0) {
+            paint.setShader(SkGradientShader::MakeLinear(pts, colors, nullptr, 2,
+                                                         SkTileMode::kClamp));
+        }
+        const SkRect rect = SkRect::MakeXYWH(rand.nextRangeF(-20, kW), rand.nextRangeF(-20, kH),
+                                             rand.nextRangeF(1, 120), rand.nextRangeF(1, 120));
+        switch (i % 4) {
+            case 0: canvas->drawRect(rect, paint); break;
+            case 1: canvas->drawOval(rect, paint); break;
+            case 2: canvas->drawRRect(SkRRect::MakeRectXY(rect, 8, 8), paint); break;
+            case 3: {
+                SkPath path;
+                path.moveTo(rect.fLeft, rect.fTop);
+                path.cubicTo(rect.fRight, rect.fTop, rect.fLeft, rect.fBottom,
+                             rect.fRight, rect.fBottom);
+                canvas->drawPath(path, paint);
+            } break;
+        }
+    }
+}
+
+DEF_TEST(ThreadedBitmapDevice_Shapes, r) {
+    for (int bandCount : {0, 1, 3, 7, kH}) {
+        check_matches_serial(r, draw_random_shapes, bandCount);
+    }
+}
+
+DEF_TEST(ThreadedBitmapDevice_LayersAndState, r) {
+    check_matches_serial(r, [](SkCanvas* canvas) {
+        canvas->clear(SK_ColorGRAY);
+
+        // A blurred layer needs content from outside each band to produce the band's pixels.
+        SkPaint layerPaint;
+        layerPaint.setImageFilter(SkImageFilters::Blur(12, 12, nullptr));
+        canvas->saveLayer(nullptr, &layerPaint);
+        SkPaint paint;
+        paint.setColor(SK_ColorRED);
+        canvas->drawRect(SkRect::MakeXYWH(40, 90, 200, 60), paint);
+        canvas->restore();
+
+        canvas->save();
+        canvas->translate(30, 200);
+        canvas->rotate(20);
+        canvas->clipRRect(SkRRect::MakeOval(SkRect::MakeWH(200, 150)), true);
+        paint.setColor(SK_ColorGREEN);
+        canvas->drawPaint(paint);
+        canvas->restore();
+
+        paint.setBlendMode(SkBlendMode::kMultiply);
+        paint.setColor(SK_ColorCYAN);
+        canvas->drawCircle(150, 250, 120, paint);
+    }, 5);
+}
+
+DEF_TEST(ThreadedBitmapDevice_FlushMidStream, r) {
+    // Reading pixels in the middle of drawing resolves pending draws, but must not lose the
+    // matrix, clip or open layers that later draws depend on.
+    check_matches_serial(r, [](SkCanvas* canvas) {
+        SkBitmap scratch;
+        scratch.allocPixels(SkImageInfo::MakeN32Premul(4, 4));
+
+        canvas->clear(SK_ColorWHITE);
+        canvas->save();
+        canvas->translate(20, 40);
+        canvas->clipRect(SkRect::MakeWH(200, 300), true);
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        paint.setColor(SK_ColorBLUE);
+        canvas->drawCircle(100, 100, 90, paint);
+        canvas->readPixels(scratch, 0, 0);
+
+        SkPaint alpha;
+        alpha.setAlphaf(0.5f);
+        canvas->saveLayer(nullptr, &alpha);
+        paint.setColor(SK_ColorRED);
+        canvas->drawCircle(100, 200, 90, paint);
+        canvas->readPixels(scratch, 100, 100);  // the layer is still open
+        paint.setColor(SK_ColorGREEN);
+        canvas->drawRect(SkRect::MakeXYWH(50, 150, 100, 100), paint);
+        canvas->restore();
+        canvas->readPixels(scratch, 100, 100);
+
+        paint.setColor(SK_ColorMAGENTA);
+        canvas->drawCircle(0, 300, 60, paint);
+        canvas->restore();
+        canvas->drawCircle(kW, kH, 60, paint);
+    }, 6);
+}
+
+DEF_TEST(ThreadedBitmapDevice_NestedPictures, r) {
+    // A picture whose layer reads its backdrop needs pixels from every band it covers, so that
+    // layer must not be split into bands, although the picture's other ops are.
+    SkPictureRecorder recorder;
+    SkCanvas* pictureCanvas = recorder.beginRecording(SkRect::MakeWH(kW, kH));
+    sk_sp<SkImageFilter> blur = SkImageFilters::Blur(10, 10, nullptr);
+    pictureCanvas->saveLayer(SkCanvas::SaveLayerRec(nullptr, nullptr, blur.get(), 0));
+    pictureCanvas->restore();
+    sk_sp<SkPicture> picture = recorder.finishRecordingAsPicture();
+
+    class Stripes final : public SkDrawable {
+    public:
+        SkColor fColor = SK_ColorGREEN;
+
+    private:
+        SkRect onGetBounds() override { return SkRect::MakeWH(kW, kH); }
+        void onDraw(SkCanvas* canvas) override {
+            SkPaint paint;
+            paint.setColor(fColor);
+            for (int y = 0; y < kH; y += 40) {
+                canvas->drawRect(SkRect::MakeXYWH(0, y, kW, 20), paint);
+            }
+        }
+    };
+
+    check_matches_serial(r, [&](SkCanvas* canvas) {
+        canvas->clear(SK_ColorWHITE);
+        draw_random_shapes(canvas);
+        canvas->drawPicture(picture);
+        // The drawable is drawn as it is now, not as it is when the draws are flushed.
+        auto drawable = sk_make_sp<Stripes>();
+        canvas->drawDrawable(drawable.get());
+        drawable->fColor = SK_ColorBLUE;
+        drawable->notifyDrawingChanged();
+        SkPaint paint;
+        paint.setColor(SK_ColorRED);
+        canvas->drawCircle(150, 250, 40, paint);
+        canvas->drawPicture(picture);
+    }, 8);
+}
+
+DEF_TEST(ThreadedBitmapDevice_StateAcrossFlushes, r) {
+    // Each flush compacts the matrix and clip changes that are still in effect.
+    check_matches_serial(r, [](SkCanvas* canvas) {
+        SkBitmap scratch;
+        scratch.allocPixels(SkImageInfo::MakeN32Premul(1, 1));
+
+        canvas->clear(SK_ColorWHITE);
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        canvas->save();
+        for (int i = 0; i < 20; ++i) {
+            canvas->translate(7, 11);
+            canvas->rotate(3);
+            canvas->scale(1.01f, 0.99f);
+            if (i % 5 == 0) {
+                SkCanvasPriv::ResetClip(canvas);
+            }
+            canvas->clipRect(SkRect::MakeXYWH(-40, -60, 260, 280), true);
+            paint.setColor(0xFF000000 | (i * 0x0B1D3F));
+            canvas->drawRect(SkRect::MakeXYWH(0, 0, 60, 40), paint);
+            canvas->readPixels(scratch, 0, 0);
+        }
+        canvas->restore();
+        canvas->drawCircle(kW / 2, kH / 2, 50, paint);
+    }, 6);
+}
+
+DEF_TEST(ThreadedBitmapDevice_Snapshot, r) {
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(64, 64);
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(2);
+    sk_sp<SkSurface> surface = SkSurfaces::RasterThreaded(info, executor.get(), 4);
+    REPORTER_ASSERT(r, surface);
+
+    surface->getCanvas()->clear(SK_ColorRED);
+    sk_sp<SkImage> red = surface->makeImageSnapshot();
+    surface->getCanvas()->clear(SK_ColorBLUE);
+    sk_sp<SkImage> blue = surface->makeImageSnapshot();
+
+    SkPixmap pm;
+    REPORTER_ASSERT(r, red->peekPixels(&pm) && pm.getColor(32, 32) == SK_ColorRED);
+    REPORTER_ASSERT(r, blue->peekPixels(&pm) && pm.getColor(32, 32) == SK_ColorBLUE);
+    REPORTER_ASSERT(r, surface->peekPixels(&pm) && pm.getColor(63, 63) == SK_ColorBLUE);
+
+    // Surfaces made from a threaded surface, like SKPBench's tiles, are threaded too.
+    sk_sp<SkSurface> tile = surface->makeSurface(32, 32);
+    REPORTER_ASSERT(r, tile);
+    tile->getCanvas()->clear(SK_ColorGREEN);
+    sk_sp<SkImage> green = tile->makeImageSnapshot();
+    REPORTER_ASSERT(r, green->peekPixels(&pm) && pm.getColor(16, 16) == SK_ColorGREEN);
+}
@@ -22,6 +22,7 @@ CORE_TESTS = [
     "BitmapGetColorTest.cpp",
     "BitmapTest.cpp",
     "BlitMaskClip.cpp",
+    "BlitMaskTest.cpp",
     "CachedDecodingPixelRefTest.cpp",
     "CanvasTest.cpp",
     "ChecksumTest.cpp",
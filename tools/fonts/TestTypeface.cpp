@@ -254,6 +254,9 @@ public:
         this->forceGenerateImageFromPath();
     }
 
+    // Paths come straight from the typeface's immutable test font data.
+    bool canGenerateImagesConcurrently() const override { return true; }
+
 protected:
     TestTypeface* getTestTypeface() const {
         return static_cast<TestTypeface*>(this->getTypeface());